@@ -0,0 +1,182 @@
+#include "app_tasks.h"
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "APP_TASKS";
+
+// The whole topology in one place. Audio sits just below the IDF's IPC tasks
+// on a core of its own; on the control core the encoder outranks the UI so a
+// long OLED redraw never delays a turn, the rig control protocol, the command
+// console and the statistics collector sit below the UI and the analyzer
+// takes what is left.
+static const app_task_config_t app_task_table[APP_TASK_COUNT] = {
+    [APP_TASK_AUDIO] = {"audio_task", 4096, configMAX_PRIORITIES - 2, APP_CORE_AUDIO},
+    [APP_TASK_ENCODER] = {"encoder_task", 2048, 6, APP_CORE_CONTROL},
+    [APP_TASK_UI] = {"ui_task", 4096, 5, APP_CORE_CONTROL},
+    [APP_TASK_SPECTRUM] = {"spectrum_task", 4096, 1, APP_CORE_CONTROL},
+    [APP_TASK_MONITOR] = {"monitor_task", 3072, 2, APP_CORE_CONTROL},
+    [APP_TASK_CONSOLE] = {"console_repl", 6144, 3, APP_CORE_CONTROL},
+    [APP_TASK_CONTROL] = {"control_task", 3072, 4, APP_CORE_CONTROL},
+};
+
+const app_task_config_t *app_tasks_get_config(app_task_id_t id)
+{
+    if (id >= APP_TASK_COUNT)
+    {
+        return NULL;
+    }
+    return &app_task_table[id];
+}
+
+esp_err_t app_tasks_create(app_task_id_t id, TaskFunction_t fn, void *arg, TaskHandle_t *handle)
+{
+    const app_task_config_t *config = app_tasks_get_config(id);
+    if (!config || !fn)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (xTaskCreatePinnedToCore(fn, config->name, config->stack, arg, config->priority, handle, config->core) !=
+        pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create %s", config->name);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void app_tasks_log_topology(void)
+{
+    for (int id = 0; id < APP_TASK_COUNT; id++)
+    {
+        const app_task_config_t *config = &app_task_table[id];
+        ESP_LOGI(TAG, "%-14s core %d, priority %2u, stack %" PRIu32, config->name, (int)config->core,
+                 (unsigned)config->priority, config->stack);
+    }
+}
+
+// Stress test state, shared with the load tasks it spawns
+typedef struct
+{
+    app_stress_fn_t hammer;
+    void *arg;
+    volatile bool stop;
+    volatile uint32_t iterations;
+    uint32_t running;
+} app_stress_ctx_t;
+
+static void app_stress_hammer_task(void *pvParameters)
+{
+    app_stress_ctx_t *ctx = (app_stress_ctx_t *)pvParameters;
+
+    // Back to back UI work at the UI's own priority
+    while (!ctx->stop)
+    {
+        ctx->hammer(ctx->arg, ctx->iterations);
+        ctx->iterations++;
+        taskYIELD();
+    }
+
+    __atomic_fetch_sub(&ctx->running, 1, __ATOMIC_RELEASE);
+    vTaskDelete(NULL);
+}
+
+static void app_stress_burn_task(void *pvParameters)
+{
+    app_stress_ctx_t *ctx = (app_stress_ctx_t *)pvParameters;
+
+    // A CPU hog above every control task, the worst the control core can do to its neighbour
+    while (!ctx->stop)
+    {
+        int64_t until_us = esp_timer_get_time() + APP_STRESS_BURN_MS * 1000;
+        while (esp_timer_get_time() < until_us)
+        {
+        }
+        vTaskDelay(pdMS_TO_TICKS(APP_STRESS_REST_MS));
+    }
+
+    __atomic_fetch_sub(&ctx->running, 1, __ATOMIC_RELEASE);
+    vTaskDelete(NULL);
+}
+
+static void app_stress_log(const char *phase, const audio_jitter_stats_t *stats)
+{
+    ESP_LOGI(TAG, "%s: %" PRIu32 " blocks, period %" PRIu32 " us, stdev %" PRIu32 " us, worst %+" PRId32
+                  " us (%.1f%% of a period), %" PRIu32 " late",
+             phase, stats->intervals, stats->ideal_period_us, stats->stdev_us, stats->worst_deviation_us,
+             stats->ideal_period_us ? stats->worst_deviation_us * 100.0f / stats->ideal_period_us : 0.0f,
+             stats->anomaly_count);
+}
+
+esp_err_t app_tasks_stress_test(uint32_t phase_ms, app_stress_fn_t hammer, void *arg, app_stress_result_t *result)
+{
+    if (!hammer || !result || phase_ms == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Audio block cadence is the latency measure: a block picked up late is a block the audio task waited for
+    ESP_LOGI(TAG, "Stress test: %" PRIu32 " ms quiet, then %" PRIu32 " ms with the UI hammered", phase_ms,
+             phase_ms);
+    audio_jitter_reset();
+    vTaskDelay(pdMS_TO_TICKS(phase_ms));
+    audio_jitter_get_stats(&result->baseline);
+
+    // The load tasks are waited for before returning, so the context can live on this stack
+    app_stress_ctx_t ctx;
+    ctx.hammer = hammer;
+    ctx.arg = arg;
+    ctx.stop = false;
+    ctx.iterations = 0;
+    ctx.running = 2;
+
+    const app_task_config_t *ui = app_tasks_get_config(APP_TASK_UI);
+    const app_task_config_t *encoder = app_tasks_get_config(APP_TASK_ENCODER);
+    audio_jitter_reset();
+    if (xTaskCreatePinnedToCore(app_stress_hammer_task, "stress_ui", ui->stack, &ctx, ui->priority, NULL,
+                                APP_CORE_CONTROL) != pdPASS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreatePinnedToCore(app_stress_burn_task, "stress_burn", 2048, &ctx, encoder->priority + 1, NULL,
+                                APP_CORE_CONTROL) != pdPASS)
+    {
+        ctx.running = 1;
+        ctx.stop = true;
+        while (__atomic_load_n(&ctx.running, __ATOMIC_ACQUIRE) != 0)
+        {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        return ESP_ERR_NO_MEM;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(phase_ms));
+    audio_jitter_get_stats(&result->loaded);
+    ctx.stop = true;
+    while (__atomic_load_n(&ctx.running, __ATOMIC_ACQUIRE) != 0)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    result->hammer_iterations = ctx.iterations;
+
+    // Which control-core activity was in flight when a late block arrived
+    audio_jitter_anomaly_t late[AUDIO_JITTER_ANOMALY_COUNT];
+    size_t count = audio_jitter_get_anomalies(late, AUDIO_JITTER_ANOMALY_COUNT);
+    result->display_anomalies = 0;
+    result->nvs_anomalies = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        result->display_anomalies += (late[i].activity & AUDIO_JITTER_ACT_DISPLAY) ? 1 : 0;
+        result->nvs_anomalies += (late[i].activity & AUDIO_JITTER_ACT_NVS) ? 1 : 0;
+    }
+
+    app_tasks_log_topology();
+    app_stress_log("Quiet", &result->baseline);
+    app_stress_log("Hammered", &result->loaded);
+    ESP_LOGI(TAG, "%" PRIu32 " UI iterations; late blocks during display %" PRIu32 ", during NVS %" PRIu32,
+             result->hammer_iterations, result->display_anomalies, result->nvs_anomalies);
+
+    // A late block under load means the control core still reaches the audio path
+    return result->loaded.anomaly_count == 0 ? ESP_OK : ESP_FAIL;
+}
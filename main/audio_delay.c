@@ -1,8 +1,18 @@
 #include "audio_delay.h"
 #include "es8388_driver.h"
+#include "audio_profiler.h"
+#include "audio_jitter.h"
+#include "audio_meter.h"
+#include "spectrum_analyzer.h"
+#include "power_manager.h"
+#include "trace_buffer.h"
+#include "metrics.h"
+#include "dsp_kernels.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
 #include <string.h>
 #include <stdlib.h>
 #include <inttypes.h>
@@ -18,62 +28,80 @@ static const char *TAG = "AUDIO_DELAY";
 // I2S channel handles
 static i2s_chan_handle_t tx_handle = NULL;
 static i2s_chan_handle_t rx_handle = NULL;
+static BaseType_t i2s_core = -1; // Core the DMA interrupts were allocated on
 
-esp_err_t audio_delay_init(audio_delay_t *delay_ctx)
-{
-    if (!delay_ctx)
-    {
-        return ESP_ERR_INVALID_ARG;
-    }
+// I2S overflow counters, written from the I2S ISR
+static audio_i2s_stats_t i2s_stats;
+static portMUX_TYPE i2s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
 
-    // Initialize delay context
-    delay_ctx->sample_rate = DEFAULT_SAMPLE_RATE;
-    delay_ctx->delay_ms = DEFAULT_DELAY_MS;
-    delay_ctx->buffer_size = DELAY_BUFFER_SIZE;
-    delay_ctx->write_index = 0;
-    delay_ctx->read_index = 0;
-    delay_ctx->initialized = false;
+// Log overflow events at most once per interval, from task context
+#define I2S_STATS_LOG_INTERVAL_US 1000000
 
-    // Allocate delay buffer
-    delay_ctx->delay_buffer = (int16_t *)malloc(DELAY_BUFFER_SIZE * sizeof(int16_t));
-    if (!delay_ctx->delay_buffer)
-    {
-        ESP_LOGE(TAG, "Failed to allocate delay buffer");
-        return ESP_ERR_NO_MEM;
-    }
+static bool IRAM_ATTR audio_i2s_on_recv_q_ovf(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
+{
+    portENTER_CRITICAL_ISR(&i2s_stats_lock);
+    i2s_stats.rx_overflow_count++;
+    i2s_stats.rx_dropped_bytes += event->size;
+    i2s_stats.last_rx_overflow_us = esp_timer_get_time();
+    uint32_t total = i2s_stats.rx_overflow_count;
+    portEXIT_CRITICAL_ISR(&i2s_stats_lock);
+    TRACE_RECORD(TRACE_EV_I2S_RX_OVERFLOW, event->size, total);
+    METRIC_INC(METRIC_I2S_RX_OVERFLOWS);
+    return false;
+}
 
-    // Clear delay buffer
-    memset(delay_ctx->delay_buffer, 0, DELAY_BUFFER_SIZE * sizeof(int16_t));
+static bool IRAM_ATTR audio_i2s_on_send_q_ovf(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
+{
+    portENTER_CRITICAL_ISR(&i2s_stats_lock);
+    i2s_stats.tx_underflow_count++;
+    i2s_stats.last_tx_underflow_us = esp_timer_get_time();
+    uint32_t total = i2s_stats.tx_underflow_count;
+    portEXIT_CRITICAL_ISR(&i2s_stats_lock);
+    TRACE_RECORD(TRACE_EV_I2S_TX_UNDERFLOW, total, 0);
+    METRIC_INC(METRIC_I2S_TX_UNDERFLOWS);
+    return false;
+}
 
-    // Initialize ES8388 codec
-    es8388_config_t es8388_cfg = ES8388_DEFAULT_CONFIG();
-    es8388_cfg.sample_rate = (es8388_sample_rate_t)delay_ctx->sample_rate;
+// Create, configure and enable both I2S channels at the given sample rate
+static esp_err_t audio_i2s_start(uint32_t sample_rate)
+{
+    // Configure I2S channel
+    i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
+    chan_cfg.dma_desc_num = AUDIO_DMA_DESC_NUM;
+    chan_cfg.dma_frame_num = AUDIO_BUFFER_SIZE;
+    chan_cfg.auto_clear = true; // Starved TX plays silence instead of repeating stale buffers
 
-    esp_err_t ret = es8388_init(&es8388_cfg);
+    esp_err_t ret = i2s_new_channel(&chan_cfg, &tx_handle, &rx_handle);
     if (ret != ESP_OK)
     {
-        ESP_LOGE(TAG, "Failed to initialize ES8388: %s", esp_err_to_name(ret));
-        free(delay_ctx->delay_buffer);
+        ESP_LOGE(TAG, "Failed to create I2S channel: %s", esp_err_to_name(ret));
+        tx_handle = NULL;
+        rx_handle = NULL;
         return ret;
     }
 
-    // Configure I2S channel
-    i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
-    chan_cfg.dma_desc_num = 8;
-    chan_cfg.dma_frame_num = AUDIO_BUFFER_SIZE;
+    // Overflow callbacks must be registered before the channels are enabled
+    i2s_event_callbacks_t rx_cbs = {
+        .on_recv_q_ovf = audio_i2s_on_recv_q_ovf,
+    };
+    i2s_event_callbacks_t tx_cbs = {
+        .on_send_q_ovf = audio_i2s_on_send_q_ovf,
+    };
 
-    ret = i2s_new_channel(&chan_cfg, &tx_handle, &rx_handle);
+    ret = i2s_channel_register_event_callback(rx_handle, &rx_cbs, NULL);
+    if (ret == ESP_OK)
+    {
+        ret = i2s_channel_register_event_callback(tx_handle, &tx_cbs, NULL);
+    }
     if (ret != ESP_OK)
     {
-        ESP_LOGE(TAG, "Failed to create I2S channel: %s", esp_err_to_name(ret));
-        es8388_deinit();
-        free(delay_ctx->delay_buffer);
-        return ret;
+        ESP_LOGE(TAG, "Failed to register I2S event callbacks: %s", esp_err_to_name(ret));
+        goto fail;
     }
 
     // Configure I2S standard mode
     i2s_std_config_t std_cfg = {
-        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(delay_ctx->sample_rate),
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(sample_rate),
         .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO),
         .gpio_cfg = {
             .mclk = I2S_GPIO_UNUSED,
@@ -93,22 +121,14 @@ esp_err_t audio_delay_init(audio_delay_t *delay_ctx)
     if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "Failed to initialize I2S TX channel: %s", esp_err_to_name(ret));
-        i2s_del_channel(tx_handle);
-        i2s_del_channel(rx_handle);
-        es8388_deinit();
-        free(delay_ctx->delay_buffer);
-        return ret;
+        goto fail;
     }
 
     ret = i2s_channel_init_std_mode(rx_handle, &std_cfg);
     if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "Failed to initialize I2S RX channel: %s", esp_err_to_name(ret));
-        i2s_del_channel(tx_handle);
-        i2s_del_channel(rx_handle);
-        es8388_deinit();
-        free(delay_ctx->delay_buffer);
-        return ret;
+        goto fail;
     }
 
     // Enable I2S channels
@@ -116,23 +136,120 @@ esp_err_t audio_delay_init(audio_delay_t *delay_ctx)
     if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "Failed to enable I2S TX channel: %s", esp_err_to_name(ret));
-        i2s_del_channel(tx_handle);
-        i2s_del_channel(rx_handle);
-        es8388_deinit();
-        free(delay_ctx->delay_buffer);
-        return ret;
+        goto fail;
     }
 
     ret = i2s_channel_enable(rx_handle);
     if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "Failed to enable I2S RX channel: %s", esp_err_to_name(ret));
+        i2s_channel_disable(tx_handle);
+        goto fail;
+    }
+    i2s_core = xPortGetCoreID();
+
+    return ESP_OK;
+
+fail:
+    i2s_del_channel(tx_handle);
+    i2s_del_channel(rx_handle);
+    tx_handle = NULL;
+    rx_handle = NULL;
+    return ret;
+}
+
+// Disable and delete both I2S channels
+static void audio_i2s_stop(void)
+{
+    if (tx_handle)
+    {
         i2s_channel_disable(tx_handle);
         i2s_del_channel(tx_handle);
+        tx_handle = NULL;
+    }
+    if (rx_handle)
+    {
+        i2s_channel_disable(rx_handle);
         i2s_del_channel(rx_handle);
+        rx_handle = NULL;
+    }
+}
+
+esp_err_t audio_delay_init(audio_delay_t *delay_ctx)
+{
+    if (!delay_ctx)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Initialize delay context
+    delay_ctx->sample_rate = DEFAULT_SAMPLE_RATE;
+    delay_ctx->delay_ms = DEFAULT_DELAY_MS;
+    delay_ctx->buffer_size = DELAY_BUFFER_SIZE;
+    delay_ctx->write_index = 0;
+    delay_ctx->read_index = 0;
+    delay_ctx->initialized = false;
+    delay_ctx->task_running = false;
+    delay_ctx->pending_sample_rate = 0;
+    memset(&delay_ctx->rate_switch, 0, sizeof(delay_ctx->rate_switch));
+    memset(&delay_ctx->watchdog, 0, sizeof(delay_ctx->watchdog));
+    delay_ctx->last_block_us = 0;
+    delay_ctx->next_recovery_us = 0;
+    delay_ctx->recovery_retry_us = 0;
+    delay_ctx->chain = NULL;
+    delay_ctx->gate = NULL;
+    delay_ctx->generator = NULL;
+    delay_ctx->bypassed = false;
+    delay_ctx->silent_run = 0;
+    delay_ctx->bypassed_samples = 0;
+    delay_ctx->stale = false;
+    delay_ctx->feedback_q15 = 0;
+    delay_ctx->damping_q15 = 0;
+    delay_ctx->damping_state = 0;
+    delay_ctx->mix_q15 = DEFAULT_MIX_Q15;
+    delay_ctx->input_peak = 0;
+    delay_ctx->input_sum_sq = 0;
+    audio_events_init(&delay_ctx->events);
+    delay_ctx->sample_clock = 0;
+    delay_ctx->clock_seq = 0;
+    delay_ctx->gain_q15 = DSP_Q15_ONE;
+
+    delay_ctx->rate_switch_done = xSemaphoreCreateBinary();
+    if (!delay_ctx->rate_switch_done)
+    {
+        ESP_LOGE(TAG, "Failed to create rate switch semaphore");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Allocate delay buffer
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    delay_ctx->delay_buffer = (int16_t *)malloc(DELAY_BUFFER_SIZE * sizeof(int16_t));
+    if (!delay_ctx->delay_buffer)
+    {
+        ESP_LOGE(TAG, "Failed to allocate delay buffer");
+        goto fail;
+    }
+
+    // Clear delay buffer
+    memset(delay_ctx->delay_buffer, 0, DELAY_BUFFER_SIZE * sizeof(int16_t));
+
+    // Initialize ES8388 codec
+    es8388_config_t es8388_cfg = ES8388_DEFAULT_CONFIG();
+    es8388_cfg.sample_rate = (es8388_sample_rate_t)delay_ctx->sample_rate;
+
+    ret = es8388_init(&es8388_cfg);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to initialize ES8388: %s", esp_err_to_name(ret));
+        goto fail;
+    }
+
+    // Create and start the I2S channels
+    ret = audio_i2s_start(delay_ctx->sample_rate);
+    if (ret != ESP_OK)
+    {
         es8388_deinit();
-        free(delay_ctx->delay_buffer);
-        return ret;
+        goto fail;
     }
 
     // Start ES8388 codec
@@ -140,13 +257,9 @@ esp_err_t audio_delay_init(audio_delay_t *delay_ctx)
     if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "Failed to start ES8388: %s", esp_err_to_name(ret));
-        i2s_channel_disable(tx_handle);
-        i2s_channel_disable(rx_handle);
-        i2s_del_channel(tx_handle);
-        i2s_del_channel(rx_handle);
+        audio_i2s_stop();
         es8388_deinit();
-        free(delay_ctx->delay_buffer);
-        return ret;
+        goto fail;
     }
 
     delay_ctx->initialized = true;
@@ -154,6 +267,13 @@ esp_err_t audio_delay_init(audio_delay_t *delay_ctx)
              delay_ctx->sample_rate, delay_ctx->delay_ms);
 
     return ESP_OK;
+
+fail:
+    free(delay_ctx->delay_buffer);
+    delay_ctx->delay_buffer = NULL;
+    vSemaphoreDelete(delay_ctx->rate_switch_done);
+    delay_ctx->rate_switch_done = NULL;
+    return ret;
 }
 
 esp_err_t audio_delay_deinit(audio_delay_t *delay_ctx)
@@ -168,18 +288,7 @@ esp_err_t audio_delay_deinit(audio_delay_t *delay_ctx)
         // Stop ES8388 codec
         es8388_stop();
 
-        if (tx_handle)
-        {
-            i2s_channel_disable(tx_handle);
-            i2s_del_channel(tx_handle);
-            tx_handle = NULL;
-        }
-        if (rx_handle)
-        {
-            i2s_channel_disable(rx_handle);
-            i2s_del_channel(rx_handle);
-            rx_handle = NULL;
-        }
+        audio_i2s_stop();
 
         // Deinitialize ES8388
         es8388_deinit();
@@ -193,10 +302,177 @@ esp_err_t audio_delay_deinit(audio_delay_t *delay_ctx)
         delay_ctx->delay_buffer = NULL;
     }
 
+    if (delay_ctx->rate_switch_done)
+    {
+        vSemaphoreDelete(delay_ctx->rate_switch_done);
+        delay_ctx->rate_switch_done = NULL;
+    }
+
     ESP_LOGI(TAG, "Audio delay deinitialized");
     return ESP_OK;
 }
 
+// Fade a block linearly to silence so the rate switch does not click
+static void audio_delay_fade_out(int16_t *samples, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        samples[i] = (int16_t)(((int32_t)samples[i] * (int32_t)(count - i)) / (int32_t)count);
+    }
+}
+
+// Reprogram the ES8388 and both I2S channels for a new sample rate.
+// The channels must not be in use by the audio task while this runs.
+static esp_err_t audio_delay_reconfigure_rate(uint32_t sample_rate)
+{
+    es8388_mute(true);
+
+    // Clock reconfiguration is only allowed on disabled channels
+    i2s_channel_disable(tx_handle);
+    i2s_channel_disable(rx_handle);
+
+    esp_err_t ret = es8388_set_sample_rate((es8388_sample_rate_t)sample_rate);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to set ES8388 sample rate: %s", esp_err_to_name(ret));
+    }
+
+    i2s_std_clk_config_t clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(sample_rate);
+
+    if (ret == ESP_OK)
+    {
+        ret = i2s_channel_reconfig_std_clock(tx_handle, &clk_cfg);
+        if (ret != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to set I2S TX sample rate: %s", esp_err_to_name(ret));
+        }
+    }
+
+    if (ret == ESP_OK)
+    {
+        ret = i2s_channel_reconfig_std_clock(rx_handle, &clk_cfg);
+        if (ret != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to set I2S RX sample rate: %s", esp_err_to_name(ret));
+        }
+    }
+
+    // Always bring the channels back so the audio task never blocks on a disabled channel
+    i2s_channel_enable(tx_handle);
+    i2s_channel_enable(rx_handle);
+    es8388_mute(false);
+
+    return ret;
+}
+
+// Re-align the read head for the current rate and silence the part of the
+// line that will be played next, so old-rate audio is not replayed
+static void audio_delay_reset_line(audio_delay_t *delay_ctx)
+{
+    uint32_t delay_samples = (delay_ctx->delay_ms * delay_ctx->sample_rate) / 1000;
+    if (delay_samples >= delay_ctx->buffer_size)
+    {
+        delay_samples = delay_ctx->buffer_size - 1;
+    }
+
+    delay_ctx->read_index = (delay_ctx->write_index + delay_ctx->buffer_size - delay_samples) % delay_ctx->buffer_size;
+
+    uint32_t first = delay_ctx->buffer_size - delay_ctx->read_index;
+    if (first > delay_samples)
+    {
+        first = delay_samples;
+    }
+    memset(&delay_ctx->delay_buffer[delay_ctx->read_index], 0, first * sizeof(int16_t));
+    memset(delay_ctx->delay_buffer, 0, (delay_samples - first) * sizeof(int16_t));
+}
+
+// One error line per AUDIO_IO_ERROR_LOG_MS with the count since the last one, the audio task only
+static void audio_delay_log_io_error(const char *what, esp_err_t err)
+{
+    static int64_t last_log_us = 0;
+    static uint32_t suppressed = 0;
+    int64_t now_us = esp_timer_get_time();
+
+    if (last_log_us != 0 && now_us - last_log_us < AUDIO_IO_ERROR_LOG_MS * 1000LL)
+    {
+        suppressed++;
+        return;
+    }
+    ESP_LOGE(TAG, "%s error: %s (%" PRIu32 " more since the last report)", what, esp_err_to_name(err), suppressed);
+    last_log_us = now_us;
+    suppressed = 0;
+}
+
+static void audio_delay_record_rate_switch(audio_delay_t *delay_ctx, uint32_t from_rate, int64_t start_us, esp_err_t result)
+{
+    delay_ctx->rate_switch.from_rate = from_rate;
+    delay_ctx->rate_switch.to_rate = delay_ctx->sample_rate;
+    delay_ctx->rate_switch.dropout_us = (uint32_t)(esp_timer_get_time() - start_us);
+    delay_ctx->rate_switch.result = result;
+    delay_ctx->rate_switch.switch_count++;
+
+    TRACE_RECORD(TRACE_EV_RATE_SWITCH, from_rate, delay_ctx->sample_rate);
+    METRIC_INC(METRIC_RATE_SWITCHES);
+    ESP_LOGI(TAG, "Sample rate %" PRIu32 " -> %" PRIu32 " Hz, dropout %" PRIu32 " us (%s)",
+             from_rate, delay_ctx->sample_rate, delay_ctx->rate_switch.dropout_us, esp_err_to_name(result));
+}
+
+// Rate switch transaction, run by the audio task in place of a normal block write:
+// fade out, drain the TX DMA ring, reprogram codec and I2S, then restart with silence.
+// Every write is bounded by io_timeout; the first failed one aborts the transaction
+// and the watchdog takes over the stalled path.
+static esp_err_t audio_delay_run_rate_switch(audio_delay_t *delay_ctx, uint32_t sample_rate,
+                                             int16_t *block, size_t samples, TickType_t io_timeout)
+{
+    int64_t start_us = esp_timer_get_time();
+    uint32_t from_rate = delay_ctx->sample_rate;
+    size_t bytes_written;
+
+    // Ramp the pending output block down and queue it
+    audio_delay_fade_out(block, samples);
+    esp_err_t ret = i2s_channel_write(tx_handle, block, samples * sizeof(int16_t), &bytes_written, io_timeout);
+
+    // Push one full DMA ring of silence so the ramp has left the codec before the clocks stop
+    memset(block, 0, AUDIO_BUFFER_SIZE * sizeof(int16_t));
+    for (int i = 0; i < AUDIO_DMA_DESC_NUM && ret == ESP_OK; i++)
+    {
+        ret = i2s_channel_write(tx_handle, block, AUDIO_BUFFER_SIZE * sizeof(int16_t), &bytes_written, io_timeout);
+    }
+
+    if (ret != ESP_OK)
+    {
+        audio_delay_log_io_error("Rate switch drain", ret);
+        audio_delay_record_rate_switch(delay_ctx, from_rate, start_us, ret);
+        return ret;
+    }
+
+    ret = audio_delay_reconfigure_rate(sample_rate);
+    if (ret == ESP_OK)
+    {
+        delay_ctx->sample_rate = sample_rate;
+        audio_delay_reset_line(delay_ctx);
+    }
+
+    // Defined silence gap at the new rate before live audio resumes
+    size_t gap_samples = (delay_ctx->sample_rate * RATE_SWITCH_SILENCE_MS) / 1000;
+    while (gap_samples > 0)
+    {
+        size_t chunk = gap_samples < AUDIO_BUFFER_SIZE ? gap_samples : AUDIO_BUFFER_SIZE;
+        esp_err_t write_ret = i2s_channel_write(tx_handle, block, chunk * sizeof(int16_t), &bytes_written,
+                                                io_timeout);
+        if (write_ret != ESP_OK)
+        {
+            audio_delay_log_io_error("Rate switch restart", write_ret);
+            ret = ret == ESP_OK ? write_ret : ret;
+            break;
+        }
+        gap_samples -= chunk;
+    }
+
+    audio_delay_record_rate_switch(delay_ctx, from_rate, start_us, ret);
+    return ret;
+}
+
 esp_err_t audio_delay_set_sample_rate(audio_delay_t *delay_ctx, uint32_t sample_rate)
 {
     if (!delay_ctx)
@@ -214,98 +490,249 @@ esp_err_t audio_delay_set_sample_rate(audio_delay_t *delay_ctx, uint32_t sample_
         return ESP_ERR_INVALID_ARG;
     }
 
-    delay_ctx->sample_rate = sample_rate;
+    if (!delay_ctx->initialized || !tx_handle || !rx_handle)
+    {
+        delay_ctx->sample_rate = sample_rate;
+        return ESP_OK;
+    }
 
-    // Reconfigure I2S if initialized
-    if (delay_ctx->initialized && tx_handle && rx_handle)
+    if (sample_rate == delay_ctx->sample_rate)
     {
-        // For the new I2S driver, we need to reconfigure the clock
-        i2s_std_clk_config_t clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(sample_rate);
+        return ESP_OK;
+    }
 
-        esp_err_t ret = i2s_channel_reconfig_std_clock(tx_handle, &clk_cfg);
-        if (ret != ESP_OK)
+    if (!delay_ctx->task_running)
+    {
+        // Nobody is streaming yet, switch in the caller's context
+        int64_t start_us = esp_timer_get_time();
+        uint32_t from_rate = delay_ctx->sample_rate;
+
+        esp_err_t ret = audio_delay_reconfigure_rate(sample_rate);
+        if (ret == ESP_OK)
         {
-            ESP_LOGE(TAG, "Failed to set I2S TX sample rate: %s", esp_err_to_name(ret));
-            return ret;
+            delay_ctx->sample_rate = sample_rate;
+            audio_delay_reset_line(delay_ctx);
         }
 
-        ret = i2s_channel_reconfig_std_clock(rx_handle, &clk_cfg);
-        if (ret != ESP_OK)
+        audio_delay_record_rate_switch(delay_ctx, from_rate, start_us, ret);
+        return ret;
+    }
+
+    // Hand the switch to the audio task and wait for it to complete
+    xSemaphoreTake(delay_ctx->rate_switch_done, 0);
+    __atomic_store_n(&delay_ctx->pending_sample_rate, sample_rate, __ATOMIC_RELEASE);
+
+    if (xSemaphoreTake(delay_ctx->rate_switch_done, pdMS_TO_TICKS(RATE_SWITCH_TIMEOUT_MS)) != pdTRUE)
+    {
+        // Withdraw the request if the task never claimed it (path down or stalled),
+        // so a later block does not switch behind the caller's back
+        if (__atomic_exchange_n(&delay_ctx->pending_sample_rate, 0, __ATOMIC_ACQ_REL) != 0)
         {
-            ESP_LOGE(TAG, "Failed to set I2S RX sample rate: %s", esp_err_to_name(ret));
-            return ret;
+            ESP_LOGE(TAG, "Timed out waiting for sample rate switch to %" PRIu32 " Hz", sample_rate);
+            return ESP_ERR_TIMEOUT;
+        }
+
+        // Claimed but still running; its writes are bounded, so one more wait settles it
+        if (xSemaphoreTake(delay_ctx->rate_switch_done, pdMS_TO_TICKS(RATE_SWITCH_TIMEOUT_MS)) != pdTRUE)
+        {
+            ESP_LOGE(TAG, "Sample rate switch to %" PRIu32 " Hz did not complete", sample_rate);
+            return ESP_ERR_TIMEOUT;
         }
     }
 
-    // Recalculate read index based on new sample rate
-    uint32_t delay_samples = (delay_ctx->delay_ms * sample_rate) / 1000;
-    delay_ctx->read_index = (delay_ctx->write_index + delay_ctx->buffer_size - delay_samples) % delay_ctx->buffer_size;
+    return delay_ctx->rate_switch.result;
+}
+
+esp_err_t audio_delay_get_rate_switch_stats(audio_delay_t *delay_ctx, audio_rate_switch_stats_t *stats)
+{
+    if (!delay_ctx || !stats)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-    ESP_LOGI(TAG, "Sample rate changed to %" PRIu32 " Hz", sample_rate);
+    *stats = delay_ctx->rate_switch;
     return ESP_OK;
 }
 
-esp_err_t audio_delay_set_delay(audio_delay_t *delay_ctx, uint32_t delay_ms)
+esp_err_t audio_delay_get_watchdog_stats(audio_delay_t *delay_ctx, audio_watchdog_stats_t *stats)
 {
-    if (!delay_ctx)
+    if (!delay_ctx || !stats)
     {
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Validate delay range
-    if (delay_ms > MAX_DELAY_MS)
+    *stats = delay_ctx->watchdog;
+    return ESP_OK;
+}
+
+esp_err_t audio_delay_get_i2s_stats(audio_i2s_stats_t *stats)
+{
+    if (!stats)
     {
-        ESP_LOGE(TAG, "Delay out of range: %" PRIu32 " ms (valid range: %d-%d ms)",
-                 delay_ms, MIN_DELAY_MS, MAX_DELAY_MS);
         return ESP_ERR_INVALID_ARG;
     }
 
-    delay_ctx->delay_ms = delay_ms;
+    portENTER_CRITICAL(&i2s_stats_lock);
+    *stats = i2s_stats;
+    portEXIT_CRITICAL(&i2s_stats_lock);
+    return ESP_OK;
+}
 
-    // Recalculate read index based on new delay
-    uint32_t delay_samples = (delay_ms * delay_ctx->sample_rate) / 1000;
+void audio_delay_reset_i2s_stats(void)
+{
+    portENTER_CRITICAL(&i2s_stats_lock);
+    memset(&i2s_stats, 0, sizeof(i2s_stats));
+    portEXIT_CRITICAL(&i2s_stats_lock);
+}
 
-    // Ensure delay doesn't exceed buffer size
-    if (delay_samples >= delay_ctx->buffer_size)
+// Report new overflow events, rate limited so a persistent overload does not flood the log
+static void audio_delay_log_i2s_events(uint32_t *last_rx, uint32_t *last_tx, int64_t *last_log_us)
+{
+    uint32_t rx = i2s_stats.rx_overflow_count;
+    uint32_t tx = i2s_stats.tx_underflow_count;
+
+    // Counters were reset through the API
+    if (rx < *last_rx || tx < *last_tx)
+    {
+        *last_rx = rx;
+        *last_tx = tx;
+    }
+
+    if (rx == *last_rx && tx == *last_tx)
+    {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    if (now_us - *last_log_us < I2S_STATS_LOG_INTERVAL_US)
+    {
+        return;
+    }
+
+    ESP_LOGW(TAG, "I2S overflow: RX +%" PRIu32 " (total %" PRIu32 "), TX underflow +%" PRIu32 " (total %" PRIu32 ")",
+             rx - *last_rx, rx, tx - *last_tx, tx);
+    *last_rx = rx;
+    *last_tx = tx;
+    *last_log_us = now_us;
+}
+
+// Attach a DSP chain that runs between the delay and playback; set before the task starts
+esp_err_t audio_delay_set_chain(audio_delay_t *delay_ctx, dsp_chain_t *chain)
+{
+    if (!delay_ctx)
     {
-        ESP_LOGE(TAG, "Delay too large for buffer: %" PRIu32 " samples (max: %" PRIu32 ")",
-                 delay_samples, delay_ctx->buffer_size - 1);
         return ESP_ERR_INVALID_ARG;
     }
 
-    delay_ctx->read_index = (delay_ctx->write_index + delay_ctx->buffer_size - delay_samples) % delay_ctx->buffer_size;
+    delay_ctx->chain = chain;
+    return ESP_OK;
+}
 
-    ESP_LOGI(TAG, "Delay changed to %" PRIu32 " ms (%" PRIu32 " samples)", delay_ms, delay_samples);
+// Attach a noise gate on the input, enabling the silence bypass; set before the task starts
+esp_err_t audio_delay_set_gate(audio_delay_t *delay_ctx, audio_gate_t *gate)
+{
+    if (!delay_ctx)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    delay_ctx->gate = gate;
     return ESP_OK;
 }
 
-esp_err_t audio_delay_process(audio_delay_t *delay_ctx, int16_t *input, int16_t *output, size_t samples)
+// Attach a test signal generator in place of the I2S input; set before the task starts
+esp_err_t audio_delay_set_generator(audio_delay_t *delay_ctx, signal_gen_t *generator)
 {
-    if (!delay_ctx || !input || !output)
+    if (!delay_ctx)
     {
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (!delay_ctx->initialized)
+    delay_ctx->generator = generator;
+    return ESP_OK;
+}
+
+// Longest gap between complete blocks before the audio path counts as stalled
+static int64_t audio_delay_stall_timeout_us(const audio_delay_t *delay_ctx)
+{
+    int64_t period_us = ((int64_t)AUDIO_BUFFER_SIZE * 1000000) / delay_ctx->sample_rate;
+    int64_t timeout_us = period_us * AUDIO_WATCHDOG_STALL_PERIODS;
+
+    if (timeout_us < AUDIO_WATCHDOG_MIN_STALL_MS * 1000)
+    {
+        timeout_us = AUDIO_WATCHDOG_MIN_STALL_MS * 1000;
+    }
+    return timeout_us;
+}
+
+// Tear down and re-initialise the I2S channels and the ES8388 in place.
+// The delay line, delay and sample rate are left untouched. A failure may
+// leave no channels at all; the next attempt waits twice as long as the last.
+static void audio_delay_recover(audio_delay_t *delay_ctx)
+{
+    int64_t start_us = esp_timer_get_time();
+
+    if (delay_ctx->recovery_retry_us == 0)
     {
-        ESP_LOGE(TAG, "Audio delay not initialized");
-        return ESP_ERR_INVALID_STATE;
+        ESP_LOGW(TAG, "Audio path stalled for %" PRId64 " ms, reinitialising I2S and ES8388",
+                 (start_us - delay_ctx->last_block_us) / 1000);
     }
 
-    for (size_t i = 0; i < samples; i++)
+    audio_i2s_stop();
+    es8388_deinit();
+
+    es8388_config_t es8388_cfg = ES8388_DEFAULT_CONFIG();
+    es8388_cfg.sample_rate = (es8388_sample_rate_t)delay_ctx->sample_rate;
+
+    esp_err_t ret = es8388_init(&es8388_cfg);
+    if (ret == ESP_OK)
     {
-        // Write input sample to delay buffer
-        delay_ctx->delay_buffer[delay_ctx->write_index] = input[i];
+        ret = audio_i2s_start(delay_ctx->sample_rate);
+    }
+    if (ret == ESP_OK)
+    {
+        ret = es8388_start();
+    }
 
-        // Read delayed sample from buffer
-        output[i] = delay_ctx->delay_buffer[delay_ctx->read_index];
+    int64_t end_us = esp_timer_get_time();
+    delay_ctx->watchdog.last_reinit_us = (uint32_t)(end_us - start_us);
 
-        // Advance indices with wrap-around
-        delay_ctx->write_index = (delay_ctx->write_index + 1) % delay_ctx->buffer_size;
-        delay_ctx->read_index = (delay_ctx->read_index + 1) % delay_ctx->buffer_size;
+    if (ret == ESP_OK)
+    {
+        delay_ctx->recovery_retry_us = 0;
+        delay_ctx->next_recovery_us = 0;
+        delay_ctx->watchdog.recovery_count++;
+        METRIC_INC(METRIC_AUDIO_RECOVERIES);
+        delay_ctx->watchdog.last_outage_us = (uint32_t)(end_us - delay_ctx->last_block_us);
+        delay_ctx->watchdog.total_outage_us += delay_ctx->watchdog.last_outage_us;
+
+        ESP_LOGW(TAG, "Audio path recovered in %" PRIu32 " us (outage %" PRIu32 " us, recoveries %" PRIu32 ")",
+                 delay_ctx->watchdog.last_reinit_us, delay_ctx->watchdog.last_outage_us,
+                 delay_ctx->watchdog.recovery_count);
+
+        // Restart the stall window
+        delay_ctx->last_block_us = end_us;
+        return;
     }
 
-    return ESP_OK;
+    // last_block_us stays at the last good block so the outage covers every failed attempt
+    int64_t retry_us = delay_ctx->recovery_retry_us ? delay_ctx->recovery_retry_us * 2
+                                                    : audio_delay_stall_timeout_us(delay_ctx);
+    if (retry_us > AUDIO_WATCHDOG_RETRY_MAX_MS * 1000LL)
+    {
+        retry_us = AUDIO_WATCHDOG_RETRY_MAX_MS * 1000LL;
+    }
+    delay_ctx->recovery_retry_us = retry_us;
+    delay_ctx->next_recovery_us = end_us + retry_us;
+    delay_ctx->watchdog.failed_recoveries++;
+    ESP_LOGE(TAG, "Audio path recovery failed: %s (attempt %" PRIu32 ", next in %" PRId64 " ms)",
+             esp_err_to_name(ret), delay_ctx->watchdog.failed_recoveries, retry_us / 1000);
+}
+
+// Both channels exist; a failed restart or recovery can leave them deleted
+static bool audio_delay_path_up(void)
+{
+    return tx_handle && rx_handle;
 }
 
 // Audio processing task function (to be called from main)
@@ -320,6 +747,7 @@ void audio_delay_task(void *pvParameters)
     }
 
     ESP_LOGI(TAG, "Audio delay task started");
+    delay_ctx->task_running = true;
 
     int16_t *input_buffer = malloc(AUDIO_BUFFER_SIZE * sizeof(int16_t));
     int16_t *output_buffer = malloc(AUDIO_BUFFER_SIZE * sizeof(int16_t));
@@ -335,44 +763,171 @@ void audio_delay_task(void *pvParameters)
         return;
     }
 
+    // The channels were created from app_main on the control core and their DMA
+    // interrupts went with them; recreate them so the interrupts run next to this task
+    if (i2s_core != xPortGetCoreID())
+    {
+        audio_i2s_stop();
+        esp_err_t ret = audio_i2s_start(delay_ctx->sample_rate);
+        if (ret != ESP_OK)
+        {
+            // No channels now; the loop below retries through the watchdog's recovery
+            ESP_LOGE(TAG, "Failed to move I2S to core %d: %s", (int)xPortGetCoreID(), esp_err_to_name(ret));
+        }
+    }
+
     size_t bytes_read, bytes_written;
+    uint32_t logged_rx_overflows = 0;
+    uint32_t logged_tx_underflows = 0;
+    int64_t last_overflow_log_us = 0;
+    delay_ctx->last_block_us = esp_timer_get_time();
 
     while (1)
     {
+        // Bounded I/O so a stuck DMA or codec is noticed by the watchdog below
+        int64_t stall_timeout_us = audio_delay_stall_timeout_us(delay_ctx);
+        TickType_t io_timeout = pdMS_TO_TICKS(stall_timeout_us / 1000);
+
+        if (!audio_delay_path_up())
+        {
+            // Nothing to read from; sleep until the next recovery attempt is due
+            int64_t wait_us = delay_ctx->next_recovery_us - esp_timer_get_time();
+            if (wait_us > 0)
+            {
+                vTaskDelay(pdMS_TO_TICKS(wait_us / 1000) + 1);
+            }
+            audio_delay_recover(delay_ctx);
+            continue;
+        }
+
         // Read audio data from I2S
         esp_err_t ret = i2s_channel_read(rx_handle, input_buffer, AUDIO_BUFFER_SIZE * sizeof(int16_t),
-                                         &bytes_read, portMAX_DELAY);
+                                         &bytes_read, io_timeout);
 
         if (ret == ESP_OK && bytes_read > 0)
         {
+            uint32_t loop_start = AUDIO_PROF_START();
             size_t samples_read = bytes_read / sizeof(int16_t);
 
+            // Full CPU ceiling while the block is worked on, the floor while waiting for the next one
+            power_manager_audio_begin();
+            uint32_t block_start = esp_cpu_get_cycle_count();
+
+            // Timestamp the block for cadence/jitter analysis. Its sequence number goes on the trace event and
+            // the profiler's worst case, so all three name the same block as the anomaly report's #seq.
+            audio_block_tag_t block_tag;
+            audio_jitter_block_arrived(samples_read, delay_ctx->sample_rate, &block_tag);
+            TRACE_RECORD(TRACE_EV_AUDIO_BLOCK_BEGIN, samples_read, block_tag.seq);
+#if AUDIO_PROFILER_ENABLED
+            audio_profiler_set_block(samples_read, delay_ctx->sample_rate, block_tag.seq);
+#endif
+
+            // A running test signal replaces what the codec delivered, the read keeps the block cadence
+            if (delay_ctx->generator)
+            {
+                signal_gen_fill(delay_ctx->generator, input_buffer, samples_read);
+            }
+
             // Process audio through delay
+            uint32_t gate_start = esp_cpu_get_cycle_count();
+            uint32_t process_start = AUDIO_PROF_START();
             ret = audio_delay_process(delay_ctx, input_buffer, output_buffer, samples_read);
+            AUDIO_PROF_END(AUDIO_PROF_PROCESS, process_start);
 
+            // A bypassed block is silence, the chain has nothing to do
+            if (ret == ESP_OK && delay_ctx->chain && !delay_ctx->bypassed)
+            {
+                uint32_t chain_start = AUDIO_PROF_START();
+                ret = dsp_chain_process(delay_ctx->chain, output_buffer, samples_read);
+                AUDIO_PROF_END(AUDIO_PROF_CHAIN, chain_start);
+            }
+
+            // Input level from the process pass, output level of what is about to be played;
+            // a bypassed block is known to be silent
             if (ret == ESP_OK)
+            {
+                audio_meter_add(AUDIO_METER_INPUT, delay_ctx->input_peak, delay_ctx->input_sum_sq, samples_read);
+                uint64_t out_sum_sq = 0;
+                int32_t out_peak = delay_ctx->bypassed ? 0 : dsp_level_s16(output_buffer, samples_read, &out_sum_sq);
+                audio_meter_add(AUDIO_METER_OUTPUT, out_peak, out_sum_sq, samples_read);
+                audio_meter_block_done(samples_read, delay_ctx->sample_rate);
+                spectrum_analyzer_tap(output_buffer, samples_read, delay_ctx->sample_rate);
+            }
+
+            if (ret == ESP_OK && delay_ctx->gate)
+            {
+                audio_gate_account(delay_ctx->gate, samples_read, esp_cpu_get_cycle_count() - gate_start,
+                                   delay_ctx->bypassed);
+            }
+
+            // The whole block counts towards the load that picks the CPU ceiling, a failed one does not
+            uint32_t block_cycles = esp_cpu_get_cycle_count() - block_start;
+            power_manager_audio_end(block_cycles, samples_read, delay_ctx->sample_rate,
+                                    delay_ctx->bypassed || ret != ESP_OK);
+            TRACE_RECORD(TRACE_EV_AUDIO_BLOCK_END, block_cycles, delay_ctx->bypassed);
+            METRIC_INC(METRIC_AUDIO_BLOCKS);
+            if (delay_ctx->bypassed)
+            {
+                METRIC_INC(METRIC_AUDIO_BYPASSED);
+            }
+            else
+            {
+                METRIC_OBSERVE(METRIC_HIST_AUDIO_BLOCK, block_cycles);
+            }
+
+            uint32_t pending_rate = ret == ESP_OK
+                                        ? __atomic_exchange_n(&delay_ctx->pending_sample_rate, 0, __ATOMIC_ACQ_REL)
+                                        : 0;
+            if (pending_rate != 0)
+            {
+                // Rate switch replaces this block's write with a fade-out and restart.
+                // A failed write leaves last_block_us alone so the watchdog sees the stall.
+                esp_err_t switch_ret = audio_delay_run_rate_switch(delay_ctx, pending_rate, output_buffer,
+                                                                   samples_read, io_timeout);
+                if (switch_ret == ESP_OK)
+                {
+                    delay_ctx->last_block_us = esp_timer_get_time();
+                }
+                xSemaphoreGive(delay_ctx->rate_switch_done);
+            }
+            else if (ret == ESP_OK)
             {
                 // Write processed audio to I2S
                 ret = i2s_channel_write(tx_handle, output_buffer, samples_read * sizeof(int16_t),
-                                        &bytes_written, portMAX_DELAY);
+                                        &bytes_written, io_timeout);
 
-                if (ret != ESP_OK)
+                if (ret == ESP_OK)
+                {
+                    AUDIO_PROF_END(AUDIO_PROF_LOOP, loop_start);
+                    delay_ctx->last_block_us = esp_timer_get_time();
+                }
+                else
                 {
-                    ESP_LOGE(TAG, "I2S write error: %s", esp_err_to_name(ret));
+                    audio_delay_log_io_error("I2S write", ret);
                 }
             }
             else
             {
-                ESP_LOGE(TAG, "Audio delay processing error: %s", esp_err_to_name(ret));
+                audio_delay_log_io_error("Audio delay processing", ret);
             }
         }
         else
         {
-            ESP_LOGE(TAG, "I2S read error: %s", esp_err_to_name(ret));
+            audio_delay_log_io_error("I2S read", ret);
             vTaskDelay(pdMS_TO_TICKS(10));
         }
+
+        audio_delay_log_i2s_events(&logged_rx_overflows, &logged_tx_underflows, &last_overflow_log_us);
+
+        // Watchdog: no complete block for several periods means the path is stuck
+        int64_t now_us = esp_timer_get_time();
+        if (now_us - delay_ctx->last_block_us > stall_timeout_us && now_us >= delay_ctx->next_recovery_us)
+        {
+            audio_delay_recover(delay_ctx);
+        }
     }
 
+    delay_ctx->task_running = false;
     free(input_buffer);
     free(output_buffer);
     vTaskDelete(NULL);
@@ -0,0 +1,771 @@
+#include "audio_delay.h"
+#include "trace_buffer.h"
+#include "metrics.h"
+#include "dsp_kernels.h"
+#include "dsp_backend.h"
+#include "esp_log.h"
+#include <string.h>
+#include <inttypes.h>
+
+// Block processing of the delay line: the ring, the plain and echo paths, the
+// silence bypass and the scheduled changes. No I2S or codec access here, so it
+// also builds on a host for the reference checks in dsp_bench.c. Parameters are
+// only changed by the audio task, from events the setters queue.
+
+static const char *TAG = "AUDIO_DELAY";
+
+// Put the read head delay_ms behind the write head, for the setter's and scheduled events
+static esp_err_t audio_delay_move_read_head(audio_delay_t *delay_ctx, uint32_t delay_ms)
+{
+    delay_ctx->delay_ms = delay_ms;
+
+    // Recalculate read index based on new delay
+    uint32_t delay_samples = (delay_ms * delay_ctx->sample_rate) / 1000;
+
+    // Ensure delay doesn't exceed buffer size
+    if (delay_samples >= delay_ctx->buffer_size)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    delay_ctx->read_index = (delay_ctx->write_index + delay_ctx->buffer_size - delay_samples) % delay_ctx->buffer_size;
+
+    // Called on every encoder step; the trace records it for a few cycles
+    TRACE_RECORD(TRACE_EV_SET_DELAY, delay_ms, delay_samples);
+    METRIC_INC(METRIC_DELAY_CHANGES);
+    return ESP_OK;
+}
+
+// The change is queued and the audio task moves the read head at its next
+// block, so the heads are never written from the control side
+esp_err_t audio_delay_set_delay(audio_delay_t *delay_ctx, uint32_t delay_ms)
+{
+    if (!delay_ctx)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Validate delay range
+    if (delay_ms > MAX_DELAY_MS)
+    {
+        ESP_LOGE(TAG, "Delay out of range: %" PRIu32 " ms (valid range: %d-%d ms)",
+                 delay_ms, MIN_DELAY_MS, MAX_DELAY_MS);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if ((delay_ms * delay_ctx->sample_rate) / 1000 >= delay_ctx->buffer_size)
+    {
+        ESP_LOGE(TAG, "Delay too large for buffer: %" PRIu32 " ms (max: %" PRIu32 " samples)",
+                 delay_ms, delay_ctx->buffer_size - 1);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const audio_event_t event = {
+        .at_sample = AUDIO_EVENT_NOW,
+        .type = AUDIO_EVENT_DELAY,
+        .value = (int32_t)delay_ms,
+    };
+    esp_err_t ret = audio_events_push(&delay_ctx->events, &event);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Delay change to %" PRIu32 " ms not queued: %s", delay_ms, esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGD(TAG, "Delay change to %" PRIu32 " ms queued", delay_ms);
+    return ESP_OK;
+}
+
+esp_err_t audio_delay_set_feedback(audio_delay_t *delay_ctx, int16_t feedback_q15, int16_t damping_q15)
+{
+    if (!delay_ctx)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Keep |feedback| below 1.0 so the loop always decays
+    if (feedback_q15 < -FEEDBACK_Q15_MAX)
+    {
+        feedback_q15 = -FEEDBACK_Q15_MAX;
+    }
+    if (damping_q15 < 0)
+    {
+        damping_q15 = 0;
+    }
+
+    // Both go in one event so the audio task never runs a half-applied pair
+    const audio_event_t event = {
+        .at_sample = AUDIO_EVENT_NOW,
+        .type = AUDIO_EVENT_FEEDBACK,
+        .value = feedback_q15,
+        .aux = damping_q15,
+    };
+    esp_err_t ret = audio_events_push(&delay_ctx->events, &event);
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+
+    TRACE_RECORD(TRACE_EV_SET_FEEDBACK, feedback_q15, damping_q15);
+    ESP_LOGD(TAG, "Feedback set to %d/32768, damping %d/32768", feedback_q15, damping_q15);
+    return ESP_OK;
+}
+
+esp_err_t audio_delay_set_mix(audio_delay_t *delay_ctx, int32_t mix_q15)
+{
+    if (!delay_ctx || mix_q15 < 0 || mix_q15 > MIX_Q15_WET)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Applied at the next block boundary and ramped across that block
+    const audio_event_t event = {
+        .at_sample = AUDIO_EVENT_NOW,
+        .type = AUDIO_EVENT_MIX,
+        .value = mix_q15,
+        .aux = AUDIO_EVENT_MIX_RAMP,
+    };
+    esp_err_t ret = audio_events_push(&delay_ctx->events, &event);
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+
+    TRACE_RECORD(TRACE_EV_SET_MIX, mix_q15, 0);
+    ESP_LOGD(TAG, "Mix set to %" PRId32 "/32768 wet", mix_q15);
+    return ESP_OK;
+}
+
+// Queue a change for the audio task to apply on sample event->at_sample.
+// Values are checked here so the audio task never has to reject one.
+esp_err_t audio_delay_schedule(audio_delay_t *delay_ctx, const audio_event_t *event)
+{
+    if (!delay_ctx || !event)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool valid;
+    switch (event->type)
+    {
+    case AUDIO_EVENT_DELAY:
+        valid = event->value >= MIN_DELAY_MS && event->value <= MAX_DELAY_MS;
+        break;
+    case AUDIO_EVENT_MIX:
+        valid = event->value >= 0 && event->value <= MIX_Q15_WET &&
+                (event->aux == 0 || event->aux == AUDIO_EVENT_MIX_RAMP);
+        break;
+    case AUDIO_EVENT_GAIN:
+        valid = event->value >= 0 && event->value <= DSP_GAIN_Q15_MAX;
+        break;
+    case AUDIO_EVENT_FEEDBACK:
+        valid = event->value >= -FEEDBACK_Q15_MAX && event->value <= FEEDBACK_Q15_MAX && event->aux >= 0 &&
+                event->aux <= DAMPING_Q15_MAX;
+        break;
+    default:
+        valid = false;
+        break;
+    }
+    if (!valid)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return audio_events_push(&delay_ctx->events, event);
+}
+
+void audio_delay_clear_schedule(audio_delay_t *delay_ctx)
+{
+    if (delay_ctx)
+    {
+        audio_events_clear(&delay_ctx->events);
+    }
+}
+
+// Sample clock at the start of the next block, consistent even while the audio task updates it
+uint64_t audio_delay_get_sample_clock(audio_delay_t *delay_ctx)
+{
+    for (;;)
+    {
+        uint32_t before = __atomic_load_n(&delay_ctx->clock_seq, __ATOMIC_ACQUIRE);
+        if (before & 1)
+        {
+            continue;
+        }
+
+        uint64_t clock = delay_ctx->sample_clock;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&delay_ctx->clock_seq, __ATOMIC_RELAXED) == before)
+        {
+            return clock;
+        }
+    }
+}
+
+esp_err_t audio_delay_get_event_stats(audio_delay_t *delay_ctx, audio_event_stats_t *stats)
+{
+    if (!delay_ctx || !stats)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    audio_events_get_stats(&delay_ctx->events, stats);
+    return ESP_OK;
+}
+
+static void audio_delay_advance_clock(audio_delay_t *delay_ctx, size_t samples)
+{
+    uint32_t seq = delay_ctx->clock_seq;
+    __atomic_store_n(&delay_ctx->clock_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    delay_ctx->sample_clock += samples;
+    __atomic_store_n(&delay_ctx->clock_seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+// Dry/wet gains for one block. The gains are kept in Q30 so the per-sample
+// step of a ramp keeps its precision; a steady block has zero steps.
+typedef struct
+{
+    int32_t dry;
+    int32_t wet;
+    int32_t dry_step;
+    int32_t wet_step;
+} audio_delay_mix_ramp_t;
+
+// Both paths sit at unity at 50% and each fades out linearly towards its own end
+static inline void audio_delay_mix_gains(int32_t mix_q15, int32_t *dry_q15, int32_t *wet_q15)
+{
+    int32_t dry = 2 * (DSP_Q15_ONE - mix_q15);
+    int32_t wet = 2 * mix_q15;
+
+    *dry_q15 = dry > DSP_Q15_ONE ? DSP_Q15_ONE : dry;
+    *wet_q15 = wet > DSP_Q15_ONE ? DSP_Q15_ONE : wet;
+}
+
+static void audio_delay_mix_ramp_init(audio_delay_mix_ramp_t *ramp, int32_t from_q15, int32_t to_q15,
+                                      size_t samples)
+{
+    int32_t dry_from, wet_from, dry_to, wet_to;
+
+    audio_delay_mix_gains(from_q15, &dry_from, &wet_from);
+    audio_delay_mix_gains(to_q15, &dry_to, &wet_to);
+
+    ramp->dry = dry_from * DSP_Q15_ONE;
+    ramp->wet = wet_from * DSP_Q15_ONE;
+    ramp->dry_step = 0;
+    ramp->wet_step = 0;
+    if (from_q15 != to_q15 && samples > 0)
+    {
+        ramp->dry_step = (dry_to - dry_from) * DSP_Q15_ONE / (int32_t)samples;
+        ramp->wet_step = (wet_to - wet_from) * DSP_Q15_ONE / (int32_t)samples;
+    }
+}
+
+// Ramp from wherever the gains are now to a new mix over the given samples
+static void audio_delay_mix_ramp_to(audio_delay_mix_ramp_t *ramp, int32_t to_q15, size_t samples)
+{
+    int32_t dry_to, wet_to;
+
+    audio_delay_mix_gains(to_q15, &dry_to, &wet_to);
+    ramp->dry_step = (dry_to * DSP_Q15_ONE - ramp->dry) / (int32_t)samples;
+    ramp->wet_step = (wet_to * DSP_Q15_ONE - ramp->wet) / (int32_t)samples;
+}
+
+// Gains are at most 1.0, so the two products plus rounding fit in 32 bits
+static inline int16_t audio_delay_mix_sample(int32_t dry, int32_t wet, int32_t dry_q15, int32_t wet_q15)
+{
+    return (int16_t)dsp_sat16((dry * dry_q15 + wet * wet_q15 + (1 << 14)) >> 15);
+}
+
+// Copy a run of samples into the ring at the write head, splitting at the wrap point
+static inline void audio_delay_ring_write(audio_delay_t *delay_ctx, const int16_t *src, size_t count)
+{
+    uint32_t first = delay_ctx->buffer_size - delay_ctx->write_index;
+    if (first > count)
+    {
+        first = count;
+    }
+
+    memcpy(&delay_ctx->delay_buffer[delay_ctx->write_index], src, first * sizeof(int16_t));
+    memcpy(delay_ctx->delay_buffer, src + first, (count - first) * sizeof(int16_t));
+
+    delay_ctx->write_index += count;
+    if (delay_ctx->write_index >= delay_ctx->buffer_size)
+    {
+        delay_ctx->write_index -= delay_ctx->buffer_size;
+    }
+}
+
+// Copy a run of samples out of the ring at the read head, splitting at the wrap point
+static inline void audio_delay_ring_read(audio_delay_t *delay_ctx, int16_t *dst, size_t count)
+{
+    uint32_t first = delay_ctx->buffer_size - delay_ctx->read_index;
+    if (first > count)
+    {
+        first = count;
+    }
+
+    memcpy(dst, &delay_ctx->delay_buffer[delay_ctx->read_index], first * sizeof(int16_t));
+    memcpy(dst + first, delay_ctx->delay_buffer, (count - first) * sizeof(int16_t));
+
+    delay_ctx->read_index += count;
+    if (delay_ctx->read_index >= delay_ctx->buffer_size)
+    {
+        delay_ctx->read_index -= delay_ctx->buffer_size;
+    }
+}
+
+// Read the delayed run and mix it with the dry input in the same pass
+static void audio_delay_ring_read_mix(audio_delay_t *delay_ctx, const int16_t *dry, int16_t *out, size_t count,
+                                      audio_delay_mix_ramp_t *ramp)
+{
+    size_t done = 0;
+
+    while (done < count)
+    {
+        size_t run = count - done;
+        if (run > delay_ctx->buffer_size - delay_ctx->read_index)
+        {
+            run = delay_ctx->buffer_size - delay_ctx->read_index;
+        }
+
+        const int16_t *in = dry + done;
+        const int16_t *wet = &delay_ctx->delay_buffer[delay_ctx->read_index];
+        int16_t *dst = out + done;
+
+        if (ramp->dry_step == 0 && ramp->wet_step == 0)
+        {
+            int32_t dry_q15 = ramp->dry >> 15;
+            int32_t wet_q15 = ramp->wet >> 15;
+            for (size_t i = 0; i < run; i++)
+            {
+                dst[i] = audio_delay_mix_sample(in[i], wet[i], dry_q15, wet_q15);
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < run; i++)
+            {
+                dst[i] = audio_delay_mix_sample(in[i], wet[i], ramp->dry >> 15, ramp->wet >> 15);
+                ramp->dry += ramp->dry_step;
+                ramp->wet += ramp->wet_step;
+            }
+        }
+
+        delay_ctx->read_index += run;
+        if (delay_ctx->read_index >= delay_ctx->buffer_size)
+        {
+            delay_ctx->read_index -= delay_ctx->buffer_size;
+        }
+        done += run;
+    }
+}
+
+// Plain delay: the block goes into the ring and the delayed block comes out,
+// mixed with the input unless the mix sits at one end. A chunk may not lap
+// the read head, which only matters for delays within one block of the ring size.
+static void audio_delay_process_plain(audio_delay_t *delay_ctx, const int16_t *input, int16_t *output,
+                                      size_t samples, uint32_t delay_samples, audio_delay_mix_ramp_t *ramp)
+{
+    bool steady = ramp->dry_step == 0 && ramp->wet_step == 0;
+    bool wet_only = steady && ramp->dry == 0;
+    bool dry_only = steady && ramp->wet == 0;
+    size_t max_chunk = delay_ctx->buffer_size - delay_samples;
+    size_t done = 0;
+
+    while (done < samples)
+    {
+        size_t chunk = samples - done;
+        if (chunk > max_chunk)
+        {
+            chunk = max_chunk;
+        }
+
+        audio_delay_ring_write(delay_ctx, input + done, chunk);
+
+        if (wet_only)
+        {
+            audio_delay_ring_read(delay_ctx, output + done, chunk);
+        }
+        else if (dry_only)
+        {
+            if (output != input)
+            {
+                memcpy(output + done, input + done, chunk * sizeof(int16_t));
+            }
+            delay_ctx->read_index = (delay_ctx->read_index + chunk) % delay_ctx->buffer_size;
+        }
+        else
+        {
+            audio_delay_ring_read_mix(delay_ctx, input + done, output + done, chunk, ramp);
+        }
+        done += chunk;
+    }
+}
+
+// Echo: the delayed sample is low-passed, scaled by the feedback and summed
+// back into the line input in the same ring slot the plain path would use.
+// Runs are limited to delay_samples so no sample in a run reads what the
+// same run writes, and to the ring wrap so the inner loop has no modulo.
+static void audio_delay_process_echo(audio_delay_t *delay_ctx, const int16_t *input, int16_t *output,
+                                     size_t samples, uint32_t delay_samples, int32_t feedback,
+                                     audio_delay_mix_ramp_t *ramp)
+{
+    int16_t *buf = delay_ctx->delay_buffer;
+    uint32_t size = delay_ctx->buffer_size;
+    uint32_t r = delay_ctx->read_index;
+    uint32_t w = delay_ctx->write_index;
+    int32_t alpha = DSP_Q15_ONE - delay_ctx->damping_q15;
+    int32_t lp = delay_ctx->damping_state;
+    int32_t dry_gain = ramp->dry;
+    int32_t wet_gain = ramp->wet;
+    size_t done = 0;
+
+    while (done < samples)
+    {
+        size_t chunk = samples - done;
+        if (chunk > delay_samples)
+        {
+            chunk = delay_samples;
+        }
+        if (chunk > size - r)
+        {
+            chunk = size - r;
+        }
+        if (chunk > size - w)
+        {
+            chunk = size - w;
+        }
+
+        const int16_t *in = input + done;
+        int16_t *out = output + done;
+        const int16_t *wet = &buf[r];
+        int16_t *line = &buf[w];
+
+        if (alpha == DSP_Q15_ONE)
+        {
+            for (size_t i = 0; i < chunk; i++)
+            {
+                int32_t dry = in[i];
+                int32_t delayed = wet[i];
+                line[i] = (int16_t)dsp_sat16(dry + ((delayed * feedback + (1 << 14)) >> 15));
+                out[i] = audio_delay_mix_sample(dry, delayed, dry_gain >> 15, wet_gain >> 15);
+                dry_gain += ramp->dry_step;
+                wet_gain += ramp->wet_step;
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < chunk; i++)
+            {
+                int32_t dry = in[i];
+                int32_t delayed = wet[i];
+                lp += ((delayed - lp) * alpha) >> 15;
+                line[i] = (int16_t)dsp_sat16(dry + ((lp * feedback + (1 << 14)) >> 15));
+                out[i] = audio_delay_mix_sample(dry, delayed, dry_gain >> 15, wet_gain >> 15);
+                dry_gain += ramp->dry_step;
+                wet_gain += ramp->wet_step;
+            }
+        }
+
+        r += chunk;
+        if (r == size)
+        {
+            r = 0;
+        }
+        w += chunk;
+        if (w == size)
+        {
+            w = 0;
+        }
+        done += chunk;
+    }
+
+    delay_ctx->read_index = r;
+    delay_ctx->write_index = w;
+    delay_ctx->damping_state = lp;
+    ramp->dry = dry_gain;
+    ramp->wet = wet_gain;
+}
+
+// Zero count ring slots starting at index, splitting at the wrap point
+static void audio_delay_ring_zero(audio_delay_t *delay_ctx, uint32_t index, size_t count)
+{
+    uint32_t first = delay_ctx->buffer_size - index;
+    if (first > count)
+    {
+        first = count;
+    }
+
+    memset(&delay_ctx->delay_buffer[index], 0, first * sizeof(int16_t));
+    memset(delay_ctx->delay_buffer, 0, (count - first) * sizeof(int16_t));
+}
+
+static bool audio_delay_ring_is_silent(const audio_delay_t *delay_ctx, uint32_t index, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (delay_ctx->delay_buffer[index] != 0)
+        {
+            return false;
+        }
+        if (++index == delay_ctx->buffer_size)
+        {
+            index = 0;
+        }
+    }
+    return true;
+}
+
+// Fed only zeros, the loop low-pass either decays or sits on a rounding fixed
+// point; only in the latter case does skipping the block leave it unchanged
+static bool audio_delay_damping_settled(const audio_delay_t *delay_ctx)
+{
+    int32_t lp = delay_ctx->damping_state;
+    int32_t alpha = DSP_Q15_ONE - delay_ctx->damping_q15;
+
+    return lp == 0 || (alpha != DSP_Q15_ONE && ((-lp * alpha) >> 15) == 0);
+}
+
+// Silent block: the line would only have been fed zeros, so the heads just move
+static void audio_delay_process_bypass(audio_delay_t *delay_ctx, int16_t *output, size_t samples)
+{
+    memset(output, 0, samples * sizeof(int16_t));
+
+    delay_ctx->write_index = (delay_ctx->write_index + samples) % delay_ctx->buffer_size;
+    delay_ctx->read_index = (delay_ctx->read_index + samples) % delay_ctx->buffer_size;
+
+    delay_ctx->bypassed_samples += samples;
+    if (delay_ctx->bypassed_samples > delay_ctx->buffer_size)
+    {
+        delay_ctx->bypassed_samples = delay_ctx->buffer_size;
+    }
+    delay_ctx->silent_run += samples;
+    if (delay_ctx->silent_run > delay_ctx->buffer_size)
+    {
+        delay_ctx->silent_run = delay_ctx->buffer_size;
+    }
+}
+
+// The slots skipped by a bypass still hold old audio. The ones between the
+// heads are cleared a block at a time just ahead of the read head, then the
+// ones behind it that only a longer delay would play, until the write head
+// catches up with them. The cost is bounded by the ring, not the silence.
+static void audio_delay_clear_stale(audio_delay_t *delay_ctx, size_t samples)
+{
+    uint32_t size = delay_ctx->buffer_size;
+
+    // A delay change moved the read head, clear the rest in one go
+    size_t budget = delay_ctx->read_index == delay_ctx->stale_read_index ? samples : size;
+
+    size_t count = size - delay_ctx->stale_up;
+    if (count > budget)
+    {
+        count = budget;
+    }
+    audio_delay_ring_zero(delay_ctx, (delay_ctx->stale_base + delay_ctx->stale_up) % size, count);
+    delay_ctx->stale_up += count;
+
+    uint32_t low = delay_ctx->stale_low > delay_ctx->stale_written ? delay_ctx->stale_low : delay_ctx->stale_written;
+    count = delay_ctx->stale_down > low ? delay_ctx->stale_down - low : 0;
+    if (count > budget)
+    {
+        count = budget;
+    }
+    delay_ctx->stale_down -= count;
+    audio_delay_ring_zero(delay_ctx, (delay_ctx->stale_base + delay_ctx->stale_down) % size, count);
+
+    // This block's writes land on the next slots behind the reader
+    delay_ctx->stale_written += samples;
+    if (delay_ctx->stale_written > size)
+    {
+        delay_ctx->stale_written = size;
+    }
+
+    low = delay_ctx->stale_low > delay_ctx->stale_written ? delay_ctx->stale_low : delay_ctx->stale_written;
+    delay_ctx->stale = delay_ctx->stale_up < size || delay_ctx->stale_down > low;
+    delay_ctx->stale_read_index = (delay_ctx->read_index + samples) % size;
+}
+
+// Apply every scheduled change due before the given sample. One that was due
+// before the block began lands on its first sample and counts as late.
+// remaining is what is left of the block from that sample on.
+static void audio_delay_apply_due(audio_delay_t *delay_ctx, uint64_t before_sample, uint64_t block_start,
+                                  audio_delay_mix_ramp_t *ramp, size_t remaining)
+{
+    audio_event_t event;
+
+    while (audio_events_pop_due(&delay_ctx->events, before_sample, &event))
+    {
+        if (event.at_sample != AUDIO_EVENT_NOW && event.at_sample < block_start)
+        {
+            delay_ctx->events.stats.late++;
+        }
+        if (event.at_sample != AUDIO_EVENT_NOW)
+        {
+            TRACE_RECORD(TRACE_EV_CUE, event.type, event.value);
+        }
+
+        switch (event.type)
+        {
+        case AUDIO_EVENT_DELAY:
+            audio_delay_move_read_head(delay_ctx, (uint32_t)event.value);
+            break;
+        case AUDIO_EVENT_MIX:
+            // Setter changes ramp over the rest of the block, cues step on their exact sample
+            if (event.aux == AUDIO_EVENT_MIX_RAMP)
+            {
+                audio_delay_mix_ramp_to(ramp, event.value, remaining);
+            }
+            else
+            {
+                audio_delay_mix_ramp_init(ramp, event.value, event.value, 0);
+            }
+            delay_ctx->mix_q15 = event.value;
+            METRIC_INC(METRIC_MIX_CHANGES);
+            break;
+        case AUDIO_EVENT_GAIN:
+            delay_ctx->gain_q15 = event.value;
+            break;
+        case AUDIO_EVENT_FEEDBACK:
+            delay_ctx->damping_q15 = (int16_t)event.aux;
+            delay_ctx->feedback_q15 = (int16_t)event.value;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+esp_err_t audio_delay_process(audio_delay_t *delay_ctx, int16_t *input, int16_t *output, size_t samples)
+{
+    if (!delay_ctx || !input || !output)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!delay_ctx->initialized)
+    {
+        ESP_LOGE(TAG, "Audio delay not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t delay_samples = (delay_ctx->write_index + delay_ctx->buffer_size - delay_ctx->read_index) %
+                             delay_ctx->buffer_size;
+    uint64_t block_start = delay_ctx->sample_clock;
+    audio_events_collect(&delay_ctx->events);
+
+    // One level pass over the input feeds both the gate and, through the task, the meter
+    delay_ctx->input_sum_sq = 0;
+    delay_ctx->input_peak = dsp_level_s16(input, samples, &delay_ctx->input_sum_sq);
+    bool closed = delay_ctx->gate && audio_gate_process(delay_ctx->gate, input, samples, delay_ctx->input_peak);
+
+    // Steady at the current mix until an event changes it
+    audio_delay_mix_ramp_t ramp;
+    audio_delay_mix_ramp_init(&ramp, delay_ctx->mix_q15, delay_ctx->mix_q15, samples);
+
+    // Bypass while a whole block of silence has already come out of the line.
+    // Skipped slots count as silence, so a longer delay ends the bypass once
+    // it reaches back to audio written before the gate closed. A change due
+    // in this block may do just that on its own sample, so such a block takes
+    // the split path below.
+    if (closed && !delay_ctx->stale && delay_ctx->silent_run >= delay_samples + samples &&
+        audio_delay_damping_settled(delay_ctx) && audio_events_next_time(&delay_ctx->events) >= block_start + samples)
+    {
+        if (!delay_ctx->bypassed)
+        {
+            delay_ctx->bypassed = true;
+            delay_ctx->bypassed_samples = 0;
+        }
+        audio_delay_process_bypass(delay_ctx, output, samples);
+        audio_delay_advance_clock(delay_ctx, samples);
+        return ESP_OK;
+    }
+
+    if (delay_ctx->bypassed)
+    {
+        // The skipped slots end at the write head, the last delay_samples of them are up next
+        uint32_t ahead = delay_ctx->bypassed_samples < delay_samples ? delay_ctx->bypassed_samples : delay_samples;
+
+        delay_ctx->bypassed = false;
+        delay_ctx->stale = true;
+        delay_ctx->stale_base = delay_ctx->write_index;
+        delay_ctx->stale_up = delay_ctx->buffer_size - ahead;
+        delay_ctx->stale_down = delay_ctx->stale_up;
+        delay_ctx->stale_low = delay_ctx->buffer_size - delay_ctx->bypassed_samples;
+        delay_ctx->stale_written = 0;
+        delay_ctx->stale_read_index = delay_ctx->read_index;
+    }
+
+    if (delay_ctx->stale)
+    {
+        audio_delay_clear_stale(delay_ctx, samples);
+    }
+
+    if (closed)
+    {
+        memset(input, 0, samples * sizeof(int16_t));
+    }
+
+    uint32_t line_start = delay_ctx->write_index;
+    bool echoed = false;
+    size_t done = 0;
+
+    // The block is split at every scheduled change, which takes effect on its exact sample
+    while (done < samples)
+    {
+        audio_delay_apply_due(delay_ctx, block_start + done + 1, block_start, &ramp, samples - done);
+
+        size_t end = samples;
+        uint64_t next = audio_events_next_time(&delay_ctx->events);
+        if (next < block_start + samples)
+        {
+            end = (size_t)(next - block_start);
+        }
+
+        delay_samples = (delay_ctx->write_index + delay_ctx->buffer_size - delay_ctx->read_index) %
+                        delay_ctx->buffer_size;
+        int32_t feedback = delay_ctx->feedback_q15;
+
+        // A zero-length line has nothing to feed back
+        if (feedback != 0 && delay_samples > 0)
+        {
+            audio_delay_process_echo(delay_ctx, input + done, output + done, end - done, delay_samples, feedback,
+                                     &ramp);
+            echoed = true;
+        }
+        else
+        {
+            audio_delay_process_plain(delay_ctx, input + done, output + done, end - done, delay_samples, &ramp);
+        }
+
+        if (delay_ctx->gain_q15 != DSP_Q15_ONE)
+        {
+            dsp_backend_gain(output + done, output + done, end - done, delay_ctx->gain_q15);
+        }
+        done = end;
+    }
+
+    // Track how much silence the line holds; the echo tail has to die out first
+    if (!closed)
+    {
+        delay_ctx->silent_run = 0;
+    }
+    else if (!echoed || audio_delay_ring_is_silent(delay_ctx, line_start, samples))
+    {
+        delay_ctx->silent_run += samples;
+        if (delay_ctx->silent_run > delay_ctx->buffer_size)
+        {
+            delay_ctx->silent_run = delay_ctx->buffer_size;
+        }
+    }
+    else
+    {
+        delay_ctx->silent_run = 0;
+    }
+
+    audio_delay_advance_clock(delay_ctx, samples);
+    return ESP_OK;
+}
+
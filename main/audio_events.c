@@ -0,0 +1,125 @@
+#include "audio_events.h"
+#include <string.h>
+
+void audio_events_init(audio_event_queue_t *queue)
+{
+    memset(queue, 0, sizeof(*queue));
+    portMUX_INITIALIZE(&queue->lock);
+}
+
+// Any task on either core; not from an ISR
+esp_err_t audio_events_push(audio_event_queue_t *queue, const audio_event_t *event)
+{
+    if (!queue || !event || event->type >= AUDIO_EVENT_TYPE_COUNT)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&queue->lock);
+    uint32_t head = queue->head;
+    if (head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE) >= AUDIO_EVENT_QUEUE_SIZE)
+    {
+        queue->stats.dropped++;
+        ret = ESP_ERR_NO_MEM;
+    }
+    else
+    {
+        queue->ring[head % AUDIO_EVENT_QUEUE_SIZE] = *event;
+        __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+        queue->stats.scheduled++;
+    }
+    portEXIT_CRITICAL(&queue->lock);
+    return ret;
+}
+
+// Drops every scheduled change pushed so far; the audio task does it at its next block
+void audio_events_clear(audio_event_queue_t *queue)
+{
+    portENTER_CRITICAL(&queue->lock);
+    queue->clear_request = true;
+    portEXIT_CRITICAL(&queue->lock);
+}
+
+// Insert behind every pending event due at the same sample or earlier
+static void audio_events_insert(audio_event_queue_t *queue, const audio_event_t *event)
+{
+    uint32_t i = queue->pending_count;
+    while (i > 0 && queue->pending[i - 1].at_sample > event->at_sample)
+    {
+        queue->pending[i] = queue->pending[i - 1];
+        i--;
+    }
+    queue->pending[i] = *event;
+    queue->pending_count++;
+}
+
+// Audio task, once per block: move what has arrived into the ordered list.
+// Events stay in the ring while the list is full.
+void audio_events_collect(audio_event_queue_t *queue)
+{
+    uint32_t tail = queue->tail;
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+    bool clear = queue->clear_request;
+    if (clear)
+    {
+        // Only what was pushed before the request is guaranteed to be covered; a later push may go too.
+        // Setter changes are not part of the schedule and survive it.
+        queue->clear_request = false;
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < queue->pending_count; i++)
+        {
+            if (queue->pending[i].at_sample == AUDIO_EVENT_NOW)
+            {
+                queue->pending[kept++] = queue->pending[i];
+            }
+        }
+        queue->stats.cleared += queue->pending_count - kept;
+        queue->pending_count = kept;
+    }
+
+    while (tail != head && queue->pending_count < AUDIO_EVENT_PENDING_MAX)
+    {
+        const audio_event_t *event = &queue->ring[tail % AUDIO_EVENT_QUEUE_SIZE];
+        if (clear && event->at_sample != AUDIO_EVENT_NOW)
+        {
+            queue->stats.cleared++;
+        }
+        else
+        {
+            audio_events_insert(queue, event);
+        }
+        tail++;
+    }
+    __atomic_store_n(&queue->tail, tail, __ATOMIC_RELEASE);
+}
+
+// Audio task: take the earliest event if it is due before the given sample
+bool audio_events_pop_due(audio_event_queue_t *queue, uint64_t before_sample, audio_event_t *event)
+{
+    if (queue->pending_count == 0 || queue->pending[0].at_sample >= before_sample)
+    {
+        return false;
+    }
+
+    *event = queue->pending[0];
+    queue->pending_count--;
+    memmove(&queue->pending[0], &queue->pending[1], queue->pending_count * sizeof(audio_event_t));
+    queue->stats.applied++;
+    return true;
+}
+
+// Audio task: sample of the earliest pending event, UINT64_MAX if there is none
+uint64_t audio_events_next_time(const audio_event_queue_t *queue)
+{
+    return queue->pending_count ? queue->pending[0].at_sample : UINT64_MAX;
+}
+
+// Counters are read without stopping either side, each one is exact on its own
+void audio_events_get_stats(audio_event_queue_t *queue, audio_event_stats_t *stats)
+{
+    *stats = queue->stats;
+    stats->pending = (__atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE)) +
+                     queue->pending_count;
+}
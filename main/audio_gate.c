@@ -0,0 +1,235 @@
+#include "audio_gate.h"
+#include "dsp_kernels.h"
+#include "dsp_backend.h"
+#include "esp_log.h"
+#include <string.h>
+#include <inttypes.h>
+
+static const char *TAG = "AUDIO_GATE";
+
+static const char *const state_names[] = {"open", "hold", "release", "closed"};
+
+static void audio_gate_update_times(audio_gate_t *gate)
+{
+    uint32_t release = (uint32_t)(((uint64_t)gate->release_ms * gate->sample_rate) / 1000);
+
+    gate->hold_samples = (uint32_t)(((uint64_t)gate->hold_ms * gate->sample_rate) / 1000);
+    gate->release_samples = release > 0 ? release : 1;
+}
+
+esp_err_t audio_gate_init(audio_gate_t *gate, uint32_t sample_rate)
+{
+    if (!gate || sample_rate == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(gate, 0, sizeof(*gate));
+    portMUX_INITIALIZE(&gate->lock);
+    gate->threshold = AUDIO_GATE_DEFAULT_THRESHOLD;
+    gate->hold_ms = AUDIO_GATE_DEFAULT_HOLD_MS;
+    gate->release_ms = AUDIO_GATE_DEFAULT_RELEASE_MS;
+    gate->sample_rate = sample_rate;
+    gate->state = AUDIO_GATE_OPEN;
+    gate->gain_q15 = DSP_Q15_ONE;
+    audio_gate_update_times(gate);
+    gate->hold_left = gate->hold_samples;
+
+    ESP_LOGI(TAG, "Gate initialized - threshold %" PRId32 ", hold %" PRIu32 " ms, release %" PRIu32 " ms",
+             gate->threshold, gate->hold_ms, gate->release_ms);
+    return ESP_OK;
+}
+
+esp_err_t audio_gate_set_params(audio_gate_t *gate, int16_t threshold, uint32_t hold_ms, uint32_t release_ms)
+{
+    if (!gate || threshold < 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    gate->threshold = threshold;
+    gate->hold_ms = hold_ms;
+    gate->release_ms = release_ms;
+    audio_gate_update_times(gate);
+
+    ESP_LOGI(TAG, "Gate set - threshold %d, hold %" PRIu32 " ms, release %" PRIu32 " ms",
+             threshold, hold_ms, release_ms);
+    return ESP_OK;
+}
+
+esp_err_t audio_gate_set_sample_rate(audio_gate_t *gate, uint32_t sample_rate)
+{
+    if (!gate || sample_rate == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    gate->sample_rate = sample_rate;
+    audio_gate_update_times(gate);
+    return ESP_OK;
+}
+
+// Linear gain ramp over count samples, then the end gain for the rest of the block
+static void audio_gate_apply_ramp(int16_t *samples, size_t count, size_t ramp, int32_t start_q15, int32_t end_q15)
+{
+    if (ramp > count)
+    {
+        ramp = count;
+    }
+
+    if (ramp > 0 && start_q15 != end_q15)
+    {
+        int32_t gain = start_q15 * DSP_Q15_ONE;
+        int32_t step = (end_q15 - start_q15) * DSP_Q15_ONE / (int32_t)ramp;
+
+        for (size_t i = 0; i < ramp; i++)
+        {
+            samples[i] = (int16_t)dsp_sat16((samples[i] * (gain >> 15) + (1 << 14)) >> 15);
+            gain += step;
+        }
+        samples += ramp;
+        count -= ramp;
+    }
+
+    if (end_q15 != DSP_Q15_ONE)
+    {
+        dsp_backend_gain(samples, samples, count, end_q15);
+    }
+}
+
+bool audio_gate_process(audio_gate_t *gate, int16_t *block, size_t samples, int32_t peak)
+{
+    int32_t gain = gate->gain_q15;
+
+    if (peak >= gate->threshold)
+    {
+        // Open immediately, fading in from wherever the release left the gain
+        gate->state = AUDIO_GATE_OPEN;
+        gate->hold_left = gate->hold_samples;
+        gate->gain_q15 = DSP_Q15_ONE;
+        audio_gate_apply_ramp(block, samples, AUDIO_GATE_ATTACK_SAMPLES, gain, DSP_Q15_ONE);
+        return false;
+    }
+
+    switch (gate->state)
+    {
+    case AUDIO_GATE_OPEN:
+    case AUDIO_GATE_HOLD:
+        if (gate->hold_left > samples)
+        {
+            gate->state = AUDIO_GATE_HOLD;
+            gate->hold_left -= (uint32_t)samples;
+            return false;
+        }
+        gate->hold_left = 0;
+        gate->state = AUDIO_GATE_RELEASE;
+        // fall through
+
+    case AUDIO_GATE_RELEASE:
+    {
+        int32_t step = (int32_t)(((uint64_t)DSP_Q15_ONE * samples) / gate->release_samples);
+        int32_t end = gain - step;
+        if (end <= 0)
+        {
+            end = 0;
+            gate->state = AUDIO_GATE_CLOSED;
+        }
+        audio_gate_apply_ramp(block, samples, samples, gain, end);
+        gate->gain_q15 = end;
+        return false;
+    }
+
+    case AUDIO_GATE_CLOSED:
+    default:
+        gate->gain_q15 = 0;
+        return true;
+    }
+}
+
+void audio_gate_account(audio_gate_t *gate, size_t samples, uint32_t cycles, bool bypassed)
+{
+    if (samples == 0)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&gate->lock);
+
+    gate->total_blocks++;
+    gate->spent_cycles += cycles;
+
+    if (bypassed)
+    {
+        // What the block would have cost on the normal path, at the recent average
+        uint64_t active = ((uint64_t)gate->active_cycles_q8 * samples) >> 8;
+        gate->bypass_blocks++;
+        if (active > cycles)
+        {
+            gate->saved_cycles += active - cycles;
+        }
+    }
+    else
+    {
+        uint32_t per_sample_q8 = (uint32_t)(((uint64_t)cycles << 8) / samples);
+        if (gate->active_cycles_q8 == 0)
+        {
+            gate->active_cycles_q8 = per_sample_q8;
+        }
+        else
+        {
+            gate->active_cycles_q8 += ((int32_t)(per_sample_q8 - gate->active_cycles_q8)) / 8;
+        }
+    }
+
+    portEXIT_CRITICAL(&gate->lock);
+}
+
+esp_err_t audio_gate_get_stats(audio_gate_t *gate, audio_gate_stats_t *stats)
+{
+    if (!gate || !stats)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&gate->lock);
+    stats->state = gate->state;
+    stats->total_blocks = gate->total_blocks;
+    stats->bypass_blocks = gate->bypass_blocks;
+    stats->active_cycles_per_sample = gate->active_cycles_q8 / 256.0f;
+    stats->spent_cycles = gate->spent_cycles;
+    stats->saved_cycles = gate->saved_cycles;
+    portEXIT_CRITICAL(&gate->lock);
+
+    uint64_t would_spend = stats->spent_cycles + stats->saved_cycles;
+    stats->saved_percent = would_spend ? (float)stats->saved_cycles * 100.0f / (float)would_spend : 0.0f;
+    return ESP_OK;
+}
+
+void audio_gate_reset_stats(audio_gate_t *gate)
+{
+    if (!gate)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&gate->lock);
+    gate->total_blocks = 0;
+    gate->bypass_blocks = 0;
+    gate->spent_cycles = 0;
+    gate->saved_cycles = 0;
+    portEXIT_CRITICAL(&gate->lock);
+}
+
+void audio_gate_log_report(audio_gate_t *gate)
+{
+    audio_gate_stats_t stats;
+    if (audio_gate_get_stats(gate, &stats) != ESP_OK)
+    {
+        return;
+    }
+
+    ESP_LOGI(TAG, "Gate %s: %" PRIu32 "/%" PRIu32 " blocks bypassed, active %.1f cycles/sample, saved %" PRIu64
+                  " cycles (%.1f%%)",
+             state_names[stats.state], stats.bypass_blocks, stats.total_blocks, stats.active_cycles_per_sample,
+             stats.saved_cycles, stats.saved_percent);
+}
@@ -0,0 +1,186 @@
+#include "audio_jitter.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <inttypes.h>
+
+static const char *TAG = "AUDIO_JITTER";
+
+// Tracker state, written by the audio task once per block
+static portMUX_TYPE jitter_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t next_seq = 0;
+static int64_t last_arrival_us = 0;
+static uint32_t ideal_period_us = 0;
+static uint32_t intervals = 0;
+static int64_t sum_dev_us = 0;
+static int64_t sum_dev_sq = 0;
+static int32_t worst_dev_us = 0;
+static uint32_t anomaly_count = 0;
+static audio_jitter_anomaly_t anomalies[AUDIO_JITTER_ANOMALY_COUNT];
+static uint32_t anomaly_head = 0;
+
+// Activities currently running and activities seen since the last block
+static volatile uint32_t activity_active = 0;
+static volatile uint32_t activity_seen = 0;
+
+static void jitter_clear_locked(void)
+{
+    intervals = 0;
+    sum_dev_us = 0;
+    sum_dev_sq = 0;
+    worst_dev_us = 0;
+    anomaly_count = 0;
+    anomaly_head = 0;
+    last_arrival_us = 0;
+    memset(anomalies, 0, sizeof(anomalies));
+}
+
+void audio_jitter_block_arrived(uint32_t samples, uint32_t sample_rate, audio_block_tag_t *tag)
+{
+    int64_t now_us = esp_timer_get_time();
+    uint32_t activity = __atomic_exchange_n(&activity_seen, activity_active, __ATOMIC_RELAXED);
+    uint32_t period_us = sample_rate ? (uint32_t)(((uint64_t)samples * 1000000) / sample_rate) : 0;
+
+    portENTER_CRITICAL(&jitter_lock);
+
+    uint32_t seq = next_seq++;
+
+    // A new block size or sample rate starts a fresh measurement
+    if (period_us != ideal_period_us)
+    {
+        jitter_clear_locked();
+        ideal_period_us = period_us;
+    }
+
+    if (last_arrival_us != 0)
+    {
+        uint32_t interval_us = (uint32_t)(now_us - last_arrival_us);
+        int32_t dev_us = (int32_t)interval_us - (int32_t)period_us;
+
+        intervals++;
+        sum_dev_us += dev_us;
+        sum_dev_sq += (int64_t)dev_us * dev_us;
+
+        if (abs(dev_us) > abs(worst_dev_us))
+        {
+            worst_dev_us = dev_us;
+        }
+
+        if ((uint32_t)abs(dev_us) * 100 > period_us * AUDIO_JITTER_ANOMALY_PERCENT)
+        {
+            audio_jitter_anomaly_t *entry = &anomalies[anomaly_head];
+            entry->seq = seq;
+            entry->timestamp_us = now_us;
+            entry->interval_us = interval_us;
+            entry->deviation_us = dev_us;
+            entry->activity = activity;
+            anomaly_head = (anomaly_head + 1) % AUDIO_JITTER_ANOMALY_COUNT;
+            anomaly_count++;
+        }
+    }
+    last_arrival_us = now_us;
+
+    portEXIT_CRITICAL(&jitter_lock);
+
+    if (tag)
+    {
+        tag->seq = seq;
+        tag->timestamp_us = now_us;
+    }
+}
+
+void audio_jitter_activity_begin(uint32_t activity)
+{
+    __atomic_fetch_or(&activity_active, activity, __ATOMIC_RELAXED);
+    __atomic_fetch_or(&activity_seen, activity, __ATOMIC_RELAXED);
+}
+
+void audio_jitter_activity_end(uint32_t activity)
+{
+    __atomic_fetch_and(&activity_active, ~activity, __ATOMIC_RELAXED);
+}
+
+esp_err_t audio_jitter_get_stats(audio_jitter_stats_t *stats)
+{
+    if (!stats)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&jitter_lock);
+    uint32_t n = intervals;
+    int64_t sum = sum_dev_us;
+    int64_t sum_sq = sum_dev_sq;
+    stats->ideal_period_us = ideal_period_us;
+    stats->worst_deviation_us = worst_dev_us;
+    stats->anomaly_count = anomaly_count;
+    portEXIT_CRITICAL(&jitter_lock);
+
+    stats->intervals = n;
+    stats->mean_interval_us = stats->ideal_period_us;
+    stats->stdev_us = 0;
+
+    if (n > 0)
+    {
+        double mean_dev = (double)sum / n;
+        double variance = (double)sum_sq / n - mean_dev * mean_dev;
+        stats->mean_interval_us = (uint32_t)((int64_t)stats->ideal_period_us + (int64_t)mean_dev);
+        stats->stdev_us = variance > 0 ? (uint32_t)sqrt(variance) : 0;
+    }
+
+    return ESP_OK;
+}
+
+size_t audio_jitter_get_anomalies(audio_jitter_anomaly_t *out, size_t max_count)
+{
+    if (!out)
+    {
+        return 0;
+    }
+
+    portENTER_CRITICAL(&jitter_lock);
+    size_t available = anomaly_count < AUDIO_JITTER_ANOMALY_COUNT ? anomaly_count : AUDIO_JITTER_ANOMALY_COUNT;
+    size_t count = available < max_count ? available : max_count;
+
+    // Newest first
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t index = (anomaly_head + AUDIO_JITTER_ANOMALY_COUNT - 1 - i) % AUDIO_JITTER_ANOMALY_COUNT;
+        out[i] = anomalies[index];
+    }
+    portEXIT_CRITICAL(&jitter_lock);
+
+    return count;
+}
+
+void audio_jitter_reset(void)
+{
+    portENTER_CRITICAL(&jitter_lock);
+    jitter_clear_locked();
+    portEXIT_CRITICAL(&jitter_lock);
+}
+
+void audio_jitter_log_report(void)
+{
+    audio_jitter_stats_t stats;
+    audio_jitter_get_stats(&stats);
+
+    ESP_LOGI(TAG, "Intervals %" PRIu32 ": ideal %" PRIu32 " us, mean %" PRIu32 " us, stdev %" PRIu32
+                  " us, worst %+" PRId32 " us, anomalies %" PRIu32,
+             stats.intervals, stats.ideal_period_us, stats.mean_interval_us, stats.stdev_us,
+             stats.worst_deviation_us, stats.anomaly_count);
+
+    audio_jitter_anomaly_t recent[AUDIO_JITTER_ANOMALY_COUNT];
+    size_t count = audio_jitter_get_anomalies(recent, AUDIO_JITTER_ANOMALY_COUNT);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        ESP_LOGI(TAG, "  #%" PRIu32 " at %" PRId64 " us: interval %" PRIu32 " us (%+" PRId32 ")%s%s",
+                 recent[i].seq, recent[i].timestamp_us, recent[i].interval_us, recent[i].deviation_us,
+                 (recent[i].activity & AUDIO_JITTER_ACT_DISPLAY) ? " [display]" : "",
+                 (recent[i].activity & AUDIO_JITTER_ACT_NVS) ? " [nvs]" : "");
+    }
+}
@@ -0,0 +1,248 @@
+#include "audio_limiter.h"
+#include "dsp_kernels.h"
+#include "esp_log.h"
+#include <math.h>
+#include <string.h>
+
+static const char *TAG = "AUDIO_LIMITER";
+
+// Gain ramps carry 15 extra fraction bits so the per-sample step keeps its precision
+#define RAMP_FRAC 15
+
+static int32_t audio_limiter_gain_for_peak(int32_t peak, int32_t ceiling)
+{
+    if (peak <= ceiling)
+    {
+        return DSP_Q15_ONE;
+    }
+    return (ceiling * DSP_Q15_ONE) / peak;
+}
+
+static void audio_limiter_update_coefs(audio_limiter_t *lim)
+{
+    uint32_t chunk_samples = (lim->lookahead_ms * lim->sample_rate / 1000 + AUDIO_LIMITER_CHUNK - 1) /
+                             AUDIO_LIMITER_CHUNK;
+    if (chunk_samples > AUDIO_LIMITER_MAX_LOOKAHEAD_CHUNKS)
+    {
+        chunk_samples = AUDIO_LIMITER_MAX_LOOKAHEAD_CHUNKS;
+    }
+
+    // One-pole release towards unity, evaluated once per chunk
+    float release_samples = lim->release_ms * lim->sample_rate / 1000.0f;
+    float coef = release_samples > 0.0f ? 1.0f - expf(-(float)AUDIO_LIMITER_CHUNK / release_samples) : 1.0f;
+
+    lim->lookahead_chunks = chunk_samples;
+    lim->release_q15 = (int32_t)(coef * DSP_Q15_ONE + 0.5f);
+}
+
+esp_err_t audio_limiter_init(audio_limiter_t *lim, audio_delay_t *delay, uint32_t sample_rate)
+{
+    if (!lim || !delay || sample_rate == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(lim, 0, sizeof(*lim));
+    lim->delay = delay;
+    lim->ceiling = AUDIO_LIMITER_DEFAULT_CEILING;
+    lim->lookahead_ms = AUDIO_LIMITER_DEFAULT_LOOKAHEAD_MS;
+    lim->release_ms = AUDIO_LIMITER_DEFAULT_RELEASE_MS;
+    lim->sample_rate = sample_rate;
+    lim->gain_q15 = DSP_Q15_ONE;
+    audio_limiter_update_coefs(lim);
+
+    ESP_LOGI(TAG, "Limiter initialized - ceiling %ld, lookahead %lu chunks",
+             (long)lim->ceiling, (unsigned long)lim->lookahead_chunks);
+    return ESP_OK;
+}
+
+esp_err_t audio_limiter_set_params(audio_limiter_t *lim, int16_t ceiling, uint32_t lookahead_ms, uint32_t release_ms)
+{
+    if (!lim || ceiling <= 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    lim->ceiling = ceiling;
+    lim->lookahead_ms = lookahead_ms;
+    lim->release_ms = release_ms;
+    audio_limiter_update_coefs(lim);
+
+    ESP_LOGI(TAG, "Limiter set - ceiling %d, lookahead %lu ms, release %lu ms",
+             ceiling, (unsigned long)lookahead_ms, (unsigned long)release_ms);
+    return ESP_OK;
+}
+
+esp_err_t audio_limiter_set_sample_rate(audio_limiter_t *lim, uint32_t sample_rate)
+{
+    if (!lim || sample_rate == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    lim->sample_rate = sample_rate;
+    audio_limiter_update_coefs(lim);
+    return ESP_OK;
+}
+
+int32_t audio_limiter_get_gain(const audio_limiter_t *lim)
+{
+    return lim ? lim->gain_q15 : DSP_Q15_ONE;
+}
+
+static int32_t audio_limiter_peak(const int16_t *samples, size_t count, int32_t peak)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        int32_t level = samples[i] < 0 ? -(int32_t)samples[i] : samples[i];
+        if (level > peak)
+        {
+            peak = level;
+        }
+    }
+    return peak;
+}
+
+// Fold ring samples up to absolute position scan_end into the per-chunk peaks.
+// Every ring sample is visited once, whatever the lookahead.
+static void audio_limiter_scan(audio_limiter_t *lim, uint32_t block_start, uint32_t block_read_index,
+                               uint32_t scan_end)
+{
+    const audio_delay_t *delay = lim->delay;
+
+    while ((int32_t)(scan_end - lim->scan_pos) > 0)
+    {
+        uint32_t chunk = lim->scan_pos / AUDIO_LIMITER_CHUNK;
+        uint32_t run = (chunk + 1) * AUDIO_LIMITER_CHUNK - lim->scan_pos;
+        if (run > scan_end - lim->scan_pos)
+        {
+            run = scan_end - lim->scan_pos;
+        }
+
+        uint32_t ring_pos = (block_read_index + (lim->scan_pos - block_start)) % delay->buffer_size;
+        uint32_t first = delay->buffer_size - ring_pos;
+        if (first > run)
+        {
+            first = run;
+        }
+
+        int16_t *slot = &lim->chunk_peak[chunk % AUDIO_LIMITER_PEAK_SLOTS];
+        int32_t peak = (lim->scan_pos % AUDIO_LIMITER_CHUNK) ? *slot : 0;
+        peak = audio_limiter_peak(&delay->delay_buffer[ring_pos], first, peak);
+        peak = audio_limiter_peak(delay->delay_buffer, run - first, peak);
+        *slot = (int16_t)(peak > INT16_MAX ? INT16_MAX : peak);
+
+        lim->scan_pos += run;
+    }
+}
+
+static void audio_limiter_apply_ramp(int16_t *samples, size_t count, int32_t start_q15, int32_t end_q15)
+{
+    if (start_q15 == DSP_Q15_ONE && end_q15 == DSP_Q15_ONE)
+    {
+        return;
+    }
+
+    int32_t gain = start_q15 * (1 << RAMP_FRAC);
+    int32_t step = (end_q15 - start_q15) * (1 << RAMP_FRAC) / (int32_t)count;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        samples[i] = (int16_t)dsp_sat16((samples[i] * (gain >> RAMP_FRAC) + (1 << 14)) >> 15);
+        gain += step;
+    }
+}
+
+void audio_limiter_process_block(void *ctx, const int16_t *in, int16_t *out, size_t samples)
+{
+    audio_limiter_t *lim = (audio_limiter_t *)ctx;
+    const audio_delay_t *delay = lim->delay;
+    uint32_t size = delay->buffer_size;
+
+    if (out != in)
+    {
+        memcpy(out, in, samples * sizeof(int16_t));
+    }
+
+    // The delay has already produced this block: it came from the ring just
+    // behind the read head, and everything up to the write head is still to come
+    uint32_t read_index = delay->read_index;
+    uint32_t block_read_index = (read_index + size - (uint32_t)(samples % size)) % size;
+    uint32_t delay_samples = (delay->write_index + size - read_index) % size;
+
+    // A delay change or rate switch moved the heads, the old chunk peaks no longer apply
+    if (!lim->primed || block_read_index != lim->expected_read_index)
+    {
+        memset(lim->chunk_peak, 0, sizeof(lim->chunk_peak));
+        lim->scan_pos = lim->out_pos;
+        lim->primed = true;
+    }
+    lim->expected_read_index = read_index;
+
+    int32_t ceiling = lim->ceiling;
+    uint32_t lookahead = lim->lookahead_chunks * AUDIO_LIMITER_CHUNK;
+    uint32_t block_start = lim->out_pos;
+    uint32_t visible_end = block_start + (uint32_t)samples + delay_samples;
+    int32_t gain = lim->gain_q15;
+    size_t done = 0;
+
+    while (done < samples)
+    {
+        uint32_t pos = lim->out_pos;
+        uint32_t chunk = pos / AUDIO_LIMITER_CHUNK;
+        size_t seg = (chunk + 1) * AUDIO_LIMITER_CHUNK - pos;
+        if (seg > samples - done)
+        {
+            seg = samples - done;
+        }
+
+        // Lookahead is free but bounded by how far the write head is ahead
+        uint32_t scan_end = pos + (uint32_t)seg + lookahead;
+        if ((int32_t)(scan_end - visible_end) > 0)
+        {
+            scan_end = visible_end;
+        }
+        audio_limiter_scan(lim, block_start, block_read_index, scan_end);
+
+        // The chunk itself: its ring peak and the actual output, which may
+        // also carry dry signal and EQ boost the ring does not see
+        int32_t peak = audio_limiter_peak(&out[done], seg, lim->chunk_peak[chunk % AUDIO_LIMITER_PEAK_SLOTS]);
+        int32_t self = audio_limiter_gain_for_peak(peak, ceiling);
+
+        // Release towards unity, but reach each upcoming chunk's gain by the end of the chunk before it
+        int32_t target = gain + (((DSP_Q15_ONE - gain) * lim->release_q15) >> 15);
+        if (self < target)
+        {
+            target = self;
+        }
+        uint32_t last_chunk = (scan_end - 1) / AUDIO_LIMITER_CHUNK;
+        for (uint32_t j = chunk + 1; (int32_t)(last_chunk - j) >= 0; j++)
+        {
+            int32_t needed = audio_limiter_gain_for_peak(lim->chunk_peak[j % AUDIO_LIMITER_PEAK_SLOTS], ceiling);
+            if (needed < gain)
+            {
+                int32_t slope = gain + (needed - gain) / (int32_t)(j - chunk);
+                if (slope < target)
+                {
+                    target = slope;
+                }
+            }
+        }
+
+        int32_t start = gain < self ? gain : self;
+        if (start < DSP_Q15_ONE || target < DSP_Q15_ONE)
+        {
+            if (self < DSP_Q15_ONE)
+            {
+                lim->limited_chunks++;
+            }
+            audio_limiter_apply_ramp(&out[done], seg, start, target);
+        }
+
+        gain = target;
+        lim->out_pos += (uint32_t)seg;
+        done += seg;
+    }
+
+    lim->gain_q15 = gain;
+}
@@ -0,0 +1,122 @@
+#include "audio_meter.h"
+#include <string.h>
+#include <math.h>
+
+#define METER_FLOOR_DBFS -120.0f
+
+// Running accumulation, audio task only
+static int32_t acc_peak[AUDIO_METER_POINT_COUNT];
+static uint64_t acc_sum_sq[AUDIO_METER_POINT_COUNT];
+static uint32_t acc_samples[AUDIO_METER_POINT_COUNT];
+static uint32_t acc_block_samples = 0;
+
+// Published levels behind a sequence lock: the audio task is the only writer
+// and makes the sequence odd while it updates; readers retry on a change
+static uint32_t snap_seq = 0;
+static audio_meter_level_t snap_level[AUDIO_METER_POINT_COUNT];
+
+static uint32_t meter_isqrt(uint32_t x)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+
+    while (bit > x)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (x >= root + bit)
+        {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+void audio_meter_add(audio_meter_point_t point, int32_t peak, uint64_t sum_sq, size_t samples)
+{
+    if (point >= AUDIO_METER_POINT_COUNT)
+    {
+        return;
+    }
+
+    if (peak > acc_peak[point])
+    {
+        acc_peak[point] = peak;
+    }
+    acc_sum_sq[point] += sum_sq;
+    acc_samples[point] += (uint32_t)samples;
+}
+
+void audio_meter_block_done(size_t samples, uint32_t sample_rate)
+{
+    acc_block_samples += (uint32_t)samples;
+    if ((uint64_t)acc_block_samples * 1000 < (uint64_t)sample_rate * AUDIO_METER_PUBLISH_MS)
+    {
+        return;
+    }
+
+    audio_meter_level_t level[AUDIO_METER_POINT_COUNT];
+    for (int i = 0; i < AUDIO_METER_POINT_COUNT; i++)
+    {
+        // Mean square of int16 samples fits in 31 bits
+        uint32_t mean_sq = acc_samples[i] ? (uint32_t)(acc_sum_sq[i] / acc_samples[i]) : 0;
+        level[i].peak = (uint16_t)acc_peak[i];
+        level[i].rms = (uint16_t)meter_isqrt(mean_sq);
+    }
+
+    uint32_t seq = snap_seq;
+    __atomic_store_n(&snap_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(snap_level, level, sizeof(snap_level));
+    __atomic_store_n(&snap_seq, seq + 2, __ATOMIC_RELEASE);
+
+    memset(acc_peak, 0, sizeof(acc_peak));
+    memset(acc_sum_sq, 0, sizeof(acc_sum_sq));
+    memset(acc_samples, 0, sizeof(acc_samples));
+    acc_block_samples = 0;
+}
+
+esp_err_t audio_meter_get_snapshot(audio_meter_snapshot_t *snapshot)
+{
+    if (!snapshot)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (int attempt = 0; attempt < AUDIO_METER_READ_RETRIES; attempt++)
+    {
+        uint32_t before = __atomic_load_n(&snap_seq, __ATOMIC_ACQUIRE);
+        if (before & 1)
+        {
+            continue;
+        }
+
+        memcpy(snapshot->level, snap_level, sizeof(snapshot->level));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&snap_seq, __ATOMIC_RELAXED) == before)
+        {
+            snapshot->seq = before / 2;
+            return ESP_OK;
+        }
+    }
+
+    return ESP_ERR_TIMEOUT;
+}
+
+float audio_meter_level_to_dbfs(uint16_t level)
+{
+    if (level == 0)
+    {
+        return METER_FLOOR_DBFS;
+    }
+    return 20.0f * log10f((float)level / 32768.0f);
+}
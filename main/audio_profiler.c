@@ -0,0 +1,201 @@
+#include "audio_profiler.h"
+#include "esp_log.h"
+#include "esp_private/esp_clk.h"
+#include <string.h>
+#include <inttypes.h>
+
+static const char *TAG = "AUDIO_PROF";
+
+// Per-stage accumulators. The audio task is the only writer; readers copy
+// under a sequence counter and retry if a block was recorded meanwhile.
+typedef struct
+{
+    volatile uint32_t seq;
+    uint32_t count;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint32_t max_block_seq;
+    uint64_t total_cycles;
+    uint32_t histogram[AUDIO_PROFILER_BUCKETS];
+} prof_stage_acc_t;
+
+static prof_stage_acc_t stages[AUDIO_PROF_STAGE_COUNT];
+static volatile uint32_t block_samples = 0;
+static volatile uint32_t block_sample_rate = 0;
+static volatile uint32_t block_seq = 0; // Tag of the block being recorded
+static volatile bool reset_requested = false;
+
+static const char *stage_names[AUDIO_PROF_STAGE_COUNT] = {
+    "process", // AUDIO_PROF_PROCESS
+    "chain",   // AUDIO_PROF_CHAIN
+    "loop",    // AUDIO_PROF_LOOP
+};
+
+#define PROF_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+static void profiler_clear(void)
+{
+    for (int i = 0; i < AUDIO_PROF_STAGE_COUNT; i++)
+    {
+        prof_stage_acc_t *acc = &stages[i];
+        acc->seq++;
+        PROF_BARRIER();
+        acc->count = 0;
+        acc->min_cycles = UINT32_MAX;
+        acc->max_cycles = 0;
+        acc->max_block_seq = 0;
+        acc->total_cycles = 0;
+        memset(acc->histogram, 0, sizeof(acc->histogram));
+        PROF_BARRIER();
+        acc->seq++;
+    }
+}
+
+void audio_profiler_record(audio_prof_stage_t stage, uint32_t cycles)
+{
+    if (stage >= AUDIO_PROF_STAGE_COUNT)
+    {
+        return;
+    }
+
+    // Resets are carried out by the writer so readers never race it
+    if (reset_requested)
+    {
+        profiler_clear();
+        reset_requested = false;
+    }
+
+    prof_stage_acc_t *acc = &stages[stage];
+    uint32_t bucket = 31 - __builtin_clz(cycles | 1);
+
+    acc->seq++;
+    PROF_BARRIER();
+    if (acc->count == 0 || cycles < acc->min_cycles)
+    {
+        acc->min_cycles = cycles;
+    }
+    if (cycles > acc->max_cycles)
+    {
+        acc->max_cycles = cycles;
+        acc->max_block_seq = block_seq;
+    }
+    acc->count++;
+    acc->total_cycles += cycles;
+    acc->histogram[bucket]++;
+    PROF_BARRIER();
+    acc->seq++;
+}
+
+void audio_profiler_set_block(uint32_t samples, uint32_t sample_rate, uint32_t seq)
+{
+    block_samples = samples;
+    block_sample_rate = sample_rate;
+    block_seq = seq;
+}
+
+const char *audio_profiler_stage_name(audio_prof_stage_t stage)
+{
+    if (stage >= AUDIO_PROF_STAGE_COUNT)
+    {
+        return "?";
+    }
+    return stage_names[stage];
+}
+
+void audio_profiler_reset(void)
+{
+    reset_requested = true;
+}
+
+static uint32_t profiler_p99(const uint32_t *histogram, uint32_t count)
+{
+    uint32_t tail = count / 100;
+    uint32_t seen = 0;
+
+    for (int bucket = AUDIO_PROFILER_BUCKETS - 1; bucket > 0; bucket--)
+    {
+        seen += histogram[bucket];
+        if (seen > tail)
+        {
+            return bucket >= 31 ? UINT32_MAX : (2u << bucket) - 1;
+        }
+    }
+    return 1;
+}
+
+esp_err_t audio_profiler_get_summary(audio_prof_stage_t stage, audio_prof_summary_t *summary)
+{
+    if (stage >= AUDIO_PROF_STAGE_COUNT || !summary)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+#if !AUDIO_PROFILER_ENABLED
+    memset(summary, 0, sizeof(*summary));
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    prof_stage_acc_t *acc = &stages[stage];
+    prof_stage_acc_t copy;
+    uint32_t seq;
+
+    // Seqlock read, a block is recorded only every few milliseconds so this rarely retries
+    do
+    {
+        seq = acc->seq;
+        PROF_BARRIER();
+        memcpy(&copy, acc, sizeof(copy));
+        PROF_BARRIER();
+    } while ((seq & 1) || seq != acc->seq);
+
+    memset(summary, 0, sizeof(*summary));
+    summary->count = copy.count;
+    if (copy.count == 0)
+    {
+        return ESP_OK;
+    }
+
+    summary->min_cycles = copy.min_cycles;
+    summary->max_cycles = copy.max_cycles;
+    summary->max_block_seq = copy.max_block_seq;
+    summary->avg_cycles = (uint32_t)(copy.total_cycles / copy.count);
+    summary->p99_cycles = profiler_p99(copy.histogram, copy.count);
+    if (summary->p99_cycles > copy.max_cycles)
+    {
+        summary->p99_cycles = copy.max_cycles;
+    }
+    memcpy(summary->histogram, copy.histogram, sizeof(summary->histogram));
+
+    uint32_t samples = block_samples;
+    uint32_t sample_rate = block_sample_rate;
+    if (samples > 0 && sample_rate > 0)
+    {
+        summary->deadline_cycles = (uint32_t)(((uint64_t)samples * esp_clk_cpu_freq()) / sample_rate);
+        summary->avg_load_percent = 100.0f * summary->avg_cycles / summary->deadline_cycles;
+        summary->p99_load_percent = 100.0f * summary->p99_cycles / summary->deadline_cycles;
+        summary->max_load_percent = 100.0f * summary->max_cycles / summary->deadline_cycles;
+    }
+
+    return ESP_OK;
+#endif
+}
+
+void audio_profiler_log_report(void)
+{
+#if !AUDIO_PROFILER_ENABLED
+    ESP_LOGI(TAG, "Profiler compiled out (AUDIO_PROFILER_ENABLED=0)");
+#else
+    ESP_LOGI(TAG, "Block: %" PRIu32 " samples @ %" PRIu32 " Hz", block_samples, block_sample_rate);
+
+    for (int i = 0; i < AUDIO_PROF_STAGE_COUNT; i++)
+    {
+        audio_prof_summary_t summary;
+        audio_profiler_get_summary((audio_prof_stage_t)i, &summary);
+
+        ESP_LOGI(TAG, "%-8s n=%" PRIu32 " min=%" PRIu32 " avg=%" PRIu32 " p99<=%" PRIu32 " max=%" PRIu32
+                      " cycles (#%" PRIu32 "), load avg %.1f%% p99 %.1f%% max %.1f%%",
+                 stage_names[i], summary.count, summary.min_cycles, summary.avg_cycles,
+                 summary.p99_cycles, summary.max_cycles, summary.max_block_seq,
+                 summary.avg_load_percent, summary.p99_load_percent, summary.max_load_percent);
+    }
+#endif
+}
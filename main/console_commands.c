@@ -0,0 +1,580 @@
+#include "console_commands.h"
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+static const console_ops_t *console_ops = NULL;
+static FILE *console_out = NULL;
+
+// Unsigned decimal only; "12ms", "-1" and empty strings are rejected
+static bool console_parse_u32(const char *text, uint32_t *value)
+{
+    if (!text || *text < '0' || *text > '9')
+    {
+        return false;
+    }
+
+    char *end;
+    unsigned long parsed = strtoul(text, &end, 10);
+    if (*end != '\0' || parsed > UINT32_MAX)
+    {
+        return false;
+    }
+    *value = (uint32_t)parsed;
+    return true;
+}
+
+// Signed decimal, "-0" included; trailing text is rejected
+static bool console_parse_s32(const char *text, int32_t *value)
+{
+    uint32_t magnitude;
+    bool negative = text && *text == '-';
+
+    if (!console_parse_u32(negative ? text + 1 : text, &magnitude) || magnitude > (uint32_t)INT32_MAX)
+    {
+        return false;
+    }
+    *value = negative ? -(int32_t)magnitude : (int32_t)magnitude;
+    return true;
+}
+
+// Decimal with optional sign and fraction, as strtof reads it; trailing text and inf/nan are rejected
+static bool console_parse_float(const char *text, float *value)
+{
+    if (!text || *text == '\0')
+    {
+        return false;
+    }
+
+    char *end;
+    float parsed = strtof(text, &end);
+    if (*end != '\0' || !isfinite(parsed))
+    {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+static int console_unavailable(const char *what)
+{
+    fprintf(console_out, "error: %s not available\n", what);
+    return CONSOLE_ERR_FAILED;
+}
+
+static int console_usage(const char *name, const char *hint)
+{
+    fprintf(console_out, "usage: %s %s\n", name, hint);
+    return CONSOLE_ERR_USAGE;
+}
+
+// get with no argument, set with one; shared by delay, rate and mix
+static int console_get_set(int argc, char **argv, const char *hint, const char *unit, uint32_t (*get)(void),
+                           int (*set)(uint32_t))
+{
+    if (argc > 2)
+    {
+        return console_usage(argv[0], hint);
+    }
+
+    if (argc == 2)
+    {
+        uint32_t value;
+        if (!console_parse_u32(argv[1], &value))
+        {
+            return console_usage(argv[0], hint);
+        }
+        if (!set)
+        {
+            return console_unavailable(argv[0]);
+        }
+        if (set(value) != 0)
+        {
+            fprintf(console_out, "error: %s %" PRIu32 " %s rejected\n", argv[0], value, unit);
+            return CONSOLE_ERR_FAILED;
+        }
+    }
+
+    if (!get)
+    {
+        return console_unavailable(argv[0]);
+    }
+    fprintf(console_out, "%s %" PRIu32 " %s\n", argv[0], get(), unit);
+    return CONSOLE_OK;
+}
+
+static int console_cmd_delay(int argc, char **argv)
+{
+    return console_get_set(argc, argv, "[ms]", "ms", console_ops->get_delay_ms, console_ops->set_delay_ms);
+}
+
+static int console_cmd_rate(int argc, char **argv)
+{
+    return console_get_set(argc, argv, "[hz]", "Hz", console_ops->get_sample_rate, console_ops->set_sample_rate);
+}
+
+static int console_cmd_mix(int argc, char **argv)
+{
+    return console_get_set(argc, argv, "[percent]", "%", console_ops->get_mix_percent, console_ops->set_mix_percent);
+}
+
+// Feedback is signed, negative values invert every other repeat; damping defaults to the current one
+static int console_cmd_feedback(int argc, char **argv)
+{
+    static const char *const hint = "[q15, -32767-32767] [damping q15, 0-32767]";
+    int32_t feedback_q15 = 0;
+    int32_t damping_q15 = 0;
+
+    if (argc > 3 || (argc > 1 && (!console_parse_s32(argv[1], &feedback_q15) ||
+                                  feedback_q15 < -CONSOLE_FEEDBACK_Q15_MAX ||
+                                  feedback_q15 > CONSOLE_FEEDBACK_Q15_MAX)) ||
+        (argc > 2 && (!console_parse_s32(argv[2], &damping_q15) || damping_q15 < 0 ||
+                      damping_q15 > CONSOLE_FEEDBACK_Q15_MAX)))
+    {
+        return console_usage(argv[0], hint);
+    }
+    if (!console_ops->get_feedback || (argc > 1 && !console_ops->set_feedback))
+    {
+        return console_unavailable(argv[0]);
+    }
+
+    if (argc > 1)
+    {
+        if (argc == 2)
+        {
+            int32_t unused;
+            console_ops->get_feedback(&unused, &damping_q15);
+        }
+        if (console_ops->set_feedback(feedback_q15, damping_q15) != 0)
+        {
+            fprintf(console_out, "error: feedback %" PRId32 " damping %" PRId32 " rejected\n", feedback_q15,
+                    damping_q15);
+            return CONSOLE_ERR_FAILED;
+        }
+    }
+
+    console_ops->get_feedback(&feedback_q15, &damping_q15);
+    fprintf(console_out, "feedback %" PRId32 " damping %" PRId32 " (Q15)\n", feedback_q15, damping_q15);
+    return CONSOLE_OK;
+}
+
+static int console_cmd_status(int argc, char **argv)
+{
+    if (argc != 1)
+    {
+        return console_usage(argv[0], "");
+    }
+    if (!console_ops->get_delay_ms || !console_ops->get_sample_rate || !console_ops->get_mix_percent)
+    {
+        return console_unavailable(argv[0]);
+    }
+
+    fprintf(console_out, "delay %" PRIu32 " ms, rate %" PRIu32 " Hz, mix %" PRIu32 " %%\n",
+            console_ops->get_delay_ms(), console_ops->get_sample_rate(), console_ops->get_mix_percent());
+    return CONSOLE_OK;
+}
+
+static int console_cmd_metrics(int argc, char **argv)
+{
+    if (argc == 1)
+    {
+        if (!console_ops->metrics_report)
+        {
+            return console_unavailable(argv[0]);
+        }
+        console_ops->metrics_report();
+        return CONSOLE_OK;
+    }
+    if (argc == 2 && strcmp(argv[1], "reset") == 0)
+    {
+        if (!console_ops->metrics_reset)
+        {
+            return console_unavailable(argv[0]);
+        }
+        console_ops->metrics_reset();
+        fprintf(console_out, "metrics reset\n");
+        return CONSOLE_OK;
+    }
+    return console_usage(argv[0], "[reset]");
+}
+
+static int console_cmd_trace(int argc, char **argv)
+{
+    const char *action = argc >= 2 ? argv[1] : "dump";
+    if (argc > 2)
+    {
+        return console_usage(argv[0], "[dump|clear|on|off]");
+    }
+
+    if (strcmp(action, "dump") == 0 && console_ops->trace_dump)
+    {
+        console_ops->trace_dump();
+    }
+    else if (strcmp(action, "clear") == 0 && console_ops->trace_clear)
+    {
+        console_ops->trace_clear();
+        fprintf(console_out, "trace cleared\n");
+    }
+    else if ((strcmp(action, "on") == 0 || strcmp(action, "off") == 0) && console_ops->trace_enable)
+    {
+        console_ops->trace_enable(strcmp(action, "on") == 0);
+        fprintf(console_out, "trace %s\n", action);
+    }
+    else if (strcmp(action, "dump") == 0 || strcmp(action, "clear") == 0 || strcmp(action, "on") == 0 ||
+             strcmp(action, "off") == 0)
+    {
+        return console_unavailable(argv[0]);
+    }
+    else
+    {
+        return console_usage(argv[0], "[dump|clear|on|off]");
+    }
+    return CONSOLE_OK;
+}
+
+static int console_cmd_tasks(int argc, char **argv)
+{
+    if (argc != 1)
+    {
+        return console_usage(argv[0], "");
+    }
+    if (!console_ops->tasks_report)
+    {
+        return console_unavailable(argv[0]);
+    }
+    console_ops->tasks_report();
+    return CONSOLE_OK;
+}
+
+static int console_cmd_preset(int argc, char **argv)
+{
+    uint32_t slot;
+    if (argc != 3 || !console_parse_u32(argv[2], &slot) ||
+        (strcmp(argv[1], "save") != 0 && strcmp(argv[1], "load") != 0))
+    {
+        return console_usage(argv[0], "save|load <slot>");
+    }
+    if (slot >= console_ops->preset_slots)
+    {
+        fprintf(console_out, "error: slot %" PRIu32 " out of range 0-%" PRIu32 "\n", slot,
+                console_ops->preset_slots ? console_ops->preset_slots - 1 : 0);
+        return CONSOLE_ERR_USAGE;
+    }
+
+    bool save = strcmp(argv[1], "save") == 0;
+    int (*op)(uint32_t) = save ? console_ops->preset_save : console_ops->preset_load;
+    if (!op)
+    {
+        return console_unavailable(argv[0]);
+    }
+    if (op(slot) != 0)
+    {
+        fprintf(console_out, "error: preset %s %" PRIu32 " failed%s\n", argv[1], slot, save ? "" : " (empty slot?)");
+        return CONSOLE_ERR_FAILED;
+    }
+
+    fprintf(console_out, "preset %" PRIu32 " %s\n", slot, save ? "saved" : "loaded");
+    return CONSOLE_OK;
+}
+
+static int console_cmd_calibrate(int argc, char **argv)
+{
+    uint32_t seconds = CONSOLE_CALIBRATE_DEFAULT_S;
+    if (argc > 2 || (argc == 2 && (!console_parse_u32(argv[1], &seconds) || seconds == 0 ||
+                                   seconds > CONSOLE_CALIBRATE_MAX_S)))
+    {
+        return console_usage(argv[0], "[seconds, 1-60]");
+    }
+    if (!console_ops->calibrate)
+    {
+        return console_unavailable(argv[0]);
+    }
+
+    fprintf(console_out, "measuring for %" PRIu32 " s\n", seconds);
+    if (console_ops->calibrate(seconds) != 0)
+    {
+        fprintf(console_out, "error: calibration failed\n");
+        return CONSOLE_ERR_FAILED;
+    }
+    return CONSOLE_OK;
+}
+
+static int console_cmd_cue(int argc, char **argv)
+{
+    static const char *const hint = "delay|mix|gain|feedback <value> <ms> | start|clear|status";
+    static const char *const params[] = {"delay", "mix", "gain", "feedback"};
+
+    if (argc == 2)
+    {
+        if (strcmp(argv[1], "start") == 0 && console_ops->cue_start)
+        {
+            console_ops->cue_start();
+            fprintf(console_out, "cue start marked\n");
+            return CONSOLE_OK;
+        }
+        if (strcmp(argv[1], "clear") == 0 && console_ops->cue_clear)
+        {
+            console_ops->cue_clear();
+            fprintf(console_out, "cues cleared\n");
+            return CONSOLE_OK;
+        }
+        if (strcmp(argv[1], "status") == 0 && console_ops->cue_report)
+        {
+            console_ops->cue_report();
+            return CONSOLE_OK;
+        }
+        if (strcmp(argv[1], "start") == 0 || strcmp(argv[1], "clear") == 0 || strcmp(argv[1], "status") == 0)
+        {
+            return console_unavailable(argv[0]);
+        }
+        return console_usage(argv[0], hint);
+    }
+
+    uint32_t value, at_ms;
+    if (argc != 4 || !console_parse_u32(argv[2], &value) || !console_parse_u32(argv[3], &at_ms))
+    {
+        return console_usage(argv[0], hint);
+    }
+    for (size_t i = 0; i < sizeof(params) / sizeof(params[0]); i++)
+    {
+        if (strcmp(argv[1], params[i]) != 0)
+        {
+            continue;
+        }
+        if (!console_ops->cue)
+        {
+            return console_unavailable(argv[0]);
+        }
+        if (console_ops->cue((console_cue_param_t)i, value, at_ms) != 0)
+        {
+            fprintf(console_out, "error: cue %s %" PRIu32 " at %" PRIu32 " ms rejected\n", argv[1], value, at_ms);
+            return CONSOLE_ERR_FAILED;
+        }
+        fprintf(console_out, "cue %s %" PRIu32 " at %" PRIu32 " ms\n", argv[1], value, at_ms);
+        return CONSOLE_OK;
+    }
+    return console_usage(argv[0], hint);
+}
+
+static int console_cmd_bench(int argc, char **argv)
+{
+    uint32_t block = 0;
+    if (argc > 3 || (argc == 3 && (!console_parse_u32(argv[2], &block) || block == 0 ||
+                                   block > CONSOLE_BENCH_MAX_BLOCK)))
+    {
+        return console_usage(argv[0], "[suite|all] [block samples, 1-4096]");
+    }
+    if (!console_ops->bench)
+    {
+        return console_unavailable(argv[0]);
+    }
+
+    const char *suite = argc > 1 ? argv[1] : "all";
+    if (console_ops->bench(suite, block) != 0)
+    {
+        fprintf(console_out, "error: bench %s failed\n", suite);
+        return CONSOLE_ERR_FAILED;
+    }
+    return CONSOLE_OK;
+}
+
+static int console_cmd_eq(int argc, char **argv)
+{
+    static const char *const hint = "[show|clear] | add <type> <hz> [q] [db]";
+    static const char *const types[] = {"lowpass", "highpass", "peaking", "lowshelf", "highshelf", "notch"};
+
+    if (argc == 1 || (argc == 2 && strcmp(argv[1], "show") == 0))
+    {
+        if (!console_ops->eq_report)
+        {
+            return console_unavailable(argv[0]);
+        }
+        console_ops->eq_report();
+        return CONSOLE_OK;
+    }
+    if (argc == 2 && strcmp(argv[1], "clear") == 0)
+    {
+        if (!console_ops->eq_clear)
+        {
+            return console_unavailable(argv[0]);
+        }
+        if (console_ops->eq_clear() != 0)
+        {
+            fprintf(console_out, "error: eq clear failed\n");
+            return CONSOLE_ERR_FAILED;
+        }
+        fprintf(console_out, "eq flat\n");
+        return CONSOLE_OK;
+    }
+
+    uint32_t freq_hz;
+    float q = CONSOLE_EQ_DEFAULT_Q;
+    float gain_db = 0.0f;
+    if (argc < 4 || argc > 6 || strcmp(argv[1], "add") != 0 || !console_parse_u32(argv[3], &freq_hz) ||
+        (argc > 4 && !console_parse_float(argv[4], &q)) || (argc > 5 && !console_parse_float(argv[5], &gain_db)))
+    {
+        return console_usage(argv[0], hint);
+    }
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        if (strcmp(argv[2], types[i]) != 0)
+        {
+            continue;
+        }
+        if (!console_ops->eq_add)
+        {
+            return console_unavailable(argv[0]);
+        }
+        if (console_ops->eq_add((console_eq_type_t)i, freq_hz, q, gain_db) != 0)
+        {
+            fprintf(console_out, "error: eq %s %" PRIu32 " Hz rejected\n", argv[2], freq_hz);
+            return CONSOLE_ERR_FAILED;
+        }
+        fprintf(console_out, "eq %s %" PRIu32 " Hz, Q %.2f, %.1f dB\n", argv[2], freq_hz, q, gain_db);
+        return CONSOLE_OK;
+    }
+    return console_usage(argv[0], hint);
+}
+
+static int console_cmd_gen(int argc, char **argv)
+{
+    static const char *const hint = "[off|sine|sweep|impulse|white|pink|mls] [hz] [level percent]";
+    static const char *const types[] = {"off", "sine", "sweep", "impulse", "white", "pink", "mls"};
+
+    if (argc == 1)
+    {
+        if (!console_ops->gen_report)
+        {
+            return console_unavailable(argv[0]);
+        }
+        console_ops->gen_report();
+        return CONSOLE_OK;
+    }
+
+    uint32_t freq_hz = 0;
+    uint32_t level = 0;
+    if (argc > 4 || (argc > 2 && !console_parse_u32(argv[2], &freq_hz)) ||
+        (argc > 3 && (!console_parse_u32(argv[3], &level) || level == 0 || level > 100)))
+    {
+        return console_usage(argv[0], hint);
+    }
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        if (strcmp(argv[1], types[i]) != 0)
+        {
+            continue;
+        }
+        if (!console_ops->gen_set)
+        {
+            return console_unavailable(argv[0]);
+        }
+        if (console_ops->gen_set((console_gen_type_t)i, freq_hz, level) != 0)
+        {
+            fprintf(console_out, "error: gen %s rejected\n", argv[1]);
+            return CONSOLE_ERR_FAILED;
+        }
+        fprintf(console_out, "gen %s\n", argv[1]);
+        return CONSOLE_OK;
+    }
+    return console_usage(argv[0], hint);
+}
+
+static const console_command_t console_table[] = {
+    {"delay", "[ms]", "Show or set the delay", console_cmd_delay},
+    {"rate", "[hz]", "Show or set the sample rate (44100, 48000, 96000, 192000)", console_cmd_rate},
+    {"mix", "[percent]", "Show or set the wet share", console_cmd_mix},
+    {"feedback", "[q15] [damping]", "Show or set the echo feedback and its damping, 0 for a plain delay",
+     console_cmd_feedback},
+    {"status", "", "Show delay, rate and mix", console_cmd_status},
+    {"metrics", "[reset]", "Print or clear the metrics registry", console_cmd_metrics},
+    {"trace", "[dump|clear|on|off]", "Dump the event trace for tools/trace_decode.py", console_cmd_trace},
+    {"tasks", "", "Print task CPU, stack and heap statistics", console_cmd_tasks},
+    {"preset", "save|load <slot>", "Store the current settings in a slot, or recall them", console_cmd_preset},
+    {"calibrate", "[seconds]", "Measure block cadence and processing cost on the running stream",
+     console_cmd_calibrate},
+    {"cue", "<param> <value> <ms>", "Schedule a sample-accurate delay, mix, gain or feedback change", console_cmd_cue},
+    {"bench", "[suite] [block]",
+     "Check DSP code against its references and time it (suites: kernels, biquad, fft, gen, convert, backends, delay)",
+     console_cmd_bench},
+    {"eq", "[show|clear|add ...]", "Show, flatten or extend the EQ on the delayed feed (up to 8 bands)",
+     console_cmd_eq},
+    {"gen", "[type] [hz] [level]", "Replace the input with a test signal, or show the current one", console_cmd_gen},
+};
+
+#define CONSOLE_COMMAND_COUNT (sizeof(console_table) / sizeof(console_table[0]))
+
+void console_commands_init(const console_ops_t *ops, FILE *out)
+{
+    console_ops = ops;
+    console_out = out ? out : stdout;
+}
+
+const console_command_t *console_commands_table(size_t *count)
+{
+    if (count)
+    {
+        *count = CONSOLE_COMMAND_COUNT;
+    }
+    return console_table;
+}
+
+static int console_help(void)
+{
+    for (size_t i = 0; i < CONSOLE_COMMAND_COUNT; i++)
+    {
+        fprintf(console_out, "%-9s %-20s %s\n", console_table[i].name, console_table[i].hint, console_table[i].help);
+    }
+    return CONSOLE_OK;
+}
+
+int console_commands_run_line(const char *line)
+{
+    if (!console_ops || !line)
+    {
+        return CONSOLE_ERR_FAILED;
+    }
+
+    // Split on blanks in a private copy; over-long lines are rejected rather than cut
+    char buffer[CONSOLE_LINE_MAX];
+    if (strlen(line) >= sizeof(buffer))
+    {
+        fprintf(console_out, "error: line longer than %d characters\n", CONSOLE_LINE_MAX - 1);
+        return CONSOLE_ERR_USAGE;
+    }
+    strcpy(buffer, line);
+
+    char *argv[CONSOLE_ARGS_MAX + 1];
+    int argc = 0;
+    for (char *token = strtok(buffer, " \t\r\n"); token; token = strtok(NULL, " \t\r\n"))
+    {
+        if (argc == CONSOLE_ARGS_MAX)
+        {
+            fprintf(console_out, "error: more than %d arguments\n", CONSOLE_ARGS_MAX - 1);
+            return CONSOLE_ERR_USAGE;
+        }
+        argv[argc++] = token;
+    }
+    argv[argc] = NULL;
+
+    // Blank lines and comments do nothing, so scripts can be piped in
+    if (argc == 0 || argv[0][0] == '#')
+    {
+        return CONSOLE_OK;
+    }
+    if (strcmp(argv[0], "help") == 0)
+    {
+        return console_help();
+    }
+
+    for (size_t i = 0; i < CONSOLE_COMMAND_COUNT; i++)
+    {
+        if (strcmp(argv[0], console_table[i].name) == 0)
+        {
+            return console_table[i].handler(argc, argv);
+        }
+    }
+
+    fprintf(console_out, "error: unknown command '%s', try help\n", argv[0]);
+    return CONSOLE_ERR_UNKNOWN;
+}
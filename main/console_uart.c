@@ -0,0 +1,61 @@
+#include "console_uart.h"
+#include "app_tasks.h"
+#include "esp_console.h"
+#include "esp_idf_version.h"
+#include "esp_log.h"
+
+static const char *TAG = "CONSOLE";
+
+esp_err_t console_uart_start(const console_ops_t *ops)
+{
+    if (!ops)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    console_commands_init(ops, stdout);
+
+    // The REPL task is esp_console's own, placed per the task table
+    const app_task_config_t *task = app_tasks_get_config(APP_TASK_CONSOLE);
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = CONSOLE_UART_PROMPT;
+    repl_config.max_cmdline_length = CONSOLE_LINE_MAX;
+    repl_config.task_stack_size = task->stack;
+    repl_config.task_priority = task->priority;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+    repl_config.task_core_id = task->core;
+#endif
+
+    esp_console_repl_t *repl = NULL;
+    esp_console_dev_uart_config_t uart_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    esp_err_t ret = esp_console_new_repl_uart(&uart_config, &repl_config, &repl);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to create console: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    esp_console_register_help_command();
+    size_t count;
+    const console_command_t *table = console_commands_table(&count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const esp_console_cmd_t cmd = {
+            .command = table[i].name,
+            .help = table[i].help,
+            .hint = table[i].hint,
+            .func = table[i].handler,
+        };
+        ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+    }
+
+    ret = esp_console_start_repl(repl);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to start console: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Console on UART0, %u commands, type help", (unsigned)count);
+    return ESP_OK;
+}
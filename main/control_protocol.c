@@ -0,0 +1,286 @@
+#include "control_protocol.h"
+#include <string.h>
+
+static const control_ops_t *control_ops = NULL;
+static control_parser_t control_parser;
+static control_stats_t control_stats;
+static uint32_t stream_interval_ms = 0; // 0 while no telemetry is requested
+static uint32_t stream_next_ms = 0;
+static bool stream_restart = false; // Send the first snapshot at the next poll
+static uint8_t telemetry_seq = 0;
+
+// CRC-16/CCITT-FALSE, bitwise: frames are short and a table would cost 512 bytes of RAM
+uint16_t control_crc16(uint16_t crc, const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t control_frame_encode(uint8_t type, uint8_t seq, const uint8_t *payload, size_t length, uint8_t *out,
+                            size_t out_size)
+{
+    if (!out || length > CONTROL_PAYLOAD_MAX || (length && !payload) ||
+        out_size < CONTROL_HEADER_SIZE + length + CONTROL_CRC_SIZE)
+    {
+        return 0;
+    }
+
+    out[0] = CONTROL_SOF;
+    out[1] = (uint8_t)length;
+    out[2] = type;
+    out[3] = seq;
+    if (length)
+    {
+        memcpy(&out[CONTROL_HEADER_SIZE], payload, length);
+    }
+
+    uint16_t crc = control_crc16(0xFFFF, &out[1], CONTROL_HEADER_SIZE - 1 + length);
+    control_put_u16(&out[CONTROL_HEADER_SIZE + length], crc);
+    return CONTROL_HEADER_SIZE + length + CONTROL_CRC_SIZE;
+}
+
+void control_parser_init(control_parser_t *parser)
+{
+    if (parser)
+    {
+        memset(parser, 0, sizeof(*parser));
+        parser->state = CONTROL_PARSE_SOF;
+    }
+}
+
+// One state per header byte. A bad CRC or an oversized length drops the frame
+// and resumes hunting for SOF with the next byte.
+const control_frame_t *control_parser_feed(control_parser_t *parser, uint8_t byte)
+{
+    switch (parser->state)
+    {
+    case CONTROL_PARSE_SOF:
+        if (byte == CONTROL_SOF)
+        {
+            parser->crc = 0xFFFF;
+            parser->state = CONTROL_PARSE_LENGTH;
+        }
+        else
+        {
+            parser->skipped++;
+        }
+        break;
+
+    case CONTROL_PARSE_LENGTH:
+        if (byte > CONTROL_PAYLOAD_MAX)
+        {
+            parser->skipped += 2;
+            parser->state = CONTROL_PARSE_SOF;
+            break;
+        }
+        parser->frame.length = byte;
+        parser->crc = control_crc16(parser->crc, &byte, 1);
+        parser->state = CONTROL_PARSE_TYPE;
+        break;
+
+    case CONTROL_PARSE_TYPE:
+        parser->frame.type = byte;
+        parser->crc = control_crc16(parser->crc, &byte, 1);
+        parser->state = CONTROL_PARSE_SEQ;
+        break;
+
+    case CONTROL_PARSE_SEQ:
+        parser->frame.seq = byte;
+        parser->crc = control_crc16(parser->crc, &byte, 1);
+        parser->received = 0;
+        parser->state = parser->frame.length ? CONTROL_PARSE_PAYLOAD : CONTROL_PARSE_CRC_LO;
+        break;
+
+    case CONTROL_PARSE_PAYLOAD:
+        parser->frame.payload[parser->received++] = byte;
+        parser->crc = control_crc16(parser->crc, &byte, 1);
+        if (parser->received == parser->frame.length)
+        {
+            parser->state = CONTROL_PARSE_CRC_LO;
+        }
+        break;
+
+    case CONTROL_PARSE_CRC_LO:
+        parser->crc_rx = byte;
+        parser->state = CONTROL_PARSE_CRC_HI;
+        break;
+
+    case CONTROL_PARSE_CRC_HI:
+        parser->crc_rx |= (uint16_t)byte << 8;
+        parser->state = CONTROL_PARSE_SOF;
+        if (parser->crc_rx != parser->crc)
+        {
+            parser->crc_errors++;
+            break;
+        }
+        parser->frames++;
+        return &parser->frame;
+    }
+    return NULL;
+}
+
+static void control_send(uint8_t type, uint8_t seq, const uint8_t *payload, size_t length)
+{
+    uint8_t out[CONTROL_FRAME_MAX];
+    size_t size = control_frame_encode(type, seq, payload, length, out, sizeof(out));
+    if (size && control_ops->write)
+    {
+        control_ops->write(out, size);
+    }
+}
+
+static void control_ack(const control_frame_t *request, control_status_t status, uint8_t param, uint32_t value)
+{
+    uint8_t payload[7] = {request->type, (uint8_t)status, param};
+    control_put_u32(&payload[3], value);
+    control_send(CONTROL_MSG_ACK, request->seq, payload, sizeof(payload));
+}
+
+// Every request gets exactly one reply carrying its sequence number
+static void control_handle(const control_frame_t *frame)
+{
+    uint8_t param = frame->length ? frame->payload[0] : 0;
+    uint32_t value = 0;
+
+    switch (frame->type)
+    {
+    case CONTROL_MSG_PING:
+        control_send(CONTROL_MSG_PONG, frame->seq, frame->payload, frame->length);
+        return;
+
+    case CONTROL_MSG_SET_PARAM:
+        if (frame->length != 5)
+        {
+            break;
+        }
+        if (param >= CONTROL_PARAM_COUNT || !control_ops->set_param || !control_ops->get_param)
+        {
+            control_ack(frame, CONTROL_STATUS_BAD_PARAM, param, 0);
+        }
+        else
+        {
+            // The reply carries the value now in effect, whether or not the write took
+            bool accepted = control_ops->set_param((control_param_t)param, control_get_u32(&frame->payload[1])) == 0;
+            control_ops->get_param((control_param_t)param, &value);
+            control_ack(frame, accepted ? CONTROL_STATUS_OK : CONTROL_STATUS_REJECTED, param, value);
+        }
+        return;
+
+    case CONTROL_MSG_GET_PARAM:
+        if (frame->length != 1)
+        {
+            break;
+        }
+        if (param >= CONTROL_PARAM_COUNT || !control_ops->get_param ||
+            control_ops->get_param((control_param_t)param, &value) != 0)
+        {
+            control_ack(frame, CONTROL_STATUS_BAD_PARAM, param, 0);
+            return;
+        }
+        control_ack(frame, CONTROL_STATUS_OK, param, value);
+        return;
+
+    case CONTROL_MSG_STREAM:
+        if (frame->length != 2)
+        {
+            break;
+        }
+        value = control_get_u16(frame->payload);
+        if ((value != 0 && (value < CONTROL_STREAM_MIN_MS || value > CONTROL_STREAM_MAX_MS)) || !control_ops->telemetry)
+        {
+            control_ack(frame, CONTROL_STATUS_REJECTED, 0, stream_interval_ms);
+            return;
+        }
+        stream_interval_ms = value;
+        stream_restart = true;
+        telemetry_seq = 0;
+        control_ack(frame, CONTROL_STATUS_OK, 0, stream_interval_ms);
+        return;
+
+    default:
+        break;
+    }
+
+    control_stats.bad_frames++;
+    control_ack(frame, CONTROL_STATUS_BAD_FRAME, param, 0);
+}
+
+void control_protocol_init(const control_ops_t *ops)
+{
+    control_ops = ops;
+    control_parser_init(&control_parser);
+    memset(&control_stats, 0, sizeof(control_stats));
+    stream_interval_ms = 0;
+}
+
+void control_protocol_receive(const uint8_t *data, size_t length)
+{
+    if (!control_ops || !data)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < length; i++)
+    {
+        const control_frame_t *frame = control_parser_feed(&control_parser, data[i]);
+        if (frame)
+        {
+            control_handle(frame);
+        }
+    }
+}
+
+// Sends a snapshot when one is due. Returns how long the caller may wait
+// before polling again, UINT32_MAX while streaming is off.
+uint32_t control_protocol_poll(uint32_t now_ms)
+{
+    if (!control_ops || stream_interval_ms == 0)
+    {
+        return UINT32_MAX;
+    }
+
+    if (stream_restart || (int32_t)(now_ms - stream_next_ms) >= 0)
+    {
+        uint8_t payload[CONTROL_PAYLOAD_MAX];
+        uint32_t values[CONTROL_TELEMETRY_MAX_VALUES];
+        size_t count = control_ops->telemetry(values, CONTROL_TELEMETRY_MAX_VALUES);
+        count = count > CONTROL_TELEMETRY_MAX_VALUES ? CONTROL_TELEMETRY_MAX_VALUES : count;
+
+        control_put_u32(payload, now_ms);
+        payload[4] = (uint8_t)count;
+        for (size_t i = 0; i < count; i++)
+        {
+            control_put_u32(&payload[5 + 4 * i], values[i]);
+        }
+        control_send(CONTROL_MSG_TELEMETRY, telemetry_seq++, payload, 5 + 4 * count);
+        control_stats.telemetry_sent++;
+
+        // Fixed cadence; after a stall skip the missed slots instead of bursting
+        stream_next_ms = (stream_restart ? now_ms : stream_next_ms) + stream_interval_ms;
+        if ((int32_t)(now_ms - stream_next_ms) >= 0)
+        {
+            stream_next_ms = now_ms + stream_interval_ms;
+        }
+        stream_restart = false;
+    }
+    return stream_next_ms - now_ms;
+}
+
+void control_protocol_get_stats(control_stats_t *stats)
+{
+    if (!stats)
+    {
+        return;
+    }
+    *stats = control_stats;
+    stats->frames = control_parser.frames;
+    stats->crc_errors = control_parser.crc_errors;
+    stats->skipped = control_parser.skipped;
+}
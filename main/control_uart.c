@@ -0,0 +1,104 @@
+#include "control_uart.h"
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "app_tasks.h"
+
+static const char *TAG = "CONTROL";
+
+static const control_ops_t *control_uart_ops = NULL;
+
+static void control_uart_write(const uint8_t *data, size_t length)
+{
+    uart_write_bytes(CONTROL_UART_PORT, data, length);
+}
+
+static void control_uart_task(void *arg)
+{
+    uint8_t buffer[128];
+    uint32_t wait_ms = CONTROL_UART_IDLE_MS;
+
+    while (1)
+    {
+        // Block for the first byte only, then take whatever else is already buffered
+        int got = uart_read_bytes(CONTROL_UART_PORT, buffer, 1, pdMS_TO_TICKS(wait_ms));
+        if (got > 0)
+        {
+            size_t buffered = 0;
+            uart_get_buffered_data_len(CONTROL_UART_PORT, &buffered);
+            buffered = buffered > sizeof(buffer) - 1 ? sizeof(buffer) - 1 : buffered;
+            if (buffered)
+            {
+                got += uart_read_bytes(CONTROL_UART_PORT, buffer + 1, buffered, 0);
+            }
+            control_protocol_receive(buffer, (size_t)got);
+        }
+
+        wait_ms = control_protocol_poll((uint32_t)(esp_timer_get_time() / 1000));
+        wait_ms = wait_ms > CONTROL_UART_IDLE_MS ? CONTROL_UART_IDLE_MS : wait_ms;
+        wait_ms = wait_ms ? wait_ms : 1;
+    }
+}
+
+esp_err_t control_uart_start(const control_ops_t *ops)
+{
+    if (!ops || !ops->get_param || !ops->set_param)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const uart_config_t uart_config = {
+        .baud_rate = CONTROL_UART_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+
+    esp_err_t ret = uart_driver_install(CONTROL_UART_PORT, CONTROL_UART_RX_BUFFER, CONTROL_UART_TX_BUFFER, 0, NULL, 0);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to install UART driver: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_ERROR_CHECK(uart_param_config(CONTROL_UART_PORT, &uart_config));
+    ESP_ERROR_CHECK(uart_set_pin(CONTROL_UART_PORT, CONTROL_UART_TX_PIN, CONTROL_UART_RX_PIN, UART_PIN_NO_CHANGE,
+                                 UART_PIN_NO_CHANGE));
+    ESP_ERROR_CHECK(uart_set_rx_timeout(CONTROL_UART_PORT, CONTROL_UART_RX_TIMEOUT_SYMBOLS));
+
+    // Writes go straight to the driver's TX buffer from the control task
+    static control_ops_t uart_ops;
+    uart_ops = *ops;
+    uart_ops.write = control_uart_write;
+    control_uart_ops = &uart_ops;
+    control_protocol_init(control_uart_ops);
+
+    ret = app_tasks_create(APP_TASK_CONTROL, control_uart_task, NULL, NULL);
+    if (ret != ESP_OK)
+    {
+        uart_driver_delete(CONTROL_UART_PORT);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Control protocol on UART1 (TX GPIO%d, RX GPIO%d) at %d baud", CONTROL_UART_TX_PIN,
+             CONTROL_UART_RX_PIN, CONTROL_UART_BAUD);
+    return ESP_OK;
+}
+
+void control_uart_log_report(void)
+{
+    if (!control_uart_ops)
+    {
+        return;
+    }
+
+    control_stats_t stats;
+    control_protocol_get_stats(&stats);
+    ESP_LOGI(TAG, "Frames %" PRIu32 ", CRC errors %" PRIu32 ", skipped bytes %" PRIu32 ", bad frames %" PRIu32
+                  ", telemetry sent %" PRIu32,
+             stats.frames, stats.crc_errors, stats.skipped, stats.bad_frames, stats.telemetry_sent);
+}
@@ -0,0 +1,112 @@
+#include "dsp_backend.h"
+
+#define Q15_SCALE (1.0f / DSP_Q15_ONE)
+
+static inline int32_t clamp_alpha(int32_t alpha_q15)
+{
+    return alpha_q15 > DSP_Q15_ONE ? DSP_Q15_ONE : (alpha_q15 < 0 ? 0 : alpha_q15);
+}
+
+// ---------------------------------------------------------------------------
+// Fixed point
+
+void dsp_fixed_onepole(dsp_fixed_onepole_state_t *state, const int16_t *in, int16_t *out, size_t samples,
+                       int32_t alpha_q15)
+{
+    int32_t alpha = clamp_alpha(alpha_q15);
+    int32_t y = state->y;
+
+    // Same update as the echo damping filter; y stays inside the input range
+    for (size_t i = 0; i < samples; i++)
+    {
+        y += ((in[i] - y) * alpha) >> 15;
+        out[i] = (int16_t)y;
+    }
+    state->y = y;
+}
+
+// ---------------------------------------------------------------------------
+// Single-precision float. The ESP32 FPU has a fused multiply-add but a few
+// cycles of latency, so the stateless loops are unrolled by four to keep it
+// busy; the integer conversions at either end are single instructions.
+
+void dsp_float_gain(const int16_t *in, int16_t *out, size_t samples, int32_t gain_q15)
+{
+    gain_q15 = gain_q15 > DSP_GAIN_Q15_MAX ? DSP_GAIN_Q15_MAX
+                                           : (gain_q15 < DSP_GAIN_Q15_MIN ? DSP_GAIN_Q15_MIN : gain_q15);
+    const float gain = gain_q15 * Q15_SCALE;
+    size_t i = 0;
+
+    for (; i + 4 <= samples; i += 4)
+    {
+        float y0 = in[i] * gain;
+        float y1 = in[i + 1] * gain;
+        float y2 = in[i + 2] * gain;
+        float y3 = in[i + 3] * gain;
+        out[i] = dsp_float_to_s16(y0);
+        out[i + 1] = dsp_float_to_s16(y1);
+        out[i + 2] = dsp_float_to_s16(y2);
+        out[i + 3] = dsp_float_to_s16(y3);
+    }
+    for (; i < samples; i++)
+    {
+        out[i] = dsp_float_to_s16(in[i] * gain);
+    }
+}
+
+void dsp_float_mix(const int16_t *a, const int16_t *b, int16_t *out, size_t samples,
+                   int16_t gain_a_q15, int16_t gain_b_q15)
+{
+    // INT16_MIN is clamped like the fixed kernel, so both backends accept the same range
+    const float ga = (gain_a_q15 == INT16_MIN ? -INT16_MAX : gain_a_q15) * Q15_SCALE;
+    const float gb = (gain_b_q15 == INT16_MIN ? -INT16_MAX : gain_b_q15) * Q15_SCALE;
+    size_t i = 0;
+
+    for (; i + 4 <= samples; i += 4)
+    {
+        float y0 = a[i] * ga + b[i] * gb;
+        float y1 = a[i + 1] * ga + b[i + 1] * gb;
+        float y2 = a[i + 2] * ga + b[i + 2] * gb;
+        float y3 = a[i + 3] * ga + b[i + 3] * gb;
+        out[i] = dsp_float_to_s16(y0);
+        out[i + 1] = dsp_float_to_s16(y1);
+        out[i + 2] = dsp_float_to_s16(y2);
+        out[i + 3] = dsp_float_to_s16(y3);
+    }
+    for (; i < samples; i++)
+    {
+        out[i] = dsp_float_to_s16(a[i] * ga + b[i] * gb);
+    }
+}
+
+void dsp_float_crossfade(const int16_t *a, const int16_t *b, int16_t *out, size_t samples,
+                         int32_t start_q15, int32_t end_q15)
+{
+    start_q15 = clamp_alpha(start_q15);
+    end_q15 = clamp_alpha(end_q15);
+    float x = start_q15 * Q15_SCALE;
+    const float step = samples ? (end_q15 - start_q15) * Q15_SCALE / samples : 0.0f;
+
+    // a + (b - a) * x, the position accumulates like the fixed kernel's
+    for (size_t i = 0; i < samples; i++)
+    {
+        float a0 = a[i];
+        out[i] = dsp_float_to_s16(a0 + (b[i] - a0) * x);
+        x += step;
+    }
+}
+
+void dsp_float_onepole(dsp_float_onepole_state_t *state, const int16_t *in, int16_t *out, size_t samples,
+                       int32_t alpha_q15)
+{
+    const float alpha = clamp_alpha(alpha_q15) * Q15_SCALE;
+    float y = state->y;
+
+    for (size_t i = 0; i < samples; i++)
+    {
+        y += (in[i] - y) * alpha;
+        out[i] = dsp_float_to_s16(y);
+    }
+    // A decaying tail would end in denormals, which the FPU handles slowly
+    state->y = (y > -DSP_FLOAT_TINY && y < DSP_FLOAT_TINY) ? 0.0f : y;
+}
@@ -0,0 +1,1920 @@
+#include "dsp_bench.h"
+#include "dsp_kernels.h"
+#include "dsp_biquad.h"
+#include "dsp_fft.h"
+#include "dsp_convert.h"
+#include "dsp_backend.h"
+#include "audio_delay.h"
+#include "signal_generator.h"
+#include "spectrum_analyzer.h"
+#include "oled_display.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_private/esp_clk.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "DSP_BENCH";
+
+// Deterministic test signal so failures are reproducible
+static uint32_t bench_rng_state = 0x12345678;
+
+static uint32_t bench_rand(void)
+{
+    uint32_t x = bench_rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    bench_rng_state = x;
+    return x;
+}
+
+static void bench_fill_s16(int16_t *buf, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        buf[i] = (int16_t)bench_rand();
+    }
+    // Full-scale edges exercise the saturation paths
+    if (samples >= 2)
+    {
+        buf[0] = INT16_MIN;
+        buf[1] = INT16_MAX;
+    }
+}
+
+static void bench_fill_s32(int32_t *buf, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        buf[i] = (int32_t)bench_rand();
+    }
+    if (samples >= 2)
+    {
+        buf[0] = INT32_MIN;
+        buf[1] = INT32_MAX;
+    }
+}
+
+static void bench_log(const char *name, uint32_t cycles, size_t samples)
+{
+    ESP_LOGI(TAG, "%-16s %6u samples: %7lu cycles, %.2f cycles/sample, %.3f samples/cycle",
+             name, (unsigned)samples, (unsigned long)cycles,
+             (double)cycles / samples, (double)samples / cycles);
+}
+
+// Best-of timing for one kernel invocation
+#define BENCH_MEASURE(result, call)                                  \
+    do                                                               \
+    {                                                                \
+        (result) = UINT32_MAX;                                       \
+        for (int iter_ = 0; iter_ < DSP_BENCH_ITERATIONS; iter_++)   \
+        {                                                            \
+            uint32_t start_ = esp_cpu_get_cycle_count();             \
+            call;                                                    \
+            uint32_t cycles_ = esp_cpu_get_cycle_count() - start_;   \
+            if (cycles_ < (result))                                  \
+            {                                                        \
+                (result) = cycles_;                                  \
+            }                                                        \
+        }                                                            \
+    } while (0)
+
+esp_err_t dsp_bench_verify_kernels(void)
+{
+    // Odd length so the unrolled loops also run their tails
+    const size_t samples = 1021;
+    const int rounds = 64;
+    esp_err_t result = ESP_OK;
+
+    int16_t *a = malloc(samples * sizeof(int16_t));
+    int16_t *b = malloc(samples * sizeof(int16_t));
+    int16_t *out = malloc(samples * sizeof(int16_t));
+    int16_t *ref = malloc(samples * sizeof(int16_t));
+    int32_t *a32 = malloc(samples * sizeof(int32_t));
+    int32_t *b32 = malloc(samples * sizeof(int32_t));
+    int32_t *out32 = malloc(samples * sizeof(int32_t));
+    int32_t *ref32 = malloc(samples * sizeof(int32_t));
+
+    if (!a || !b || !out || !ref || !a32 || !b32 || !out32 || !ref32)
+    {
+        result = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    bench_rng_state = 0x12345678;
+
+    for (int round = 0; round < rounds && result == ESP_OK; round++)
+    {
+        bench_fill_s16(a, samples);
+        bench_fill_s16(b, samples);
+        bench_fill_s32(a32, samples);
+        bench_fill_s32(b32, samples);
+
+        int32_t gain = (int32_t)(bench_rand() % (2 * DSP_GAIN_Q15_MAX + 1)) - DSP_GAIN_Q15_MAX;
+        int16_t gain_a = (int16_t)bench_rand();
+        int16_t gain_b = (int16_t)bench_rand();
+        int32_t fade_start = (int32_t)(bench_rand() % (DSP_Q15_ONE + 1));
+        int32_t fade_end = (int32_t)(bench_rand() % (DSP_Q15_ONE + 1));
+
+        dsp_gain_q15_s16(a, out, samples, gain);
+        dsp_gain_q15_s16_ref(a, ref, samples, gain);
+        if (memcmp(out, ref, samples * sizeof(int16_t)) != 0)
+        {
+            ESP_LOGE(TAG, "gain_q15_s16 mismatch (round %d, gain %ld)", round, (long)gain);
+            result = ESP_FAIL;
+        }
+
+        dsp_gain_q15_s32(a32, out32, samples, gain);
+        dsp_gain_q15_s32_ref(a32, ref32, samples, gain);
+        if (memcmp(out32, ref32, samples * sizeof(int32_t)) != 0)
+        {
+            ESP_LOGE(TAG, "gain_q15_s32 mismatch (round %d, gain %ld)", round, (long)gain);
+            result = ESP_FAIL;
+        }
+
+        dsp_mix_s16(a, b, out, samples, gain_a, gain_b);
+        dsp_mix_s16_ref(a, b, ref, samples, gain_a, gain_b);
+        if (memcmp(out, ref, samples * sizeof(int16_t)) != 0)
+        {
+            ESP_LOGE(TAG, "mix_s16 mismatch (round %d)", round);
+            result = ESP_FAIL;
+        }
+
+        dsp_mix_s32(a32, b32, out32, samples, gain_a, gain_b);
+        dsp_mix_s32_ref(a32, b32, ref32, samples, gain_a, gain_b);
+        if (memcmp(out32, ref32, samples * sizeof(int32_t)) != 0)
+        {
+            ESP_LOGE(TAG, "mix_s32 mismatch (round %d)", round);
+            result = ESP_FAIL;
+        }
+
+        dsp_crossfade_s16(a, b, out, samples, fade_start, fade_end);
+        dsp_crossfade_s16_ref(a, b, ref, samples, fade_start, fade_end);
+        if (memcmp(out, ref, samples * sizeof(int16_t)) != 0)
+        {
+            ESP_LOGE(TAG, "crossfade_s16 mismatch (round %d)", round);
+            result = ESP_FAIL;
+        }
+
+        dsp_crossfade_s32(a32, b32, out32, samples, fade_start, fade_end);
+        dsp_crossfade_s32_ref(a32, b32, ref32, samples, fade_start, fade_end);
+        if (memcmp(out32, ref32, samples * sizeof(int32_t)) != 0)
+        {
+            ESP_LOGE(TAG, "crossfade_s32 mismatch (round %d)", round);
+            result = ESP_FAIL;
+        }
+
+        uint64_t sum_sq = 0;
+        uint64_t sum_sq_ref = 0;
+        a[round % samples] = INT16_MIN; // Full-scale negative is the corner case for both outputs
+        if (dsp_level_s16(a, samples, &sum_sq) != dsp_level_s16_ref(a, samples, &sum_sq_ref) ||
+            sum_sq != sum_sq_ref)
+        {
+            ESP_LOGE(TAG, "level_s16 mismatch (round %d)", round);
+            result = ESP_FAIL;
+        }
+    }
+
+    if (result == ESP_OK)
+    {
+        ESP_LOGI(TAG, "Kernels bit-exact against reference (%d rounds)", rounds);
+    }
+
+cleanup:
+    free(a);
+    free(b);
+    free(out);
+    free(ref);
+    free(a32);
+    free(b32);
+    free(out32);
+    free(ref32);
+    return result;
+}
+
+esp_err_t dsp_bench_run_kernels(size_t samples)
+{
+    if (samples == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int16_t *a = malloc(samples * sizeof(int16_t));
+    int16_t *b = malloc(samples * sizeof(int16_t));
+    int16_t *out = malloc(samples * sizeof(int16_t));
+    int32_t *a32 = malloc(samples * sizeof(int32_t));
+    int32_t *b32 = malloc(samples * sizeof(int32_t));
+    int32_t *out32 = malloc(samples * sizeof(int32_t));
+    esp_err_t result = ESP_OK;
+
+    if (!a || !b || !out || !a32 || !b32 || !out32)
+    {
+        result = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    bench_fill_s16(a, samples);
+    bench_fill_s16(b, samples);
+    bench_fill_s32(a32, samples);
+    bench_fill_s32(b32, samples);
+
+    uint32_t cycles;
+
+    BENCH_MEASURE(cycles, dsp_gain_q15_s16_ref(a, out, samples, 23170));
+    bench_log("gain_s16 ref", cycles, samples);
+    BENCH_MEASURE(cycles, dsp_gain_q15_s16(a, out, samples, 23170));
+    bench_log("gain_s16", cycles, samples);
+
+    BENCH_MEASURE(cycles, dsp_mix_s16_ref(a, b, out, samples, 16384, 16384));
+    bench_log("mix_s16 ref", cycles, samples);
+    BENCH_MEASURE(cycles, dsp_mix_s16(a, b, out, samples, 16384, 16384));
+    bench_log("mix_s16", cycles, samples);
+
+    BENCH_MEASURE(cycles, dsp_crossfade_s16_ref(a, b, out, samples, 0, DSP_Q15_ONE));
+    bench_log("xfade_s16 ref", cycles, samples);
+    BENCH_MEASURE(cycles, dsp_crossfade_s16(a, b, out, samples, 0, DSP_Q15_ONE));
+    bench_log("xfade_s16", cycles, samples);
+
+    uint64_t sum_sq = 0;
+    BENCH_MEASURE(cycles, dsp_level_s16_ref(a, samples, &sum_sq));
+    bench_log("level_s16 ref", cycles, samples);
+    BENCH_MEASURE(cycles, dsp_level_s16(a, samples, &sum_sq));
+    bench_log("level_s16", cycles, samples);
+
+    BENCH_MEASURE(cycles, dsp_gain_q15_s32_ref(a32, out32, samples, 23170));
+    bench_log("gain_s32 ref", cycles, samples);
+    BENCH_MEASURE(cycles, dsp_gain_q15_s32(a32, out32, samples, 23170));
+    bench_log("gain_s32", cycles, samples);
+
+    BENCH_MEASURE(cycles, dsp_mix_s32_ref(a32, b32, out32, samples, 16384, 16384));
+    bench_log("mix_s32 ref", cycles, samples);
+    BENCH_MEASURE(cycles, dsp_mix_s32(a32, b32, out32, samples, 16384, 16384));
+    bench_log("mix_s32", cycles, samples);
+
+    BENCH_MEASURE(cycles, dsp_crossfade_s32_ref(a32, b32, out32, samples, 0, DSP_Q15_ONE));
+    bench_log("xfade_s32 ref", cycles, samples);
+    BENCH_MEASURE(cycles, dsp_crossfade_s32(a32, b32, out32, samples, 0, DSP_Q15_ONE));
+    bench_log("xfade_s32", cycles, samples);
+
+cleanup:
+    free(a);
+    free(b);
+    free(out);
+    free(a32);
+    free(b32);
+    free(out32);
+    return result;
+}
+
+// A typical corrective set: rumble filter, mains notch and a few tone bands
+static const dsp_biquad_band_t bench_eq_bands[] = {
+    {DSP_BIQUAD_HIGHPASS, 40.0f, 0.707f, 0.0f},
+    {DSP_BIQUAD_NOTCH, 50.0f, 10.0f, 0.0f},
+    {DSP_BIQUAD_LOWSHELF, 120.0f, 0.707f, 3.0f},
+    {DSP_BIQUAD_PEAKING, 1000.0f, 1.4f, 6.0f},
+    {DSP_BIQUAD_PEAKING, 3150.0f, 2.0f, -6.0f},
+    {DSP_BIQUAD_HIGHSHELF, 8000.0f, 0.707f, -4.0f},
+    {DSP_BIQUAD_LOWPASS, 16000.0f, 0.707f, 0.0f},
+    {DSP_BIQUAD_PEAKING, 250.0f, 0.7f, -3.0f},
+};
+
+#define BENCH_EQ_BAND_COUNT (sizeof(bench_eq_bands) / sizeof(bench_eq_bands[0]))
+
+static const uint32_t bench_eq_rates[] = {44100, 48000, 96000, 192000};
+
+// Sweep plus noise at about -8 dBFS, leaves headroom for the boosting bands
+static void bench_fill_program(int16_t *buf, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        float phase = 0.001f * i * (1.0f + i * 1e-4f);
+        buf[i] = (int16_t)(8000.0f * sinf(phase) + (int32_t)(bench_rand() % 4001) - 2000);
+    }
+}
+
+// Worst deviation of one fixed-point section from a double-precision run of the same coefficients
+static double bench_biquad_error(const dsp_biquad_coefs_t *coefs, const int16_t *in, int16_t *out, size_t samples)
+{
+    const double scale = 1.0 / DSP_BIQUAD_COEF_ONE;
+    double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    double worst = 0;
+    dsp_biquad_state_t state = {0};
+
+    dsp_biquad_section_s16(coefs, &state, in, out, samples);
+
+    for (size_t i = 0; i < samples; i++)
+    {
+        double x0 = in[i];
+        double y0 = (coefs->b0 * x0 + coefs->b1 * x1 + coefs->b2 * x2 - coefs->a1 * y1 - coefs->a2 * y2) * scale;
+        double err = fabs(y0 - out[i]);
+        if (err > worst)
+        {
+            worst = err;
+        }
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+    }
+
+    return worst;
+}
+
+esp_err_t dsp_bench_verify_biquad(void)
+{
+    const size_t samples = 8191; // Odd so the unrolled loop also runs its tail
+    esp_err_t result = ESP_OK;
+
+    int16_t *in = malloc(samples * sizeof(int16_t));
+    int16_t *out = malloc(samples * sizeof(int16_t));
+    int16_t *ref = malloc(samples * sizeof(int16_t));
+
+    if (!in || !out || !ref)
+    {
+        result = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    bench_rng_state = 0x12345678;
+
+    // Optimised kernel against the plain loop, including unstable and clipping coefficient sets
+    for (int round = 0; round < 64 && result == ESP_OK; round++)
+    {
+        dsp_biquad_coefs_t coefs = {
+            (int32_t)bench_rand(), (int32_t)bench_rand(), (int32_t)bench_rand(),
+            (int32_t)bench_rand(), (int32_t)bench_rand()};
+        dsp_biquad_state_t state = {0};
+        dsp_biquad_state_t state_ref = {0};
+        size_t length = 1 + bench_rand() % samples;
+
+        bench_fill_s16(in, length);
+        dsp_biquad_section_s16(&coefs, &state, in, out, length);
+        dsp_biquad_section_s16_ref(&coefs, &state_ref, in, ref, length);
+        if (memcmp(out, ref, length * sizeof(int16_t)) != 0 || memcmp(&state, &state_ref, sizeof(state)) != 0)
+        {
+            ESP_LOGE(TAG, "biquad section mismatch (round %d, %u samples)", round, (unsigned)length);
+            result = ESP_FAIL;
+        }
+    }
+
+    // Every band of the bench EQ at every supported rate against double precision
+    bench_fill_program(in, samples);
+    for (size_t r = 0; r < sizeof(bench_eq_rates) / sizeof(bench_eq_rates[0]); r++)
+    {
+        for (size_t b = 0; b < BENCH_EQ_BAND_COUNT; b++)
+        {
+            dsp_biquad_coefs_t coefs;
+            if (dsp_biquad_design(&bench_eq_bands[b], bench_eq_rates[r], &coefs) != ESP_OK)
+            {
+                result = ESP_FAIL;
+                continue;
+            }
+
+            double err = bench_biquad_error(&coefs, in, out, samples);
+            if (err > DSP_BENCH_BIQUAD_MAX_ERR_LSB)
+            {
+                ESP_LOGE(TAG, "biquad band %u at %lu Hz: %.2f LSB from double reference",
+                         (unsigned)b, (unsigned long)bench_eq_rates[r], err);
+                result = ESP_FAIL;
+            }
+            else
+            {
+                ESP_LOGD(TAG, "biquad band %u at %lu Hz: %.2f LSB", (unsigned)b, (unsigned long)bench_eq_rates[r], err);
+            }
+        }
+    }
+
+    if (result == ESP_OK)
+    {
+        ESP_LOGI(TAG, "Biquad bit-exact against reference, within %.1f LSB of double precision",
+                 DSP_BENCH_BIQUAD_MAX_ERR_LSB);
+    }
+
+cleanup:
+    free(in);
+    free(out);
+    free(ref);
+    return result;
+}
+
+esp_err_t dsp_bench_run_biquad(size_t samples)
+{
+    if (samples == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const uint32_t rate = 192000;
+    int16_t *in = malloc(samples * sizeof(int16_t));
+    int16_t *out = malloc(samples * sizeof(int16_t));
+    dsp_biquad_t *eq = malloc(sizeof(dsp_biquad_t));
+    esp_err_t result = ESP_OK;
+
+    if (!in || !out || !eq)
+    {
+        result = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    bench_fill_program(in, samples);
+
+    dsp_biquad_coefs_t coefs;
+    dsp_biquad_state_t state = {0};
+    result = dsp_biquad_design(&bench_eq_bands[3], rate, &coefs);
+    if (result != ESP_OK)
+    {
+        goto cleanup;
+    }
+
+    uint32_t cycles;
+    BENCH_MEASURE(cycles, dsp_biquad_section_s16_ref(&coefs, &state, in, out, samples));
+    bench_log("biquad ref", cycles, samples);
+    BENCH_MEASURE(cycles, dsp_biquad_section_s16(&coefs, &state, in, out, samples));
+    bench_log("biquad", cycles, samples);
+
+    // Full cascade as the chain stage runs it, in place
+    dsp_biquad_init(eq, rate);
+    result = dsp_biquad_set_bands(eq, bench_eq_bands, BENCH_EQ_BAND_COUNT);
+    if (result != ESP_OK)
+    {
+        goto cleanup;
+    }
+    dsp_biquad_process_block(eq, in, out, samples); // Picks up the coefficient bank
+    BENCH_MEASURE(cycles, dsp_biquad_process_block(eq, out, out, samples));
+    bench_log("biquad x8", cycles, samples);
+
+    // Share of the per-sample budget at 192 kHz
+    uint32_t budget = esp_clk_cpu_freq() / rate;
+    double per_section = (double)cycles / samples / BENCH_EQ_BAND_COUNT;
+    ESP_LOGI(TAG, "biquad at %lu Hz: %.2f cycles/sample/section, %lu cycles/sample budget, "
+             "%u sections use %.1f%%",
+             (unsigned long)rate, per_section, (unsigned long)budget, (unsigned)BENCH_EQ_BAND_COUNT,
+             100.0 * cycles / samples / budget);
+
+cleanup:
+    free(in);
+    free(out);
+    free(eq);
+    return result;
+}
+
+// Worst deviation of the fixed-point FFT from a double-precision DFT, in dB below a full-scale bin
+static double bench_fft_error_db(const dsp_fft_real_t *fft, const int16_t *in, int32_t *buf, const double *cos_table)
+{
+    const uint32_t n = fft->size;
+    double worst = 0;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        buf[i] = in[i];
+    }
+    dsp_fft_real_s32(fft, buf);
+
+    for (uint32_t k = 0; k <= n / 2; k++)
+    {
+        double re = 0, im = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            uint32_t phase = (uint32_t)(((uint64_t)k * i) % n);
+            re += in[i] * cos_table[phase];
+            im -= in[i] * cos_table[(phase + n - n / 4) % n]; // sin(x) = cos(x - pi/2)
+        }
+
+        double got_re = k == 0 ? buf[0] : (k == n / 2 ? buf[1] : buf[2 * k]);
+        double got_im = (k == 0 || k == n / 2) ? 0 : buf[2 * k + 1];
+        double err = hypot(got_re - 2 * re, got_im - 2 * im);
+        if (err > worst)
+        {
+            worst = err;
+        }
+    }
+
+    // A full-scale input can put 32768 * N into one bin of the 2X output
+    return worst > 0 ? 20.0 * log10(worst / (32768.0 * n)) : -200.0;
+}
+
+esp_err_t dsp_bench_verify_fft(void)
+{
+    const uint32_t max_size = 1u << DSP_FFT_MAX_BITS;
+    const int rounds = 4; // The reference DFT is O(N^2) in soft double, keep it short
+    esp_err_t result = ESP_OK;
+
+    int16_t *in = malloc(max_size * sizeof(int16_t));
+    int32_t *buf = malloc(max_size * sizeof(int32_t));
+    double *cos_table = malloc(max_size * sizeof(double));
+
+    if (!in || !buf || !cos_table)
+    {
+        result = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    bench_rng_state = 0x12345678;
+
+    for (uint32_t bits = DSP_FFT_MIN_BITS; bits <= DSP_FFT_MAX_BITS; bits++)
+    {
+        uint32_t n = 1u << bits;
+        dsp_fft_real_t fft;
+        if (dsp_fft_real_init(&fft, n) != ESP_OK)
+        {
+            result = ESP_ERR_NO_MEM;
+            goto cleanup;
+        }
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            cos_table[i] = cos(2.0 * M_PI * i / n);
+        }
+
+        double worst = -200.0;
+        for (int round = 0; round < rounds; round++)
+        {
+            // Random full scale, the DC and Nyquist extremes, then program material
+            if (round == 0)
+            {
+                bench_fill_s16(in, n);
+            }
+            else if (round < 3)
+            {
+                for (uint32_t i = 0; i < n; i++)
+                {
+                    in[i] = (round == 1 || (i & 1) == 0) ? INT16_MIN : INT16_MAX;
+                }
+            }
+            else
+            {
+                bench_fill_program(in, n);
+            }
+
+            double err = bench_fft_error_db(&fft, in, buf, cos_table);
+            if (err > worst)
+            {
+                worst = err;
+            }
+        }
+        dsp_fft_real_deinit(&fft);
+
+        if (worst > DSP_BENCH_FFT_MAX_ERR_DB)
+        {
+            ESP_LOGE(TAG, "fft %lu points: %.1f dB error against double DFT", (unsigned long)n, worst);
+            result = ESP_FAIL;
+        }
+        else
+        {
+            ESP_LOGD(TAG, "fft %lu points: %.1f dB", (unsigned long)n, worst);
+        }
+    }
+
+    if (result == ESP_OK)
+    {
+        ESP_LOGI(TAG, "FFT within %.0f dB of double precision", DSP_BENCH_FFT_MAX_ERR_DB);
+    }
+
+cleanup:
+    free(in);
+    free(buf);
+    free(cos_table);
+    return result;
+}
+
+esp_err_t dsp_bench_run_fft(void)
+{
+    const uint32_t max_size = 1u << DSP_FFT_MAX_BITS;
+    int16_t *in = malloc(max_size * sizeof(int16_t));
+    int32_t *src = malloc(max_size * sizeof(int32_t));
+    int32_t *buf = malloc(max_size * sizeof(int32_t));
+    esp_err_t result = ESP_OK;
+
+    if (!in || !src || !buf)
+    {
+        result = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    bench_fill_program(in, max_size);
+    for (uint32_t i = 0; i < max_size; i++)
+    {
+        src[i] = in[i];
+    }
+
+    uint32_t cpu_hz = esp_clk_cpu_freq();
+    for (uint32_t bits = DSP_FFT_MIN_BITS; bits <= DSP_FFT_MAX_BITS; bits++)
+    {
+        uint32_t n = 1u << bits;
+        dsp_fft_real_t fft;
+        if (dsp_fft_real_init(&fft, n) != ESP_OK)
+        {
+            result = ESP_ERR_NO_MEM;
+            goto cleanup;
+        }
+
+        // The transform is in place, so each run starts from a fresh copy of the frame
+        uint32_t copy_cycles;
+        uint32_t cycles;
+        BENCH_MEASURE(copy_cycles, memcpy(buf, src, n * sizeof(int32_t)));
+        BENCH_MEASURE(cycles, (memcpy(buf, src, n * sizeof(int32_t)), dsp_fft_real_s32(&fft, buf)));
+        cycles = cycles > copy_cycles ? cycles - copy_cycles : 0;
+        dsp_fft_real_deinit(&fft);
+
+        char name[16];
+        snprintf(name, sizeof(name), "fft %lu", (unsigned long)n);
+        bench_log(name, cycles, n);
+        ESP_LOGI(TAG, "fft %lu points: %.1f us per frame, %.2f%% CPU at %d fps, %lu fps max",
+                 (unsigned long)n, cycles * 1e6 / cpu_hz, 100.0 * cycles * SPECTRUM_TARGET_FPS / cpu_hz,
+                 SPECTRUM_TARGET_FPS, (unsigned long)(cpu_hz / (cycles ? cycles : 1)));
+    }
+
+    // Display side bound: a full spectrum redraw at 9 bits per byte on the I2C bus, before command overhead
+    uint32_t redraw_bytes = OLED_SPECTRUM_PAGES * OLED_WIDTH;
+    double redraw_ms = redraw_bytes * 9 * 1000.0 / OLED_I2C_FREQ_HZ;
+    ESP_LOGI(TAG, "spectrum redraw: %lu bytes, %.1f ms at %d Hz I2C, %.0f fps max",
+             (unsigned long)redraw_bytes, redraw_ms, OLED_I2C_FREQ_HZ, 1000.0 / redraw_ms);
+
+cleanup:
+    free(in);
+    free(src);
+    free(buf);
+    return result;
+}
+
+// Generator output in blocks that do not divide any period, so state carries across block edges
+static void bench_gen_fill(signal_gen_t *gen, int16_t *out, size_t samples)
+{
+    const size_t block = 250;
+    for (size_t done = 0; done < samples; done += block)
+    {
+        signal_gen_fill(gen, &out[done], samples - done < block ? samples - done : block);
+    }
+}
+
+esp_err_t dsp_bench_verify_signal_gen(void)
+{
+    const uint32_t rate = 48000;
+    const size_t total = rate; // One second
+    const uint32_t mls_length = signal_gen_mls_length(SIGNAL_GEN_MLS_ORDER_MIN);
+    int16_t *out = malloc(total * sizeof(int16_t));
+    signal_gen_t *gen = malloc(sizeof(signal_gen_t));
+    esp_err_t result = ESP_OK;
+
+    if (!out || !gen)
+    {
+        result = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    signal_gen_init(gen, rate);
+    signal_gen_config_t config = gen->config;
+    const int32_t amplitude = config.amplitude;
+
+    // Sine: RMS level, peak and one rising zero crossing per cycle
+    config.type = SIGNAL_GEN_SINE;
+    config.freq_hz = 997.0f;
+    signal_gen_configure(gen, &config);
+    bench_gen_fill(gen, out, total);
+
+    int32_t peak = 0;
+    double sum_sq = 0.0;
+    uint32_t crossings = 0;
+    for (size_t i = 0; i < total; i++)
+    {
+        int32_t level = out[i] < 0 ? -out[i] : out[i];
+        peak = level > peak ? level : peak;
+        sum_sq += (double)out[i] * out[i];
+        crossings += i > 0 && out[i - 1] < 0 && out[i] >= 0;
+    }
+    double level_db = 20.0 * log10(sqrt(sum_sq / total) / (amplitude / sqrt(2.0)));
+    if (fabs(level_db) > DSP_BENCH_GEN_MAX_LEVEL_ERR_DB || peak > amplitude || crossings < 996 || crossings > 998)
+    {
+        ESP_LOGE(TAG, "sine 997 Hz: level %.3f dB, peak %ld, %lu cycles", level_db, (long)peak,
+                 (unsigned long)crossings);
+        result = ESP_FAIL;
+    }
+
+    // MLS: one more high than low sample per period, and the period repeats exactly
+    config.type = SIGNAL_GEN_MLS;
+    config.mls_order = SIGNAL_GEN_MLS_ORDER_MIN;
+    signal_gen_configure(gen, &config);
+    bench_gen_fill(gen, out, 2 * mls_length);
+
+    int32_t sum = 0;
+    for (size_t i = 0; i < mls_length; i++)
+    {
+        sum += out[i];
+    }
+    if (sum != amplitude || memcmp(out, &out[mls_length], mls_length * sizeof(int16_t)) != 0)
+    {
+        ESP_LOGE(TAG, "mls order %d: period sum %ld, expected %ld", SIGNAL_GEN_MLS_ORDER_MIN, (long)sum,
+                 (long)amplitude);
+        result = ESP_FAIL;
+    }
+
+    // Impulses: exactly on the period grid, at full amplitude, nothing in between
+    config.type = SIGNAL_GEN_IMPULSE;
+    config.period_ms = 10;
+    signal_gen_configure(gen, &config);
+    bench_gen_fill(gen, out, total);
+
+    const size_t spacing = rate / 100;
+    for (size_t i = 0; i < total; i++)
+    {
+        if (out[i] != (i % spacing == 0 ? amplitude : 0))
+        {
+            ESP_LOGE(TAG, "impulse train wrong at sample %u", (unsigned)i);
+            result = ESP_FAIL;
+            break;
+        }
+    }
+
+    if (result == ESP_OK)
+    {
+        ESP_LOGI(TAG, "Generator sine within %.4f dB, MLS and impulse train exact", fabs(level_db));
+    }
+
+cleanup:
+    free(out);
+    free(gen);
+    return result;
+}
+
+esp_err_t dsp_bench_run_signal_gen(size_t samples)
+{
+    if (samples == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Worst case rate, every source has to fit in a small share of its budget
+    const uint32_t rate = 192000;
+    int16_t *out = malloc(samples * sizeof(int16_t));
+    signal_gen_t *gen = malloc(sizeof(signal_gen_t));
+    esp_err_t result = ESP_OK;
+
+    if (!out || !gen)
+    {
+        result = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    signal_gen_init(gen, rate);
+    uint32_t budget = esp_clk_cpu_freq() / rate;
+
+    for (int type = SIGNAL_GEN_SINE; type < SIGNAL_GEN_TYPE_COUNT; type++)
+    {
+        signal_gen_config_t config = gen->config;
+        config.type = (signal_gen_type_t)type;
+        config.freq_hz = 20.0f;
+        config.freq_end_hz = 20000.0f;
+        config.period_ms = 100;
+        result = signal_gen_configure(gen, &config);
+        if (result != ESP_OK)
+        {
+            goto cleanup;
+        }
+        signal_gen_fill(gen, out, samples); // Picks up the config
+
+        uint32_t cycles;
+        BENCH_MEASURE(cycles, signal_gen_fill(gen, out, samples));
+        bench_log(signal_gen_type_name(config.type), cycles, samples);
+        ESP_LOGI(TAG, "%s at %lu Hz: %.1f%% of the %lu cycles/sample budget", signal_gen_type_name(config.type),
+                 (unsigned long)rate, 100.0 * cycles / samples / budget, (unsigned long)budget);
+    }
+
+cleanup:
+    free(out);
+    free(gen);
+    return result;
+}
+
+// Narrowing error of one s24 to s16 pass, as low band (adjacent sum) over high band (adjacent difference) power
+static double bench_dither_tilt(dsp_dither_mode_t mode, const int32_t *in, int16_t *out, size_t samples)
+{
+    dsp_dither_t dither;
+    double low = 0, high = 0, prev = 0;
+
+    dsp_dither_init(&dither, mode, 0x12345678);
+    dsp_convert_s24_to_s16(&dither, in, out, samples);
+    for (size_t i = 0; i < samples; i++)
+    {
+        double err = (double)out[i] * 256 - in[i];
+        low += (err + prev) * (err + prev);
+        high += (err - prev) * (err - prev);
+        prev = err;
+    }
+    return high > 0 ? low / high : 0;
+}
+
+esp_err_t dsp_bench_verify_convert(void)
+{
+    const size_t samples = 1021; // Odd so the unrolled loops also run their tails
+    const int rounds = 64;
+    esp_err_t result = ESP_OK;
+
+    int16_t *in16 = malloc(2 * samples * sizeof(int16_t));
+    int16_t *out16 = malloc(samples * sizeof(int16_t));
+    int16_t *ref16 = malloc(samples * sizeof(int16_t));
+    int32_t *in32 = malloc(2 * samples * sizeof(int32_t));
+    int32_t *out32 = malloc(2 * samples * sizeof(int32_t));
+    int32_t *ref32 = malloc(2 * samples * sizeof(int32_t));
+
+    if (!in16 || !out16 || !ref16 || !in32 || !out32 || !ref32)
+    {
+        result = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    bench_rng_state = 0x12345678;
+
+    for (int round = 0; round < rounds && result == ESP_OK; round++)
+    {
+        size_t length = 1 + bench_rand() % samples;
+        uint32_t bits = 8 + bench_rand() % 25;
+        bench_fill_s16(in16, 2 * length);
+        bench_fill_s32(in32, 2 * length);
+
+        dsp_convert_s16_to_s24(in16, out32, length);
+        dsp_convert_s16_to_s24_ref(in16, ref32, length);
+        if (memcmp(out32, ref32, length * sizeof(int32_t)) != 0)
+        {
+            ESP_LOGE(TAG, "s16_to_s24 mismatch (round %d)", round);
+            result = ESP_FAIL;
+        }
+
+        // In place, the widened block overlays its source
+        memcpy(out32, in16, length * sizeof(int16_t));
+        dsp_convert_s16_to_s32((const int16_t *)out32, out32, length);
+        dsp_convert_s16_to_s32_ref(in16, ref32, length);
+        if (memcmp(out32, ref32, length * sizeof(int32_t)) != 0)
+        {
+            ESP_LOGE(TAG, "s16_to_s32 mismatch (round %d)", round);
+            result = ESP_FAIL;
+        }
+
+        dsp_convert_s24_to_s32(in32, out32, length);
+        dsp_convert_s24_to_s32_ref(in32, ref32, length);
+        if (memcmp(out32, ref32, length * sizeof(int32_t)) != 0)
+        {
+            ESP_LOGE(TAG, "s24_to_s32 mismatch (round %d)", round);
+            result = ESP_FAIL;
+        }
+
+        dsp_convert_s32_to_s24(in32, out32, length);
+        dsp_convert_s32_to_s24_ref(in32, ref32, length);
+        if (memcmp(out32, ref32, length * sizeof(int32_t)) != 0)
+        {
+            ESP_LOGE(TAG, "s32_to_s24 mismatch (round %d)", round);
+            result = ESP_FAIL;
+        }
+
+        // Two blocks per mode so the carried dither state is compared too; s24 input is left out of range on purpose
+        for (int mode = DSP_DITHER_NONE; mode <= DSP_DITHER_SHAPED; mode++)
+        {
+            dsp_dither_t dither, dither_ref;
+            dsp_dither_init(&dither, (dsp_dither_mode_t)mode, (uint32_t)round);
+            dsp_dither_init(&dither_ref, (dsp_dither_mode_t)mode, (uint32_t)round);
+            for (int block = 0; block < 2; block++)
+            {
+                const int32_t *src = in32 + block * length;
+                dsp_convert_s32_to_s16(&dither, src, out16, length);
+                dsp_convert_s32_to_s16_ref(&dither_ref, src, ref16, length);
+                bool same = memcmp(out16, ref16, length * sizeof(int16_t)) == 0;
+                dsp_convert_s24_to_s16(&dither, src, out16, length);
+                dsp_convert_s24_to_s16_ref(&dither_ref, src, ref16, length);
+                same = same && memcmp(out16, ref16, length * sizeof(int16_t)) == 0;
+                if (!same || memcmp(&dither, &dither_ref, sizeof(dither)) != 0)
+                {
+                    ESP_LOGE(TAG, "narrowing mismatch (round %d, mode %d)", round, mode);
+                    result = ESP_FAIL;
+                }
+            }
+        }
+
+        for (size_t channels = 1; channels <= 2; channels++)
+        {
+            size_t channel = channels - 1;
+
+            dsp_convert_unpack_slot32(in32, out32, length, channels, channel, bits);
+            dsp_convert_unpack_slot32_ref(in32, ref32, length, channels, channel, bits);
+            if (memcmp(out32, ref32, length * sizeof(int32_t)) != 0)
+            {
+                ESP_LOGE(TAG, "unpack_slot32 mismatch (round %d, %u bits)", round, (unsigned)bits);
+                result = ESP_FAIL;
+            }
+
+            memcpy(out32, in32, length * sizeof(int32_t));
+            dsp_convert_pack_slot32(out32, out32, length, channels, bits);
+            dsp_convert_pack_slot32_ref(in32, ref32, length, channels, bits);
+            if (memcmp(out32, ref32, channels * length * sizeof(int32_t)) != 0)
+            {
+                ESP_LOGE(TAG, "pack_slot32 mismatch (round %d, %u bits)", round, (unsigned)bits);
+                result = ESP_FAIL;
+            }
+
+            dsp_convert_extract_s16(in16, out16, length, channels, channel);
+            dsp_convert_extract_s16_ref(in16, ref16, length, channels, channel);
+            dsp_convert_extract_s32(in32, out32, length, channels, channel);
+            dsp_convert_extract_s32_ref(in32, ref32, length, channels, channel);
+            if (memcmp(out16, ref16, length * sizeof(int16_t)) != 0 ||
+                memcmp(out32, ref32, length * sizeof(int32_t)) != 0)
+            {
+                ESP_LOGE(TAG, "extract mismatch (round %d)", round);
+                result = ESP_FAIL;
+            }
+        }
+    }
+
+    // A constant a quarter LSB above zero: rounding loses it, dither must keep it on average
+    for (int mode = DSP_DITHER_TPDF; mode <= DSP_DITHER_SHAPED && result == ESP_OK; mode++)
+    {
+        dsp_dither_t dither;
+        int64_t sum = 0;
+        dsp_dither_init(&dither, (dsp_dither_mode_t)mode, 0x12345678);
+        for (size_t i = 0; i < samples; i++)
+        {
+            in32[i] = 64;
+        }
+        for (int block = 0; block < rounds; block++)
+        {
+            dsp_convert_s24_to_s16(&dither, in32, out16, samples);
+            for (size_t i = 0; i < samples; i++)
+            {
+                sum += out16[i];
+            }
+        }
+
+        double bias = (double)sum / ((double)rounds * samples) - 0.25;
+        if (fabs(bias) > DSP_BENCH_DITHER_MAX_BIAS_LSB)
+        {
+            ESP_LOGE(TAG, "dither mode %d: %.4f LSB bias on a 0.25 LSB constant", mode, bias);
+            result = ESP_FAIL;
+        }
+    }
+
+    // Plain TPDF leaves the error white (ratio near 1), first-order shaping gives about 1/3
+    if (result == ESP_OK)
+    {
+        bench_fill_program(in16, samples);
+        for (size_t i = 0; i < samples; i++)
+        {
+            in32[i] = (int32_t)in16[i] * 256 + (int32_t)(bench_rand() & 0xFF);
+        }
+        double white = bench_dither_tilt(DSP_DITHER_TPDF, in32, out16, samples);
+        double shaped = bench_dither_tilt(DSP_DITHER_SHAPED, in32, out16, samples);
+        ESP_LOGI(TAG, "dither error low/high band power: tpdf %.2f, shaped %.2f", white, shaped);
+        if (white < 0.8 || shaped > 0.5)
+        {
+            ESP_LOGE(TAG, "noise shaping not effective");
+            result = ESP_FAIL;
+        }
+    }
+
+    if (result == ESP_OK)
+    {
+        ESP_LOGI(TAG, "Conversion kernels bit-exact against reference, dither unbiased (%d rounds)", rounds);
+    }
+
+cleanup:
+    free(in16);
+    free(out16);
+    free(ref16);
+    free(in32);
+    free(out32);
+    free(ref32);
+    return result;
+}
+
+static void bench_log_pair(const char *name, uint32_t cycles, uint32_t ref_cycles, size_t samples)
+{
+    ESP_LOGI(TAG, "%-16s %6u samples: %.2f cycles/sample, ref %.2f, %.2fx", name, (unsigned)samples,
+             (double)cycles / samples, (double)ref_cycles / samples, (double)ref_cycles / (cycles ? cycles : 1));
+}
+
+// Optimised kernel against its reference on the same arguments
+#define BENCH_CONVERT(name, samples, call, ref_call)             \
+    do                                                           \
+    {                                                            \
+        uint32_t opt_cycles_, ref_cycles_;                       \
+        BENCH_MEASURE(ref_cycles_, ref_call);                    \
+        BENCH_MEASURE(opt_cycles_, call);                        \
+        bench_log_pair(name, opt_cycles_, ref_cycles_, samples); \
+    } while (0)
+
+static const size_t bench_convert_blocks[] = {32, 128, 512, DSP_BENCH_DEFAULT_BLOCK};
+
+esp_err_t dsp_bench_run_convert(void)
+{
+    const size_t max_samples = DSP_BENCH_DEFAULT_BLOCK;
+    int16_t *in16 = malloc(2 * max_samples * sizeof(int16_t));
+    int16_t *out16 = malloc(max_samples * sizeof(int16_t));
+    int32_t *in32 = malloc(2 * max_samples * sizeof(int32_t));
+    int32_t *out32 = malloc(2 * max_samples * sizeof(int32_t));
+    esp_err_t result = ESP_OK;
+
+    if (!in16 || !out16 || !in32 || !out32)
+    {
+        result = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    bench_fill_s16(in16, 2 * max_samples);
+    bench_fill_s32(in32, 2 * max_samples);
+
+    dsp_dither_t round, tpdf, shaped;
+    dsp_dither_init(&round, DSP_DITHER_NONE, 1);
+    dsp_dither_init(&tpdf, DSP_DITHER_TPDF, 1);
+    dsp_dither_init(&shaped, DSP_DITHER_SHAPED, 1);
+
+    // Per-call overhead shows at small blocks, so every kernel runs at each size the audio path can use
+    for (size_t b = 0; b < sizeof(bench_convert_blocks) / sizeof(bench_convert_blocks[0]); b++)
+    {
+        size_t n = bench_convert_blocks[b];
+
+        BENCH_CONVERT("s16->s24", n, dsp_convert_s16_to_s24(in16, out32, n),
+                      dsp_convert_s16_to_s24_ref(in16, out32, n));
+        BENCH_CONVERT("s16->s32", n, dsp_convert_s16_to_s32(in16, out32, n),
+                      dsp_convert_s16_to_s32_ref(in16, out32, n));
+        BENCH_CONVERT("s24->s32", n, dsp_convert_s24_to_s32(in32, out32, n),
+                      dsp_convert_s24_to_s32_ref(in32, out32, n));
+        BENCH_CONVERT("s32->s24", n, dsp_convert_s32_to_s24(in32, out32, n),
+                      dsp_convert_s32_to_s24_ref(in32, out32, n));
+        BENCH_CONVERT("s24->s16 round", n, dsp_convert_s24_to_s16(&round, in32, out16, n),
+                      dsp_convert_s24_to_s16_ref(&round, in32, out16, n));
+        BENCH_CONVERT("s24->s16 tpdf", n, dsp_convert_s24_to_s16(&tpdf, in32, out16, n),
+                      dsp_convert_s24_to_s16_ref(&tpdf, in32, out16, n));
+        BENCH_CONVERT("s24->s16 shaped", n, dsp_convert_s24_to_s16(&shaped, in32, out16, n),
+                      dsp_convert_s24_to_s16_ref(&shaped, in32, out16, n));
+        BENCH_CONVERT("s32->s16 tpdf", n, dsp_convert_s32_to_s16(&tpdf, in32, out16, n),
+                      dsp_convert_s32_to_s16_ref(&tpdf, in32, out16, n));
+        BENCH_CONVERT("unpack stereo", n, dsp_convert_unpack_slot32(in32, out32, n, 2, 0, 24),
+                      dsp_convert_unpack_slot32_ref(in32, out32, n, 2, 0, 24));
+        BENCH_CONVERT("pack stereo", n, dsp_convert_pack_slot32(in32, out32, n, 2, 24),
+                      dsp_convert_pack_slot32_ref(in32, out32, n, 2, 24));
+        BENCH_CONVERT("extract s16", n, dsp_convert_extract_s16(in16, out16, n, 2, 1),
+                      dsp_convert_extract_s16_ref(in16, out16, n, 2, 1));
+        BENCH_CONVERT("extract s32", n, dsp_convert_extract_s32(in32, out32, n, 2, 1),
+                      dsp_convert_extract_s32_ref(in32, out32, n, 2, 1));
+    }
+
+    // Full receive and transmit path for one 24-bit stereo block at the worst case rate
+    const uint32_t rate = 192000;
+    uint32_t budget = esp_clk_cpu_freq() / rate;
+    uint32_t cycles;
+    BENCH_MEASURE(cycles, (dsp_convert_unpack_slot32(in32, out32, max_samples, 2, 0, 24),
+                           dsp_convert_s24_to_s16(&tpdf, out32, out16, max_samples),
+                           dsp_convert_s16_to_s24(out16, out32, max_samples),
+                           dsp_convert_pack_slot32(out32, out32, max_samples, 2, 24)));
+    ESP_LOGI(TAG, "24-bit stereo slots in and out, TPDF to s16: %.2f cycles/sample, %.1f%% of %lu at %lu Hz",
+             (double)cycles / max_samples, 100.0 * cycles / max_samples / budget, (unsigned long)budget,
+             (unsigned long)rate);
+
+cleanup:
+    free(in16);
+    free(out16);
+    free(in32);
+    free(out32);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Fixed against float backend. Every stage runs on the same program material
+// and parameters in both backends, and both are scored against a double run.
+
+#define BENCH_BACKEND_GAIN_Q15 23170  // -3 dB
+#define BENCH_BACKEND_ALPHA_Q15 8192  // Damping 0.75
+#define BENCH_BACKEND_EQ_RATE 48000
+
+typedef struct
+{
+    const int16_t *a;
+    const int16_t *b;
+    dsp_fixed_onepole_state_t onepole_fixed;
+    dsp_float_onepole_state_t onepole_float;
+    dsp_biquad_coefs_t eq[BENCH_EQ_BAND_COUNT];
+    dsp_biquad_state_t eq_fixed[BENCH_EQ_BAND_COUNT];
+    dsp_biquad_state_f32_t eq_float[BENCH_EQ_BAND_COUNT];
+} bench_backend_ctx_t;
+
+typedef void (*bench_backend_fn_t)(bench_backend_ctx_t *ctx, int16_t *out, size_t samples);
+typedef void (*bench_backend_ref_fn_t)(const bench_backend_ctx_t *ctx, double *out, size_t samples);
+
+static void bench_gain_fixed(bench_backend_ctx_t *ctx, int16_t *out, size_t samples)
+{
+    dsp_fixed_gain(ctx->a, out, samples, BENCH_BACKEND_GAIN_Q15);
+}
+
+static void bench_gain_float(bench_backend_ctx_t *ctx, int16_t *out, size_t samples)
+{
+    dsp_float_gain(ctx->a, out, samples, BENCH_BACKEND_GAIN_Q15);
+}
+
+static void bench_gain_ref(const bench_backend_ctx_t *ctx, double *out, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        out[i] = ctx->a[i] * (BENCH_BACKEND_GAIN_Q15 / 32768.0);
+    }
+}
+
+static void bench_mix_fixed(bench_backend_ctx_t *ctx, int16_t *out, size_t samples)
+{
+    dsp_fixed_mix(ctx->a, ctx->b, out, samples, 16384, 16384);
+}
+
+static void bench_mix_float(bench_backend_ctx_t *ctx, int16_t *out, size_t samples)
+{
+    dsp_float_mix(ctx->a, ctx->b, out, samples, 16384, 16384);
+}
+
+static void bench_mix_ref(const bench_backend_ctx_t *ctx, double *out, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        out[i] = 0.5 * ctx->a[i] + 0.5 * ctx->b[i];
+    }
+}
+
+static void bench_xfade_fixed(bench_backend_ctx_t *ctx, int16_t *out, size_t samples)
+{
+    dsp_fixed_crossfade(ctx->a, ctx->b, out, samples, 0, DSP_Q15_ONE);
+}
+
+static void bench_xfade_float(bench_backend_ctx_t *ctx, int16_t *out, size_t samples)
+{
+    dsp_float_crossfade(ctx->a, ctx->b, out, samples, 0, DSP_Q15_ONE);
+}
+
+static void bench_xfade_ref(const bench_backend_ctx_t *ctx, double *out, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        double x = (double)i / samples;
+        out[i] = ctx->a[i] * (1.0 - x) + ctx->b[i] * x;
+    }
+}
+
+static void bench_onepole_fixed(bench_backend_ctx_t *ctx, int16_t *out, size_t samples)
+{
+    dsp_fixed_onepole(&ctx->onepole_fixed, ctx->a, out, samples, BENCH_BACKEND_ALPHA_Q15);
+}
+
+static void bench_onepole_float(bench_backend_ctx_t *ctx, int16_t *out, size_t samples)
+{
+    dsp_float_onepole(&ctx->onepole_float, ctx->a, out, samples, BENCH_BACKEND_ALPHA_Q15);
+}
+
+static void bench_onepole_ref(const bench_backend_ctx_t *ctx, double *out, size_t samples)
+{
+    double y = 0;
+    for (size_t i = 0; i < samples; i++)
+    {
+        y += (ctx->a[i] - y) * (BENCH_BACKEND_ALPHA_Q15 / 32768.0);
+        out[i] = y;
+    }
+}
+
+static void bench_eq_fixed(bench_backend_ctx_t *ctx, int16_t *out, size_t samples)
+{
+    dsp_biquad_section_s16(&ctx->eq[0], &ctx->eq_fixed[0], ctx->a, out, samples);
+    for (size_t s = 1; s < BENCH_EQ_BAND_COUNT; s++)
+    {
+        dsp_biquad_section_s16(&ctx->eq[s], &ctx->eq_fixed[s], out, out, samples);
+    }
+}
+
+static void bench_eq_float(bench_backend_ctx_t *ctx, int16_t *out, size_t samples)
+{
+    dsp_biquad_section_f32(&ctx->eq[0], &ctx->eq_float[0], ctx->a, out, samples);
+    for (size_t s = 1; s < BENCH_EQ_BAND_COUNT; s++)
+    {
+        dsp_biquad_section_f32(&ctx->eq[s], &ctx->eq_float[s], out, out, samples);
+    }
+}
+
+// The cascade in double on the same quantised coefficients, sections in place on the output
+static void bench_eq_ref(const bench_backend_ctx_t *ctx, double *out, size_t samples)
+{
+    const double scale = 1.0 / DSP_BIQUAD_COEF_ONE;
+
+    for (size_t i = 0; i < samples; i++)
+    {
+        out[i] = ctx->a[i];
+    }
+    for (size_t s = 0; s < BENCH_EQ_BAND_COUNT; s++)
+    {
+        const dsp_biquad_coefs_t *c = &ctx->eq[s];
+        double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+        for (size_t i = 0; i < samples; i++)
+        {
+            double x0 = out[i];
+            double y0 = (c->b0 * x0 + c->b1 * x1 + c->b2 * x2 - c->a1 * y1 - c->a2 * y2) * scale;
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            out[i] = y0;
+        }
+    }
+}
+
+static const struct
+{
+    const char *name;
+    bench_backend_fn_t fixed;
+    bench_backend_fn_t flt;
+    bench_backend_ref_fn_t ref;
+} bench_backend_stages[] = {
+    {"gain", bench_gain_fixed, bench_gain_float, bench_gain_ref},
+    {"mix", bench_mix_fixed, bench_mix_float, bench_mix_ref},
+    {"crossfade", bench_xfade_fixed, bench_xfade_float, bench_xfade_ref},
+    {"onepole", bench_onepole_fixed, bench_onepole_float, bench_onepole_ref},
+    {"eq x8", bench_eq_fixed, bench_eq_float, bench_eq_ref},
+};
+
+static void bench_backend_reset(bench_backend_ctx_t *ctx)
+{
+    memset(&ctx->onepole_fixed, 0, sizeof(ctx->onepole_fixed));
+    memset(&ctx->onepole_float, 0, sizeof(ctx->onepole_float));
+    memset(ctx->eq_fixed, 0, sizeof(ctx->eq_fixed));
+    memset(ctx->eq_float, 0, sizeof(ctx->eq_float));
+}
+
+// Cycles per sample, then the worst and rms error in LSB over one run from a clean state
+static void bench_backend_score(const char *stage, const char *backend, bench_backend_fn_t fn,
+                                bench_backend_ctx_t *ctx, const double *ref, int16_t *out, size_t samples)
+{
+    uint32_t cycles;
+    BENCH_MEASURE(cycles, fn(ctx, out, samples));
+
+    bench_backend_reset(ctx);
+    fn(ctx, out, samples);
+    double worst = 0, sum_sq = 0;
+    for (size_t i = 0; i < samples; i++)
+    {
+        double err = fabs(out[i] - ref[i]);
+        worst = err > worst ? err : worst;
+        sum_sq += err * err;
+    }
+
+    ESP_LOGI(TAG, "%-10s %-5s %6.2f cycles/sample, error max %.2f LSB, rms %.3f LSB", stage, backend,
+             (double)cycles / samples, worst, sqrt(sum_sq / samples));
+}
+
+esp_err_t dsp_bench_run_backends(size_t samples)
+{
+    if (samples == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int16_t *a = malloc(samples * sizeof(int16_t));
+    int16_t *b = malloc(samples * sizeof(int16_t));
+    int16_t *out = malloc(samples * sizeof(int16_t));
+    double *ref = malloc(samples * sizeof(double));
+    bench_backend_ctx_t *ctx = calloc(1, sizeof(bench_backend_ctx_t));
+    esp_err_t result = ESP_OK;
+
+    if (!a || !b || !out || !ref || !ctx)
+    {
+        result = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    bench_rng_state = 0x12345678;
+    bench_fill_program(a, samples);
+    bench_fill_program(b, samples);
+    ctx->a = a;
+    ctx->b = b;
+    for (size_t s = 0; s < BENCH_EQ_BAND_COUNT; s++)
+    {
+        result = dsp_biquad_design(&bench_eq_bands[s], BENCH_BACKEND_EQ_RATE, &ctx->eq[s]);
+        if (result != ESP_OK)
+        {
+            goto cleanup;
+        }
+    }
+
+    ESP_LOGI(TAG, "Audio path built with the %s backend", DSP_BACKEND_NAME);
+    for (size_t s = 0; s < sizeof(bench_backend_stages) / sizeof(bench_backend_stages[0]); s++)
+    {
+        bench_backend_stages[s].ref(ctx, ref, samples);
+        bench_backend_score(bench_backend_stages[s].name, "fixed", bench_backend_stages[s].fixed, ctx, ref, out,
+                            samples);
+        bench_backend_score(bench_backend_stages[s].name, "float", bench_backend_stages[s].flt, ctx, ref, out,
+                            samples);
+    }
+
+cleanup:
+    free(a);
+    free(b);
+    free(out);
+    free(ref);
+    free(ctx);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Delay line: the block engine against a sample-by-sample model of the same
+// ring, with setter changes at block starts and cues anywhere in a block.
+
+#define BENCH_DELAY_RATE 48000
+#define BENCH_DELAY_VERIFY_RING 2400 // 50 ms, short enough to wrap every few blocks
+#define BENCH_DELAY_VERIFY_BLOCKS 400
+#define BENCH_DELAY_VERIFY_MAX_BLOCK 512
+#define BENCH_DELAY_MAX_CUES 512
+#define BENCH_DELAY_BYPASS_BLOCKS 2000
+#define BENCH_DELAY_GATE_HOLD_MS 2
+#define BENCH_DELAY_GATE_RELEASE_MS 1
+#define BENCH_DELAY_RUN_RING 8192
+#define BENCH_DELAY_RUN_MS 100
+
+typedef struct
+{
+    int16_t *ring;
+    uint32_t size;
+    uint32_t w;
+    uint32_t r;
+    int32_t feedback;
+    int32_t damping;
+    int32_t lp;
+    int32_t mix_q15;
+    int32_t dry; // Q30, like the engine's ramp
+    int32_t wet;
+    int32_t dry_step;
+    int32_t wet_step;
+    int32_t gain;
+} bench_delay_model_t;
+
+static esp_err_t bench_delay_init(audio_delay_t *ctx, uint32_t buffer_size)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->delay_buffer = calloc(buffer_size, sizeof(int16_t));
+    if (!ctx->delay_buffer)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    ctx->sample_rate = BENCH_DELAY_RATE;
+    ctx->buffer_size = buffer_size;
+    ctx->mix_q15 = MIX_Q15_WET;
+    ctx->gain_q15 = DSP_Q15_ONE;
+    audio_events_init(&ctx->events);
+    ctx->initialized = true;
+    return ESP_OK;
+}
+
+static void bench_delay_gains(int32_t mix_q15, int32_t *dry_q15, int32_t *wet_q15)
+{
+    int32_t dry = 2 * (DSP_Q15_ONE - mix_q15);
+    int32_t wet = 2 * mix_q15;
+
+    *dry_q15 = dry > DSP_Q15_ONE ? DSP_Q15_ONE : dry;
+    *wet_q15 = wet > DSP_Q15_ONE ? DSP_Q15_ONE : wet;
+}
+
+static void bench_delay_model_apply(bench_delay_model_t *model, const audio_event_t *event, size_t remaining)
+{
+    int32_t dry_q15, wet_q15;
+    uint32_t delay_samples;
+
+    switch (event->type)
+    {
+    case AUDIO_EVENT_DELAY:
+        delay_samples = (uint32_t)event->value * BENCH_DELAY_RATE / 1000;
+        if (delay_samples < model->size)
+        {
+            model->r = (model->w + model->size - delay_samples) % model->size;
+        }
+        break;
+    case AUDIO_EVENT_MIX:
+        bench_delay_gains(event->value, &dry_q15, &wet_q15);
+        if (event->aux == AUDIO_EVENT_MIX_RAMP)
+        {
+            model->dry_step = (dry_q15 * DSP_Q15_ONE - model->dry) / (int32_t)remaining;
+            model->wet_step = (wet_q15 * DSP_Q15_ONE - model->wet) / (int32_t)remaining;
+        }
+        else
+        {
+            model->dry = dry_q15 * DSP_Q15_ONE;
+            model->wet = wet_q15 * DSP_Q15_ONE;
+            model->dry_step = 0;
+            model->wet_step = 0;
+        }
+        model->mix_q15 = event->value;
+        break;
+    case AUDIO_EVENT_GAIN:
+        model->gain = event->value;
+        break;
+    case AUDIO_EVENT_FEEDBACK:
+        model->feedback = event->value;
+        model->damping = event->aux;
+        break;
+    default:
+        break;
+    }
+}
+
+// One sample: read the delayed slot, write the line input, mix the output
+static int16_t bench_delay_model_sample(bench_delay_model_t *model, int16_t x)
+{
+    uint32_t delay_samples = (model->w + model->size - model->r) % model->size;
+    int32_t delayed;
+
+    if (model->feedback != 0 && delay_samples > 0)
+    {
+        delayed = model->ring[model->r];
+        int32_t loop = delayed;
+        if (model->damping != 0)
+        {
+            model->lp += ((delayed - model->lp) * (DSP_Q15_ONE - model->damping)) >> 15;
+            loop = model->lp;
+        }
+        model->ring[model->w] = (int16_t)dsp_sat16(x + ((loop * model->feedback + (1 << 14)) >> 15));
+    }
+    else
+    {
+        // A zero delay plays the sample just written
+        model->ring[model->w] = x;
+        delayed = model->ring[model->r];
+    }
+
+    int16_t y = (int16_t)dsp_sat16((x * (model->dry >> 15) + delayed * (model->wet >> 15) + (1 << 14)) >> 15);
+    model->dry += model->dry_step;
+    model->wet += model->wet_step;
+    if (model->gain != DSP_Q15_ONE)
+    {
+        dsp_backend_gain(&y, &y, 1, model->gain);
+    }
+
+    model->w = (model->w + 1) % model->size;
+    model->r = (model->r + 1) % model->size;
+    return y;
+}
+
+// Random but valid change of one parameter, as a setter or a cue would make it
+static audio_event_t bench_delay_random_event(void)
+{
+    audio_event_t event = {.type = (uint8_t)(bench_rand() % AUDIO_EVENT_TYPE_COUNT)};
+
+    switch (event.type)
+    {
+    case AUDIO_EVENT_DELAY:
+        event.value = (int32_t)(bench_rand() % (BENCH_DELAY_VERIFY_RING * 1000 / BENCH_DELAY_RATE));
+        break;
+    case AUDIO_EVENT_MIX:
+        event.value = (int32_t)(bench_rand() % (MIX_Q15_WET + 1));
+        break;
+    case AUDIO_EVENT_GAIN:
+        event.value = (int32_t)(bench_rand() % (DSP_GAIN_Q15_MAX + 1));
+        break;
+    default:
+        // Zero feedback and zero damping both have their own paths
+        event.value = bench_rand() % 4 ? (int32_t)(bench_rand() % (2 * FEEDBACK_Q15_MAX + 1)) - FEEDBACK_Q15_MAX : 0;
+        event.aux = bench_rand() % 3 ? (int32_t)(bench_rand() % (DAMPING_Q15_MAX + 1)) : 0;
+        break;
+    }
+    return event;
+}
+
+// Send a change through the engine's setter for its type
+static esp_err_t bench_delay_set(audio_delay_t *ctx, const audio_event_t *event)
+{
+    switch (event->type)
+    {
+    case AUDIO_EVENT_DELAY:
+        return audio_delay_set_delay(ctx, (uint32_t)event->value);
+    case AUDIO_EVENT_MIX:
+        return audio_delay_set_mix(ctx, event->value);
+    case AUDIO_EVENT_FEEDBACK:
+        return audio_delay_set_feedback(ctx, (int16_t)event->value, (int16_t)event->aux);
+    default:
+        // Gain has no setter, it only changes on a cue
+        return audio_delay_schedule(ctx, event);
+    }
+}
+
+static esp_err_t bench_delay_verify_model(void)
+{
+    audio_delay_t *ctx = calloc(1, sizeof(audio_delay_t));
+    bench_delay_model_t model = {
+        .size = BENCH_DELAY_VERIFY_RING,
+        .mix_q15 = MIX_Q15_WET,
+        .gain = DSP_Q15_ONE,
+    };
+    audio_event_t *cues = malloc(BENCH_DELAY_MAX_CUES * sizeof(audio_event_t));
+    int16_t *in = malloc(BENCH_DELAY_VERIFY_MAX_BLOCK * sizeof(int16_t));
+    int16_t *out = malloc(BENCH_DELAY_VERIFY_MAX_BLOCK * sizeof(int16_t));
+    int16_t *ref = malloc(BENCH_DELAY_VERIFY_MAX_BLOCK * sizeof(int16_t));
+    size_t cue_count = 0;
+    size_t echo_blocks = 0;
+    esp_err_t result = ESP_ERR_NO_MEM;
+
+    model.ring = calloc(BENCH_DELAY_VERIFY_RING, sizeof(int16_t));
+    if (!ctx || !cues || !in || !out || !ref || !model.ring ||
+        bench_delay_init(ctx, BENCH_DELAY_VERIFY_RING) != ESP_OK)
+    {
+        goto cleanup;
+    }
+
+    bench_rng_state = 0x12345678;
+    result = ESP_OK;
+    uint64_t block_start = 0;
+
+    for (int block = 0; block < BENCH_DELAY_VERIFY_BLOCKS && result == ESP_OK; block++)
+    {
+        size_t samples = 1 + bench_rand() % BENCH_DELAY_VERIFY_MAX_BLOCK;
+        audio_event_t now[2];
+        size_t now_count = 0;
+
+        bench_fill_program(in, samples);
+
+        // Setter changes land on the block's first sample, the mix ramps across the block
+        for (int i = 0; i < 2 && result == ESP_OK; i++)
+        {
+            if (bench_rand() % 4 == 0)
+            {
+                now[now_count] = bench_delay_random_event();
+                if (now[now_count].type == AUDIO_EVENT_MIX)
+                {
+                    now[now_count].aux = AUDIO_EVENT_MIX_RAMP;
+                }
+                result = bench_delay_set(ctx, &now[now_count++]);
+            }
+        }
+
+        // Cues on any sample of this block or the next stretch, stepping the mix
+        for (int i = 0; i < 2 && result == ESP_OK && cue_count < BENCH_DELAY_MAX_CUES; i++)
+        {
+            if (bench_rand() % 3 == 0)
+            {
+                audio_event_t cue = bench_delay_random_event();
+                cue.at_sample = block_start + bench_rand() % (2 * samples);
+                cues[cue_count++] = cue;
+                result = audio_delay_schedule(ctx, &cue);
+            }
+        }
+        if (result != ESP_OK)
+        {
+            ESP_LOGE(TAG, "delay: event not queued (block %d)", block);
+            break;
+        }
+
+        bool echo = model.feedback != 0;
+        result = audio_delay_process(ctx, in, out, samples);
+        if (result != ESP_OK)
+        {
+            break;
+        }
+
+        bench_delay_gains(model.mix_q15, &model.dry, &model.wet);
+        model.dry *= DSP_Q15_ONE;
+        model.wet *= DSP_Q15_ONE;
+        model.dry_step = 0;
+        model.wet_step = 0;
+        for (size_t i = 0; i < now_count; i++)
+        {
+            bench_delay_model_apply(&model, &now[i], samples);
+        }
+        for (size_t n = 0; n < samples; n++)
+        {
+            // Cues due on the same sample apply in the order they were pushed
+            for (size_t c = 0; c < cue_count; c++)
+            {
+                if (cues[c].at_sample == block_start + n)
+                {
+                    bench_delay_model_apply(&model, &cues[c], samples - n);
+                }
+            }
+            ref[n] = bench_delay_model_sample(&model, in[n]);
+        }
+        echo_blocks += echo || model.feedback != 0;
+
+        for (size_t n = 0; n < samples; n++)
+        {
+            if (out[n] != ref[n])
+            {
+                ESP_LOGE(TAG, "delay mismatch (block %d, sample %u: %d, expected %d)", block, (unsigned)n, out[n],
+                         ref[n]);
+                result = ESP_FAIL;
+                break;
+            }
+        }
+        block_start += samples;
+    }
+
+    if (result == ESP_OK)
+    {
+        ESP_LOGI(TAG, "Delay line bit-exact against the per-sample model (%d blocks, %u with echo, %u cues)",
+                 BENCH_DELAY_VERIFY_BLOCKS, (unsigned)echo_blocks, (unsigned)cue_count);
+    }
+
+cleanup:
+    if (ctx)
+    {
+        free(ctx->delay_buffer);
+    }
+    free(ctx);
+    free(model.ring);
+    free(cues);
+    free(in);
+    free(out);
+    free(ref);
+    return result;
+}
+
+// The silence bypass against the full path on the same gated input: one
+// engine owns the gate, the other sees its decisions applied by hand and
+// never bypasses. Delay changes, lengthening ones included, land anywhere
+// in the silent stretches.
+static esp_err_t bench_delay_verify_bypass(void)
+{
+    audio_delay_t *bypass = calloc(1, sizeof(audio_delay_t));
+    audio_delay_t *full = calloc(1, sizeof(audio_delay_t));
+    audio_gate_t *gate = calloc(1, sizeof(audio_gate_t));
+    audio_gate_t *full_gate = calloc(1, sizeof(audio_gate_t));
+    int16_t *in = malloc(BENCH_DELAY_VERIFY_MAX_BLOCK * sizeof(int16_t));
+    int16_t *full_in = malloc(BENCH_DELAY_VERIFY_MAX_BLOCK * sizeof(int16_t));
+    int16_t *out = malloc(BENCH_DELAY_VERIFY_MAX_BLOCK * sizeof(int16_t));
+    int16_t *ref = malloc(BENCH_DELAY_VERIFY_MAX_BLOCK * sizeof(int16_t));
+    size_t bypassed_blocks = 0;
+    size_t events = 0;
+    esp_err_t result = ESP_ERR_NO_MEM;
+
+    if (!bypass || !full || !gate || !full_gate || !in || !full_in || !out || !ref ||
+        bench_delay_init(bypass, BENCH_DELAY_VERIFY_RING) != ESP_OK ||
+        bench_delay_init(full, BENCH_DELAY_VERIFY_RING) != ESP_OK)
+    {
+        goto cleanup;
+    }
+
+    // A short hold and release so the gate closes within a few blocks of silence
+    audio_gate_init(gate, BENCH_DELAY_RATE);
+    audio_gate_init(full_gate, BENCH_DELAY_RATE);
+    audio_gate_set_params(gate, AUDIO_GATE_DEFAULT_THRESHOLD, BENCH_DELAY_GATE_HOLD_MS, BENCH_DELAY_GATE_RELEASE_MS);
+    audio_gate_set_params(full_gate, AUDIO_GATE_DEFAULT_THRESHOLD, BENCH_DELAY_GATE_HOLD_MS,
+                          BENCH_DELAY_GATE_RELEASE_MS);
+    bypass->gate = gate;
+
+    bench_rng_state = 0x12345678;
+    result = ESP_OK;
+    uint64_t block_start = 0;
+    int loud_left = 0;
+    int quiet_left = 0;
+
+    for (int block = 0; block < BENCH_DELAY_BYPASS_BLOCKS && result == ESP_OK; block++)
+    {
+        size_t samples = 1 + bench_rand() % BENCH_DELAY_VERIFY_MAX_BLOCK;
+
+        // Short bursts of program between long silences
+        if (loud_left == 0 && quiet_left == 0)
+        {
+            loud_left = 1 + (int)(bench_rand() % 3);
+            quiet_left = 5 + (int)(bench_rand() % 40);
+        }
+        if (loud_left > 0)
+        {
+            bench_fill_program(in, samples);
+            loud_left--;
+        }
+        else
+        {
+            memset(in, 0, samples * sizeof(int16_t));
+            quiet_left--;
+        }
+
+        for (int i = 0; i < 2 && result == ESP_OK; i++)
+        {
+            uint32_t pick = bench_rand() % 8;
+            audio_event_t event = bench_delay_random_event();
+            if (pick == 0)
+            {
+                // Setter change at the block start
+                if (event.type == AUDIO_EVENT_MIX)
+                {
+                    event.aux = AUDIO_EVENT_MIX_RAMP;
+                }
+                result = bench_delay_set(bypass, &event);
+                result = result == ESP_OK ? bench_delay_set(full, &event) : result;
+                events++;
+            }
+            else if (pick == 1)
+            {
+                // Delay cue inside the block, most likely while bypassed
+                event.type = AUDIO_EVENT_DELAY;
+                event.value = (int32_t)(bench_rand() % (BENCH_DELAY_VERIFY_RING * 1000 / BENCH_DELAY_RATE));
+                event.at_sample = block_start + bench_rand() % samples;
+                result = audio_delay_schedule(bypass, &event);
+                result = result == ESP_OK ? audio_delay_schedule(full, &event) : result;
+                events++;
+            }
+        }
+        if (result != ESP_OK)
+        {
+            ESP_LOGE(TAG, "delay bypass: event not queued (block %d)", block);
+            break;
+        }
+
+        memcpy(full_in, in, samples * sizeof(int16_t));
+        uint64_t sum_sq = 0;
+        if (audio_gate_process(full_gate, full_in, samples, dsp_level_s16(full_in, samples, &sum_sq)))
+        {
+            memset(full_in, 0, samples * sizeof(int16_t));
+        }
+
+        result = audio_delay_process(bypass, in, out, samples);
+        result = result == ESP_OK ? audio_delay_process(full, full_in, ref, samples) : result;
+        bypassed_blocks += bypass->bypassed;
+
+        for (size_t n = 0; n < samples && result == ESP_OK; n++)
+        {
+            if (out[n] != ref[n])
+            {
+                ESP_LOGE(TAG, "delay bypass mismatch (block %d, sample %u: %d, expected %d)", block, (unsigned)n,
+                         out[n], ref[n]);
+                result = ESP_FAIL;
+            }
+        }
+        block_start += samples;
+    }
+
+    if (result == ESP_OK && bypassed_blocks == 0)
+    {
+        ESP_LOGE(TAG, "delay bypass never engaged");
+        result = ESP_FAIL;
+    }
+    if (result == ESP_OK)
+    {
+        ESP_LOGI(TAG, "Delay bypass bit-exact against the full path (%d blocks, %u bypassed, %u changes)",
+                 BENCH_DELAY_BYPASS_BLOCKS, (unsigned)bypassed_blocks, (unsigned)events);
+    }
+
+cleanup:
+    if (bypass)
+    {
+        free(bypass->delay_buffer);
+    }
+    if (full)
+    {
+        free(full->delay_buffer);
+    }
+    free(bypass);
+    free(full);
+    free(gate);
+    free(full_gate);
+    free(in);
+    free(full_in);
+    free(out);
+    free(ref);
+    return result;
+}
+
+esp_err_t dsp_bench_verify_delay(void)
+{
+    esp_err_t result = bench_delay_verify_model();
+    return result == ESP_OK ? bench_delay_verify_bypass() : result;
+}
+
+// Cycles per sample of the plain path, a mixed output and the echo with and without damping
+esp_err_t dsp_bench_run_delay(size_t samples)
+{
+    static const struct
+    {
+        const char *name;
+        int32_t mix_q15;
+        int16_t feedback_q15;
+        int16_t damping_q15;
+    } cases[] = {
+        {"delay wet", MIX_Q15_WET, 0, 0},
+        {"delay mix", MIX_Q15_WET / 2, 0, 0},
+        {"delay echo", MIX_Q15_WET / 2, 16384, 0},
+        {"delay echo damp", MIX_Q15_WET / 2, 16384, 16384},
+    };
+
+    if (samples == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    audio_delay_t *ctx = calloc(1, sizeof(audio_delay_t));
+    int16_t *in = malloc(samples * sizeof(int16_t));
+    int16_t *out = malloc(samples * sizeof(int16_t));
+    esp_err_t result = ESP_ERR_NO_MEM;
+
+    if (!ctx || !in || !out || bench_delay_init(ctx, BENCH_DELAY_RUN_RING) != ESP_OK)
+    {
+        goto cleanup;
+    }
+
+    bench_rng_state = 0x12345678;
+    bench_fill_program(in, samples);
+    result = audio_delay_set_delay(ctx, BENCH_DELAY_RUN_MS);
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]) && result == ESP_OK; i++)
+    {
+        result = audio_delay_set_mix(ctx, cases[i].mix_q15);
+        if (result == ESP_OK)
+        {
+            result = audio_delay_set_feedback(ctx, cases[i].feedback_q15, cases[i].damping_q15);
+        }
+        if (result == ESP_OK)
+        {
+            // One block to apply the changes and finish the mix ramp
+            result = audio_delay_process(ctx, in, out, samples);
+        }
+        if (result == ESP_OK)
+        {
+            uint32_t cycles;
+            BENCH_MEASURE(cycles, audio_delay_process(ctx, in, out, samples));
+            bench_log(cases[i].name, cycles, samples);
+        }
+    }
+
+cleanup:
+    if (ctx)
+    {
+        free(ctx->delay_buffer);
+    }
+    free(ctx);
+    free(in);
+    free(out);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Suites: verification then timing for one area, by name. The console bench
+// command and tools/dsp_host.c both run them through here.
+
+typedef struct
+{
+    const char *name;
+    esp_err_t (*verify)(void); // NULL when the suite only measures
+    esp_err_t (*run)(size_t block_samples);
+} bench_suite_t;
+
+// The FFT runs at the analyzer's fixed sizes, the block length does not apply
+static esp_err_t bench_run_fft(size_t block_samples)
+{
+    (void)block_samples;
+    return dsp_bench_run_fft();
+}
+
+// Conversion timing sweeps its own block lengths
+static esp_err_t bench_run_convert(size_t block_samples)
+{
+    (void)block_samples;
+    return dsp_bench_run_convert();
+}
+
+static const bench_suite_t bench_suites[] = {
+    {"kernels", dsp_bench_verify_kernels, dsp_bench_run_kernels},
+    {"biquad", dsp_bench_verify_biquad, dsp_bench_run_biquad},
+    {"fft", dsp_bench_verify_fft, bench_run_fft},
+    {"gen", dsp_bench_verify_signal_gen, dsp_bench_run_signal_gen},
+    {"convert", dsp_bench_verify_convert, bench_run_convert},
+    {"backends", NULL, dsp_bench_run_backends},
+    {"delay", dsp_bench_verify_delay, dsp_bench_run_delay},
+};
+
+#define BENCH_SUITE_COUNT (sizeof(bench_suites) / sizeof(bench_suites[0]))
+
+size_t dsp_bench_suite_count(void)
+{
+    return BENCH_SUITE_COUNT;
+}
+
+const char *dsp_bench_suite_name(size_t index)
+{
+    return index < BENCH_SUITE_COUNT ? bench_suites[index].name : NULL;
+}
+
+esp_err_t dsp_bench_run_suite(const char *name, size_t block_samples)
+{
+    bool all = !name || strcmp(name, "all") == 0;
+    esp_err_t result = all ? ESP_OK : ESP_ERR_NOT_FOUND;
+
+    block_samples = block_samples ? block_samples : DSP_BENCH_DEFAULT_BLOCK;
+    for (size_t i = 0; i < BENCH_SUITE_COUNT; i++)
+    {
+        const bench_suite_t *suite = &bench_suites[i];
+        if (!all && strcmp(name, suite->name) != 0)
+        {
+            continue;
+        }
+
+        // A failed check is the result that matters, the timing still runs for the log
+        esp_err_t ret = suite->verify ? suite->verify() : ESP_OK;
+        if (ret != ESP_OK)
+        {
+            ESP_LOGE(TAG, "%s: verification failed (%s)", suite->name, esp_err_to_name(ret));
+        }
+        esp_err_t run_ret = suite->run(block_samples);
+        ret = ret == ESP_OK ? run_ret : ret;
+
+        if (result == ESP_OK || result == ESP_ERR_NOT_FOUND)
+        {
+            result = ret;
+        }
+    }
+    return result;
+}
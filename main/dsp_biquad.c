@@ -0,0 +1,432 @@
+#include "dsp_biquad.h"
+#include "dsp_kernels.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include <math.h>
+#include <string.h>
+
+static const char *TAG = "DSP_BIQUAD";
+
+// How long a coefficient update waits for the audio task to release the spare bank
+#define DSP_BIQUAD_SWAP_TIMEOUT_MS 100
+
+#define ACC_FRAC_MASK ((1 << DSP_BIQUAD_ACC_SHIFT) - 1)
+
+// coef * x / 2^16, rounded to nearest. A truncated high word would bias every
+// product by half a unit, and sections with poles near DC amplify a bias by
+// their full DC noise gain (tens of LSBs for a 40 Hz high-pass at 192 kHz).
+static inline uint32_t biquad_mulh(int32_t coef, int32_t x)
+{
+    return (uint32_t)(int32_t)(((int64_t)coef * (x * 65536) + 0x80000000LL) >> 32);
+}
+
+// ---------------------------------------------------------------------------
+// Kernels
+//
+// Q30 coefficients keep low-frequency poles at 192 kHz off the unit circle,
+// which int16 coefficients cannot do. The accumulator is summed with
+// unsigned wrap-around, so intermediate overflow is harmless and the result
+// is exact as long as the unsaturated output stays within 4x full scale.
+// The fractions dropped by the output shift are fed back with second-order
+// shaping (2*e1 - e2), which places a double zero at DC in the truncation
+// noise and cancels the gain of the double pole near z = 1 that
+// low-frequency sections would otherwise apply to it.
+
+void dsp_biquad_section_s16_ref(const dsp_biquad_coefs_t *coefs, dsp_biquad_state_t *state,
+                                const int16_t *in, int16_t *out, size_t samples)
+{
+    int32_t x1 = state->x1;
+    int32_t x2 = state->x2;
+    int32_t y1 = state->y1;
+    int32_t y2 = state->y2;
+    int32_t e1 = state->e1;
+    int32_t e2 = state->e2;
+
+    for (size_t i = 0; i < samples; i++)
+    {
+        int32_t x0 = in[i];
+        uint32_t acc = (uint32_t)(2 * e1 - e2) + biquad_mulh(coefs->b0, x0) + biquad_mulh(coefs->b1, x1) +
+                       biquad_mulh(coefs->b2, x2) - biquad_mulh(coefs->a1, y1) - biquad_mulh(coefs->a2, y2);
+        int32_t y0 = dsp_sat16((int32_t)acc >> DSP_BIQUAD_ACC_SHIFT);
+
+        e2 = e1;
+        e1 = (int32_t)(acc & ACC_FRAC_MASK);
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+        out[i] = (int16_t)y0;
+    }
+
+    state->x1 = x1;
+    state->x2 = x2;
+    state->y1 = y1;
+    state->y2 = y2;
+    state->e1 = e1;
+    state->e2 = e2;
+}
+
+// Two samples per iteration so the history rotates through registers instead of being shuffled
+void dsp_biquad_section_s16(const dsp_biquad_coefs_t *coefs, dsp_biquad_state_t *state,
+                            const int16_t *in, int16_t *out, size_t samples)
+{
+    const int32_t b0 = coefs->b0;
+    const int32_t b1 = coefs->b1;
+    const int32_t b2 = coefs->b2;
+    const int32_t a1 = coefs->a1;
+    const int32_t a2 = coefs->a2;
+    int32_t x1 = state->x1;
+    int32_t x2 = state->x2;
+    int32_t y1 = state->y1;
+    int32_t y2 = state->y2;
+    int32_t e1 = state->e1;
+    int32_t e2 = state->e2;
+    size_t i = 0;
+
+    for (; i + 2 <= samples; i += 2)
+    {
+        int32_t xa = in[i];
+        int32_t xb = in[i + 1];
+
+        uint32_t acc = (uint32_t)(2 * e1 - e2) + biquad_mulh(b0, xa) + biquad_mulh(b1, x1) +
+                       biquad_mulh(b2, x2) - biquad_mulh(a1, y1) - biquad_mulh(a2, y2);
+        int32_t ya = dsp_sat16((int32_t)acc >> DSP_BIQUAD_ACC_SHIFT);
+        int32_t ea = (int32_t)(acc & ACC_FRAC_MASK);
+
+        acc = (uint32_t)(2 * ea - e1) + biquad_mulh(b0, xb) + biquad_mulh(b1, xa) +
+              biquad_mulh(b2, x1) - biquad_mulh(a1, ya) - biquad_mulh(a2, y1);
+        int32_t yb = dsp_sat16((int32_t)acc >> DSP_BIQUAD_ACC_SHIFT);
+
+        out[i] = (int16_t)ya;
+        out[i + 1] = (int16_t)yb;
+        e2 = ea;
+        e1 = (int32_t)(acc & ACC_FRAC_MASK);
+        x2 = xa;
+        x1 = xb;
+        y2 = ya;
+        y1 = yb;
+    }
+
+    if (i < samples)
+    {
+        int32_t x0 = in[i];
+        uint32_t acc = (uint32_t)(2 * e1 - e2) + biquad_mulh(b0, x0) + biquad_mulh(b1, x1) +
+                       biquad_mulh(b2, x2) - biquad_mulh(a1, y1) - biquad_mulh(a2, y2);
+        int32_t y0 = dsp_sat16((int32_t)acc >> DSP_BIQUAD_ACC_SHIFT);
+
+        out[i] = (int16_t)y0;
+        e2 = e1;
+        e1 = (int32_t)(acc & ACC_FRAC_MASK);
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+    }
+
+    state->x1 = x1;
+    state->x2 = x2;
+    state->y1 = y1;
+    state->y2 = y2;
+    state->e1 = e1;
+    state->e2 = e2;
+}
+
+// Single precision on the FPU: two states instead of four, the output is rounded only on the way out
+void dsp_biquad_section_f32(const dsp_biquad_coefs_t *coefs, dsp_biquad_state_f32_t *state,
+                            const int16_t *in, int16_t *out, size_t samples)
+{
+    const float scale = 1.0f / DSP_BIQUAD_COEF_ONE;
+    const float b0 = coefs->b0 * scale;
+    const float b1 = coefs->b1 * scale;
+    const float b2 = coefs->b2 * scale;
+    const float a1 = coefs->a1 * scale;
+    const float a2 = coefs->a2 * scale;
+    float s1 = state->s1;
+    float s2 = state->s2;
+
+    for (size_t i = 0; i < samples; i++)
+    {
+        float x = in[i];
+        float y = b0 * x + s1;
+        s1 = b1 * x - a1 * y + s2;
+        s2 = b2 * x - a2 * y;
+        out[i] = dsp_float_to_s16(y);
+    }
+
+    state->s1 = (s1 > -DSP_FLOAT_TINY && s1 < DSP_FLOAT_TINY) ? 0.0f : s1;
+    state->s2 = (s2 > -DSP_FLOAT_TINY && s2 < DSP_FLOAT_TINY) ? 0.0f : s2;
+}
+
+// ---------------------------------------------------------------------------
+// Audio side
+
+void dsp_biquad_process_block(void *ctx, const int16_t *in, int16_t *out, size_t samples)
+{
+    dsp_biquad_t *eq = (dsp_biquad_t *)ctx;
+
+    uint32_t bank_index = __atomic_load_n(&eq->active_bank, __ATOMIC_ACQUIRE);
+    const dsp_biquad_bank_t *bank = &eq->banks[bank_index];
+
+    if (bank_index != eq->running_bank)
+    {
+        // Sections that were idle start from silence, running ones keep their history
+        for (size_t s = eq->running_sections; s < bank->sections; s++)
+        {
+            memset(&eq->state[s], 0, sizeof(eq->state[s]));
+        }
+        eq->running_sections = bank->sections;
+        __atomic_store_n(&eq->running_bank, bank_index, __ATOMIC_RELEASE);
+    }
+
+    if (bank->sections == 0)
+    {
+        if (out != in)
+        {
+            memcpy(out, in, samples * sizeof(int16_t));
+        }
+        return;
+    }
+
+    dsp_backend_biquad_section(&bank->coefs[0], &eq->state[0], in, out, samples);
+    for (size_t s = 1; s < bank->sections; s++)
+    {
+        dsp_backend_biquad_section(&bank->coefs[s], &eq->state[s], out, out, samples);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Control side
+
+esp_err_t dsp_biquad_init(dsp_biquad_t *eq, uint32_t sample_rate)
+{
+    if (!eq || sample_rate == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // No sections: the stage passes audio through untouched
+    memset(eq, 0, sizeof(*eq));
+    eq->sample_rate = sample_rate;
+    return ESP_OK;
+}
+
+static bool dsp_biquad_quantize(float value, int32_t *coef)
+{
+    // 2^31 is exact in float, anything at or beyond it does not fit
+    float scaled = roundf(value * DSP_BIQUAD_COEF_ONE);
+    if (scaled < -2147483648.0f || scaled >= 2147483648.0f)
+    {
+        return false;
+    }
+    *coef = (int32_t)scaled;
+    return true;
+}
+
+// RBJ audio EQ cookbook designs, computed in float off the audio path
+esp_err_t dsp_biquad_design(const dsp_biquad_band_t *band, uint32_t sample_rate, dsp_biquad_coefs_t *coefs)
+{
+    if (!band || !coefs || sample_rate == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (band->freq_hz <= 0.0f || band->freq_hz >= sample_rate / 2.0f || band->q <= 0.0f ||
+        fabsf(band->gain_db) > DSP_BIQUAD_GAIN_DB_MAX)
+    {
+        ESP_LOGE(TAG, "Band out of range: %.1f Hz, Q %.2f, %.1f dB at %u Hz",
+                 band->freq_hz, band->q, band->gain_db, (unsigned)sample_rate);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    float w0 = 2.0f * (float)M_PI * band->freq_hz / sample_rate;
+    float cw = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * band->q);
+    float amp = powf(10.0f, band->gain_db / 40.0f);
+    float shelf = 2.0f * sqrtf(amp) * alpha;
+    float b0, b1, b2, a0, a1, a2;
+
+    switch (band->type)
+    {
+    case DSP_BIQUAD_LOWPASS:
+        b0 = (1.0f - cw) / 2.0f;
+        b1 = 1.0f - cw;
+        b2 = b0;
+        a0 = 1.0f + alpha;
+        a1 = -2.0f * cw;
+        a2 = 1.0f - alpha;
+        break;
+
+    case DSP_BIQUAD_HIGHPASS:
+        b0 = (1.0f + cw) / 2.0f;
+        b1 = -(1.0f + cw);
+        b2 = b0;
+        a0 = 1.0f + alpha;
+        a1 = -2.0f * cw;
+        a2 = 1.0f - alpha;
+        break;
+
+    case DSP_BIQUAD_PEAKING:
+        b0 = 1.0f + alpha * amp;
+        b1 = -2.0f * cw;
+        b2 = 1.0f - alpha * amp;
+        a0 = 1.0f + alpha / amp;
+        a1 = -2.0f * cw;
+        a2 = 1.0f - alpha / amp;
+        break;
+
+    case DSP_BIQUAD_LOWSHELF:
+        b0 = amp * ((amp + 1.0f) - (amp - 1.0f) * cw + shelf);
+        b1 = 2.0f * amp * ((amp - 1.0f) - (amp + 1.0f) * cw);
+        b2 = amp * ((amp + 1.0f) - (amp - 1.0f) * cw - shelf);
+        a0 = (amp + 1.0f) + (amp - 1.0f) * cw + shelf;
+        a1 = -2.0f * ((amp - 1.0f) + (amp + 1.0f) * cw);
+        a2 = (amp + 1.0f) + (amp - 1.0f) * cw - shelf;
+        break;
+
+    case DSP_BIQUAD_HIGHSHELF:
+        b0 = amp * ((amp + 1.0f) + (amp - 1.0f) * cw + shelf);
+        b1 = -2.0f * amp * ((amp - 1.0f) + (amp + 1.0f) * cw);
+        b2 = amp * ((amp + 1.0f) + (amp - 1.0f) * cw - shelf);
+        a0 = (amp + 1.0f) - (amp - 1.0f) * cw + shelf;
+        a1 = 2.0f * ((amp - 1.0f) - (amp + 1.0f) * cw);
+        a2 = (amp + 1.0f) - (amp - 1.0f) * cw - shelf;
+        break;
+
+    case DSP_BIQUAD_NOTCH:
+        b0 = 1.0f;
+        b1 = -2.0f * cw;
+        b2 = 1.0f;
+        a0 = 1.0f + alpha;
+        a1 = -2.0f * cw;
+        a2 = 1.0f - alpha;
+        break;
+
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Sections whose coefficients need more than Q2.30 cannot run in this format
+    if (!dsp_biquad_quantize(b0 / a0, &coefs->b0) || !dsp_biquad_quantize(b1 / a0, &coefs->b1) ||
+        !dsp_biquad_quantize(b2 / a0, &coefs->b2) || !dsp_biquad_quantize(a1 / a0, &coefs->a1) ||
+        !dsp_biquad_quantize(a2 / a0, &coefs->a2))
+    {
+        ESP_LOGE(TAG, "Band %.1f Hz %.1f dB does not fit Q2.30 coefficients", band->freq_hz, band->gain_db);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Poles must stay strictly inside the unit circle after quantisation
+    int64_t a1q = coefs->a1;
+    int64_t a2q = coefs->a2;
+    if (a2q >= DSP_BIQUAD_COEF_ONE || a2q <= -DSP_BIQUAD_COEF_ONE ||
+        (a1q < 0 ? -a1q : a1q) >= DSP_BIQUAD_COEF_ONE + a2q)
+    {
+        ESP_LOGE(TAG, "Band %.1f Hz Q %.2f is unstable at %u Hz", band->freq_hz, band->q, (unsigned)sample_rate);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return ESP_OK;
+}
+
+// Publish a new coefficient set; never blocks the audio task, which keeps
+// running on the current bank until it sees the flip.
+esp_err_t dsp_biquad_load_bank(dsp_biquad_t *eq, const dsp_biquad_bank_t *bank)
+{
+    if (!eq || !bank || bank->sections > DSP_BIQUAD_MAX_SECTIONS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // The spare bank is free once the audio task has acknowledged the previous flip.
+    // If it never does, the stage is not being processed and the bank is free anyway.
+    uint32_t active = __atomic_load_n(&eq->active_bank, __ATOMIC_ACQUIRE);
+    TickType_t start = xTaskGetTickCount();
+    while (__atomic_load_n(&eq->running_bank, __ATOMIC_ACQUIRE) != active &&
+           (xTaskGetTickCount() - start) < pdMS_TO_TICKS(DSP_BIQUAD_SWAP_TIMEOUT_MS))
+    {
+        vTaskDelay(1);
+    }
+
+    uint32_t spare = active ^ 1;
+    eq->banks[spare] = *bank;
+    __atomic_store_n(&eq->active_bank, spare, __ATOMIC_RELEASE);
+    return ESP_OK;
+}
+
+static esp_err_t dsp_biquad_rebuild(dsp_biquad_t *eq)
+{
+    dsp_biquad_bank_t bank;
+    bank.sections = eq->band_count;
+
+    for (size_t i = 0; i < eq->band_count; i++)
+    {
+        esp_err_t ret = dsp_biquad_design(&eq->bands[i], eq->sample_rate, &bank.coefs[i]);
+        if (ret != ESP_OK)
+        {
+            return ret;
+        }
+    }
+
+    return dsp_biquad_load_bank(eq, &bank);
+}
+
+esp_err_t dsp_biquad_set_bands(dsp_biquad_t *eq, const dsp_biquad_band_t *bands, size_t band_count)
+{
+    if (!eq || (band_count > 0 && !bands) || band_count > DSP_BIQUAD_MAX_SECTIONS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Validate the whole set before touching the running filter
+    dsp_biquad_coefs_t coefs;
+    for (size_t i = 0; i < band_count; i++)
+    {
+        esp_err_t ret = dsp_biquad_design(&bands[i], eq->sample_rate, &coefs);
+        if (ret != ESP_OK)
+        {
+            return ret;
+        }
+    }
+
+    memcpy(eq->bands, bands, band_count * sizeof(dsp_biquad_band_t));
+    eq->band_count = band_count;
+
+    ESP_LOGI(TAG, "EQ set to %u sections", (unsigned)band_count);
+    return dsp_biquad_rebuild(eq);
+}
+
+esp_err_t dsp_biquad_set_sample_rate(dsp_biquad_t *eq, uint32_t sample_rate)
+{
+    if (!eq || sample_rate == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (sample_rate == eq->sample_rate)
+    {
+        return ESP_OK;
+    }
+
+    eq->sample_rate = sample_rate;
+    if (eq->band_count == 0)
+    {
+        return ESP_OK;
+    }
+
+    // Bands that no longer fit (e.g. above the new Nyquist) leave the old set running
+    esp_err_t ret = dsp_biquad_rebuild(eq);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGW(TAG, "EQ not redesigned for %u Hz: %s", (unsigned)sample_rate, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+// Clears the filter history; only call while the stage is not being processed
+void dsp_biquad_reset(dsp_biquad_t *eq)
+{
+    if (eq)
+    {
+        memset(eq->state, 0, sizeof(eq->state));
+    }
+}
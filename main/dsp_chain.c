@@ -0,0 +1,166 @@
+#include "dsp_chain.h"
+#include "audio_profiler.h"
+#include "esp_log.h"
+#include <string.h>
+#include <stdlib.h>
+
+static const char *TAG = "DSP_CHAIN";
+
+esp_err_t dsp_chain_init(dsp_chain_t *chain, size_t max_block)
+{
+    if (!chain || max_block == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(chain, 0, sizeof(*chain));
+
+    // All memory the chain needs is allocated here, processing never allocates
+    chain->scratch = (int16_t *)malloc(max_block * sizeof(int16_t));
+    if (!chain->scratch)
+    {
+        ESP_LOGE(TAG, "Failed to allocate scratch buffer");
+        return ESP_ERR_NO_MEM;
+    }
+    chain->max_block = max_block;
+
+    ESP_LOGI(TAG, "DSP chain initialized - max block %u samples", (unsigned)max_block);
+    return ESP_OK;
+}
+
+esp_err_t dsp_chain_deinit(dsp_chain_t *chain)
+{
+    if (!chain)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    free(chain->scratch);
+    chain->scratch = NULL;
+    chain->stage_count = 0;
+    return ESP_OK;
+}
+
+// Stages must be added during setup, before the audio task starts processing
+esp_err_t dsp_chain_add_stage(dsp_chain_t *chain, const char *name, dsp_process_fn_t process_block,
+                              void *ctx, bool in_place, int *stage_index)
+{
+    if (!chain || !process_block)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (chain->stage_count >= DSP_CHAIN_MAX_STAGES)
+    {
+        ESP_LOGE(TAG, "Too many stages (max %d)", DSP_CHAIN_MAX_STAGES);
+        return ESP_ERR_NO_MEM;
+    }
+
+    dsp_stage_t *stage = &chain->stages[chain->stage_count];
+    memset(stage, 0, sizeof(*stage));
+    stage->name = name ? name : "stage";
+    stage->process_block = process_block;
+    stage->ctx = ctx;
+    stage->in_place = in_place;
+    stage->bypass = false;
+
+    if (stage_index)
+    {
+        *stage_index = (int)chain->stage_count;
+    }
+    chain->stage_count++;
+
+    ESP_LOGI(TAG, "Added stage %d: %s%s", (int)chain->stage_count - 1, stage->name,
+             in_place ? " (in place)" : "");
+    return ESP_OK;
+}
+
+esp_err_t dsp_chain_set_bypass(dsp_chain_t *chain, int stage_index, bool bypass)
+{
+    if (!chain || stage_index < 0 || (size_t)stage_index >= chain->stage_count)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    chain->stages[stage_index].bypass = bypass;
+    return ESP_OK;
+}
+
+// Run the chain over buffer. In-place stages work directly on the current
+// block; other stages ping-pong between buffer and the scratch block, so at
+// most one copy back is needed when the block ends up in scratch.
+esp_err_t dsp_chain_process(dsp_chain_t *chain, int16_t *buffer, size_t samples)
+{
+    if (!chain || !buffer)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (samples > chain->max_block)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    int16_t *current = buffer;
+    int16_t *spare = chain->scratch;
+
+    for (size_t i = 0; i < chain->stage_count; i++)
+    {
+        dsp_stage_t *stage = &chain->stages[i];
+        if (stage->bypass)
+        {
+            continue;
+        }
+
+#if AUDIO_PROFILER_ENABLED
+        uint32_t start = esp_cpu_get_cycle_count();
+#endif
+
+        if (stage->in_place)
+        {
+            stage->process_block(stage->ctx, current, current, samples);
+        }
+        else
+        {
+            stage->process_block(stage->ctx, current, spare, samples);
+            int16_t *tmp = current;
+            current = spare;
+            spare = tmp;
+        }
+
+#if AUDIO_PROFILER_ENABLED
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        stage->blocks++;
+        stage->last_cycles = cycles;
+        stage->total_cycles += cycles;
+        if (cycles > stage->max_cycles)
+        {
+            stage->max_cycles = cycles;
+        }
+#endif
+    }
+
+    if (current != buffer)
+    {
+        memcpy(buffer, current, samples * sizeof(int16_t));
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t dsp_chain_get_stage_stats(dsp_chain_t *chain, int stage_index, dsp_stage_stats_t *stats)
+{
+    if (!chain || !stats || stage_index < 0 || (size_t)stage_index >= chain->stage_count)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const dsp_stage_t *stage = &chain->stages[stage_index];
+    stats->name = stage->name;
+    stats->bypass = stage->bypass;
+    stats->blocks = stage->blocks;
+    stats->last_cycles = stage->last_cycles;
+    stats->max_cycles = stage->max_cycles;
+    stats->avg_cycles = stage->blocks ? (uint32_t)(stage->total_cycles / stage->blocks) : 0;
+    return ESP_OK;
+}
@@ -0,0 +1,432 @@
+#include "dsp_convert.h"
+#include "dsp_kernels.h"
+
+#define S24_MAX ((1 << 23) - 1)
+#define S24_MIN (-(1 << 23))
+
+// Saturate to 24 bits, single CLAMPS instruction on Xtensa
+static inline int32_t sat24(int32_t x)
+{
+#if defined(__XTENSA__)
+    int32_t r;
+    __asm__("clamps %0, %1, 23" : "=a"(r) : "a"(x));
+    return r;
+#else
+    return x > S24_MAX ? S24_MAX : (x < S24_MIN ? S24_MIN : x);
+#endif
+}
+
+static inline uint32_t xorshift32(uint32_t x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+void dsp_dither_init(dsp_dither_t *dither, dsp_dither_mode_t mode, uint32_t seed)
+{
+    dither->mode = mode;
+    dither->rng = seed ? seed : 0x9E3779B9;
+    dither->error = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Reference implementations
+
+void dsp_convert_s16_to_s24_ref(const int16_t *in, int32_t *out, size_t samples)
+{
+    for (size_t i = samples; i-- > 0;)
+    {
+        out[i] = (int32_t)in[i] * 256;
+    }
+}
+
+void dsp_convert_s16_to_s32_ref(const int16_t *in, int32_t *out, size_t samples)
+{
+    for (size_t i = samples; i-- > 0;)
+    {
+        out[i] = (int32_t)in[i] * 65536;
+    }
+}
+
+void dsp_convert_s24_to_s32_ref(const int32_t *in, int32_t *out, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        out[i] = (int32_t)((uint32_t)in[i] << 8);
+    }
+}
+
+void dsp_convert_s32_to_s24_ref(const int32_t *in, int32_t *out, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        int64_t y = ((int64_t)in[i] + 128) >> 8;
+        out[i] = y > S24_MAX ? S24_MAX : (int32_t)y;
+    }
+}
+
+// Quantise x to 16 bits: subtract the shaped error, add TPDF noise of two uniforms, round
+static int16_t dither_sample_ref(dsp_dither_t *dither, int32_t x, int shift)
+{
+    const int64_t mask = ((int64_t)1 << shift) - 1;
+    int64_t v = (int64_t)x - (dither->mode == DSP_DITHER_SHAPED ? dither->error : 0);
+    int64_t noise = 0;
+
+    if (dither->mode != DSP_DITHER_NONE)
+    {
+        dither->rng = xorshift32(dither->rng);
+        noise = (int64_t)(dither->rng & mask) + ((dither->rng >> 16) & mask) - mask;
+    }
+
+    int64_t y = (v + noise + (mask + 1) / 2) >> shift;
+    if (dither->mode == DSP_DITHER_SHAPED)
+    {
+        // Error of the unclipped quantiser, so a clipped peak cannot wind up the loop
+        dither->error = (int32_t)(y * (mask + 1) - v);
+    }
+    return (int16_t)(y > INT16_MAX ? INT16_MAX : (y < INT16_MIN ? INT16_MIN : y));
+}
+
+void dsp_convert_s24_to_s16_ref(dsp_dither_t *dither, const int32_t *in, int16_t *out, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        out[i] = dither_sample_ref(dither, in[i], 8);
+    }
+}
+
+void dsp_convert_s32_to_s16_ref(dsp_dither_t *dither, const int32_t *in, int16_t *out, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        out[i] = dither_sample_ref(dither, in[i], 16);
+    }
+}
+
+void dsp_convert_unpack_slot32_ref(const int32_t *slots, int32_t *out, size_t frames, size_t channels,
+                                   size_t channel, uint32_t bits)
+{
+    for (size_t i = 0; i < frames; i++)
+    {
+        out[i] = slots[i * channels + channel] >> (32 - bits);
+    }
+}
+
+void dsp_convert_pack_slot32_ref(const int32_t *in, int32_t *slots, size_t frames, size_t channels, uint32_t bits)
+{
+    for (size_t i = frames; i-- > 0;)
+    {
+        int32_t slot = (int32_t)((uint32_t)in[i] << (32 - bits));
+        for (size_t c = channels; c-- > 0;)
+        {
+            slots[i * channels + c] = slot;
+        }
+    }
+}
+
+void dsp_convert_extract_s16_ref(const int16_t *frames_in, int16_t *out, size_t frames, size_t channels,
+                                 size_t channel)
+{
+    for (size_t i = 0; i < frames; i++)
+    {
+        out[i] = frames_in[i * channels + channel];
+    }
+}
+
+void dsp_convert_extract_s32_ref(const int32_t *frames_in, int32_t *out, size_t frames, size_t channels,
+                                 size_t channel)
+{
+    for (size_t i = 0; i < frames; i++)
+    {
+        out[i] = frames_in[i * channels + channel];
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Optimised implementations. Loops are unrolled so the LX6 can overlap
+// loads and stores, and the narrowing kernels keep the dither state
+// in registers, specialise on the mode and split each sample into its kept
+// and dropped bits so no 64-bit arithmetic is needed.
+
+void dsp_convert_s16_to_s24(const int16_t *in, int32_t *out, size_t samples)
+{
+    size_t i = samples;
+
+    // From the end, so out may overlay in
+    for (; i >= 4; i -= 4)
+    {
+        int32_t x3 = in[i - 1];
+        int32_t x2 = in[i - 2];
+        int32_t x1 = in[i - 3];
+        int32_t x0 = in[i - 4];
+        out[i - 1] = (int32_t)((uint32_t)x3 << 8);
+        out[i - 2] = (int32_t)((uint32_t)x2 << 8);
+        out[i - 3] = (int32_t)((uint32_t)x1 << 8);
+        out[i - 4] = (int32_t)((uint32_t)x0 << 8);
+    }
+    while (i-- > 0)
+    {
+        out[i] = (int32_t)((uint32_t)in[i] << 8);
+    }
+}
+
+void dsp_convert_s16_to_s32(const int16_t *in, int32_t *out, size_t samples)
+{
+    size_t i = samples;
+
+    for (; i >= 4; i -= 4)
+    {
+        int32_t x3 = in[i - 1];
+        int32_t x2 = in[i - 2];
+        int32_t x1 = in[i - 3];
+        int32_t x0 = in[i - 4];
+        out[i - 1] = (int32_t)((uint32_t)x3 << 16);
+        out[i - 2] = (int32_t)((uint32_t)x2 << 16);
+        out[i - 3] = (int32_t)((uint32_t)x1 << 16);
+        out[i - 4] = (int32_t)((uint32_t)x0 << 16);
+    }
+    while (i-- > 0)
+    {
+        out[i] = (int32_t)((uint32_t)in[i] << 16);
+    }
+}
+
+void dsp_convert_s24_to_s32(const int32_t *in, int32_t *out, size_t samples)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= samples; i += 4)
+    {
+        uint32_t x0 = (uint32_t)in[i];
+        uint32_t x1 = (uint32_t)in[i + 1];
+        uint32_t x2 = (uint32_t)in[i + 2];
+        uint32_t x3 = (uint32_t)in[i + 3];
+        out[i] = (int32_t)(x0 << 8);
+        out[i + 1] = (int32_t)(x1 << 8);
+        out[i + 2] = (int32_t)(x2 << 8);
+        out[i + 3] = (int32_t)(x3 << 8);
+    }
+    for (; i < samples; i++)
+    {
+        out[i] = (int32_t)((uint32_t)in[i] << 8);
+    }
+}
+
+// (x + 128) >> 8 without the overflow near full scale
+static inline int32_t round_s32_to_s24(int32_t x)
+{
+    return sat24((x >> 8) + (((x & 0xFF) + 128) >> 8));
+}
+
+void dsp_convert_s32_to_s24(const int32_t *in, int32_t *out, size_t samples)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= samples; i += 4)
+    {
+        int32_t x0 = in[i];
+        int32_t x1 = in[i + 1];
+        int32_t x2 = in[i + 2];
+        int32_t x3 = in[i + 3];
+        out[i] = round_s32_to_s24(x0);
+        out[i + 1] = round_s32_to_s24(x1);
+        out[i + 2] = round_s32_to_s24(x2);
+        out[i + 3] = round_s32_to_s24(x3);
+    }
+    for (; i < samples; i++)
+    {
+        out[i] = round_s32_to_s24(in[i]);
+    }
+}
+
+// Narrowing by a constant shift; the two wrappers below let the compiler fold it.
+// hi + ((lo + noise + half) >> shift) equals (x + noise + half) >> shift in 64 bits.
+static inline void narrow_s16(dsp_dither_t *dither, const int32_t *in, int16_t *out, size_t samples,
+                              const int shift)
+{
+    const int32_t mask = (1 << shift) - 1;
+    const int32_t half = 1 << (shift - 1);
+    uint32_t rng = dither->rng;
+    size_t i = 0;
+
+    switch (dither->mode)
+    {
+    case DSP_DITHER_NONE:
+        for (; i + 4 <= samples; i += 4)
+        {
+            int32_t x0 = in[i];
+            int32_t x1 = in[i + 1];
+            int32_t x2 = in[i + 2];
+            int32_t x3 = in[i + 3];
+            out[i] = (int16_t)dsp_sat16((x0 >> shift) + (((x0 & mask) + half) >> shift));
+            out[i + 1] = (int16_t)dsp_sat16((x1 >> shift) + (((x1 & mask) + half) >> shift));
+            out[i + 2] = (int16_t)dsp_sat16((x2 >> shift) + (((x2 & mask) + half) >> shift));
+            out[i + 3] = (int16_t)dsp_sat16((x3 >> shift) + (((x3 & mask) + half) >> shift));
+        }
+        for (; i < samples; i++)
+        {
+            int32_t x = in[i];
+            out[i] = (int16_t)dsp_sat16((x >> shift) + (((x & mask) + half) >> shift));
+        }
+        break;
+
+    case DSP_DITHER_TPDF:
+        // Half minus the mean of the two uniforms, folded into one constant
+        for (; i + 2 <= samples; i += 2)
+        {
+            int32_t x0 = in[i];
+            int32_t x1 = in[i + 1];
+            uint32_t r0 = xorshift32(rng);
+            uint32_t r1 = xorshift32(r0);
+            rng = r1;
+            int32_t n0 = (int32_t)(r0 & mask) + (int32_t)((r0 >> 16) & mask) - mask + half;
+            int32_t n1 = (int32_t)(r1 & mask) + (int32_t)((r1 >> 16) & mask) - mask + half;
+            out[i] = (int16_t)dsp_sat16((x0 >> shift) + (((x0 & mask) + n0) >> shift));
+            out[i + 1] = (int16_t)dsp_sat16((x1 >> shift) + (((x1 & mask) + n1) >> shift));
+        }
+        for (; i < samples; i++)
+        {
+            int32_t x = in[i];
+            rng = xorshift32(rng);
+            int32_t n = (int32_t)(rng & mask) + (int32_t)((rng >> 16) & mask) - mask + half;
+            out[i] = (int16_t)dsp_sat16((x >> shift) + (((x & mask) + n) >> shift));
+        }
+        break;
+
+    case DSP_DITHER_SHAPED:
+    {
+        // The error feeds the next sample, so there is nothing to gain from unrolling
+        int32_t error = dither->error;
+        for (; i < samples; i++)
+        {
+            int32_t x = in[i];
+            rng = xorshift32(rng);
+            int32_t n = (int32_t)(rng & mask) + (int32_t)((rng >> 16) & mask) - mask + half;
+            int32_t low = (x & mask) - error;
+            int32_t carry = (low + n) >> shift;
+            out[i] = (int16_t)dsp_sat16((x >> shift) + carry);
+            error = carry * (mask + 1) - low;
+        }
+        dither->error = error;
+        break;
+    }
+    }
+
+    dither->rng = rng;
+}
+
+void dsp_convert_s24_to_s16(dsp_dither_t *dither, const int32_t *in, int16_t *out, size_t samples)
+{
+    narrow_s16(dither, in, out, samples, 8);
+}
+
+void dsp_convert_s32_to_s16(dsp_dither_t *dither, const int32_t *in, int16_t *out, size_t samples)
+{
+    narrow_s16(dither, in, out, samples, 16);
+}
+
+void dsp_convert_unpack_slot32(const int32_t *slots, int32_t *out, size_t frames, size_t channels,
+                               size_t channel, uint32_t bits)
+{
+    const int shift = 32 - (int)bits;
+    const int32_t *src = slots + channel;
+    size_t i = 0;
+
+    // Arithmetic shift sign-extends the left-justified sample and drops the padding bits
+    for (; i + 4 <= frames; i += 4)
+    {
+        int32_t x0 = src[0];
+        int32_t x1 = src[channels];
+        int32_t x2 = src[2 * channels];
+        int32_t x3 = src[3 * channels];
+        src += 4 * channels;
+        out[i] = x0 >> shift;
+        out[i + 1] = x1 >> shift;
+        out[i + 2] = x2 >> shift;
+        out[i + 3] = x3 >> shift;
+    }
+    for (; i < frames; i++)
+    {
+        out[i] = *src >> shift;
+        src += channels;
+    }
+}
+
+void dsp_convert_pack_slot32(const int32_t *in, int32_t *slots, size_t frames, size_t channels, uint32_t bits)
+{
+    const int shift = 32 - (int)bits;
+    size_t i = frames;
+
+    if (channels == 2)
+    {
+        // The usual case, both slots of a stereo frame in one pass
+        while (i-- > 0)
+        {
+            int32_t slot = (int32_t)((uint32_t)in[i] << shift);
+            slots[2 * i + 1] = slot;
+            slots[2 * i] = slot;
+        }
+        return;
+    }
+
+    while (i-- > 0)
+    {
+        int32_t slot = (int32_t)((uint32_t)in[i] << shift);
+        for (size_t c = channels; c-- > 0;)
+        {
+            slots[i * channels + c] = slot;
+        }
+    }
+}
+
+void dsp_convert_extract_s16(const int16_t *frames_in, int16_t *out, size_t frames, size_t channels,
+                             size_t channel)
+{
+    const int16_t *src = frames_in + channel;
+    size_t i = 0;
+
+    for (; i + 4 <= frames; i += 4)
+    {
+        int16_t x0 = src[0];
+        int16_t x1 = src[channels];
+        int16_t x2 = src[2 * channels];
+        int16_t x3 = src[3 * channels];
+        src += 4 * channels;
+        out[i] = x0;
+        out[i + 1] = x1;
+        out[i + 2] = x2;
+        out[i + 3] = x3;
+    }
+    for (; i < frames; i++)
+    {
+        out[i] = *src;
+        src += channels;
+    }
+}
+
+void dsp_convert_extract_s32(const int32_t *frames_in, int32_t *out, size_t frames, size_t channels,
+                             size_t channel)
+{
+    const int32_t *src = frames_in + channel;
+    size_t i = 0;
+
+    for (; i + 4 <= frames; i += 4)
+    {
+        int32_t x0 = src[0];
+        int32_t x1 = src[channels];
+        int32_t x2 = src[2 * channels];
+        int32_t x3 = src[3 * channels];
+        src += 4 * channels;
+        out[i] = x0;
+        out[i + 1] = x1;
+        out[i + 2] = x2;
+        out[i + 3] = x3;
+    }
+    for (; i < frames; i++)
+    {
+        out[i] = *src;
+        src += channels;
+    }
+}
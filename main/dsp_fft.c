@@ -0,0 +1,154 @@
+#include "dsp_fft.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+esp_err_t dsp_fft_real_init(dsp_fft_real_t *fft, uint32_t size)
+{
+    if (!fft)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t bits = 0;
+    while ((1u << bits) < size)
+    {
+        bits++;
+    }
+    if ((1u << bits) != size || bits < DSP_FFT_MIN_BITS || bits > DSP_FFT_MAX_BITS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t half = size / 2;
+    memset(fft, 0, sizeof(*fft));
+    fft->cos_q15 = malloc(half * sizeof(int16_t));
+    fft->sin_q15 = malloc(half * sizeof(int16_t));
+    fft->bitrev = malloc(half * sizeof(uint16_t));
+    if (!fft->cos_q15 || !fft->sin_q15 || !fft->bitrev)
+    {
+        dsp_fft_real_deinit(fft);
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint32_t k = 0; k < half; k++)
+    {
+        // 1.0 does not fit Q15, the top entry is one LSB short
+        double phase = 2.0 * M_PI * k / size;
+        long c = lround(cos(phase) * 32768.0);
+        long s = lround(sin(phase) * 32768.0);
+        fft->cos_q15[k] = (int16_t)(c > INT16_MAX ? INT16_MAX : c);
+        fft->sin_q15[k] = (int16_t)(s > INT16_MAX ? INT16_MAX : s);
+
+        uint32_t rev = 0;
+        for (uint32_t b = 0; b < bits - 1; b++)
+        {
+            rev |= ((k >> b) & 1u) << (bits - 2 - b);
+        }
+        fft->bitrev[k] = (uint16_t)rev;
+    }
+
+    fft->size = size;
+    fft->bits = bits;
+    return ESP_OK;
+}
+
+void dsp_fft_real_deinit(dsp_fft_real_t *fft)
+{
+    if (!fft)
+    {
+        return;
+    }
+
+    free(fft->cos_q15);
+    free(fft->sin_q15);
+    free(fft->bitrev);
+    memset(fft, 0, sizeof(*fft));
+}
+
+// (re + j*im) * (c - j*s), rounded back from Q15
+static inline void fft_twiddle(int32_t re, int32_t im, int32_t c, int32_t s, int32_t *out_re, int32_t *out_im)
+{
+    *out_re = (int32_t)(((int64_t)re * c + (int64_t)im * s + (1 << 14)) >> 15);
+    *out_im = (int32_t)(((int64_t)im * c - (int64_t)re * s + (1 << 14)) >> 15);
+}
+
+void dsp_fft_real_s32(const dsp_fft_real_t *fft, int32_t *buf)
+{
+    const uint32_t half = fft->size / 2;
+
+    // Even samples as real parts, odd as imaginary: the buffer already is that complex array
+    for (uint32_t i = 0; i < half; i++)
+    {
+        uint32_t j = fft->bitrev[i];
+        if (j > i)
+        {
+            int32_t re = buf[2 * i];
+            int32_t im = buf[2 * i + 1];
+            buf[2 * i] = buf[2 * j];
+            buf[2 * i + 1] = buf[2 * j + 1];
+            buf[2 * j] = re;
+            buf[2 * j + 1] = im;
+        }
+    }
+
+    // Radix-2 decimation in time; a length-len stage uses every (N/len)th twiddle
+    for (uint32_t len = 2; len <= half; len <<= 1)
+    {
+        uint32_t span = len / 2;
+        uint32_t step = fft->size / len;
+
+        for (uint32_t start = 0; start < half; start += len)
+        {
+            for (uint32_t j = 0; j < span; j++)
+            {
+                int32_t *a = &buf[2 * (start + j)];
+                int32_t *b = &buf[2 * (start + j + span)];
+                int32_t tr, ti;
+
+                if (j == 0)
+                {
+                    tr = b[0];
+                    ti = b[1];
+                }
+                else
+                {
+                    fft_twiddle(b[0], b[1], fft->cos_q15[j * step], fft->sin_q15[j * step], &tr, &ti);
+                }
+
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+
+    // Split pass: with Z = E + jO, 2X[k] = (Z[k] + Z*[M-k]) - j W^k (Z[k] - Z*[M-k]),
+    // and 2X[M-k] is the conjugate of the same terms with the twiddled part negated
+    int32_t z0_re = buf[0];
+    int32_t z0_im = buf[1];
+    buf[0] = 2 * (z0_re + z0_im);
+    buf[1] = 2 * (z0_re - z0_im);
+
+    for (uint32_t k = 1; k <= half / 2; k++)
+    {
+        int32_t *a = &buf[2 * k];
+        int32_t *b = &buf[2 * (half - k)];
+
+        int32_t sum_re = a[0] + b[0];
+        int32_t sum_im = a[1] - b[1];
+        int32_t odd_re = a[1] + b[1];
+        int32_t odd_im = b[0] - a[0];
+        int32_t pr, pi;
+        fft_twiddle(odd_re, odd_im, fft->cos_q15[k], fft->sin_q15[k], &pr, &pi);
+
+        a[0] = sum_re + pr;
+        a[1] = sum_im + pi;
+        if (b != a)
+        {
+            b[0] = sum_re - pr;
+            b[1] = pi - sum_im;
+        }
+    }
+}
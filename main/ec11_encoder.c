@@ -4,6 +4,7 @@
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "trace_buffer.h"
 
 static const char *TAG = "EC11";
 
@@ -29,6 +30,37 @@ static const int8_t encoder_table[16] = {
     0   // 1111
 };
 
+// Quadrature is decoded here so fast turns lose no transitions to task latency
+static void ec11_rotation_isr(void *arg) {
+    ec11_encoder_t *encoder = (ec11_encoder_t *)arg;
+    uint8_t current_state = (gpio_get_level(encoder->pin_s1) << 1) | gpio_get_level(encoder->pin_s2);
+    
+    if (current_state != encoder->last_state) {
+        int8_t step = encoder_table[(encoder->last_state << 2) | current_state];
+        __atomic_fetch_add(&encoder->steps, step, __ATOMIC_RELAXED);
+        encoder->last_state = current_state;
+        TRACE_RECORD(TRACE_EV_ENCODER_EDGE, current_state, step);
+    }
+    
+    if (encoder->task) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(encoder->task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+// The button is debounced and timed in the task, the interrupt only wakes it
+static void ec11_key_isr(void *arg) {
+    ec11_encoder_t *encoder = (ec11_encoder_t *)arg;
+    TRACE_RECORD(TRACE_EV_ENCODER_KEY, gpio_get_level(encoder->pin_key), 0);
+    
+    if (encoder->task) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(encoder->task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
 esp_err_t ec11_encoder_init(ec11_encoder_t *encoder, ec11_callback_t callback) {
     if (!encoder || !callback) {
         return ESP_ERR_INVALID_ARG;
@@ -41,13 +73,17 @@ esp_err_t ec11_encoder_init(ec11_encoder_t *encoder, ec11_callback_t callback) {
     encoder->last_state = 0;
     encoder->key_pressed = false;
     encoder->last_key_time = 0;
+    encoder->long_press_sent = false;
     encoder->debounce_time_ms = 50;
     
+    encoder->task = NULL;
+    encoder->steps = 0;
+    
     g_callback = callback;
     
-    // Configure GPIO pins
+    // Configure GPIO pins; every edge wakes the task, nothing polls
     gpio_config_t io_conf = {
-        .intr_type = GPIO_INTR_DISABLE,
+        .intr_type = GPIO_INTR_ANYEDGE,
         .mode = GPIO_MODE_INPUT,
         .pin_bit_mask = (1ULL << encoder->pin_s1) | (1ULL << encoder->pin_s2),
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
@@ -62,6 +98,16 @@ esp_err_t ec11_encoder_init(ec11_encoder_t *encoder, ec11_callback_t callback) {
     // Read initial state
     encoder->last_state = (gpio_get_level(encoder->pin_s1) << 1) | gpio_get_level(encoder->pin_s2);
     
+    // Another driver may already have installed the shared GPIO ISR service
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Failed to install GPIO ISR service: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_ERROR_CHECK(gpio_isr_handler_add(encoder->pin_s1, ec11_rotation_isr, encoder));
+    ESP_ERROR_CHECK(gpio_isr_handler_add(encoder->pin_s2, ec11_rotation_isr, encoder));
+    ESP_ERROR_CHECK(gpio_isr_handler_add(encoder->pin_key, ec11_key_isr, encoder));
+    
     ESP_LOGI(TAG, "EC11 encoder initialized");
     return ESP_OK;
 }
@@ -71,6 +117,9 @@ esp_err_t ec11_encoder_deinit(ec11_encoder_t *encoder) {
         return ESP_ERR_INVALID_ARG;
     }
     
+    gpio_isr_handler_remove(encoder->pin_s1);
+    gpio_isr_handler_remove(encoder->pin_s2);
+    gpio_isr_handler_remove(encoder->pin_key);
     g_callback = NULL;
     ESP_LOGI(TAG, "EC11 encoder deinitialized");
     return ESP_OK;
@@ -84,26 +133,17 @@ void ec11_encoder_task(void *pvParameters) {
         return;
     }
     
+    encoder->task = xTaskGetCurrentTaskHandle();
     ESP_LOGI(TAG, "EC11 encoder task started");
     
     while (1) {
-        // Read current encoder state
-        uint8_t current_state = (gpio_get_level(encoder->pin_s1) << 1) | gpio_get_level(encoder->pin_s2);
-        
-        // Check for rotation
-        if (current_state != encoder->last_state) {
-            uint8_t combined_state = (encoder->last_state << 2) | current_state;
-            int8_t direction = encoder_table[combined_state];
-            
-            if (direction != 0 && g_callback) {
-                if (direction > 0) {
-                    g_callback(EC11_CW);
-                } else {
-                    g_callback(EC11_CCW);
-                }
-            }
-            
-            encoder->last_state = current_state;
+        // Report rotation decoded by the interrupt since the last wakeup
+        int32_t steps = __atomic_exchange_n(&encoder->steps, 0, __ATOMIC_RELAXED);
+        for (; steps > 0 && g_callback; steps--) {
+            g_callback(EC11_CW);
+        }
+        for (; steps < 0 && g_callback; steps++) {
+            g_callback(EC11_CCW);
         }
         
         // Check button state
@@ -115,16 +155,34 @@ void ec11_encoder_task(void *pvParameters) {
                 encoder->key_pressed = key_current;
                 encoder->last_key_time = current_time;
                 
-                if (g_callback) {
-                    if (encoder->key_pressed) {
+                // A press is only classified once it ends or turns into a long press
+                if (encoder->key_pressed) {
+                    encoder->long_press_sent = false;
+                } else if (g_callback) {
+                    if (!encoder->long_press_sent) {
                         g_callback(EC11_PRESSED);
-                    } else {
-                        g_callback(EC11_RELEASED);
                     }
+                    g_callback(EC11_RELEASED);
                 }
             }
+        } else if (encoder->key_pressed && !encoder->long_press_sent &&
+                   current_time - encoder->last_key_time >= EC11_LONG_PRESS_MS) {
+            encoder->long_press_sent = true;
+            if (g_callback) {
+                g_callback(EC11_LONG_PRESSED);
+            }
         }
         
-        vTaskDelay(pdMS_TO_TICKS(5)); // 5ms polling interval
+        // Sleep until the next edge; only a bouncing or held button needs a timed wakeup
+        TickType_t wait = portMAX_DELAY;
+        uint32_t held_ms = (uint32_t)(current_time - encoder->last_key_time);
+        if (key_current != encoder->key_pressed) {
+            uint32_t left = held_ms > encoder->debounce_time_ms ? 0 : encoder->debounce_time_ms - held_ms + 1;
+            wait = pdMS_TO_TICKS(left) + 1;
+        } else if (encoder->key_pressed && !encoder->long_press_sent) {
+            uint32_t left = held_ms >= EC11_LONG_PRESS_MS ? 0 : EC11_LONG_PRESS_MS - held_ms;
+            wait = pdMS_TO_TICKS(left) + 1;
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
     }
 }
@@ -218,6 +218,15 @@ esp_err_t es8388_init(const es8388_config_t *config)
         goto init_fail;
 
     es8388_initialized = true;
+
+    // Apply the configured sample rate, the register defaults above are not tied to it
+    ret = es8388_set_sample_rate(config->sample_rate);
+    if (ret != ESP_OK)
+    {
+        es8388_initialized = false;
+        goto init_fail;
+    }
+
     ESP_LOGI(TAG, "ES8388 initialized successfully");
     return ESP_OK;
 
@@ -325,9 +334,17 @@ esp_err_t es8388_mute(bool enable)
         return ESP_ERR_INVALID_STATE;
     }
 
-    uint8_t mute_val = enable ? 0x80 : 0x00;
+    // DACMute is bit 2 of DACCONTROL3, keep the ramp configuration in the other bits
+    uint8_t reg_val;
+    esp_err_t ret = es8388_read_reg(ES8388_DACCONTROL3, &reg_val);
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+
+    reg_val = enable ? (reg_val | 0x04) : (reg_val & ~0x04);
 
-    esp_err_t ret = es8388_write_reg(ES8388_DACCONTROL3, mute_val);
+    ret = es8388_write_reg(ES8388_DACCONTROL3, reg_val);
     if (ret != ESP_OK)
     {
         return ret;
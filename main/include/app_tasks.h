@@ -0,0 +1,64 @@
+#ifndef APP_TASKS_H
+#define APP_TASKS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "audio_jitter.h"
+
+// Task topology: the audio path owns one core, everything that touches I2C,
+// NVS or the user runs on the other. The IDF's own system tasks (esp_timer,
+// event loop) are pinned to core 0, so that is the control core.
+#define APP_CORE_CONTROL 0
+#define APP_CORE_AUDIO 1
+
+// Run app_tasks_stress_test() from app_main once everything is up
+#ifndef APP_STRESS_AT_BOOT
+#define APP_STRESS_AT_BOOT 0
+#endif
+
+#define APP_STRESS_PHASE_MS 10000 // Quiet baseline, then the same time under load
+#define APP_STRESS_BURN_MS 9      // Control core hog: busy this long ...
+#define APP_STRESS_REST_MS 1      // ... then yields so the idle task still feeds the watchdog
+
+typedef enum
+{
+    APP_TASK_AUDIO,    // I2S read, delay, DSP chain, I2S write
+    APP_TASK_ENCODER,  // EC11 events into the UI
+    APP_TASK_UI,       // Display refresh, settings, NVS saves, periodic reports
+    APP_TASK_SPECTRUM, // FFT in the control core's idle time
+    APP_TASK_MONITOR,  // Run-time, stack and heap statistics
+    APP_TASK_CONSOLE,  // UART command shell; created by esp_console from these values
+    APP_TASK_CONTROL,  // Binary control protocol on UART1
+    APP_TASK_COUNT
+} app_task_id_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t stack;
+    UBaseType_t priority;
+    BaseType_t core;
+} app_task_config_t;
+
+typedef struct
+{
+    audio_jitter_stats_t baseline; // Audio block cadence with the UI idle
+    audio_jitter_stats_t loaded;   // Same, while the UI is hammered
+    uint32_t hammer_iterations;
+    uint32_t display_anomalies; // Late blocks with an OLED transfer in flight
+    uint32_t nvs_anomalies;     // Late blocks with an NVS write in flight
+} app_stress_result_t;
+
+// One unit of UI work, called in a loop by the stress test
+typedef void (*app_stress_fn_t)(void *arg, uint32_t iteration);
+
+// Function declarations
+const app_task_config_t *app_tasks_get_config(app_task_id_t id);
+esp_err_t app_tasks_create(app_task_id_t id, TaskFunction_t fn, void *arg, TaskHandle_t *handle);
+void app_tasks_log_topology(void);
+esp_err_t app_tasks_stress_test(uint32_t phase_ms, app_stress_fn_t hammer, void *arg, app_stress_result_t *result);
+
+#endif // APP_TASKS_H
@@ -5,6 +5,12 @@
 #include <stdbool.h>
 #include "driver/i2s_std.h"
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "dsp_chain.h"
+#include "audio_gate.h"
+#include "signal_generator.h"
+#include "audio_events.h"
 
 // Audio configuration constants
 #define AUDIO_SAMPLE_RATE_44K 44100
@@ -22,9 +28,58 @@
 
 #define DEFAULT_SAMPLE_RATE AUDIO_SAMPLE_RATE_48K
 
+// Feedback echo, Q15 (32768 = 1.0); feedback magnitude is kept below 1.0 for stability
+#define FEEDBACK_Q15_MAX 32767
+#define DAMPING_Q15_MAX 32767
+
+// Dry/wet mix, Q15: 0 = dry only, 32768 = delayed signal only, 16384 = both at unity
+#define MIX_Q15_WET 32768
+#define DEFAULT_MIX_Q15 MIX_Q15_WET
+
 // Audio buffer configuration
 #define AUDIO_BUFFER_SIZE 1024
 #define DELAY_BUFFER_SIZE (MAX_DELAY_MS * AUDIO_SAMPLE_RATE_192K / 1000 * 2) // Max buffer size
+#define AUDIO_DMA_DESC_NUM 8
+
+// Sample rate switch configuration
+#define RATE_SWITCH_SILENCE_MS 20     // Silence inserted after the I2S restart
+#define RATE_SWITCH_TIMEOUT_MS 2000   // Max time a caller waits for the audio task
+
+// Audio path watchdog configuration
+#define AUDIO_WATCHDOG_STALL_PERIODS 8 // Missed block periods before the path counts as stalled
+#define AUDIO_WATCHDOG_MIN_STALL_MS 50
+#define AUDIO_WATCHDOG_RETRY_MAX_MS 4000 // Failed recoveries are retried at doubling intervals up to this
+#define AUDIO_IO_ERROR_LOG_MS 1000        // At most one I2S error line per interval, with a count
+
+// Result of the last sample rate switch
+typedef struct
+{
+    uint32_t from_rate;
+    uint32_t to_rate;
+    uint32_t dropout_us; // From start of the fade-out until audio resumes
+    uint32_t switch_count;
+    esp_err_t result;
+} audio_rate_switch_stats_t;
+
+// Audio path watchdog recoveries, MTTR = total_outage_us / recovery_count
+typedef struct
+{
+    uint32_t recovery_count;
+    uint32_t failed_recoveries;
+    uint32_t last_outage_us; // From the last good block until audio resumed
+    uint64_t total_outage_us;
+    uint32_t last_reinit_us; // Time spent tearing down and re-initialising
+} audio_watchdog_stats_t;
+
+// I2S DMA queue overflow events, counted in the I2S ISR
+typedef struct
+{
+    uint32_t rx_overflow_count;  // RX DMA buffers dropped because the audio task read too late
+    uint32_t rx_dropped_bytes;
+    uint32_t tx_underflow_count; // TX DMA ran out of queued data and played silence
+    int64_t last_rx_overflow_us; // esp_timer time of the last event, 0 if none
+    int64_t last_tx_underflow_us;
+} audio_i2s_stats_t;
 
 typedef struct
 {
@@ -35,6 +90,61 @@ typedef struct
     uint32_t write_index;
     uint32_t read_index;
     bool initialized;
+
+    // Feedback echo: line input = input + feedback * lowpass(delayed), output follows the mix
+    int16_t feedback_q15; // 0 disables echo mode
+    int16_t damping_q15;  // 0 = no damping, higher = darker repeats
+    int32_t damping_state;
+
+    // Dry/wet mix, a set_mix event ramps it over the rest of its block
+    int32_t mix_q15;
+
+    // Level of the last input block before the gate, for the task's meter
+    int32_t input_peak;
+    uint64_t input_sum_sq;
+
+    // Sample rate switch handshake, executed by the audio task between blocks
+    bool task_running;
+    volatile uint32_t pending_sample_rate;
+    SemaphoreHandle_t rate_switch_done;
+    audio_rate_switch_stats_t rate_switch;
+
+    // Optional processing applied to the delayed block before playback
+    dsp_chain_t *chain;
+
+    // Optional test source, replaces the I2S input while it is not off
+    signal_gen_t *generator;
+
+    // Optional input gate. Once it is closed and the line holds only zeros the
+    // block is bypassed: both heads advance without touching the ring.
+    audio_gate_t *gate;
+    bool bypassed;             // The last block took the bypass
+    uint32_t silent_run;       // Zero samples written in a row, ending at the write head
+    uint32_t bypassed_samples; // Ring writes skipped by the current bypass
+
+    // Skipped slots still hold old audio and are cleared after the bypass ends.
+    // Offsets are from stale_base: the reader's side is [stale_up, buffer_size),
+    // the side behind it [max(stale_low, stale_written), stale_down).
+    bool stale;
+    uint32_t stale_base;       // Write head when the bypass ended
+    uint32_t stale_up;
+    uint32_t stale_down;
+    uint32_t stale_low;
+    uint32_t stale_written;    // Written since the bypass ended, needs no clearing
+    uint32_t stale_read_index; // Read head expected at the next block
+
+    // Block cadence watchdog
+    int64_t last_block_us;
+    int64_t next_recovery_us;  // No recovery attempt before this
+    int64_t recovery_retry_us; // Back-off after a failed recovery, 0 while the path is healthy
+    audio_watchdog_stats_t watchdog;
+
+    // Scheduled changes. The sample clock counts input samples processed so far
+    // and is published under a sequence count for readers on the other core.
+    audio_event_queue_t events;
+    uint64_t sample_clock;
+    uint32_t clock_seq;
+    int32_t gain_q15; // Output gain, only changed by scheduled events
 } audio_delay_t;
 
 // Function declarations
@@ -42,6 +152,19 @@ esp_err_t audio_delay_init(audio_delay_t *delay_ctx);
 esp_err_t audio_delay_deinit(audio_delay_t *delay_ctx);
 esp_err_t audio_delay_set_sample_rate(audio_delay_t *delay_ctx, uint32_t sample_rate);
 esp_err_t audio_delay_set_delay(audio_delay_t *delay_ctx, uint32_t delay_ms);
+esp_err_t audio_delay_set_feedback(audio_delay_t *delay_ctx, int16_t feedback_q15, int16_t damping_q15);
+esp_err_t audio_delay_set_mix(audio_delay_t *delay_ctx, int32_t mix_q15);
+esp_err_t audio_delay_get_rate_switch_stats(audio_delay_t *delay_ctx, audio_rate_switch_stats_t *stats);
+esp_err_t audio_delay_get_watchdog_stats(audio_delay_t *delay_ctx, audio_watchdog_stats_t *stats);
+esp_err_t audio_delay_get_i2s_stats(audio_i2s_stats_t *stats);
+void audio_delay_reset_i2s_stats(void);
+esp_err_t audio_delay_set_chain(audio_delay_t *delay_ctx, dsp_chain_t *chain);
+esp_err_t audio_delay_set_gate(audio_delay_t *delay_ctx, audio_gate_t *gate);
+esp_err_t audio_delay_set_generator(audio_delay_t *delay_ctx, signal_gen_t *generator);
+esp_err_t audio_delay_schedule(audio_delay_t *delay_ctx, const audio_event_t *event);
+void audio_delay_clear_schedule(audio_delay_t *delay_ctx);
+uint64_t audio_delay_get_sample_clock(audio_delay_t *delay_ctx);
+esp_err_t audio_delay_get_event_stats(audio_delay_t *delay_ctx, audio_event_stats_t *stats);
 esp_err_t audio_delay_process(audio_delay_t *delay_ctx, int16_t *input, int16_t *output, size_t samples);
 void audio_delay_task(void *pvParameters);
 
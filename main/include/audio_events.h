@@ -0,0 +1,72 @@
+#ifndef AUDIO_EVENTS_H
+#define AUDIO_EVENTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// Parameter changes timestamped against the audio engine's sample clock.
+// Control tasks push events into a small ring; the audio task moves them
+// into a time-ordered list once per block and applies each one on its exact
+// sample, splitting the block there. Producers serialise on a spinlock
+// among themselves, the audio side never takes it.
+#define AUDIO_EVENT_QUEUE_SIZE 32 // Ring between the control tasks and the audio task, power of two
+#define AUDIO_EVENT_PENDING_MAX 32 // Scheduled but not yet due, held by the audio task
+#define AUDIO_EVENT_NOW 0          // at_sample for "next block boundary", never counted as late or cleared
+#define AUDIO_EVENT_MIX_RAMP 1     // MIX aux: ramp over the rest of the block instead of stepping
+
+typedef enum
+{
+    AUDIO_EVENT_DELAY,    // value: delay in ms
+    AUDIO_EVENT_MIX,      // value: wet share, Q15 0-32768, aux: 0 or AUDIO_EVENT_MIX_RAMP
+    AUDIO_EVENT_GAIN,     // value: output gain, Q15 0-DSP_GAIN_Q15_MAX
+    AUDIO_EVENT_FEEDBACK, // value: feedback Q15, aux: damping Q15
+    AUDIO_EVENT_TYPE_COUNT
+} audio_event_type_t;
+
+typedef struct
+{
+    uint64_t at_sample; // Sample clock value the change applies to
+    uint8_t type;       // audio_event_type_t
+    int32_t value;
+    int32_t aux;
+} audio_event_t;
+
+typedef struct
+{
+    uint32_t scheduled;
+    uint32_t applied;
+    uint32_t late;     // Due before the block they were seen in, applied at its first sample
+    uint32_t dropped;  // Ring or pending list full
+    uint32_t cleared;  // Scheduled changes discarded by audio_events_clear()
+    uint32_t pending;  // Waiting in the ring or the list right now
+} audio_event_stats_t;
+
+typedef struct
+{
+    // Ring, written by control tasks under the lock, read by the audio task
+    audio_event_t ring[AUDIO_EVENT_QUEUE_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    portMUX_TYPE lock;
+    volatile bool clear_request;
+
+    // Audio task only: due order, equal times keep their push order
+    audio_event_t pending[AUDIO_EVENT_PENDING_MAX];
+    uint32_t pending_count;
+
+    audio_event_stats_t stats;
+} audio_event_queue_t;
+
+// Function declarations
+void audio_events_init(audio_event_queue_t *queue);
+esp_err_t audio_events_push(audio_event_queue_t *queue, const audio_event_t *event);
+void audio_events_clear(audio_event_queue_t *queue);
+void audio_events_collect(audio_event_queue_t *queue);
+bool audio_events_pop_due(audio_event_queue_t *queue, uint64_t before_sample, audio_event_t *event);
+uint64_t audio_events_next_time(const audio_event_queue_t *queue);
+void audio_events_get_stats(audio_event_queue_t *queue, audio_event_stats_t *stats);
+
+#endif // AUDIO_EVENTS_H
@@ -0,0 +1,73 @@
+#ifndef AUDIO_GATE_H
+#define AUDIO_GATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// Block-level noise gate, decisions are taken once per I2S block on its peak
+#define AUDIO_GATE_DEFAULT_THRESHOLD 33 // Peak, -60 dBFS
+#define AUDIO_GATE_DEFAULT_HOLD_MS 250
+#define AUDIO_GATE_DEFAULT_RELEASE_MS 50
+#define AUDIO_GATE_ATTACK_SAMPLES 32 // Fade-in when the gate opens, avoids a click
+
+typedef enum
+{
+    AUDIO_GATE_OPEN,    // Peak above threshold
+    AUDIO_GATE_HOLD,    // Below threshold, still passing for the hold time
+    AUDIO_GATE_RELEASE, // Fading out
+    AUDIO_GATE_CLOSED,  // Input is silenced
+} audio_gate_state_t;
+
+typedef struct
+{
+    audio_gate_state_t state;
+    uint32_t total_blocks;
+    uint32_t bypass_blocks;         // Blocks served by the silence bypass
+    float active_cycles_per_sample; // Recent cost of normally processed blocks
+    uint64_t spent_cycles;          // Delay plus chain, all blocks
+    uint64_t saved_cycles;          // Estimated, bypassed blocks at the active cost minus what they took
+    float saved_percent;            // Of what the audio path would have spent without the bypass
+} audio_gate_stats_t;
+
+typedef struct
+{
+    // Parameters, written by the control side
+    volatile int32_t threshold;
+    volatile uint32_t hold_samples;
+    volatile uint32_t release_samples;
+    uint32_t hold_ms;
+    uint32_t release_ms;
+    uint32_t sample_rate;
+
+    // Audio side state
+    audio_gate_state_t state;
+    int32_t gain_q15;
+    uint32_t hold_left;
+
+    // CPU accounting, written by the audio task once per block
+    portMUX_TYPE lock;
+    uint32_t total_blocks;
+    uint32_t bypass_blocks;
+    uint32_t active_cycles_q8; // Per sample, running average of non-bypassed blocks
+    uint64_t spent_cycles;
+    uint64_t saved_cycles;
+} audio_gate_t;
+
+// Function declarations
+esp_err_t audio_gate_init(audio_gate_t *gate, uint32_t sample_rate);
+esp_err_t audio_gate_set_params(audio_gate_t *gate, int16_t threshold, uint32_t hold_ms, uint32_t release_ms);
+esp_err_t audio_gate_set_sample_rate(audio_gate_t *gate, uint32_t sample_rate);
+esp_err_t audio_gate_get_stats(audio_gate_t *gate, audio_gate_stats_t *stats);
+void audio_gate_reset_stats(audio_gate_t *gate);
+void audio_gate_log_report(audio_gate_t *gate);
+
+// Audio task side. process() takes the block's peak from the caller's level pass,
+// applies the gate gain in place and returns true when the gate is closed;
+// a closed block is left for the caller to silence or skip.
+bool audio_gate_process(audio_gate_t *gate, int16_t *block, size_t samples, int32_t peak);
+void audio_gate_account(audio_gate_t *gate, size_t samples, uint32_t cycles, bool bypassed);
+
+#endif // AUDIO_GATE_H
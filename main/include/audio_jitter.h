@@ -0,0 +1,50 @@
+#ifndef AUDIO_JITTER_H
+#define AUDIO_JITTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define AUDIO_JITTER_ANOMALY_COUNT 16   // Recent anomalies kept in the ring
+#define AUDIO_JITTER_ANOMALY_PERCENT 25 // Deviation from the ideal period that counts as an anomaly
+
+// Non-audio activities that may delay the audio task, tagged onto anomalies
+#define AUDIO_JITTER_ACT_DISPLAY (1u << 0) // OLED I2C transfers
+#define AUDIO_JITTER_ACT_NVS (1u << 1)     // NVS writes and commits
+
+// Tag attached to each captured I2S block
+typedef struct
+{
+    uint32_t seq;
+    int64_t timestamp_us; // esp_timer time the read returned
+} audio_block_tag_t;
+
+typedef struct
+{
+    uint32_t seq;
+    int64_t timestamp_us;
+    uint32_t interval_us;  // Time since the previous block
+    int32_t deviation_us;  // interval_us minus the ideal period
+    uint32_t activity;     // AUDIO_JITTER_ACT_* seen during the interval
+} audio_jitter_anomaly_t;
+
+typedef struct
+{
+    uint32_t intervals;
+    uint32_t ideal_period_us;
+    uint32_t mean_interval_us;
+    uint32_t stdev_us;
+    int32_t worst_deviation_us; // Largest deviation by magnitude, signed
+    uint32_t anomaly_count;
+} audio_jitter_stats_t;
+
+// Function declarations
+void audio_jitter_block_arrived(uint32_t samples, uint32_t sample_rate, audio_block_tag_t *tag);
+void audio_jitter_activity_begin(uint32_t activity);
+void audio_jitter_activity_end(uint32_t activity);
+esp_err_t audio_jitter_get_stats(audio_jitter_stats_t *stats);
+size_t audio_jitter_get_anomalies(audio_jitter_anomaly_t *anomalies, size_t max_count);
+void audio_jitter_reset(void);
+void audio_jitter_log_report(void);
+
+#endif // AUDIO_JITTER_H
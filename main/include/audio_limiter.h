@@ -0,0 +1,54 @@
+#ifndef AUDIO_LIMITER_H
+#define AUDIO_LIMITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "audio_delay.h"
+
+// Gain is computed per chunk of output samples and ramped linearly inside it
+#define AUDIO_LIMITER_CHUNK 32
+#define AUDIO_LIMITER_MAX_LOOKAHEAD_CHUNKS 30 // 960 samples, 5 ms at 192 kHz
+#define AUDIO_LIMITER_PEAK_SLOTS (AUDIO_LIMITER_MAX_LOOKAHEAD_CHUNKS + 2)
+
+#define AUDIO_LIMITER_DEFAULT_CEILING 29205 // -1 dBFS
+#define AUDIO_LIMITER_DEFAULT_LOOKAHEAD_MS 2
+#define AUDIO_LIMITER_DEFAULT_RELEASE_MS 80
+
+typedef struct
+{
+    // The delay line supplies the lookahead: samples between its read and
+    // write heads are the future of the block this stage is limiting
+    audio_delay_t *delay;
+
+    // Parameters, written by the control side
+    volatile int32_t ceiling;
+    volatile uint32_t lookahead_chunks;
+    volatile int32_t release_q15; // Per-chunk release coefficient
+    uint32_t lookahead_ms;
+    uint32_t release_ms;
+    uint32_t sample_rate;
+
+    // Audio side state, positions count output samples since start
+    int32_t gain_q15;
+    uint32_t out_pos;
+    uint32_t scan_pos;
+    uint32_t expected_read_index;
+    bool primed;
+    int16_t chunk_peak[AUDIO_LIMITER_PEAK_SLOTS]; // Ring peak per chunk, indexed by chunk number
+
+    // Statistics, written by the audio task only
+    volatile uint32_t limited_chunks;
+} audio_limiter_t;
+
+// Function declarations
+esp_err_t audio_limiter_init(audio_limiter_t *lim, audio_delay_t *delay, uint32_t sample_rate);
+esp_err_t audio_limiter_set_params(audio_limiter_t *lim, int16_t ceiling, uint32_t lookahead_ms, uint32_t release_ms);
+esp_err_t audio_limiter_set_sample_rate(audio_limiter_t *lim, uint32_t sample_rate);
+int32_t audio_limiter_get_gain(const audio_limiter_t *lim);
+
+// Chain stage entry point, runs in place and must be the last stage
+void audio_limiter_process_block(void *ctx, const int16_t *in, int16_t *out, size_t samples);
+
+#endif // AUDIO_LIMITER_H
@@ -0,0 +1,41 @@
+#ifndef AUDIO_METER_H
+#define AUDIO_METER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Levels are accumulated per block and published at this interval
+#define AUDIO_METER_PUBLISH_MS 50
+#define AUDIO_METER_READ_RETRIES 8 // Snapshot reads racing a publish before giving up
+
+// Metering points in the audio path
+typedef enum
+{
+    AUDIO_METER_INPUT,  // I2S input, before the gate
+    AUDIO_METER_OUTPUT, // Delayed output after the DSP chain, as written to I2S
+    AUDIO_METER_POINT_COUNT
+} audio_meter_point_t;
+
+// Linear levels, 32768 is a full-scale square wave
+typedef struct
+{
+    uint16_t peak;
+    uint16_t rms;
+} audio_meter_level_t;
+
+typedef struct
+{
+    audio_meter_level_t level[AUDIO_METER_POINT_COUNT];
+    uint32_t seq; // Publish count, unchanged means nothing new
+} audio_meter_snapshot_t;
+
+// Audio task side: add a measured block, then close the block once all points are in
+void audio_meter_add(audio_meter_point_t point, int32_t peak, uint64_t sum_sq, size_t samples);
+void audio_meter_block_done(size_t samples, uint32_t sample_rate);
+
+// Any task, lock-free
+esp_err_t audio_meter_get_snapshot(audio_meter_snapshot_t *snapshot);
+float audio_meter_level_to_dbfs(uint16_t level);
+
+#endif // AUDIO_METER_H
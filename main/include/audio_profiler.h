@@ -0,0 +1,57 @@
+#ifndef AUDIO_PROFILER_H
+#define AUDIO_PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_cpu.h"
+
+// Set to 0 to compile the profiler out of the audio path entirely
+#ifndef AUDIO_PROFILER_ENABLED
+#define AUDIO_PROFILER_ENABLED 1
+#endif
+
+// log2 histogram, bucket n counts blocks that took [2^n, 2^(n+1)) cycles
+#define AUDIO_PROFILER_BUCKETS 32
+
+// Profiled stages of the audio path
+typedef enum
+{
+    AUDIO_PROF_PROCESS, // audio_delay_process
+    AUDIO_PROF_CHAIN,   // DSP stage chain after the delay
+    AUDIO_PROF_LOOP,    // audio_delay_task iteration, from read return to write return
+    AUDIO_PROF_STAGE_COUNT
+} audio_prof_stage_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint32_t max_block_seq;   // audio_block_tag_t seq of the block that took max_cycles
+    uint32_t avg_cycles;
+    uint32_t p99_cycles;      // Upper bound of the histogram bucket holding the 99th percentile
+    uint32_t deadline_cycles; // One block period at the current sample rate and CPU clock
+    float avg_load_percent;   // Share of the block deadline
+    float p99_load_percent;
+    float max_load_percent;
+    uint32_t histogram[AUDIO_PROFILER_BUCKETS];
+} audio_prof_summary_t;
+
+#if AUDIO_PROFILER_ENABLED
+#define AUDIO_PROF_START() esp_cpu_get_cycle_count()
+#define AUDIO_PROF_END(stage, start) audio_profiler_record((stage), esp_cpu_get_cycle_count() - (start))
+#else
+#define AUDIO_PROF_START() 0
+#define AUDIO_PROF_END(stage, start) ((void)(start))
+#endif
+
+// Function declarations
+void audio_profiler_record(audio_prof_stage_t stage, uint32_t cycles);
+void audio_profiler_set_block(uint32_t samples, uint32_t sample_rate, uint32_t seq);
+esp_err_t audio_profiler_get_summary(audio_prof_stage_t stage, audio_prof_summary_t *summary);
+const char *audio_profiler_stage_name(audio_prof_stage_t stage);
+void audio_profiler_reset(void);
+void audio_profiler_log_report(void);
+
+#endif // AUDIO_PROFILER_H
@@ -0,0 +1,109 @@
+#ifndef CONSOLE_COMMANDS_H
+#define CONSOLE_COMMANDS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Text commands for runtime control and inspection. Parsing and the
+// handlers only use the C library and the operations below, so the same
+// code runs behind esp_console on UART0 and on a host through
+// tools/console_host.c. Nothing here touches the audio path directly: every
+// change goes through the operations, which the firmware routes through
+// ui_manager like an encoder turn.
+#define CONSOLE_LINE_MAX 128
+#define CONSOLE_ARGS_MAX 8
+#define CONSOLE_CALIBRATE_DEFAULT_S 5
+#define CONSOLE_CALIBRATE_MAX_S 60
+#define CONSOLE_BENCH_MAX_BLOCK 4096
+#define CONSOLE_EQ_DEFAULT_Q 0.707f
+#define CONSOLE_FEEDBACK_Q15_MAX 32767 // Echo feedback and damping, |value| below 1.0
+
+// Results of console_commands_run_line() and of the handlers
+#define CONSOLE_OK 0
+#define CONSOLE_ERR_UNKNOWN 1 // No such command
+#define CONSOLE_ERR_USAGE 2   // Bad arguments
+#define CONSOLE_ERR_FAILED 3  // The operation refused or failed
+
+// Parameters the cue command can schedule
+typedef enum
+{
+    CONSOLE_CUE_DELAY,    // ms
+    CONSOLE_CUE_MIX,      // Wet percent
+    CONSOLE_CUE_GAIN,     // Output gain percent
+    CONSOLE_CUE_FEEDBACK, // Echo feedback Q15 0-32767, 0 ends the echo; damping stays as set
+} console_cue_param_t;
+
+// Band types for the eq command, same order as the firmware's filter types
+typedef enum
+{
+    CONSOLE_EQ_LOWPASS,
+    CONSOLE_EQ_HIGHPASS,
+    CONSOLE_EQ_PEAKING,
+    CONSOLE_EQ_LOWSHELF,
+    CONSOLE_EQ_HIGHSHELF,
+    CONSOLE_EQ_NOTCH,
+} console_eq_type_t;
+
+// Sources for the gen command, same order as the firmware's generator types
+typedef enum
+{
+    CONSOLE_GEN_OFF, // I2S input
+    CONSOLE_GEN_SINE,
+    CONSOLE_GEN_SWEEP,   // From hz up to 20 kHz
+    CONSOLE_GEN_IMPULSE, // hz impulses per second
+    CONSOLE_GEN_WHITE,
+    CONSOLE_GEN_PINK,
+    CONSOLE_GEN_MLS,
+} console_gen_type_t;
+
+// Operations return 0 on success. Any of them may be NULL, the command then reports it as unavailable.
+typedef struct
+{
+    uint32_t (*get_delay_ms)(void);
+    int (*set_delay_ms)(uint32_t delay_ms);
+    uint32_t (*get_sample_rate)(void);
+    int (*set_sample_rate)(uint32_t sample_rate);
+    uint32_t (*get_mix_percent)(void);
+    int (*set_mix_percent)(uint32_t mix_percent);
+    void (*get_feedback)(int32_t *feedback_q15, int32_t *damping_q15);
+    int (*set_feedback)(int32_t feedback_q15, int32_t damping_q15);
+    void (*metrics_report)(void);
+    void (*metrics_reset)(void);
+    void (*trace_dump)(void);
+    void (*trace_clear)(void);
+    void (*trace_enable)(bool enabled);
+    void (*tasks_report)(void);
+    int (*preset_save)(uint32_t slot);
+    int (*preset_load)(uint32_t slot);
+    uint32_t preset_slots;
+    int (*calibrate)(uint32_t seconds);
+    int (*cue)(console_cue_param_t param, uint32_t value, uint32_t at_ms); // at_ms after the cue start
+    void (*cue_start)(void);
+    void (*cue_clear)(void);
+    void (*cue_report)(void);
+    int (*bench)(const char *suite, uint32_t block_samples); // block_samples 0 for the default
+    int (*eq_add)(console_eq_type_t type, uint32_t freq_hz, float q, float gain_db); // Appends one band
+    int (*eq_clear)(void);
+    void (*eq_report)(void);
+    int (*gen_set)(console_gen_type_t type, uint32_t freq_hz, uint32_t level_percent); // 0 keeps the current value
+    void (*gen_report)(void);
+} console_ops_t;
+
+typedef int (*console_handler_t)(int argc, char **argv);
+
+typedef struct
+{
+    const char *name;
+    const char *hint; // Arguments, for help
+    const char *help;
+    console_handler_t handler;
+} console_command_t;
+
+// Function declarations
+void console_commands_init(const console_ops_t *ops, FILE *out);
+const console_command_t *console_commands_table(size_t *count);
+int console_commands_run_line(const char *line);
+
+#endif // CONSOLE_COMMANDS_H
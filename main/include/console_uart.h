@@ -0,0 +1,14 @@
+#ifndef CONSOLE_UART_H
+#define CONSOLE_UART_H
+
+#include "esp_err.h"
+#include "console_commands.h"
+
+// Interactive shell on the console UART (UART0), one esp_console command per
+// console_commands table entry. Log output shares the port.
+#define CONSOLE_UART_PROMPT "delay> "
+
+// Function declarations
+esp_err_t console_uart_start(const console_ops_t *ops);
+
+#endif // CONSOLE_UART_H
@@ -0,0 +1,147 @@
+#ifndef CONTROL_PROTOCOL_H
+#define CONTROL_PROTOCOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Binary control and telemetry protocol for test rigs. Like the console
+// commands this only uses the C library, so the firmware (UART1, through
+// control_uart.c) and the host tools (tools/control_client.c) share the
+// framing, the parser and the dispatcher.
+//
+// Frame: SOF, length, type, sequence, payload[length], CRC-16 (LSB first).
+// The CRC is CRC-16/CCITT-FALSE over length, type, sequence and payload.
+// Multi-byte payload fields are little-endian.
+#define CONTROL_SOF 0xA5
+#define CONTROL_PAYLOAD_MAX 96
+#define CONTROL_HEADER_SIZE 4 // SOF, length, type, sequence
+#define CONTROL_CRC_SIZE 2
+#define CONTROL_FRAME_MAX (CONTROL_HEADER_SIZE + CONTROL_PAYLOAD_MAX + CONTROL_CRC_SIZE)
+
+#define CONTROL_STREAM_MIN_MS 10 // Fastest telemetry rate a rig may ask for
+#define CONTROL_STREAM_MAX_MS 60000
+#define CONTROL_TELEMETRY_MAX_VALUES ((CONTROL_PAYLOAD_MAX - 5) / 4)
+
+typedef enum
+{
+    // Host to device
+    CONTROL_MSG_PING = 0x01,      // Any payload, echoed back in a PONG
+    CONTROL_MSG_SET_PARAM = 0x02, // u8 param, u32 value; answered with an ACK
+    CONTROL_MSG_GET_PARAM = 0x03, // u8 param; answered with an ACK
+    CONTROL_MSG_STREAM = 0x04,    // u16 interval ms, 0 stops; answered with an ACK
+    // Device to host
+    CONTROL_MSG_PONG = 0x81,
+    CONTROL_MSG_ACK = 0x82,       // u8 request type, u8 status, u8 param, u32 value
+    CONTROL_MSG_TELEMETRY = 0x83, // u32 time ms, u8 count, u32 values[count]
+} control_msg_type_t;
+
+typedef enum
+{
+    CONTROL_PARAM_DELAY_MS = 0,
+    CONTROL_PARAM_SAMPLE_RATE = 1,
+    CONTROL_PARAM_MIX_PERCENT = 2,
+    CONTROL_PARAM_HIGHPASS_HZ = 3,       // EQ high-pass corner, 0 for none
+    CONTROL_PARAM_GEN_TYPE = 4,          // Test source replacing the input, 0 off (see signal_gen_type_t)
+    CONTROL_PARAM_GEN_FREQ_HZ = 5,       // Sine frequency, sweep start or impulse rate
+    CONTROL_PARAM_GEN_LEVEL_PERCENT = 6, // Peak, percent of full scale
+    CONTROL_PARAM_FEEDBACK_Q15 = 7,      // Echo feedback, signed -32767-32767 as two's complement, 0 for none
+    CONTROL_PARAM_DAMPING_Q15 = 8,       // Low-pass in the echo loop, 0-32767
+    CONTROL_PARAM_COUNT
+} control_param_t;
+
+typedef enum
+{
+    CONTROL_STATUS_OK = 0,
+    CONTROL_STATUS_BAD_PARAM = 1, // Unknown parameter
+    CONTROL_STATUS_REJECTED = 2,  // Value out of range or refused
+    CONTROL_STATUS_BAD_FRAME = 3, // Unknown type or wrong payload length
+} control_status_t;
+
+typedef struct
+{
+    uint8_t type;
+    uint8_t seq;
+    uint8_t length;
+    uint8_t payload[CONTROL_PAYLOAD_MAX];
+} control_frame_t;
+
+typedef enum
+{
+    CONTROL_PARSE_SOF,
+    CONTROL_PARSE_LENGTH,
+    CONTROL_PARSE_TYPE,
+    CONTROL_PARSE_SEQ,
+    CONTROL_PARSE_PAYLOAD,
+    CONTROL_PARSE_CRC_LO,
+    CONTROL_PARSE_CRC_HI
+} control_parse_state_t;
+
+// Byte-at-a-time parser; the frame being assembled lives inside it
+typedef struct
+{
+    control_parse_state_t state;
+    control_frame_t frame;
+    uint8_t received;
+    uint16_t crc;
+    uint16_t crc_rx;
+    uint32_t frames;
+    uint32_t crc_errors;
+    uint32_t skipped; // Bytes thrown away while hunting for SOF
+} control_parser_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t crc_errors;
+    uint32_t skipped;
+    uint32_t bad_frames; // Well formed, but not a request this end understands
+    uint32_t telemetry_sent;
+} control_stats_t;
+
+// Device side operations. Setters return 0 on success; write sends raw bytes.
+typedef struct
+{
+    int (*get_param)(control_param_t param, uint32_t *value);
+    int (*set_param)(control_param_t param, uint32_t value);
+    size_t (*telemetry)(uint32_t *values, size_t max); // Fills up to max values, returns the count
+    void (*write)(const uint8_t *data, size_t length);
+} control_ops_t;
+
+static inline void control_put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void control_put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint16_t control_get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t control_get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Function declarations
+uint16_t control_crc16(uint16_t crc, const uint8_t *data, size_t length);
+size_t control_frame_encode(uint8_t type, uint8_t seq, const uint8_t *payload, size_t length, uint8_t *out,
+                            size_t out_size);
+void control_parser_init(control_parser_t *parser);
+const control_frame_t *control_parser_feed(control_parser_t *parser, uint8_t byte);
+
+void control_protocol_init(const control_ops_t *ops);
+void control_protocol_receive(const uint8_t *data, size_t length);
+uint32_t control_protocol_poll(uint32_t now_ms);
+void control_protocol_get_stats(control_stats_t *stats);
+
+#endif // CONTROL_PROTOCOL_H
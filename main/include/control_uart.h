@@ -0,0 +1,24 @@
+#ifndef CONTROL_UART_H
+#define CONTROL_UART_H
+
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "control_protocol.h"
+
+// Binary control protocol on UART1, next to the text console on UART0.
+// One task on the control core reads whatever has arrived, dispatches it
+// and sends telemetry snapshots when they are due.
+#define CONTROL_UART_PORT UART_NUM_1
+#define CONTROL_UART_TX_PIN GPIO_NUM_14
+#define CONTROL_UART_RX_PIN GPIO_NUM_15
+#define CONTROL_UART_BAUD 921600
+#define CONTROL_UART_RX_BUFFER 512
+#define CONTROL_UART_TX_BUFFER 1024       // Replies and telemetry are queued, the task never waits for the wire
+#define CONTROL_UART_RX_TIMEOUT_SYMBOLS 2 // Hand a short frame over 2 byte times after its last byte
+#define CONTROL_UART_IDLE_MS 1000         // Longest sleep while nothing is streaming
+
+// Function declarations
+esp_err_t control_uart_start(const control_ops_t *ops);
+void control_uart_log_report(void);
+
+#endif // CONTROL_UART_H
@@ -0,0 +1,97 @@
+#ifndef DSP_BACKEND_H
+#define DSP_BACKEND_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dsp_kernels.h"
+
+// Processing stages exist in a fixed-point (Q15/Q30 integer) and a
+// single-precision float backend with identical APIs: int16 blocks in and
+// out, parameters in the same Q15 units the control side already uses.
+// Only the arithmetic differs. Both are always compiled so the bench can
+// compare them; DSP_BACKEND picks the one the audio path calls through the
+// dsp_backend_* names. The biquad section pair lives in dsp_biquad.h.
+//
+// The switch covers the output gain (skipped at unity), the gate's gain
+// below unity and the EQ sections (when bands are set). The delay line,
+// its wet/dry mix and the echo feedback with its damping stay fixed point
+// in both builds: the mix runs at the unity gain of 32768 that the int16
+// mix gains cannot hold, and the damping filter is fused into the
+// per-sample feedback loop. Mix and one-pole exist here for the bench.
+#define DSP_BACKEND_FIXED 0
+#define DSP_BACKEND_FLOAT 1
+
+// Set to DSP_BACKEND_FLOAT to run the audio path on the FPU
+#ifndef DSP_BACKEND
+#define DSP_BACKEND DSP_BACKEND_FIXED
+#endif
+
+#define DSP_FLOAT_TINY 1e-20f // Float filter state below this is flushed to zero between blocks
+
+// One-pole low-pass y += (x - y) * alpha, the echo damping filter as a stage
+typedef struct
+{
+    int32_t y;
+} dsp_fixed_onepole_state_t;
+
+typedef struct
+{
+    float y;
+} dsp_float_onepole_state_t;
+
+// Fixed-point backend, the existing kernels
+static inline void dsp_fixed_gain(const int16_t *in, int16_t *out, size_t samples, int32_t gain_q15)
+{
+    dsp_gain_q15_s16(in, out, samples, gain_q15);
+}
+
+static inline void dsp_fixed_mix(const int16_t *a, const int16_t *b, int16_t *out, size_t samples,
+                                 int16_t gain_a_q15, int16_t gain_b_q15)
+{
+    dsp_mix_s16(a, b, out, samples, gain_a_q15, gain_b_q15);
+}
+
+static inline void dsp_fixed_crossfade(const int16_t *a, const int16_t *b, int16_t *out, size_t samples,
+                                       int32_t start_q15, int32_t end_q15)
+{
+    dsp_crossfade_s16(a, b, out, samples, start_q15, end_q15);
+}
+
+void dsp_fixed_onepole(dsp_fixed_onepole_state_t *state, const int16_t *in, int16_t *out, size_t samples,
+                       int32_t alpha_q15);
+
+// Float backend: samples and parameters are converted on the way in, results
+// are rounded to nearest and saturated on the way out
+void dsp_float_gain(const int16_t *in, int16_t *out, size_t samples, int32_t gain_q15);
+void dsp_float_mix(const int16_t *a, const int16_t *b, int16_t *out, size_t samples,
+                   int16_t gain_a_q15, int16_t gain_b_q15);
+void dsp_float_crossfade(const int16_t *a, const int16_t *b, int16_t *out, size_t samples,
+                         int32_t start_q15, int32_t end_q15);
+void dsp_float_onepole(dsp_float_onepole_state_t *state, const int16_t *in, int16_t *out, size_t samples,
+                       int32_t alpha_q15);
+
+static inline int16_t dsp_float_to_s16(float y)
+{
+    y = y > (float)INT16_MAX ? (float)INT16_MAX : (y < (float)INT16_MIN ? (float)INT16_MIN : y);
+    return (int16_t)(y < 0.0f ? y - 0.5f : y + 0.5f);
+}
+
+#if DSP_BACKEND == DSP_BACKEND_FLOAT
+#define DSP_BACKEND_NAME "float"
+typedef dsp_float_onepole_state_t dsp_backend_onepole_state_t;
+#define dsp_backend_gain dsp_float_gain
+#define dsp_backend_mix dsp_float_mix
+#define dsp_backend_crossfade dsp_float_crossfade
+#define dsp_backend_onepole dsp_float_onepole
+#elif DSP_BACKEND == DSP_BACKEND_FIXED
+#define DSP_BACKEND_NAME "fixed"
+typedef dsp_fixed_onepole_state_t dsp_backend_onepole_state_t;
+#define dsp_backend_gain dsp_fixed_gain
+#define dsp_backend_mix dsp_fixed_mix
+#define dsp_backend_crossfade dsp_fixed_crossfade
+#define dsp_backend_onepole dsp_fixed_onepole
+#else
+#error "DSP_BACKEND must be DSP_BACKEND_FIXED or DSP_BACKEND_FLOAT"
+#endif
+
+#endif // DSP_BACKEND_H
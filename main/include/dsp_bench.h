@@ -0,0 +1,36 @@
+#ifndef DSP_BENCH_H
+#define DSP_BENCH_H
+
+#include <stddef.h>
+#include "esp_err.h"
+
+#define DSP_BENCH_DEFAULT_BLOCK 1024
+#define DSP_BENCH_ITERATIONS 16 // Best-of runs per measurement
+#define DSP_BENCH_BIQUAD_MAX_ERR_LSB 6.0 // Per section, against a double-precision run of the same coefficients
+#define DSP_BENCH_FFT_MAX_ERR_DB -90.0   // Worst bin error against a double DFT, relative to a full-scale bin
+#define DSP_BENCH_DITHER_MAX_BIAS_LSB 0.01 // Mean of a dithered sub-LSB constant against its true value
+#define DSP_BENCH_GEN_MAX_LEVEL_ERR_DB 0.05 // Sine RMS against amplitude / sqrt(2)
+
+// Function declarations
+esp_err_t dsp_bench_verify_kernels(void);
+esp_err_t dsp_bench_run_kernels(size_t block_samples);
+esp_err_t dsp_bench_verify_biquad(void);
+esp_err_t dsp_bench_run_biquad(size_t block_samples);
+esp_err_t dsp_bench_verify_fft(void);
+esp_err_t dsp_bench_run_fft(void);
+esp_err_t dsp_bench_verify_signal_gen(void);
+esp_err_t dsp_bench_run_signal_gen(size_t block_samples);
+esp_err_t dsp_bench_verify_convert(void);
+esp_err_t dsp_bench_run_convert(void);
+esp_err_t dsp_bench_run_backends(size_t block_samples);
+esp_err_t dsp_bench_verify_delay(void);
+esp_err_t dsp_bench_run_delay(size_t block_samples);
+
+// Named suites (verify, then time) for the console and tools/dsp_host.c.
+// name NULL or "all" runs every suite; block_samples 0 is DSP_BENCH_DEFAULT_BLOCK.
+// Returns the first failure, ESP_ERR_NOT_FOUND for an unknown name.
+size_t dsp_bench_suite_count(void);
+const char *dsp_bench_suite_name(size_t index);
+esp_err_t dsp_bench_run_suite(const char *name, size_t block_samples);
+
+#endif // DSP_BENCH_H
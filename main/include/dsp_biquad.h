@@ -0,0 +1,121 @@
+#ifndef DSP_BIQUAD_H
+#define DSP_BIQUAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "dsp_backend.h"
+
+#define DSP_BIQUAD_MAX_SECTIONS 8
+
+// Coefficients are Q2.30 in int32 (range [-2, 2)); a0 is normalised away.
+// Each product keeps its high word, so the accumulator holds the output in Q14.
+#define DSP_BIQUAD_COEF_SHIFT 30
+#define DSP_BIQUAD_COEF_ONE (1 << DSP_BIQUAD_COEF_SHIFT)
+#define DSP_BIQUAD_ACC_SHIFT 14
+
+// Band gains are limited so a section never needs more than 4x headroom in the accumulator
+#define DSP_BIQUAD_GAIN_DB_MAX 12.0f
+
+typedef enum
+{
+    DSP_BIQUAD_LOWPASS,
+    DSP_BIQUAD_HIGHPASS,
+    DSP_BIQUAD_PEAKING,
+    DSP_BIQUAD_LOWSHELF,
+    DSP_BIQUAD_HIGHSHELF,
+    DSP_BIQUAD_NOTCH
+} dsp_biquad_type_t;
+
+// One EQ band as the user sees it
+typedef struct
+{
+    dsp_biquad_type_t type;
+    float freq_hz;
+    float q;
+    float gain_db; // Peaking and shelf types only
+} dsp_biquad_band_t;
+
+// y = b0*x0 + b1*x1 + b2*x2 - a1*y1 - a2*y2
+typedef struct
+{
+    int32_t b0;
+    int32_t b1;
+    int32_t b2;
+    int32_t a1;
+    int32_t a2;
+} dsp_biquad_coefs_t;
+
+typedef struct
+{
+    size_t sections;
+    dsp_biquad_coefs_t coefs[DSP_BIQUAD_MAX_SECTIONS];
+} dsp_biquad_bank_t;
+
+// Direct Form I history plus the last two truncation residuals for error feedback
+typedef struct
+{
+    int32_t x1;
+    int32_t x2;
+    int32_t y1;
+    int32_t y2;
+    int32_t e1;
+    int32_t e2;
+} dsp_biquad_state_t;
+
+// Float backend section state, transposed direct form II
+typedef struct
+{
+    float s1;
+    float s2;
+} dsp_biquad_state_f32_t;
+
+#if DSP_BACKEND == DSP_BACKEND_FLOAT
+typedef dsp_biquad_state_f32_t dsp_backend_biquad_state_t;
+#define dsp_backend_biquad_section dsp_biquad_section_f32
+#else
+typedef dsp_biquad_state_t dsp_backend_biquad_state_t;
+#define dsp_backend_biquad_section dsp_biquad_section_s16
+#endif
+
+typedef struct
+{
+    // Double-buffered coefficients: the control side fills the inactive bank
+    // and publishes it by flipping active_bank, the audio side picks the
+    // flip up at the next block and acknowledges it in running_bank.
+    dsp_biquad_bank_t banks[2];
+    volatile uint32_t active_bank;
+    volatile uint32_t running_bank;
+    size_t running_sections;
+
+    dsp_backend_biquad_state_t state[DSP_BIQUAD_MAX_SECTIONS];
+
+    // Control side copy of the design, redesigned on sample rate changes
+    dsp_biquad_band_t bands[DSP_BIQUAD_MAX_SECTIONS];
+    size_t band_count;
+    uint32_t sample_rate;
+} dsp_biquad_t;
+
+// Function declarations
+esp_err_t dsp_biquad_init(dsp_biquad_t *eq, uint32_t sample_rate);
+esp_err_t dsp_biquad_design(const dsp_biquad_band_t *band, uint32_t sample_rate, dsp_biquad_coefs_t *coefs);
+esp_err_t dsp_biquad_set_bands(dsp_biquad_t *eq, const dsp_biquad_band_t *bands, size_t band_count);
+esp_err_t dsp_biquad_set_sample_rate(dsp_biquad_t *eq, uint32_t sample_rate);
+esp_err_t dsp_biquad_load_bank(dsp_biquad_t *eq, const dsp_biquad_bank_t *bank);
+void dsp_biquad_reset(dsp_biquad_t *eq);
+
+// Chain stage entry point, runs in place
+void dsp_biquad_process_block(void *ctx, const int16_t *in, int16_t *out, size_t samples);
+
+// Single section kernels, the optimised one must match the reference bit for bit
+void dsp_biquad_section_s16(const dsp_biquad_coefs_t *coefs, dsp_biquad_state_t *state,
+                            const int16_t *in, int16_t *out, size_t samples);
+void dsp_biquad_section_s16_ref(const dsp_biquad_coefs_t *coefs, dsp_biquad_state_t *state,
+                                const int16_t *in, int16_t *out, size_t samples);
+
+// Float backend section on the same Q2.30 coefficients, so both backends run the identical filter
+void dsp_biquad_section_f32(const dsp_biquad_coefs_t *coefs, dsp_biquad_state_f32_t *state,
+                            const int16_t *in, int16_t *out, size_t samples);
+
+#endif // DSP_BIQUAD_H
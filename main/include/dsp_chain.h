@@ -0,0 +1,56 @@
+#ifndef DSP_CHAIN_H
+#define DSP_CHAIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define DSP_CHAIN_MAX_STAGES 8
+
+// Block processing callback. out may equal in when the stage is registered as in-place.
+typedef void (*dsp_process_fn_t)(void *ctx, const int16_t *in, int16_t *out, size_t samples);
+
+typedef struct
+{
+    const char *name;
+    dsp_process_fn_t process_block;
+    void *ctx;
+    bool in_place;
+    volatile bool bypass;
+
+    // Cycle accounting, written by the audio task only
+    uint32_t blocks;
+    uint32_t last_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+} dsp_stage_t;
+
+typedef struct
+{
+    const char *name;
+    bool bypass;
+    uint32_t blocks;
+    uint32_t last_cycles;
+    uint32_t max_cycles;
+    uint32_t avg_cycles;
+} dsp_stage_stats_t;
+
+typedef struct
+{
+    dsp_stage_t stages[DSP_CHAIN_MAX_STAGES];
+    size_t stage_count;
+    int16_t *scratch; // Ping-pong buffer for stages that cannot run in place
+    size_t max_block;
+} dsp_chain_t;
+
+// Function declarations
+esp_err_t dsp_chain_init(dsp_chain_t *chain, size_t max_block);
+esp_err_t dsp_chain_deinit(dsp_chain_t *chain);
+esp_err_t dsp_chain_add_stage(dsp_chain_t *chain, const char *name, dsp_process_fn_t process_block,
+                              void *ctx, bool in_place, int *stage_index);
+esp_err_t dsp_chain_set_bypass(dsp_chain_t *chain, int stage_index, bool bypass);
+esp_err_t dsp_chain_process(dsp_chain_t *chain, int16_t *buffer, size_t samples);
+esp_err_t dsp_chain_get_stage_stats(dsp_chain_t *chain, int stage_index, dsp_stage_stats_t *stats);
+
+#endif // DSP_CHAIN_H
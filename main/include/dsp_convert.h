@@ -0,0 +1,73 @@
+#ifndef DSP_CONVERT_H
+#define DSP_CONVERT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Sample format conversion between I2S slots and internal storage.
+// s16 is int16_t, s24 is a 24-bit value right-justified and sign-extended
+// in an int32_t, s32 uses the full int32_t. Slots are 32 bits wide with the
+// sample left-justified (MSB in bit 31), as the codec sends 24-bit data.
+// Widening is exact; narrowing rounds to nearest or dithers, never truncates.
+// Every kernel works in place: out may start at the same address as in, the
+// widening ones run from the end of the block for that.
+
+typedef enum
+{
+    DSP_DITHER_NONE,   // Round to nearest
+    DSP_DITHER_TPDF,   // Triangular dither, +-1 output LSB peak
+    DSP_DITHER_SHAPED, // TPDF with first-order error feedback, noise moved towards Nyquist
+} dsp_dither_mode_t;
+
+// Per-channel narrowing state, keep one for each stream being converted
+typedef struct
+{
+    dsp_dither_mode_t mode;
+    uint32_t rng;   // xorshift32, never 0
+    int32_t error;  // Last quantisation error in input units, shaped mode only
+} dsp_dither_t;
+
+void dsp_dither_init(dsp_dither_t *dither, dsp_dither_mode_t mode, uint32_t seed);
+
+// Widening
+void dsp_convert_s16_to_s24(const int16_t *in, int32_t *out, size_t samples);
+void dsp_convert_s16_to_s32(const int16_t *in, int32_t *out, size_t samples);
+void dsp_convert_s24_to_s32(const int32_t *in, int32_t *out, size_t samples);
+
+// s32 to s24, round to nearest and saturate; the codec's noise floor is far above a 24-bit LSB
+void dsp_convert_s32_to_s24(const int32_t *in, int32_t *out, size_t samples);
+
+// Narrowing to s16 through the dither state
+void dsp_convert_s24_to_s16(dsp_dither_t *dither, const int32_t *in, int16_t *out, size_t samples);
+void dsp_convert_s32_to_s16(dsp_dither_t *dither, const int32_t *in, int16_t *out, size_t samples);
+
+// One channel of interleaved 32-bit slots to a right-justified value of bits (8-32) width.
+// frames counts frames, not slots; channels 1 for mono slots, 2 for stereo.
+void dsp_convert_unpack_slot32(const int32_t *slots, int32_t *out, size_t frames, size_t channels,
+                               size_t channel, uint32_t bits);
+
+// Right-justified values of bits width into every channel of interleaved 32-bit slots
+void dsp_convert_pack_slot32(const int32_t *in, int32_t *slots, size_t frames, size_t channels, uint32_t bits);
+
+// One channel of interleaved frames
+void dsp_convert_extract_s16(const int16_t *frames_in, int16_t *out, size_t frames, size_t channels,
+                             size_t channel);
+void dsp_convert_extract_s32(const int32_t *frames_in, int32_t *out, size_t frames, size_t channels,
+                             size_t channel);
+
+// Portable reference implementations, the optimised kernels above must match them bit for bit
+void dsp_convert_s16_to_s24_ref(const int16_t *in, int32_t *out, size_t samples);
+void dsp_convert_s16_to_s32_ref(const int16_t *in, int32_t *out, size_t samples);
+void dsp_convert_s24_to_s32_ref(const int32_t *in, int32_t *out, size_t samples);
+void dsp_convert_s32_to_s24_ref(const int32_t *in, int32_t *out, size_t samples);
+void dsp_convert_s24_to_s16_ref(dsp_dither_t *dither, const int32_t *in, int16_t *out, size_t samples);
+void dsp_convert_s32_to_s16_ref(dsp_dither_t *dither, const int32_t *in, int16_t *out, size_t samples);
+void dsp_convert_unpack_slot32_ref(const int32_t *slots, int32_t *out, size_t frames, size_t channels,
+                                   size_t channel, uint32_t bits);
+void dsp_convert_pack_slot32_ref(const int32_t *in, int32_t *slots, size_t frames, size_t channels, uint32_t bits);
+void dsp_convert_extract_s16_ref(const int16_t *frames_in, int16_t *out, size_t frames, size_t channels,
+                                 size_t channel);
+void dsp_convert_extract_s32_ref(const int32_t *frames_in, int32_t *out, size_t frames, size_t channels,
+                                 size_t channel);
+
+#endif // DSP_CONVERT_H
@@ -0,0 +1,31 @@
+#ifndef DSP_FFT_H
+#define DSP_FFT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Fixed-point real FFT: an N/2-point complex radix-2 transform plus a split pass.
+// No per-stage scaling; int16-range input grows by at most log2(N) + 1 bits,
+// which int32 holds for every supported size.
+#define DSP_FFT_MIN_BITS 8  // 256 points
+#define DSP_FFT_MAX_BITS 10 // 1024 points
+
+typedef struct
+{
+    uint32_t size;     // Real input points
+    uint32_t bits;
+    int16_t *cos_q15;  // W_N^k = cos - j*sin for k < N/2, Q15
+    int16_t *sin_q15;
+    uint16_t *bitrev;  // Permutation for the N/2-point complex stage
+} dsp_fft_real_t;
+
+// Function declarations
+esp_err_t dsp_fft_real_init(dsp_fft_real_t *fft, uint32_t size);
+void dsp_fft_real_deinit(dsp_fft_real_t *fft);
+
+// In place on size int32 values. Output is packed: buf[0] = 2*X[0], buf[1] = 2*X[N/2],
+// then re/im pairs of 2*X[k] for k = 1..N/2-1.
+void dsp_fft_real_s32(const dsp_fft_real_t *fft, int32_t *buf);
+
+#endif // DSP_FFT_H
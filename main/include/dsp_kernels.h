@@ -0,0 +1,64 @@
+#ifndef DSP_KERNELS_H
+#define DSP_KERNELS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Q15 fixed point: 32768 is 1.0
+#define DSP_Q15_ONE 32768
+#define DSP_GAIN_Q15_MAX 65535 // Just under +6 dB, keeps the int16 product inside 32 bits
+#define DSP_GAIN_Q15_MIN (-65535)
+
+// All kernels round to nearest and saturate to the output width.
+// in and out may be the same buffer.
+
+// out = in * gain
+void dsp_gain_q15_s16(const int16_t *in, int16_t *out, size_t samples, int32_t gain_q15);
+void dsp_gain_q15_s32(const int32_t *in, int32_t *out, size_t samples, int32_t gain_q15);
+
+// out = a * gain_a + b * gain_b, gains in [-32767, 32767]
+void dsp_mix_s16(const int16_t *a, const int16_t *b, int16_t *out, size_t samples,
+                 int16_t gain_a_q15, int16_t gain_b_q15);
+void dsp_mix_s32(const int32_t *a, const int32_t *b, int32_t *out, size_t samples,
+                 int16_t gain_a_q15, int16_t gain_b_q15);
+
+// out = a * (1 - x) + b * x, x ramping linearly from start_q15 to end_q15 over the block
+void dsp_crossfade_s16(const int16_t *a, const int16_t *b, int16_t *out, size_t samples,
+                       int32_t start_q15, int32_t end_q15);
+void dsp_crossfade_s32(const int32_t *a, const int32_t *b, int32_t *out, size_t samples,
+                       int32_t start_q15, int32_t end_q15);
+
+// Block level: returns the peak magnitude (32768 for INT16_MIN) and adds the sum of squares to *sum_sq
+int32_t dsp_level_s16(const int16_t *in, size_t samples, uint64_t *sum_sq);
+
+// Portable reference implementations, the optimised kernels above must match them bit for bit
+void dsp_gain_q15_s16_ref(const int16_t *in, int16_t *out, size_t samples, int32_t gain_q15);
+void dsp_gain_q15_s32_ref(const int32_t *in, int32_t *out, size_t samples, int32_t gain_q15);
+void dsp_mix_s16_ref(const int16_t *a, const int16_t *b, int16_t *out, size_t samples,
+                     int16_t gain_a_q15, int16_t gain_b_q15);
+void dsp_mix_s32_ref(const int32_t *a, const int32_t *b, int32_t *out, size_t samples,
+                     int16_t gain_a_q15, int16_t gain_b_q15);
+void dsp_crossfade_s16_ref(const int16_t *a, const int16_t *b, int16_t *out, size_t samples,
+                           int32_t start_q15, int32_t end_q15);
+void dsp_crossfade_s32_ref(const int32_t *a, const int32_t *b, int32_t *out, size_t samples,
+                           int32_t start_q15, int32_t end_q15);
+int32_t dsp_level_s16_ref(const int16_t *in, size_t samples, uint64_t *sum_sq);
+
+// Saturate a 32-bit value to int16, single CLAMPS instruction on Xtensa
+static inline int32_t dsp_sat16(int32_t x)
+{
+#if defined(__XTENSA__)
+    int32_t r;
+    __asm__("clamps %0, %1, 15" : "=a"(r) : "a"(x));
+    return r;
+#else
+    return x > INT16_MAX ? INT16_MAX : (x < INT16_MIN ? INT16_MIN : x);
+#endif
+}
+
+static inline int32_t dsp_sat32(int64_t x)
+{
+    return x > INT32_MAX ? INT32_MAX : (x < INT32_MIN ? INT32_MIN : (int32_t)x);
+}
+
+#endif // DSP_KERNELS_H
@@ -4,20 +4,26 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 // EC11 encoder pin definitions for ESP32-A1S-AudioKit (基于可用扩展引脚)
 #define EC11_PIN_S1 GPIO_NUM_22 // Encoder A (使用可插拔引脚)
 #define EC11_PIN_S2 GPIO_NUM_19 // Encoder B (使用可插拔引脚)
 #define EC11_PIN_KEY GPIO_NUM_0 // Push button (使用可插拔引脚)
 
+// Holding the button this long reports EC11_LONG_PRESSED instead of EC11_PRESSED
+#define EC11_LONG_PRESS_MS 800
+
 // Encoder states
 typedef enum
 {
     EC11_IDLE,
     EC11_CW,      // Clockwise rotation
     EC11_CCW,     // Counter-clockwise rotation
-    EC11_PRESSED, // Button pressed
-    EC11_RELEASED // Button released
+    EC11_PRESSED,      // Short press, reported on release
+    EC11_RELEASED,     // Button released
+    EC11_LONG_PRESSED  // Button held for EC11_LONG_PRESS_MS
 } ec11_event_t;
 
 typedef struct
@@ -28,7 +34,10 @@ typedef struct
     uint8_t last_state;
     bool key_pressed;
     uint32_t last_key_time;
+    bool long_press_sent;
     uint32_t debounce_time_ms;
+    TaskHandle_t task;      // Woken by the pin interrupts
+    volatile int32_t steps; // Decoded by the interrupt, CW positive, drained by the task
 } ec11_encoder_t;
 
 // Callback function type
@@ -0,0 +1,107 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Set to 0 to compile every metric update out
+#ifndef METRICS_ENABLED
+#define METRICS_ENABLED 1
+#endif
+
+// Statically registered metrics. An update is one relaxed atomic on a static
+// word, safe from any task or ISR; nothing is formatted or copied until
+// someone takes a snapshot.
+//
+// Counters and gauges: id, name, short label for the OLED (9 chars), unit
+#define METRICS_SCALAR_TABLE(X)                                                       \
+    X(METRIC_AUDIO_BLOCKS, "audio_blocks", "BLOCKS", "", METRIC_COUNTER)              \
+    X(METRIC_AUDIO_BYPASSED, "audio_bypassed", "BYPASSED", "", METRIC_COUNTER)        \
+    X(METRIC_AUDIO_RECOVERIES, "audio_recoveries", "RECOVER", "", METRIC_COUNTER)     \
+    X(METRIC_I2S_RX_OVERFLOWS, "i2s_rx_overflows", "I2S RX OV", "", METRIC_COUNTER)   \
+    X(METRIC_I2S_TX_UNDERFLOWS, "i2s_tx_underflows", "I2S TX UN", "", METRIC_COUNTER) \
+    X(METRIC_RATE_SWITCHES, "rate_switches", "RATE SW", "", METRIC_COUNTER)           \
+    X(METRIC_DELAY_CHANGES, "delay_changes", "DELAY CHG", "", METRIC_COUNTER)         \
+    X(METRIC_MIX_CHANGES, "mix_changes", "MIX CHG", "", METRIC_COUNTER)               \
+    X(METRIC_ENCODER_EVENTS, "encoder_events", "ENCODER", "", METRIC_COUNTER)         \
+    X(METRIC_NVS_WRITES, "nvs_writes", "NVS WR", "", METRIC_COUNTER)                  \
+    X(METRIC_NVS_ERRORS, "nvs_errors", "NVS ERR", "", METRIC_COUNTER)                 \
+    X(METRIC_DISPLAY_BYTES, "display_bytes", "OLED B", "bytes", METRIC_COUNTER)       \
+    X(METRIC_DISPLAY_ERRORS, "display_errors", "OLED ERR", "", METRIC_COUNTER)        \
+    X(METRIC_CPU_CEILING_MHZ, "cpu_ceiling", "CPU MHZ", "MHz", METRIC_GAUGE)
+
+// Histograms (log2 buckets): id, name, short label, unit
+#define METRICS_HISTOGRAM_TABLE(X)                                          \
+    X(METRIC_HIST_AUDIO_BLOCK, "audio_block_cycles", "BLK CYC", "cycles")   \
+    X(METRIC_HIST_DISPLAY_WRITE, "display_write_us", "OLED US", "us")       \
+    X(METRIC_HIST_DISPLAY_UPDATE, "display_update_us", "UI US", "us")       \
+    X(METRIC_HIST_NVS_WRITE, "nvs_write_us", "NVS US", "us")
+
+#define METRICS_HISTOGRAM_BUCKETS 32 // Bucket n counts values in [2^n, 2^(n+1)), bucket 0 also 0
+
+typedef enum
+{
+    METRIC_COUNTER, // Only goes up, cleared by metrics_reset()
+    METRIC_GAUGE    // Last value set, kept across resets
+} metric_type_t;
+
+#define METRICS_SCALAR_ENUM(id, name, label, unit, type) id,
+typedef enum
+{
+    METRICS_SCALAR_TABLE(METRICS_SCALAR_ENUM) METRIC_COUNT
+} metric_id_t;
+#undef METRICS_SCALAR_ENUM
+
+#define METRICS_HISTOGRAM_ENUM(id, name, label, unit) id,
+typedef enum
+{
+    METRICS_HISTOGRAM_TABLE(METRICS_HISTOGRAM_ENUM) METRIC_HIST_COUNT
+} metric_hist_id_t;
+#undef METRICS_HISTOGRAM_ENUM
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t p50; // Percentiles are upper bounds of the bucket they fall in
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max; // Exact
+} metrics_hist_summary_t;
+
+// Every value is read atomically, but the snapshot as a whole is not one instant
+typedef struct
+{
+    int64_t time_us;
+    uint32_t values[METRIC_COUNT];
+    metrics_hist_summary_t histograms[METRIC_HIST_COUNT];
+} metrics_snapshot_t;
+
+// One line per scalar, then one per histogram showing its p99
+#define METRICS_ROW_COUNT (METRIC_COUNT + METRIC_HIST_COUNT)
+
+#if METRICS_ENABLED
+#define METRIC_INC(id) metrics_add((id), 1)
+#define METRIC_ADD(id, n) metrics_add((id), (uint32_t)(n))
+#define METRIC_SET(id, v) metrics_set((id), (uint32_t)(v))
+#define METRIC_OBSERVE(id, v) metrics_observe((id), (uint32_t)(v))
+#else
+#define METRIC_INC(id) ((void)0)
+#define METRIC_ADD(id, n) ((void)0)
+#define METRIC_SET(id, v) ((void)0)
+#define METRIC_OBSERVE(id, v) ((void)0)
+#endif
+
+// Function declarations
+void metrics_add(metric_id_t id, uint32_t n);
+void metrics_set(metric_id_t id, uint32_t value);
+void metrics_observe(metric_hist_id_t id, uint32_t value);
+esp_err_t metrics_get_snapshot(metrics_snapshot_t *snapshot);
+esp_err_t metrics_get_histogram(metric_hist_id_t id, uint32_t *buckets, size_t bucket_count);
+const char *metrics_name(metric_id_t id);
+const char *metrics_hist_name(metric_hist_id_t id);
+void metrics_format_row(const metrics_snapshot_t *snapshot, size_t row, char *line, size_t len); // 16 chars
+void metrics_reset(void);
+void metrics_log_report(void);
+
+#endif // METRICS_H
@@ -4,6 +4,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "driver/i2c.h"
+#include "audio_meter.h"
+#include "spectrum_analyzer.h"
+#include "task_monitor.h"
+#include "metrics.h"
 
 // OLED display configuration
 #define OLED_I2C_PORT I2C_NUM_0
@@ -16,20 +20,67 @@
 #define OLED_HEIGHT 64
 #define OLED_PAGES 8
 
+// Level meters on the main page: one page per metering point, -60..0 dBFS
+#define OLED_METER_PAGE_FIRST 1
+#define OLED_METER_COLUMN 10
+#define OLED_METER_WIDTH (OLED_WIDTH - OLED_METER_COLUMN)
+#define OLED_METER_RANGE_DB 60
+#define OLED_METER_PEAK_FALL_PX 3 // Peak marker fall per refresh
+#define OLED_METER_REFRESH_MS 100 // Bounds the I2C traffic the meters can cause
+
+// Spectrum page: bars grow up from the bottom page, the title keeps page 0
+#define OLED_SPECTRUM_PAGE_FIRST 1
+#define OLED_SPECTRUM_PAGES (OLED_PAGES - OLED_SPECTRUM_PAGE_FIRST)
+
+// Debug page: load and heap on the first pages, then a scrollable task list
+#define OLED_DEBUG_TASK_PAGE_FIRST 3
+#define OLED_DEBUG_TASK_ROWS (OLED_PAGES - OLED_DEBUG_TASK_PAGE_FIRST)
+
+// Metrics page: a title, then a scrollable list of registry rows
+#define OLED_METRICS_ROWS (OLED_PAGES - 1)
+#define OLED_LINE_CHARS 16
+
 // Display modes
 typedef enum
 {
-    DISPLAY_MODE_MAIN, // Main delay display
-    DISPLAY_MODE_MENU  // Sample rate menu
+    DISPLAY_MODE_MAIN,    // Main delay display
+    DISPLAY_MODE_MENU,    // Sample rate menu
+    DISPLAY_MODE_MIX,     // Dry/wet mix edit
+    DISPLAY_MODE_SPECTRUM, // Output spectrum
+    DISPLAY_MODE_DEBUG,    // Task and heap statistics
+    DISPLAY_MODE_METRICS   // Metrics registry
 } display_mode_t;
 
 typedef struct
 {
     uint32_t current_delay_ms;
     uint32_t current_sample_rate;
+    uint32_t current_mix_percent;
     display_mode_t mode;
     uint8_t menu_selection;
     bool menu_confirmed;
+
+    // Meter rows as last sent, so a refresh only transfers the columns that changed
+    uint8_t meter_rows[AUDIO_METER_POINT_COUNT][OLED_METER_WIDTH];
+    uint8_t meter_peak_x[AUDIO_METER_POINT_COUNT];
+    uint32_t meter_seq;
+    int64_t meter_refresh_us;
+    int64_t meter_changed_us; // Last refresh that moved a bar, lets the UI slow down on a still page
+
+    // Spectrum pages as last sent, plus the update rate the I2C link actually achieved
+    uint8_t spectrum_pages[OLED_SPECTRUM_PAGES][OLED_WIDTH];
+    uint32_t spectrum_seq;
+    uint32_t spectrum_draws;
+    uint32_t spectrum_bytes;
+    int64_t spectrum_start_us;
+
+    // Debug page: first task row shown, and the monitor sample it shows
+    uint8_t debug_first;
+    uint32_t debug_seq;
+
+    // Metrics page: first registry row shown and the text on screen, so only changed rows are sent
+    uint8_t metrics_first;
+    char metrics_lines[OLED_METRICS_ROWS][OLED_LINE_CHARS + 1];
 } oled_display_t;
 
 // Function declarations
@@ -38,9 +89,20 @@ esp_err_t oled_display_deinit(oled_display_t *display);
 esp_err_t oled_display_clear(void);
 esp_err_t oled_display_update_delay(oled_display_t *display, uint32_t delay_ms);
 esp_err_t oled_display_update_sample_rate(oled_display_t *display, uint32_t sample_rate);
+esp_err_t oled_display_update_mix(oled_display_t *display, uint32_t mix_percent);
 esp_err_t oled_display_show_menu(oled_display_t *display);
+esp_err_t oled_display_show_mix(oled_display_t *display);
 esp_err_t oled_display_show_main(oled_display_t *display);
 esp_err_t oled_display_set_selection(oled_display_t *display, uint8_t selection);
+esp_err_t oled_display_update_meters(oled_display_t *display, const audio_meter_snapshot_t *levels);
+esp_err_t oled_display_show_spectrum(oled_display_t *display);
+esp_err_t oled_display_update_spectrum(oled_display_t *display, const spectrum_frame_t *frame);
+void oled_display_log_spectrum_rate(oled_display_t *display);
+esp_err_t oled_display_show_debug(oled_display_t *display);
+esp_err_t oled_display_update_debug(oled_display_t *display, const task_monitor_snapshot_t *snapshot);
+esp_err_t oled_display_show_metrics(oled_display_t *display);
+esp_err_t oled_display_scroll_metrics(oled_display_t *display, int rows);
+esp_err_t oled_display_update_metrics(oled_display_t *display, const metrics_snapshot_t *snapshot);
 
 // Low-level display functions
 esp_err_t oled_write_command(uint8_t cmd);
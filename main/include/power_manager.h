@@ -0,0 +1,67 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// CPU frequency ceiling picked from the audio load. The audio task holds a
+// CPU_FREQ_MAX lock only while it processes a block; between blocks the CPU
+// drops to the floor. On the ESP32 a 240 MHz ceiling keeps the CPU at 240 even
+// when idle, since the I2S driver's APB lock maps to 240 there, so the real
+// saving comes from running at a lower ceiling.
+#define POWER_FREQ_LEVELS 3
+#define POWER_MIN_FREQ_MHZ 80  // I2S keeps APB at 80 MHz, nothing lower is reachable while streaming
+#define POWER_MAX_FREQ_MHZ 240
+
+// Frequency choice: the lowest level whose worst block stays under the target share of its period
+#define POWER_TARGET_LOAD_PERCENT 60
+#define POWER_DOWNSHIFT_MARGIN_PERCENT 15 // A lower level must fit with this much to spare
+#define POWER_DOWNSHIFT_HOLD_MS 3000      // ... for this long before stepping down
+#define POWER_EVAL_MIN_BLOCKS 8           // Active blocks needed before a window counts
+
+// Light sleep would stop the I2S clocks, the stream runs continuously
+#define POWER_LIGHT_SLEEP_ENABLE false
+
+// Rates reported separately, matching the UI's sample rate options
+#define POWER_RATE_SLOTS 4
+
+// Power in the report is estimated from typical datasheet currents at this supply
+#define POWER_SUPPLY_MV 3300
+
+typedef struct
+{
+    uint32_t sample_rate;
+    uint32_t freq_mhz;                     // Ceiling last chosen at this rate, 0 if not measured yet
+    float cycles_per_sample;               // Active blocks, running average
+    float peak_cycles_per_sample;          // Worst active block seen at this rate
+    float load_percent[POWER_FREQ_LEVELS]; // Average share of a block period at each level
+    float peak_percent[POWER_FREQ_LEVELS]; // Worst block at each level
+    float est_mw[POWER_FREQ_LEVELS];       // Estimated supply power at each level
+    uint64_t time_us[POWER_FREQ_LEVELS];   // Spent at each level while running this rate
+} power_rate_stats_t;
+
+typedef struct
+{
+    bool pm_enabled; // esp_pm accepted the configuration; false means fixed frequency
+    uint32_t freq_mhz;
+    uint32_t switches;
+    power_rate_stats_t rate[POWER_RATE_SLOTS];
+} power_stats_t;
+
+// Function declarations
+esp_err_t power_manager_init(void);
+void power_manager_set_sample_rate(uint32_t sample_rate); // Before the stream switches rate
+void power_manager_update(void); // Control side, re-evaluates the ceiling from the latest window
+uint32_t power_manager_get_freq_mhz(void);
+uint32_t power_manager_level_mhz(int level);
+esp_err_t power_manager_get_stats(power_stats_t *stats);
+void power_manager_log_report(void);
+
+// Audio task side: begin() after the I2S read returns, end() before the write.
+// Bypassed blocks are not counted towards the load.
+void power_manager_audio_begin(void);
+void power_manager_audio_end(uint32_t cycles, size_t samples, uint32_t sample_rate, bool bypassed);
+
+#endif // POWER_MANAGER_H
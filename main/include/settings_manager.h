@@ -11,14 +11,21 @@
 #define NVS_NAMESPACE "audio_delay"
 #define NVS_KEY_DELAY_MS "delay_ms"
 #define NVS_KEY_SAMPLE_RATE "sample_rate"
+#define NVS_KEY_MIX_PERCENT "mix_pct"
+#define NVS_KEY_PRESET_FORMAT "preset%u" // One blob per slot
+
+// Named settings slots, saved and recalled on request, never automatically
+#define SETTINGS_PRESET_SLOTS 8
 
 // Default settings
 #define DEFAULT_DELAY_MS 30
+#define DEFAULT_MIX_PERCENT 100 // Delayed signal only
 
 typedef struct
 {
     uint32_t delay_ms;
     uint32_t sample_rate;
+    uint32_t mix_percent; // Wet share, 0 = dry only
 } user_settings_t;
 
 // Function declarations
@@ -27,5 +34,7 @@ esp_err_t settings_manager_deinit(void);
 esp_err_t settings_load(user_settings_t *settings);
 esp_err_t settings_save(const user_settings_t *settings);
 esp_err_t settings_reset_to_default(user_settings_t *settings);
+esp_err_t settings_save_preset(uint32_t slot, const user_settings_t *settings);
+esp_err_t settings_load_preset(uint32_t slot, user_settings_t *settings); // ESP_ERR_NVS_NOT_FOUND if never saved
 
 #endif // SETTINGS_MANAGER_H
@@ -0,0 +1,85 @@
+#ifndef SIGNAL_GENERATOR_H
+#define SIGNAL_GENERATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Block-based test sources for measuring the audio path. Plain C with no RTOS
+// calls, so the same generators can drive host-side tests.
+#define SIGNAL_GEN_SINE_LUT_BITS 10 // Sine table entries, linearly interpolated
+#define SIGNAL_GEN_SWEEP_SEGMENT 32 // Sweep frequency is exact at segment edges, linear in between
+#define SIGNAL_GEN_PINK_ROWS 16     // Voss-McCartney rows, one octave each
+#define SIGNAL_GEN_MLS_ORDER_MIN 10
+#define SIGNAL_GEN_MLS_ORDER_MAX 20
+#define SIGNAL_GEN_DEFAULT_AMPLITUDE 16384 // -6 dBFS peak
+
+typedef enum
+{
+    SIGNAL_GEN_OFF,     // I2S input passes through
+    SIGNAL_GEN_SINE,    // freq_hz
+    SIGNAL_GEN_SWEEP,   // Exponential, freq_hz to freq_end_hz over period_ms, then repeats
+    SIGNAL_GEN_IMPULSE, // One full-amplitude sample every period_ms
+    SIGNAL_GEN_WHITE,   // Uniform
+    SIGNAL_GEN_PINK,    // -3 dB/octave
+    SIGNAL_GEN_MLS,     // Maximum length sequence of mls_order, +/- amplitude
+    SIGNAL_GEN_TYPE_COUNT
+} signal_gen_type_t;
+
+typedef struct
+{
+    signal_gen_type_t type;
+    int16_t amplitude; // Peak, linear
+    float freq_hz;
+    float freq_end_hz;
+    uint32_t period_ms;
+    uint32_t mls_order;
+} signal_gen_config_t;
+
+// Per-sample parameters derived from a config at the current sample rate
+typedef struct
+{
+    signal_gen_type_t type;
+    int32_t amplitude;
+    uint32_t phase_inc;      // Sine, Q32 cycles per sample
+    float sweep_inc_start;   // Sweep phase increment at the start, Q32
+    float sweep_log_rate;    // Natural log of the increment growth per sample
+    uint32_t period_samples; // Sweep length or impulse spacing
+    uint32_t mls_taps;       // Galois feedback mask
+} signal_gen_params_t;
+
+typedef struct
+{
+    // Control side: the latest config and its derived parameters, published
+    // behind a sequence lock and picked up by the generator at its next block
+    signal_gen_config_t config;
+    uint32_t sample_rate;
+    signal_gen_params_t staged;
+    uint32_t staged_seq;
+
+    // Generator side
+    signal_gen_params_t params;
+    uint32_t applied_seq;
+    uint32_t phase;
+    uint32_t sweep_inc;
+    int32_t sweep_step;
+    uint32_t position; // Samples into the current sweep or impulse period
+    uint32_t noise_state;
+    uint32_t mls_state;
+    int32_t pink_rows[SIGNAL_GEN_PINK_ROWS];
+    int32_t pink_sum;
+    uint32_t pink_counter;
+} signal_gen_t;
+
+// Function declarations
+esp_err_t signal_gen_init(signal_gen_t *gen, uint32_t sample_rate);
+esp_err_t signal_gen_configure(signal_gen_t *gen, const signal_gen_config_t *config);
+esp_err_t signal_gen_set_sample_rate(signal_gen_t *gen, uint32_t sample_rate);
+uint32_t signal_gen_mls_length(uint32_t order);
+const char *signal_gen_type_name(signal_gen_type_t type);
+
+// Generator side: fills the block and returns true, or leaves it alone and returns false when off
+bool signal_gen_fill(signal_gen_t *gen, int16_t *out, size_t samples);
+
+#endif // SIGNAL_GENERATOR_H
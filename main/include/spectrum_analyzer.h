@@ -0,0 +1,54 @@
+#ifndef SPECTRUM_ANALYZER_H
+#define SPECTRUM_ANALYZER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// FFT frame taken from the output stream, decimated so the analyzer never sees more than 48 kHz
+#define SPECTRUM_FFT_BITS 9
+#define SPECTRUM_FFT_SIZE (1 << SPECTRUM_FFT_BITS)
+#define SPECTRUM_TAP_RATE_MAX 48000
+
+// Display shape: one bar per OLED column on a log frequency axis, -60..0 dBFS
+#define SPECTRUM_COLUMNS 128
+#define SPECTRUM_HEIGHT 56 // Pixels, pages 1-7 below the title
+#define SPECTRUM_RANGE_DB 60
+#define SPECTRUM_MIN_FREQ_HZ 40
+#define SPECTRUM_FALL_PX 4 // Bar fall per frame
+
+// Analyzer task rate; its core and priority are in the app_tasks table
+#define SPECTRUM_TARGET_FPS 10
+#define SPECTRUM_READ_RETRIES 8 // Frame reads racing a publish before giving up
+
+typedef struct
+{
+    uint8_t height[SPECTRUM_COLUMNS]; // Bar height in pixels, 0..SPECTRUM_HEIGHT
+    uint32_t tap_rate;                // Analyzed rate after decimation
+    uint32_t seq;                     // Publish count, unchanged means nothing new
+} spectrum_frame_t;
+
+// Cycle counts are wall time on the analyzer's core, so preemption by the audio task is included
+typedef struct
+{
+    uint32_t frames;
+    uint32_t fft_cycles;     // Window plus FFT, last frame
+    uint32_t fft_cycles_max;
+    uint32_t frame_cycles;   // Whole frame including the column mapping, last frame
+    float fps;               // Measured publish rate
+    float cpu_percent;       // Of one core at the measured rate
+} spectrum_stats_t;
+
+// Function declarations
+esp_err_t spectrum_analyzer_init(void);
+esp_err_t spectrum_analyzer_start(void);
+void spectrum_analyzer_set_active(bool active);
+esp_err_t spectrum_analyzer_get_frame(spectrum_frame_t *frame);
+esp_err_t spectrum_analyzer_get_stats(spectrum_stats_t *stats);
+void spectrum_analyzer_log_report(void);
+
+// Audio task side: costs one atomic load unless the analyzer is waiting for samples
+void spectrum_analyzer_tap(const int16_t *block, size_t samples, uint32_t sample_rate);
+
+#endif // SPECTRUM_ANALYZER_H
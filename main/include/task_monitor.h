@@ -0,0 +1,64 @@
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Periodic collector on the control core. It reads the FreeRTOS run-time
+// counters and stack high-water marks of every task plus the heap low-water
+// marks, and keeps a short history; the audio task is only read, never touched.
+#define TASK_MONITOR_PERIOD_MS 1000
+#define TASK_MONITOR_MAX_TASKS 24 // More tasks than this and the system state read fails
+#define TASK_MONITOR_HISTORY 60   // Samples, one per period
+#define TASK_MONITOR_NAME_LEN 16
+#define TASK_MONITOR_CORES 2
+#define TASK_MONITOR_CORE_ANY 0xFF
+
+// History values that do not fit are clamped; a task absent from a sample reads as TASK_MONITOR_ABSENT
+#define TASK_MONITOR_ABSENT 0xFF
+
+typedef struct
+{
+    char name[TASK_MONITOR_NAME_LEN];
+    uint8_t slot;          // Column in the history samples
+    uint8_t core;          // Pinned core or TASK_MONITOR_CORE_ANY
+    uint8_t priority;
+    uint16_t cpu_permille; // Of one core over the last period
+    uint32_t stack_free;   // Least free stack seen since the task started, bytes
+} task_monitor_task_t;
+
+typedef struct
+{
+    uint32_t seq; // Samples taken, unchanged means nothing new
+    uint32_t time_s;
+    uint16_t core_load_permille[TASK_MONITOR_CORES];
+    uint32_t internal_free;
+    uint32_t internal_min; // Lowest free internal heap since boot
+    uint32_t spiram_free;  // 0 without SPIRAM
+    uint32_t spiram_min;
+    uint32_t task_count;
+    task_monitor_task_t tasks[TASK_MONITOR_MAX_TASKS]; // Busiest first
+} task_monitor_snapshot_t;
+
+// One history entry, about 90 bytes; per-task columns are indexed by task_monitor_task_t.slot
+typedef struct
+{
+    uint32_t time_s;
+    uint16_t core_load_permille[TASK_MONITOR_CORES];
+    uint16_t internal_free_kb;
+    uint16_t internal_min_kb;
+    uint16_t spiram_free_kb;
+    uint16_t spiram_min_kb;
+    uint8_t task_cpu_half_pct[TASK_MONITOR_MAX_TASKS]; // 0.5% steps, TASK_MONITOR_ABSENT if not running
+    uint16_t task_stack_free[TASK_MONITOR_MAX_TASKS];  // Bytes
+} task_monitor_sample_t;
+
+// Function declarations
+esp_err_t task_monitor_start(void);
+esp_err_t task_monitor_get_snapshot(task_monitor_snapshot_t *snapshot);
+size_t task_monitor_get_history(task_monitor_sample_t *samples, size_t max_count); // Newest first
+esp_err_t task_monitor_get_slot_name(uint8_t slot, char *name, size_t len);
+void task_monitor_log_report(void);
+
+#endif // TASK_MONITOR_H
@@ -0,0 +1,80 @@
+#ifndef TRACE_BUFFER_H
+#define TRACE_BUFFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Set to 0 to compile every trace point out
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+// Binary event rings, one per core so writers never contend across cores.
+// Recording reserves a slot with one atomic add, invalidates its sequence and
+// fills it in, so it is safe from any task or ISR. Timestamps are esp_timer
+// microseconds: the cycle counter differs per core and changes rate with the
+// CPU clock.
+#define TRACE_CORES 2
+#define TRACE_RING_EVENTS 512 // Per core, power of two; the oldest events are overwritten
+
+// Event table: id, name, Chrome trace phase ('B' begin, 'E' end, 'i' instant,
+// 'C' counter), then what the two arguments hold. The dump carries this
+// table, so the host decoder needs no copy of it.
+#define TRACE_EVENT_TABLE(X)                                                          \
+    X(TRACE_EV_AUDIO_BLOCK_BEGIN, "audio_block", 'B', "samples", "seq")               \
+    X(TRACE_EV_AUDIO_BLOCK_END, "audio_block", 'E', "cycles", "bypassed")             \
+    X(TRACE_EV_I2S_RX_OVERFLOW, "i2s_rx_overflow", 'i', "bytes", "total")             \
+    X(TRACE_EV_I2S_TX_UNDERFLOW, "i2s_tx_underflow", 'i', "total", "unused")          \
+    X(TRACE_EV_RATE_SWITCH, "rate_switch", 'i', "from", "to")                         \
+    X(TRACE_EV_SET_DELAY, "set_delay", 'i', "ms", "samples")                          \
+    X(TRACE_EV_SET_MIX, "set_mix", 'i', "mix_q15", "unused")                          \
+    X(TRACE_EV_SET_FEEDBACK, "set_feedback", 'i', "feedback_q15", "damping_q15")      \
+    X(TRACE_EV_CUE, "cue", 'i', "type", "value")                                      \
+    X(TRACE_EV_ENCODER_EDGE, "encoder_edge", 'i', "state", "step")                    \
+    X(TRACE_EV_ENCODER_KEY, "encoder_key", 'i', "level", "unused")                    \
+    X(TRACE_EV_DISPLAY_BEGIN, "oled_write", 'B', "bytes", "unused")                   \
+    X(TRACE_EV_DISPLAY_END, "oled_write", 'E', "result", "unused")                    \
+    X(TRACE_EV_NVS_BEGIN, "nvs_save", 'B', "unused", "unused")                        \
+    X(TRACE_EV_NVS_END, "nvs_save", 'E', "result", "unused")                          \
+    X(TRACE_EV_CPU_CEILING, "cpu_ceiling_mhz", 'C', "mhz", "unused")
+
+#define TRACE_EVENT_ENUM(id, name, phase, arg0, arg1) id,
+typedef enum
+{
+    TRACE_EVENT_TABLE(TRACE_EVENT_ENUM) TRACE_EV_COUNT
+} trace_event_id_t;
+#undef TRACE_EVENT_ENUM
+
+// One ring slot, 16 bytes
+typedef struct
+{
+    uint32_t timestamp_us; // Low 32 bits of esp_timer time, the dump carries the high part
+    uint16_t id;
+    uint16_t seq;          // Low bits of the slot's index + 1; invalidated first, set last
+    uint32_t arg0;
+    uint32_t arg1;
+} trace_event_t;
+
+typedef struct
+{
+    uint32_t recorded[TRACE_CORES]; // Since boot
+    uint32_t overwritten[TRACE_CORES];
+    bool enabled;
+} trace_stats_t;
+
+#if TRACE_ENABLED
+#define TRACE_RECORD(id, arg0, arg1) trace_buffer_record((id), (uint32_t)(arg0), (uint32_t)(arg1))
+#else
+#define TRACE_RECORD(id, arg0, arg1) ((void)0)
+#endif
+
+// Function declarations
+void trace_buffer_record(uint16_t id, uint32_t arg0, uint32_t arg1); // Any task or ISR, any core
+void trace_buffer_set_enabled(bool enabled);
+esp_err_t trace_buffer_get_stats(trace_stats_t *stats);
+void trace_buffer_clear(void);
+void trace_buffer_dump(void); // Text dump for tools/trace_decode.py, pauses recording while it runs
+
+#endif // TRACE_BUFFER_H
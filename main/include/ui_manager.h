@@ -3,6 +3,10 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "ec11_encoder.h"
 #include "oled_display.h"
 #include "settings_manager.h"
@@ -12,7 +16,11 @@ typedef enum
 {
     UI_STATE_MAIN,        // Main delay adjustment
     UI_STATE_MENU,        // Sample rate menu
-    UI_STATE_MENU_CONFIRM // Confirming sample rate selection
+    UI_STATE_MENU_CONFIRM, // Confirming sample rate selection
+    UI_STATE_MIX,          // Dry/wet mix adjustment, entered with a long press
+    UI_STATE_SPECTRUM,     // Output spectrum, long press from the mix page
+    UI_STATE_DEBUG,        // Task and heap statistics, long press from the spectrum page
+    UI_STATE_METRICS       // Metrics registry, long press from the debug page
 } ui_state_t;
 
 // Sample rate options
@@ -33,20 +41,43 @@ typedef struct
     sample_rate_option_t selected_sample_rate;
     bool settings_changed;
     uint32_t last_interaction_time;
+
+    // Everything above belongs to the UI task. Other tasks post requests that
+    // it applies in ui_manager_process_requests(), one at a time.
+    QueueHandle_t requests;
+    SemaphoreHandle_t request_lock; // One waiting caller at a time
+    SemaphoreHandle_t request_done; // Given by the UI task once a waited-for request is applied
+    uint32_t request_seq;
+    uint32_t request_done_seq;
+    esp_err_t request_result;
+    user_settings_t request_settings; // Snapshot returned by ui_manager_get_settings()
+    TaskHandle_t owner;
 } ui_manager_t;
 
 // Function declarations
 esp_err_t ui_manager_init(ui_manager_t *ui);
 esp_err_t ui_manager_deinit(ui_manager_t *ui);
-void ui_manager_handle_encoder_event(ui_manager_t *ui, ec11_event_t event);
+esp_err_t ui_manager_post_encoder_event(ui_manager_t *ui, ec11_event_t event);
+void ui_manager_process_requests(ui_manager_t *ui);
 esp_err_t ui_manager_update_display(ui_manager_t *ui);
+uint32_t ui_manager_get_refresh_ms(ui_manager_t *ui);
 esp_err_t ui_manager_save_settings(ui_manager_t *ui);
 uint32_t ui_manager_get_sample_rate_value(sample_rate_option_t option);
 sample_rate_option_t ui_manager_get_sample_rate_option(uint32_t sample_rate);
 
-// Helper functions
+// Helper functions; single values, safe to read from any task
 uint32_t ui_manager_get_current_delay(ui_manager_t *ui);
 uint32_t ui_manager_get_current_sample_rate(ui_manager_t *ui);
+uint32_t ui_manager_get_current_mix(ui_manager_t *ui);
+
+// Direct setters for controls other than the knob; they change the same
+// settings the encoder does. From another task they queue the change and
+// wait until the UI task has applied it, or ESP_ERR_TIMEOUT.
+esp_err_t ui_manager_set_delay(ui_manager_t *ui, uint32_t delay_ms);
+esp_err_t ui_manager_set_sample_rate(ui_manager_t *ui, uint32_t sample_rate);
+esp_err_t ui_manager_set_mix(ui_manager_t *ui, uint32_t mix_percent);
+esp_err_t ui_manager_apply_settings(ui_manager_t *ui, const user_settings_t *settings);
+esp_err_t ui_manager_get_settings(ui_manager_t *ui, user_settings_t *settings); // All three from one state
 bool ui_manager_settings_changed(ui_manager_t *ui);
 
 #endif // UI_MANAGER_H
@@ -1,29 +1,78 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <inttypes.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "nvs_flash.h"
 
 #include "audio_delay.h"
+#include "audio_gate.h"
+#include "signal_generator.h"
+#include "dsp_chain.h"
+#include "dsp_biquad.h"
+#include "audio_limiter.h"
+#include "dsp_kernels.h"
+#include "dsp_bench.h"
 #include "ec11_encoder.h"
 #include "oled_display.h"
 #include "settings_manager.h"
 #include "ui_manager.h"
+#include "spectrum_analyzer.h"
+#include "power_manager.h"
+#include "app_tasks.h"
+#include "task_monitor.h"
+#include "metrics.h"
+#include "trace_buffer.h"
+#include "audio_jitter.h"
+#include "audio_profiler.h"
+#include "console_uart.h"
+#include "control_uart.h"
 
 static const char *TAG = "MAIN";
 
+// High-pass the control protocol can put at the head of the EQ
+#define EQ_HIGHPASS_MIN_HZ 20
+#define EQ_HIGHPASS_MAX_HZ 1000
+#define EQ_HIGHPASS_Q 0.707f
+
+// Test source settings from the console and the protocol
+#define GEN_IMPULSE_MAX_HZ 1000
+#define GEN_SWEEP_PERIOD_MS 1000
+
+// How often the gate's CPU savings, the power report, task statistics, metrics and protocol counters are logged
+#define GATE_REPORT_INTERVAL_MS 60000
+
 // Global variables
 static audio_delay_t g_audio_delay;
+static audio_gate_t g_gate;
+static signal_gen_t g_generator;
+static SemaphoreHandle_t g_gen_lock; // Generator config has a single writer; console, control and UI tasks share it
+static StaticSemaphore_t g_gen_lock_buffer;
+static SemaphoreHandle_t g_feedback_lock; // Echo settings, set from the console and control tasks as a pair
+static StaticSemaphore_t g_feedback_lock_buffer;
+static int32_t g_feedback_q15 = 0;
+static int32_t g_damping_q15 = 0;
+static dsp_chain_t g_dsp_chain;
+static dsp_biquad_t g_eq;
+static SemaphoreHandle_t g_eq_lock; // EQ edits come from the console and control tasks, rate changes from the UI
+static StaticSemaphore_t g_eq_lock_buffer;
+static audio_limiter_t g_limiter;
 static ec11_encoder_t g_encoder;
 static ui_manager_t g_ui_manager;
 
+// Sample clock that cue times count from, set by "cue start"; without it they count from now
+static uint64_t g_cue_start = 0;
+static bool g_cue_started = false;
+
 // Task handles
 static TaskHandle_t audio_task_handle = NULL;
 static TaskHandle_t encoder_task_handle = NULL;
+static TaskHandle_t ui_task_handle = NULL;
 
 // Audio processing task
 static void audio_task(void *pvParameters)
@@ -34,74 +83,657 @@ static void audio_task(void *pvParameters)
     audio_delay_task(&g_audio_delay);
 }
 
-// Encoder event callback
+// UI mix percentage to the engine's Q15 wet share
+static int32_t mix_percent_to_q15(uint32_t mix_percent)
+{
+    return (int32_t)((mix_percent * MIX_Q15_WET + 50) / 100);
+}
+
+// Encoder event callback; the UI task handles the event and redraws
 static void encoder_callback(ec11_event_t event)
 {
-    ui_manager_handle_encoder_event(&g_ui_manager, event);
+    ui_manager_post_encoder_event(&g_ui_manager, event);
 }
 
-void app_main(void)
+// Console operations. Settings are queued to the UI manager like a knob
+// turn; the UI task applies them to the display, the flash and the audio path.
+static uint32_t console_get_delay(void)
 {
-    ESP_LOGI(TAG, "ESP32 Audio Delay starting...");
+    return ui_manager_get_current_delay(&g_ui_manager);
+}
 
-    // Initialize NVS
-    esp_err_t ret = nvs_flash_init();
-    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+static int console_set_delay(uint32_t delay_ms)
+{
+    return ui_manager_set_delay(&g_ui_manager, delay_ms);
+}
+
+static uint32_t console_get_sample_rate(void)
+{
+    return ui_manager_get_current_sample_rate(&g_ui_manager);
+}
+
+static int console_set_sample_rate(uint32_t sample_rate)
+{
+    return ui_manager_set_sample_rate(&g_ui_manager, sample_rate);
+}
+
+static uint32_t console_get_mix(void)
+{
+    return ui_manager_get_current_mix(&g_ui_manager);
+}
+
+static int console_set_mix(uint32_t mix_percent)
+{
+    return ui_manager_set_mix(&g_ui_manager, mix_percent);
+}
+
+// The pair is queued to the audio task under the lock, so the last one set is the one that runs
+static int feedback_set(int32_t feedback_q15, int32_t damping_q15)
+{
+    if (feedback_q15 < -FEEDBACK_Q15_MAX || feedback_q15 > FEEDBACK_Q15_MAX || damping_q15 < 0 ||
+        damping_q15 > DAMPING_Q15_MAX)
     {
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        ret = nvs_flash_init();
+        return ESP_ERR_INVALID_ARG;
     }
-    ESP_ERROR_CHECK(ret);
 
-    // Initialize settings manager
-    ESP_ERROR_CHECK(settings_manager_init());
+    xSemaphoreTake(g_feedback_lock, portMAX_DELAY);
+    esp_err_t ret = audio_delay_set_feedback(&g_audio_delay, (int16_t)feedback_q15, (int16_t)damping_q15);
+    if (ret == ESP_OK)
+    {
+        g_feedback_q15 = feedback_q15;
+        g_damping_q15 = damping_q15;
+    }
+    xSemaphoreGive(g_feedback_lock);
+    return ret;
+}
 
-    // Initialize UI manager
-    ESP_ERROR_CHECK(ui_manager_init(&g_ui_manager));
+static void feedback_get(int32_t *feedback_q15, int32_t *damping_q15)
+{
+    xSemaphoreTake(g_feedback_lock, portMAX_DELAY);
+    *feedback_q15 = g_feedback_q15;
+    *damping_q15 = g_damping_q15;
+    xSemaphoreGive(g_feedback_lock);
+}
 
-    // Initialize audio delay
-    ESP_ERROR_CHECK(audio_delay_init(&g_audio_delay));
+static int console_preset_save(uint32_t slot)
+{
+    user_settings_t settings;
+    esp_err_t ret = ui_manager_get_settings(&g_ui_manager, &settings);
+    if (ret == ESP_OK)
+    {
+        ret = settings_save_preset(slot, &settings);
+    }
+    return ret;
+}
 
-    // Set initial audio delay parameters from UI settings
-    ESP_ERROR_CHECK(audio_delay_set_delay(&g_audio_delay, ui_manager_get_current_delay(&g_ui_manager)));
-    ESP_ERROR_CHECK(audio_delay_set_sample_rate(&g_audio_delay, ui_manager_get_current_sample_rate(&g_ui_manager)));
+static int console_preset_load(uint32_t slot)
+{
+    user_settings_t settings;
+    esp_err_t ret = settings_load_preset(slot, &settings);
+    if (ret == ESP_OK)
+    {
+        ret = ui_manager_apply_settings(&g_ui_manager, &settings);
+    }
+    return ret;
+}
 
-    // Initialize encoder
-    ESP_ERROR_CHECK(ec11_encoder_init(&g_encoder, encoder_callback));
+// Timing baseline of the running stream: block cadence and per-stage cycles over a quiet window
+static int console_calibrate(uint32_t seconds)
+{
+    audio_jitter_reset();
+    audio_profiler_reset();
+    vTaskDelay(pdMS_TO_TICKS(seconds * 1000));
+    audio_jitter_log_report();
+    audio_profiler_log_report();
+    power_manager_log_report();
+    return ESP_OK;
+}
 
-    // Create tasks
-    xTaskCreate(audio_task, "audio_task", 4096, NULL, 5, &audio_task_handle);
-    xTaskCreate(ec11_encoder_task, "encoder_task", 2048, &g_encoder, 4, &encoder_task_handle);
+// Scheduled changes bypass the UI and land on the exact sample; the menus keep showing the knob values
+static int console_cue(console_cue_param_t param, uint32_t value, uint32_t at_ms)
+{
+    uint64_t base = g_cue_started ? g_cue_start : audio_delay_get_sample_clock(&g_audio_delay);
+    audio_event_t event = {
+        .at_sample = base + (uint64_t)at_ms * g_audio_delay.sample_rate / 1000,
+        .value = (int32_t)value,
+    };
 
-    ESP_LOGI(TAG, "System initialized successfully");
+    switch (param)
+    {
+    case CONSOLE_CUE_DELAY:
+        event.type = AUDIO_EVENT_DELAY;
+        break;
+    case CONSOLE_CUE_MIX:
+        event.type = AUDIO_EVENT_MIX;
+        event.value = value <= 100 ? mix_percent_to_q15(value) : -1;
+        break;
+    case CONSOLE_CUE_GAIN:
+        event.type = AUDIO_EVENT_GAIN;
+        event.value = value <= DSP_GAIN_Q15_MAX * 100 / DSP_Q15_ONE ? (int32_t)(value * DSP_Q15_ONE / 100) : -1;
+        break;
+    case CONSOLE_CUE_FEEDBACK:
+    {
+        // Carries the damping that is set now; the requested pair only follows the console and protocol
+        int32_t feedback_q15, damping_q15;
+        feedback_get(&feedback_q15, &damping_q15);
+        event.type = AUDIO_EVENT_FEEDBACK;
+        event.value = value <= FEEDBACK_Q15_MAX ? (int32_t)value : -1;
+        event.aux = damping_q15;
+        break;
+    }
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+    return audio_delay_schedule(&g_audio_delay, &event);
+}
+
+static void console_cue_start(void)
+{
+    g_cue_start = audio_delay_get_sample_clock(&g_audio_delay);
+    g_cue_started = true;
+}
+
+static void console_cue_clear(void)
+{
+    audio_delay_clear_schedule(&g_audio_delay);
+    g_cue_started = false;
+}
+
+static void console_cue_report(void)
+{
+    audio_event_stats_t stats;
+    audio_delay_get_event_stats(&g_audio_delay, &stats);
+    ESP_LOGI(TAG, "Sample clock %" PRIu64 ", cue start %" PRIu64, audio_delay_get_sample_clock(&g_audio_delay),
+             g_cue_start);
+    ESP_LOGI(TAG, "Events scheduled %" PRIu32 ", applied %" PRIu32 ", late %" PRIu32 ", dropped %" PRIu32
+                  ", cleared %" PRIu32 ", pending %" PRIu32,
+             stats.scheduled, stats.applied, stats.late, stats.dropped, stats.cleared, stats.pending);
+}
+
+// EQ edits work on the filter's own copy of the bands and publish the whole set again
+static const dsp_biquad_type_t eq_types[] = {
+    [CONSOLE_EQ_LOWPASS] = DSP_BIQUAD_LOWPASS,
+    [CONSOLE_EQ_HIGHPASS] = DSP_BIQUAD_HIGHPASS,
+    [CONSOLE_EQ_PEAKING] = DSP_BIQUAD_PEAKING,
+    [CONSOLE_EQ_LOWSHELF] = DSP_BIQUAD_LOWSHELF,
+    [CONSOLE_EQ_HIGHSHELF] = DSP_BIQUAD_HIGHSHELF,
+    [CONSOLE_EQ_NOTCH] = DSP_BIQUAD_NOTCH,
+};
+
+static const char *const eq_type_names[] = {
+    [DSP_BIQUAD_LOWPASS] = "lowpass",
+    [DSP_BIQUAD_HIGHPASS] = "highpass",
+    [DSP_BIQUAD_PEAKING] = "peaking",
+    [DSP_BIQUAD_LOWSHELF] = "lowshelf",
+    [DSP_BIQUAD_HIGHSHELF] = "highshelf",
+    [DSP_BIQUAD_NOTCH] = "notch",
+};
+
+static int console_eq_add(console_eq_type_t type, uint32_t freq_hz, float q, float gain_db)
+{
+    if ((size_t)type >= sizeof(eq_types) / sizeof(eq_types[0]))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(g_eq_lock, portMAX_DELAY);
+    dsp_biquad_band_t bands[DSP_BIQUAD_MAX_SECTIONS];
+    size_t count = g_eq.band_count;
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    if (count < DSP_BIQUAD_MAX_SECTIONS)
+    {
+        memcpy(bands, g_eq.bands, count * sizeof(dsp_biquad_band_t));
+        bands[count] = (dsp_biquad_band_t){
+            .type = eq_types[type],
+            .freq_hz = (float)freq_hz,
+            .q = q,
+            .gain_db = gain_db,
+        };
+        ret = dsp_biquad_set_bands(&g_eq, bands, count + 1);
+    }
+    xSemaphoreGive(g_eq_lock);
+    return ret;
+}
+
+static int console_eq_clear(void)
+{
+    xSemaphoreTake(g_eq_lock, portMAX_DELAY);
+    esp_err_t ret = dsp_biquad_set_bands(&g_eq, NULL, 0);
+    xSemaphoreGive(g_eq_lock);
+    return ret;
+}
+
+static void console_eq_report(void)
+{
+    xSemaphoreTake(g_eq_lock, portMAX_DELAY);
+    ESP_LOGI(TAG, "EQ at %" PRIu32 " Hz, %u bands", g_eq.sample_rate, (unsigned)g_eq.band_count);
+    for (size_t i = 0; i < g_eq.band_count; i++)
+    {
+        const dsp_biquad_band_t *band = &g_eq.bands[i];
+        ESP_LOGI(TAG, "  %u: %-9s %7.1f Hz, Q %.2f, %+.1f dB", (unsigned)i, eq_type_names[band->type],
+                 band->freq_hz, band->q, band->gain_db);
+    }
+    xSemaphoreGive(g_eq_lock);
+}
+
+// The protocol's high-pass is a leading highpass band; the console sees it as band 0
+static uint32_t eq_get_highpass(void)
+{
+    xSemaphoreTake(g_eq_lock, portMAX_DELAY);
+    uint32_t freq_hz = g_eq.band_count > 0 && g_eq.bands[0].type == DSP_BIQUAD_HIGHPASS
+                           ? (uint32_t)g_eq.bands[0].freq_hz
+                           : 0;
+    xSemaphoreGive(g_eq_lock);
+    return freq_hz;
+}
+
+static int eq_set_highpass(uint32_t freq_hz)
+{
+    if (freq_hz != 0 && (freq_hz < EQ_HIGHPASS_MIN_HZ || freq_hz > EQ_HIGHPASS_MAX_HZ))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(g_eq_lock, portMAX_DELAY);
+    dsp_biquad_band_t bands[DSP_BIQUAD_MAX_SECTIONS + 1];
+    size_t count = g_eq.band_count;
+    bool present = count > 0 && g_eq.bands[0].type == DSP_BIQUAD_HIGHPASS;
+    const dsp_biquad_band_t highpass = {
+        .type = DSP_BIQUAD_HIGHPASS,
+        .freq_hz = (float)freq_hz,
+        .q = EQ_HIGHPASS_Q,
+    };
+
+    // Keep everything after the current high-pass, if any, and put the new one in front
+    size_t kept = present ? count - 1 : count;
+    memcpy(&bands[1], &g_eq.bands[present ? 1 : 0], kept * sizeof(dsp_biquad_band_t));
+    bands[0] = highpass;
+    esp_err_t ret = freq_hz ? dsp_biquad_set_bands(&g_eq, bands, kept + 1)
+                            : dsp_biquad_set_bands(&g_eq, &bands[1], kept);
+    xSemaphoreGive(g_eq_lock);
+    return ret;
+}
+
+// Generator edits start from the running config: type -1 and values of 0 keep the current setting
+static int gen_update(int type, uint32_t freq_hz, uint32_t level_percent)
+{
+    if (type >= SIGNAL_GEN_TYPE_COUNT || level_percent > 100)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(g_gen_lock, portMAX_DELAY);
+    signal_gen_config_t config = g_generator.config;
+    config.type = type < 0 ? config.type : (signal_gen_type_t)type;
+    config.freq_hz = freq_hz ? (float)freq_hz : config.freq_hz;
+    config.amplitude = level_percent ? (int16_t)(level_percent * INT16_MAX / 100) : config.amplitude;
+    config.period_ms = GEN_SWEEP_PERIOD_MS;
+
+    esp_err_t ret = ESP_OK;
+    if (config.type == SIGNAL_GEN_IMPULSE)
+    {
+        // The frequency is the impulse rate here
+        ret = config.freq_hz >= 1.0f && config.freq_hz <= GEN_IMPULSE_MAX_HZ ? ESP_OK : ESP_ERR_INVALID_ARG;
+        config.period_ms = ret == ESP_OK ? (uint32_t)(1000.0f / config.freq_hz) : 0;
+    }
+    if (ret == ESP_OK)
+    {
+        ret = signal_gen_configure(&g_generator, &config);
+    }
+    xSemaphoreGive(g_gen_lock);
+    return ret;
+}
+
+static void gen_get(signal_gen_config_t *config)
+{
+    xSemaphoreTake(g_gen_lock, portMAX_DELAY);
+    *config = g_generator.config;
+    xSemaphoreGive(g_gen_lock);
+}
+
+static uint32_t gen_level_percent(const signal_gen_config_t *config)
+{
+    return ((uint32_t)config->amplitude * 100 + INT16_MAX / 2) / INT16_MAX;
+}
+
+static int console_gen_set(console_gen_type_t type, uint32_t freq_hz, uint32_t level_percent)
+{
+    // console_gen_type_t follows signal_gen_type_t
+    return gen_update((int)type, freq_hz, level_percent);
+}
+
+static void console_gen_report(void)
+{
+    signal_gen_config_t config;
+    gen_get(&config);
+    ESP_LOGI(TAG, "Generator %s, %.0f Hz, level %" PRIu32 "%%", signal_gen_type_name(config.type), config.freq_hz,
+             gen_level_percent(&config));
+}
+
+// Runs on the console task; the audio task preempts it, which the best-of timing absorbs
+static int console_bench(const char *suite, uint32_t block_samples)
+{
+    esp_err_t ret = dsp_bench_run_suite(suite, block_samples);
+    if (ret == ESP_ERR_NOT_FOUND)
+    {
+        for (size_t i = 0; i < dsp_bench_suite_count(); i++)
+        {
+            ESP_LOGI(TAG, "Bench suite: %s", dsp_bench_suite_name(i));
+        }
+    }
+    return ret;
+}
+
+static const console_ops_t console_ops = {
+    .get_delay_ms = console_get_delay,
+    .set_delay_ms = console_set_delay,
+    .get_sample_rate = console_get_sample_rate,
+    .set_sample_rate = console_set_sample_rate,
+    .get_mix_percent = console_get_mix,
+    .set_mix_percent = console_set_mix,
+    .get_feedback = feedback_get,
+    .set_feedback = feedback_set,
+    .metrics_report = metrics_log_report,
+    .metrics_reset = metrics_reset,
+    .trace_dump = trace_buffer_dump,
+    .trace_clear = trace_buffer_clear,
+    .trace_enable = trace_buffer_set_enabled,
+    .tasks_report = task_monitor_log_report,
+    .preset_save = console_preset_save,
+    .preset_load = console_preset_load,
+    .preset_slots = SETTINGS_PRESET_SLOTS,
+    .calibrate = console_calibrate,
+    .cue = console_cue,
+    .cue_start = console_cue_start,
+    .cue_clear = console_cue_clear,
+    .cue_report = console_cue_report,
+    .bench = console_bench,
+    .eq_add = console_eq_add,
+    .eq_clear = console_eq_clear,
+    .eq_report = console_eq_report,
+    .gen_set = console_gen_set,
+    .gen_report = console_gen_report,
+};
 
-    // Main loop
+// Binary protocol operations: the same setters as the console, one parameter id each
+static int control_get_param(control_param_t param, uint32_t *value)
+{
+    switch (param)
+    {
+    case CONTROL_PARAM_DELAY_MS:
+        *value = console_get_delay();
+        return 0;
+    case CONTROL_PARAM_SAMPLE_RATE:
+        *value = console_get_sample_rate();
+        return 0;
+    case CONTROL_PARAM_MIX_PERCENT:
+        *value = console_get_mix();
+        return 0;
+    case CONTROL_PARAM_HIGHPASS_HZ:
+        *value = eq_get_highpass();
+        return 0;
+    case CONTROL_PARAM_GEN_TYPE:
+    case CONTROL_PARAM_GEN_FREQ_HZ:
+    case CONTROL_PARAM_GEN_LEVEL_PERCENT:
+    {
+        signal_gen_config_t config;
+        gen_get(&config);
+        *value = param == CONTROL_PARAM_GEN_TYPE      ? (uint32_t)config.type
+                 : param == CONTROL_PARAM_GEN_FREQ_HZ ? (uint32_t)config.freq_hz
+                                                      : gen_level_percent(&config);
+        return 0;
+    }
+    case CONTROL_PARAM_FEEDBACK_Q15:
+    case CONTROL_PARAM_DAMPING_Q15:
+    {
+        int32_t feedback_q15, damping_q15;
+        feedback_get(&feedback_q15, &damping_q15);
+        *value = (uint32_t)(param == CONTROL_PARAM_FEEDBACK_Q15 ? feedback_q15 : damping_q15);
+        return 0;
+    }
+    default:
+        return -1;
+    }
+}
+
+static int control_set_param(control_param_t param, uint32_t value)
+{
+    switch (param)
+    {
+    case CONTROL_PARAM_DELAY_MS:
+        return console_set_delay(value);
+    case CONTROL_PARAM_SAMPLE_RATE:
+        return console_set_sample_rate(value);
+    case CONTROL_PARAM_MIX_PERCENT:
+        return console_set_mix(value);
+    case CONTROL_PARAM_HIGHPASS_HZ:
+        return eq_set_highpass(value);
+    case CONTROL_PARAM_GEN_TYPE:
+        return value < SIGNAL_GEN_TYPE_COUNT ? gen_update((int)value, 0, 0) : ESP_ERR_INVALID_ARG;
+    case CONTROL_PARAM_GEN_FREQ_HZ:
+        return value ? gen_update(-1, value, 0) : ESP_ERR_INVALID_ARG;
+    case CONTROL_PARAM_GEN_LEVEL_PERCENT:
+        return value ? gen_update(-1, 0, value) : ESP_ERR_INVALID_ARG;
+    case CONTROL_PARAM_FEEDBACK_Q15:
+    case CONTROL_PARAM_DAMPING_Q15:
+    {
+        // Each id changes one half of the pair
+        int32_t feedback_q15, damping_q15;
+        feedback_get(&feedback_q15, &damping_q15);
+        return param == CONTROL_PARAM_FEEDBACK_Q15 ? feedback_set((int32_t)value, damping_q15)
+                                                   : feedback_set(feedback_q15, (int32_t)value);
+    }
+    default:
+        return -1;
+    }
+}
+
+// Telemetry carries the metric rows of the OLED page: every scalar, then each histogram's p99
+static size_t control_telemetry(uint32_t *values, size_t max)
+{
+    metrics_snapshot_t snapshot;
+    size_t count = 0;
+
+    metrics_get_snapshot(&snapshot);
+    for (int id = 0; id < METRIC_COUNT && count < max; id++)
+    {
+        values[count++] = snapshot.values[id];
+    }
+    for (int id = 0; id < METRIC_HIST_COUNT && count < max; id++)
+    {
+        values[count++] = snapshot.histograms[id].p99;
+    }
+    return count;
+}
+
+static const control_ops_t control_ops = {
+    .get_param = control_get_param,
+    .set_param = control_set_param,
+    .telemetry = control_telemetry,
+};
+
+// Display, settings and reports; everything here may block on I2C or flash,
+// so it runs on the control core next to the encoder
+static void ui_task(void *pvParameters)
+{
     uint32_t last_delay = ui_manager_get_current_delay(&g_ui_manager);
     uint32_t last_sample_rate = ui_manager_get_current_sample_rate(&g_ui_manager);
+    uint32_t last_mix = ui_manager_get_current_mix(&g_ui_manager);
+    TickType_t last_gate_report = xTaskGetTickCount();
 
     while (1)
     {
+        // Knob events and setter calls from the other tasks, applied here so nothing renders half a change
+        ui_manager_process_requests(&g_ui_manager);
+
         // Update display
         ui_manager_update_display(&g_ui_manager);
 
         // Check for setting changes and update audio delay accordingly
         uint32_t current_delay = ui_manager_get_current_delay(&g_ui_manager);
         uint32_t current_sample_rate = ui_manager_get_current_sample_rate(&g_ui_manager);
+        uint32_t current_mix = ui_manager_get_current_mix(&g_ui_manager);
 
-        if (current_delay != last_delay)
+        // The audio task applies both at its next block; a full event queue is retried on the next pass
+        if (current_delay != last_delay && audio_delay_set_delay(&g_audio_delay, current_delay) == ESP_OK)
         {
-            ESP_ERROR_CHECK(audio_delay_set_delay(&g_audio_delay, current_delay));
             last_delay = current_delay;
             ESP_LOGI(TAG, "Audio delay updated to %d ms", current_delay);
         }
 
+        if (current_mix != last_mix && audio_delay_set_mix(&g_audio_delay, mix_percent_to_q15(current_mix)) == ESP_OK)
+        {
+            last_mix = current_mix;
+        }
+
         if (current_sample_rate != last_sample_rate)
         {
-            ESP_ERROR_CHECK(audio_delay_set_sample_rate(&g_audio_delay, current_sample_rate));
-            last_sample_rate = current_sample_rate;
-            ESP_LOGI(TAG, "Audio sample rate updated to %d Hz", current_sample_rate);
+            // The switch mutes and restarts the stream; a failure must not reboot the box.
+            // The new rate starts at the ceiling it needed last time, or at the top.
+            power_manager_set_sample_rate(current_sample_rate);
+            esp_err_t ret = audio_delay_set_sample_rate(&g_audio_delay, current_sample_rate);
+            if (ret == ESP_OK)
+            {
+                xSemaphoreTake(g_eq_lock, portMAX_DELAY);
+                dsp_biquad_set_sample_rate(&g_eq, current_sample_rate);
+                xSemaphoreGive(g_eq_lock);
+                audio_limiter_set_sample_rate(&g_limiter, current_sample_rate);
+                audio_gate_set_sample_rate(&g_gate, current_sample_rate);
+                xSemaphoreTake(g_gen_lock, portMAX_DELAY);
+                signal_gen_set_sample_rate(&g_generator, current_sample_rate);
+                xSemaphoreGive(g_gen_lock);
+                last_sample_rate = current_sample_rate;
+                ESP_LOGI(TAG, "Audio sample rate updated to %d Hz", current_sample_rate);
+            }
+            else
+            {
+                // The stream kept its old rate; show and plan for the rate actually running
+                uint32_t running_rate = g_audio_delay.sample_rate;
+                ESP_LOGE(TAG, "Sample rate switch failed: %s, staying at %" PRIu32 " Hz",
+                         esp_err_to_name(ret), running_rate);
+                power_manager_set_sample_rate(running_rate);
+                ui_manager_set_sample_rate(&g_ui_manager, running_rate);
+                last_sample_rate = running_rate;
+            }
         }
 
-        vTaskDelay(pdMS_TO_TICKS(100));
+        if (xTaskGetTickCount() - last_gate_report >= pdMS_TO_TICKS(GATE_REPORT_INTERVAL_MS))
+        {
+            audio_gate_log_report(&g_gate);
+            power_manager_log_report();
+            task_monitor_log_report();
+            metrics_log_report();
+            control_uart_log_report();
+            last_gate_report = xTaskGetTickCount();
+        }
+
+        power_manager_update();
+
+        // Sleep until an encoder event or the page's next refresh, so idle pages let the CPU rest
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ui_manager_get_refresh_ms(&g_ui_manager)));
+    }
+}
+
+#if APP_STRESS_AT_BOOT
+// One unit of hammering for the task topology stress test: turns and page changes go
+// through the encoder path so the UI task handles and redraws them, plus NVS saves.
+// Reading the settings back waits for the UI task, which keeps the queue from overflowing.
+static void stress_ui_step(void *arg, uint32_t iteration)
+{
+    static const ec11_event_t steps[] = {EC11_CW, EC11_CCW, EC11_LONG_PRESSED, EC11_CW, EC11_CCW,
+                                         EC11_LONG_PRESSED, EC11_CW, EC11_CCW, EC11_PRESSED};
+
+    encoder_callback(steps[iteration % (sizeof(steps) / sizeof(steps[0]))]);
+
+    user_settings_t settings;
+    if (ui_manager_get_settings(&g_ui_manager, &settings) == ESP_OK && iteration % 16 == 0)
+    {
+        settings_save(&settings);
+    }
+}
+#endif
+
+void app_main(void)
+{
+    ESP_LOGI(TAG, "ESP32 Audio Delay starting...");
+
+    // Initialize NVS
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(ret);
+
+    // Initialize settings manager
+    ESP_ERROR_CHECK(settings_manager_init());
+
+    // Initialize UI manager
+    ESP_ERROR_CHECK(ui_manager_init(&g_ui_manager));
+
+    // Initialize audio delay; it starts as a plain delay, the echo comes from the feedback command or the protocol
+    ESP_ERROR_CHECK(audio_delay_init(&g_audio_delay));
+    g_feedback_lock = xSemaphoreCreateMutexStatic(&g_feedback_lock_buffer);
+
+    // Input noise gate; while it is closed and the line has gone silent the engine bypasses the ring
+    ESP_ERROR_CHECK(audio_gate_init(&g_gate, ui_manager_get_current_sample_rate(&g_ui_manager)));
+    ESP_ERROR_CHECK(audio_delay_set_gate(&g_audio_delay, &g_gate));
+
+    // Built-in test source for measurements, off until chosen with the gen command or the protocol
+    g_gen_lock = xSemaphoreCreateMutexStatic(&g_gen_lock_buffer);
+    ESP_ERROR_CHECK(signal_gen_init(&g_generator, ui_manager_get_current_sample_rate(&g_ui_manager)));
+    ESP_ERROR_CHECK(audio_delay_set_generator(&g_audio_delay, &g_generator));
+
+    // Processing chain after the delay, stages are added here before the audio task starts
+    ESP_ERROR_CHECK(dsp_chain_init(&g_dsp_chain, AUDIO_BUFFER_SIZE));
+    ESP_ERROR_CHECK(audio_delay_set_chain(&g_audio_delay, &g_dsp_chain));
+
+    // Corrective EQ on the delayed feed, starts flat; bands come from the eq command or the protocol's high-pass
+    g_eq_lock = xSemaphoreCreateMutexStatic(&g_eq_lock_buffer);
+    ESP_ERROR_CHECK(dsp_biquad_init(&g_eq, ui_manager_get_current_sample_rate(&g_ui_manager)));
+    ESP_ERROR_CHECK(dsp_chain_add_stage(&g_dsp_chain, "eq", dsp_biquad_process_block, &g_eq, true, NULL));
+
+    // Brickwall limiter, last in the chain; its lookahead is the delay line itself
+    ESP_ERROR_CHECK(audio_limiter_init(&g_limiter, &g_audio_delay, ui_manager_get_current_sample_rate(&g_ui_manager)));
+    ESP_ERROR_CHECK(dsp_chain_add_stage(&g_dsp_chain, "limiter", audio_limiter_process_block, &g_limiter, true, NULL));
+
+    // Set initial audio delay parameters from UI settings
+    ESP_ERROR_CHECK(audio_delay_set_delay(&g_audio_delay, ui_manager_get_current_delay(&g_ui_manager)));
+    ESP_ERROR_CHECK(audio_delay_set_sample_rate(&g_audio_delay, ui_manager_get_current_sample_rate(&g_ui_manager)));
+    ESP_ERROR_CHECK(audio_delay_set_mix(&g_audio_delay, mix_percent_to_q15(ui_manager_get_current_mix(&g_ui_manager))));
+
+    // CPU frequency follows the measured audio load; must be up before the audio task takes its lock
+    ESP_ERROR_CHECK(power_manager_init());
+
+    // Initialize encoder
+    ESP_ERROR_CHECK(ec11_encoder_init(&g_encoder, encoder_callback));
+
+    // Spectrum page analyzer, idle until the page is opened
+    ESP_ERROR_CHECK(spectrum_analyzer_init());
+
+    // Create tasks; cores, priorities and stacks come from the table in app_tasks.c
+    ESP_ERROR_CHECK(app_tasks_create(APP_TASK_AUDIO, audio_task, NULL, &audio_task_handle));
+    ESP_ERROR_CHECK(app_tasks_create(APP_TASK_ENCODER, ec11_encoder_task, &g_encoder, &encoder_task_handle));
+    ESP_ERROR_CHECK(app_tasks_create(APP_TASK_UI, ui_task, NULL, &ui_task_handle));
+    ESP_ERROR_CHECK(spectrum_analyzer_start());
+    ESP_ERROR_CHECK(task_monitor_start());
+
+    // The box works without the shell, so a console failure is not fatal
+    if (console_uart_start(&console_ops) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Command console unavailable");
+    }
+    if (control_uart_start(&control_ops) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Control protocol unavailable");
     }
+    app_tasks_log_topology();
+
+    ESP_LOGI(TAG, "System initialized successfully");
+
+#if APP_STRESS_AT_BOOT
+    app_stress_result_t stress;
+    app_tasks_stress_test(APP_STRESS_PHASE_MS, stress_ui_step, NULL, &stress);
+#endif
 }
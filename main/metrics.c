@@ -0,0 +1,237 @@
+#include "metrics.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "METRICS";
+
+typedef struct
+{
+    const char *name;
+    const char *label;
+    const char *unit;
+    metric_type_t type;
+} metric_info_t;
+
+#define METRICS_SCALAR_INFO(id, name, label, unit, type) {name, label, unit, type},
+static const metric_info_t scalar_info[METRIC_COUNT] = {METRICS_SCALAR_TABLE(METRICS_SCALAR_INFO)};
+#undef METRICS_SCALAR_INFO
+
+#define METRICS_HISTOGRAM_INFO(id, name, label, unit) {name, label, unit, METRIC_COUNTER},
+static const metric_info_t hist_info[METRIC_HIST_COUNT] = {METRICS_HISTOGRAM_TABLE(METRICS_HISTOGRAM_INFO)};
+#undef METRICS_HISTOGRAM_INFO
+
+// Plain words in internal RAM, updated with single atomics and never locked.
+// A histogram's count is the sum of its buckets, so the two always agree.
+typedef struct
+{
+    uint32_t buckets[METRICS_HISTOGRAM_BUCKETS];
+    uint32_t max;
+} metric_hist_t;
+
+static DRAM_ATTR uint32_t scalar_values[METRIC_COUNT];
+static DRAM_ATTR metric_hist_t histograms[METRIC_HIST_COUNT];
+
+void IRAM_ATTR metrics_add(metric_id_t id, uint32_t n)
+{
+    if (id < METRIC_COUNT)
+    {
+        __atomic_fetch_add(&scalar_values[id], n, __ATOMIC_RELAXED);
+    }
+}
+
+void IRAM_ATTR metrics_set(metric_id_t id, uint32_t value)
+{
+    if (id < METRIC_COUNT)
+    {
+        __atomic_store_n(&scalar_values[id], value, __ATOMIC_RELAXED);
+    }
+}
+
+void IRAM_ATTR metrics_observe(metric_hist_id_t id, uint32_t value)
+{
+    if (id >= METRIC_HIST_COUNT)
+    {
+        return;
+    }
+
+    metric_hist_t *hist = &histograms[id];
+    __atomic_fetch_add(&hist->buckets[31 - __builtin_clz(value | 1)], 1, __ATOMIC_RELAXED);
+
+    // Only contended when two cores set a new maximum at once
+    uint32_t max = __atomic_load_n(&hist->max, __ATOMIC_RELAXED);
+    while (value > max &&
+           !__atomic_compare_exchange_n(&hist->max, &max, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+// Upper bound of the bucket holding the given share of the observations
+static uint32_t metrics_percentile(const uint32_t *buckets, uint32_t count, uint32_t permille)
+{
+    uint32_t rank = (uint32_t)(((uint64_t)count * permille + 999) / 1000);
+    uint32_t seen = 0;
+
+    for (int bucket = 0; bucket < METRICS_HISTOGRAM_BUCKETS; bucket++)
+    {
+        seen += buckets[bucket];
+        if (seen >= rank)
+        {
+            return bucket >= 31 ? UINT32_MAX : (2u << bucket) - 1;
+        }
+    }
+    return UINT32_MAX;
+}
+
+esp_err_t metrics_get_histogram(metric_hist_id_t id, uint32_t *buckets, size_t bucket_count)
+{
+    if (id >= METRIC_HIST_COUNT || !buckets)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (size_t i = 0; i < bucket_count; i++)
+    {
+        buckets[i] = i < METRICS_HISTOGRAM_BUCKETS ? __atomic_load_n(&histograms[id].buckets[i], __ATOMIC_RELAXED) : 0;
+    }
+    return ESP_OK;
+}
+
+esp_err_t metrics_get_snapshot(metrics_snapshot_t *snapshot)
+{
+    if (!snapshot)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    snapshot->time_us = esp_timer_get_time();
+    for (int id = 0; id < METRIC_COUNT; id++)
+    {
+        snapshot->values[id] = __atomic_load_n(&scalar_values[id], __ATOMIC_RELAXED);
+    }
+
+    for (int id = 0; id < METRIC_HIST_COUNT; id++)
+    {
+        uint32_t buckets[METRICS_HISTOGRAM_BUCKETS];
+        metrics_get_histogram((metric_hist_id_t)id, buckets, METRICS_HISTOGRAM_BUCKETS);
+
+        metrics_hist_summary_t *summary = &snapshot->histograms[id];
+        memset(summary, 0, sizeof(*summary));
+        for (int bucket = 0; bucket < METRICS_HISTOGRAM_BUCKETS; bucket++)
+        {
+            summary->count += buckets[bucket];
+        }
+        if (summary->count == 0)
+        {
+            continue;
+        }
+
+        // A bucket bound can exceed what was actually seen, the maximum is exact
+        summary->max = __atomic_load_n(&histograms[id].max, __ATOMIC_RELAXED);
+        summary->p50 = metrics_percentile(buckets, summary->count, 500);
+        summary->p90 = metrics_percentile(buckets, summary->count, 900);
+        summary->p99 = metrics_percentile(buckets, summary->count, 990);
+        summary->p50 = summary->p50 > summary->max ? summary->max : summary->p50;
+        summary->p90 = summary->p90 > summary->max ? summary->max : summary->p90;
+        summary->p99 = summary->p99 > summary->max ? summary->max : summary->p99;
+    }
+    return ESP_OK;
+}
+
+const char *metrics_name(metric_id_t id)
+{
+    return id < METRIC_COUNT ? scalar_info[id].name : "?";
+}
+
+const char *metrics_hist_name(metric_hist_id_t id)
+{
+    return id < METRIC_HIST_COUNT ? hist_info[id].name : "?";
+}
+
+void metrics_format_row(const metrics_snapshot_t *snapshot, size_t row, char *line, size_t len)
+{
+    if (!snapshot || !line || len == 0)
+    {
+        return;
+    }
+
+    const metric_info_t *info;
+    uint32_t value;
+    if (row < METRIC_COUNT)
+    {
+        info = &scalar_info[row];
+        value = snapshot->values[row];
+    }
+    else if (row < METRICS_ROW_COUNT)
+    {
+        info = &hist_info[row - METRIC_COUNT];
+        value = snapshot->histograms[row - METRIC_COUNT].p99;
+    }
+    else
+    {
+        snprintf(line, len, "%16s", "");
+        return;
+    }
+
+    // Label in 9 columns, value in 6 with a K or M suffix once it no longer fits
+    char number[12];
+    if (value < 1000000)
+    {
+        snprintf(number, sizeof(number), "%" PRIu32, value);
+    }
+    else if (value < 100000000)
+    {
+        snprintf(number, sizeof(number), "%" PRIu32 "K", value / 1000);
+    }
+    else
+    {
+        snprintf(number, sizeof(number), "%" PRIu32 "M", value / 1000000);
+    }
+    snprintf(line, len, "%-9.9s %6.6s", info->label, number);
+}
+
+void metrics_reset(void)
+{
+    // Gauges hold current state, not history, and are left alone
+    for (int id = 0; id < METRIC_COUNT; id++)
+    {
+        if (scalar_info[id].type == METRIC_COUNTER)
+        {
+            __atomic_store_n(&scalar_values[id], 0, __ATOMIC_RELAXED);
+        }
+    }
+    for (int id = 0; id < METRIC_HIST_COUNT; id++)
+    {
+        for (int bucket = 0; bucket < METRICS_HISTOGRAM_BUCKETS; bucket++)
+        {
+            __atomic_store_n(&histograms[id].buckets[bucket], 0, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&histograms[id].max, 0, __ATOMIC_RELAXED);
+    }
+}
+
+void metrics_log_report(void)
+{
+#if !METRICS_ENABLED
+    ESP_LOGI(TAG, "Metrics compiled out (METRICS_ENABLED=0)");
+#else
+    metrics_snapshot_t snapshot;
+    metrics_get_snapshot(&snapshot);
+
+    for (int id = 0; id < METRIC_COUNT; id++)
+    {
+        ESP_LOGI(TAG, "%-18s %10" PRIu32 " %s", scalar_info[id].name, snapshot.values[id], scalar_info[id].unit);
+    }
+    for (int id = 0; id < METRIC_HIST_COUNT; id++)
+    {
+        const metrics_hist_summary_t *summary = &snapshot.histograms[id];
+        ESP_LOGI(TAG, "%-18s n=%" PRIu32 " p50<=%" PRIu32 " p90<=%" PRIu32 " p99<=%" PRIu32 " max=%" PRIu32 " %s",
+                 hist_info[id].name, summary->count, summary->p50, summary->p90, summary->p99, summary->max,
+                 hist_info[id].unit);
+    }
+#endif
+}
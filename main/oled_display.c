@@ -1,9 +1,13 @@
 #include "oled_display.h"
 #include "audio_delay.h"
+#include "audio_jitter.h"
+#include "trace_buffer.h"
+#include "metrics.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/i2c.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <string.h>
 #include <stdio.h>
 #include <inttypes.h>
@@ -107,6 +111,8 @@ static esp_err_t i2c_master_init(void)
 
 esp_err_t oled_write_command(uint8_t cmd)
 {
+    audio_jitter_activity_begin(AUDIO_JITTER_ACT_DISPLAY);
+    TRACE_RECORD(TRACE_EV_DISPLAY_BEGIN, 1, 0);
     i2c_cmd_handle_t cmd_handle = i2c_cmd_link_create();
     i2c_master_start(cmd_handle);
     i2c_master_write_byte(cmd_handle, (OLED_I2C_ADDR << 1) | I2C_MASTER_WRITE, true);
@@ -115,11 +121,20 @@ esp_err_t oled_write_command(uint8_t cmd)
     i2c_master_stop(cmd_handle);
     esp_err_t ret = i2c_master_cmd_begin(OLED_I2C_PORT, cmd_handle, pdMS_TO_TICKS(1000));
     i2c_cmd_link_delete(cmd_handle);
+    TRACE_RECORD(TRACE_EV_DISPLAY_END, ret, 0);
+    audio_jitter_activity_end(AUDIO_JITTER_ACT_DISPLAY);
+    if (ret != ESP_OK)
+    {
+        METRIC_INC(METRIC_DISPLAY_ERRORS);
+    }
     return ret;
 }
 
 esp_err_t oled_write_data(uint8_t *data, size_t len)
 {
+    audio_jitter_activity_begin(AUDIO_JITTER_ACT_DISPLAY);
+    TRACE_RECORD(TRACE_EV_DISPLAY_BEGIN, len, 0);
+    int64_t start_us = esp_timer_get_time();
     i2c_cmd_handle_t cmd_handle = i2c_cmd_link_create();
     i2c_master_start(cmd_handle);
     i2c_master_write_byte(cmd_handle, (OLED_I2C_ADDR << 1) | I2C_MASTER_WRITE, true);
@@ -128,6 +143,17 @@ esp_err_t oled_write_data(uint8_t *data, size_t len)
     i2c_master_stop(cmd_handle);
     esp_err_t ret = i2c_master_cmd_begin(OLED_I2C_PORT, cmd_handle, pdMS_TO_TICKS(1000));
     i2c_cmd_link_delete(cmd_handle);
+    TRACE_RECORD(TRACE_EV_DISPLAY_END, ret, 0);
+    audio_jitter_activity_end(AUDIO_JITTER_ACT_DISPLAY);
+    METRIC_OBSERVE(METRIC_HIST_DISPLAY_WRITE, esp_timer_get_time() - start_us);
+    if (ret == ESP_OK)
+    {
+        METRIC_ADD(METRIC_DISPLAY_BYTES, len);
+    }
+    else
+    {
+        METRIC_INC(METRIC_DISPLAY_ERRORS);
+    }
     return ret;
 }
 
@@ -159,9 +185,20 @@ esp_err_t oled_display_init(oled_display_t *display)
     // Initialize display structure
     display->current_delay_ms = DEFAULT_DELAY_MS;
     display->current_sample_rate = DEFAULT_SAMPLE_RATE;
+    display->current_mix_percent = 100;
     display->mode = DISPLAY_MODE_MAIN;
     display->menu_selection = 0;
     display->menu_confirmed = false;
+    memset(display->meter_rows, 0, sizeof(display->meter_rows));
+    memset(display->meter_peak_x, 0, sizeof(display->meter_peak_x));
+    display->meter_seq = 0;
+    display->meter_refresh_us = 0;
+    display->meter_changed_us = 0;
+    memset(display->spectrum_pages, 0, sizeof(display->spectrum_pages));
+    display->spectrum_seq = 0;
+    display->spectrum_draws = 0;
+    display->spectrum_bytes = 0;
+    display->spectrum_start_us = 0;
 
     // SSD1306 initialization sequence
     ESP_ERROR_CHECK(oled_write_command(SSD1306_DISPLAYOFF));
@@ -303,6 +340,17 @@ esp_err_t oled_display_update_sample_rate(oled_display_t *display, uint32_t samp
     return ESP_OK;
 }
 
+esp_err_t oled_display_update_mix(oled_display_t *display, uint32_t mix_percent)
+{
+    if (!display)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    display->current_mix_percent = mix_percent;
+    return ESP_OK;
+}
+
 esp_err_t oled_display_show_main(oled_display_t *display)
 {
     if (!display)
@@ -332,6 +380,19 @@ esp_err_t oled_display_show_main(oled_display_t *display)
     }
     ESP_ERROR_CHECK(oled_draw_string(5, 8, rate_str, false));
 
+    // Display dry/wet mix
+    char mix_str[32];
+    snprintf(mix_str, sizeof(mix_str), "MIX: %" PRIu32 " WET", display->current_mix_percent);
+    ESP_ERROR_CHECK(oled_draw_string(7, 8, mix_str, false));
+
+    // Meter labels; the bars start blank and fill in on the next meter refresh
+    ESP_ERROR_CHECK(oled_draw_string(OLED_METER_PAGE_FIRST + AUDIO_METER_INPUT, 0, "I", false));
+    ESP_ERROR_CHECK(oled_draw_string(OLED_METER_PAGE_FIRST + AUDIO_METER_OUTPUT, 0, "O", false));
+    memset(display->meter_rows, 0, sizeof(display->meter_rows));
+    memset(display->meter_peak_x, 0, sizeof(display->meter_peak_x));
+    display->meter_refresh_us = 0;
+    display->meter_changed_us = esp_timer_get_time();
+
     display->mode = DISPLAY_MODE_MAIN;
     return ESP_OK;
 }
@@ -377,6 +438,47 @@ esp_err_t oled_display_show_menu(oled_display_t *display)
     return ESP_OK;
 }
 
+esp_err_t oled_display_show_mix(oled_display_t *display)
+{
+    if (!display)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ESP_ERROR_CHECK(oled_display_clear());
+
+    // Display page title
+    ESP_ERROR_CHECK(oled_draw_string(0, 16, "DRY WET MIX", false));
+
+    // Path levels follow the engine's mix law: both at 100 in the middle
+    uint32_t mix = display->current_mix_percent;
+    uint32_t wet = mix * 2 > 100 ? 100 : mix * 2;
+    uint32_t dry = (100 - mix) * 2 > 100 ? 100 : (100 - mix) * 2;
+
+    char line[32];
+    snprintf(line, sizeof(line), "MIX: %" PRIu32, mix);
+    ESP_ERROR_CHECK(oled_draw_string(2, 8, line, true));
+    snprintf(line, sizeof(line), "DRY: %" PRIu32, dry);
+    ESP_ERROR_CHECK(oled_draw_string(4, 8, line, false));
+    snprintf(line, sizeof(line), "WET: %" PRIu32, wet);
+    ESP_ERROR_CHECK(oled_draw_string(5, 8, line, false));
+
+    // Mix position bar across the bottom page
+    uint8_t bar[OLED_WIDTH];
+    uint32_t filled = mix * OLED_WIDTH / 100;
+    for (uint32_t i = 0; i < OLED_WIDTH; i++)
+    {
+        bar[i] = i < filled ? 0x3C : 0x24;
+    }
+    bar[0] = 0x3C;
+    bar[OLED_WIDTH - 1] = 0x3C;
+    ESP_ERROR_CHECK(oled_set_position(7, 0));
+    ESP_ERROR_CHECK(oled_write_data(bar, sizeof(bar)));
+
+    display->mode = DISPLAY_MODE_MIX;
+    return ESP_OK;
+}
+
 esp_err_t oled_display_set_selection(oled_display_t *display, uint8_t selection)
 {
     if (!display)
@@ -387,3 +489,318 @@ esp_err_t oled_display_set_selection(oled_display_t *display, uint8_t selection)
     display->menu_selection = selection;
     return ESP_OK;
 }
+
+// Send the span between the first and last column that differs from what was sent before
+static esp_err_t oled_send_changed(uint8_t page, uint8_t column, uint8_t *row, uint8_t *sent, int width,
+                                   uint32_t *bytes)
+{
+    int first = 0;
+    int last = width - 1;
+    while (first < width && row[first] == sent[first])
+    {
+        first++;
+    }
+    if (first == width)
+    {
+        return ESP_OK;
+    }
+    while (row[last] == sent[last])
+    {
+        last--;
+    }
+
+    esp_err_t ret = oled_set_position(page, column + first);
+    if (ret == ESP_OK)
+    {
+        ret = oled_write_data(&row[first], last - first + 1);
+    }
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+    memcpy(&sent[first], &row[first], last - first + 1);
+    if (bytes)
+    {
+        *bytes += last - first + 1;
+    }
+    return ESP_OK;
+}
+
+// Bar length in columns for a linear level on the -60..0 dBFS scale
+static uint32_t oled_meter_columns(uint16_t level)
+{
+    float db = audio_meter_level_to_dbfs(level);
+    if (db <= -OLED_METER_RANGE_DB)
+    {
+        return 0;
+    }
+
+    uint32_t x = (uint32_t)((db + OLED_METER_RANGE_DB) * OLED_METER_WIDTH / OLED_METER_RANGE_DB);
+    return x > OLED_METER_WIDTH ? OLED_METER_WIDTH : x;
+}
+
+// RMS as a filled bar over a dotted track, peak as a falling marker
+static void oled_meter_render(uint8_t *row, uint32_t rms_x, uint32_t peak_x)
+{
+    for (uint32_t i = 0; i < OLED_METER_WIDTH; i++)
+    {
+        row[i] = i < rms_x ? 0x3C : 0x24;
+    }
+    if (peak_x > 0)
+    {
+        row[peak_x - 1] = 0x7E;
+    }
+}
+
+esp_err_t oled_display_update_meters(oled_display_t *display, const audio_meter_snapshot_t *levels)
+{
+    if (!display || !levels)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Only the main page shows meters, and only a new snapshot is worth a refresh
+    int64_t now_us = esp_timer_get_time();
+    if (display->mode != DISPLAY_MODE_MAIN || levels->seq == display->meter_seq ||
+        now_us - display->meter_refresh_us < OLED_METER_REFRESH_MS * 1000)
+    {
+        return ESP_OK;
+    }
+    display->meter_seq = levels->seq;
+    display->meter_refresh_us = now_us;
+
+    uint32_t sent_bytes = 0;
+    for (int point = 0; point < AUDIO_METER_POINT_COUNT; point++)
+    {
+        uint32_t peak_x = oled_meter_columns(levels->level[point].peak);
+        uint32_t held_x = display->meter_peak_x[point];
+        held_x = held_x > OLED_METER_PEAK_FALL_PX ? held_x - OLED_METER_PEAK_FALL_PX : 0;
+        if (peak_x < held_x)
+        {
+            peak_x = held_x;
+        }
+        display->meter_peak_x[point] = (uint8_t)peak_x;
+
+        uint8_t row[OLED_METER_WIDTH];
+        oled_meter_render(row, oled_meter_columns(levels->level[point].rms), peak_x);
+
+        esp_err_t ret = oled_send_changed(OLED_METER_PAGE_FIRST + point, OLED_METER_COLUMN, row,
+                                          display->meter_rows[point], OLED_METER_WIDTH, &sent_bytes);
+        if (ret != ESP_OK)
+        {
+            return ret;
+        }
+    }
+
+    if (sent_bytes > 0)
+    {
+        display->meter_changed_us = now_us;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t oled_display_show_spectrum(oled_display_t *display)
+{
+    if (!display)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ESP_ERROR_CHECK(oled_display_clear());
+
+    // Title with the top of the frequency axis, the analyzer never runs above 48 kHz
+    uint32_t rate = display->current_sample_rate;
+    uint32_t factor = (rate + SPECTRUM_TAP_RATE_MAX - 1) / SPECTRUM_TAP_RATE_MAX;
+    char title[32];
+    snprintf(title, sizeof(title), "SPECTRUM %" PRIu32 "KHZ", factor ? rate / factor / 2000 : 0);
+    ESP_ERROR_CHECK(oled_draw_string(0, 0, title, false));
+
+    // Bars start blank and fill in with the next analyzer frame
+    memset(display->spectrum_pages, 0, sizeof(display->spectrum_pages));
+    display->spectrum_draws = 0;
+    display->spectrum_bytes = 0;
+    display->spectrum_start_us = esp_timer_get_time();
+
+    display->mode = DISPLAY_MODE_SPECTRUM;
+    return ESP_OK;
+}
+
+esp_err_t oled_display_update_spectrum(oled_display_t *display, const spectrum_frame_t *frame)
+{
+    if (!display || !frame)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (display->mode != DISPLAY_MODE_SPECTRUM || frame->seq == display->spectrum_seq)
+    {
+        return ESP_OK;
+    }
+    display->spectrum_seq = frame->seq;
+
+    for (int page = 0; page < OLED_SPECTRUM_PAGES; page++)
+    {
+        // Bar pixels that fall inside this page; bit 7 is the page's bottom row
+        int bottom = (OLED_SPECTRUM_PAGES - 1 - page) * 8;
+        uint8_t row[OLED_WIDTH];
+        for (int x = 0; x < OLED_WIDTH; x++)
+        {
+            int lit = frame->height[x] - bottom;
+            lit = lit < 0 ? 0 : (lit > 8 ? 8 : lit);
+            row[x] = (uint8_t)(0xFF << (8 - lit));
+        }
+
+        esp_err_t ret = oled_send_changed(OLED_SPECTRUM_PAGE_FIRST + page, 0, row, display->spectrum_pages[page],
+                                          OLED_WIDTH, &display->spectrum_bytes);
+        if (ret != ESP_OK)
+        {
+            return ret;
+        }
+    }
+
+    display->spectrum_draws++;
+    return ESP_OK;
+}
+
+void oled_display_log_spectrum_rate(oled_display_t *display)
+{
+    if (!display || display->spectrum_draws == 0)
+    {
+        return;
+    }
+
+    float seconds = (esp_timer_get_time() - display->spectrum_start_us) / 1e6f;
+    ESP_LOGI(TAG, "Spectrum page: %" PRIu32 " draws in %.1f s (%.1f fps), %" PRIu32 " bytes per draw",
+             display->spectrum_draws, seconds, seconds > 0 ? display->spectrum_draws / seconds : 0.0f,
+             display->spectrum_bytes / display->spectrum_draws);
+}
+
+esp_err_t oled_display_show_debug(oled_display_t *display)
+{
+    if (!display)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ESP_ERROR_CHECK(oled_display_clear());
+    ESP_ERROR_CHECK(oled_draw_string(0, 0, "TASK MONITOR", false));
+
+    // Filled in by the next monitor sample
+    display->debug_first = 0;
+    display->debug_seq = 0;
+    display->mode = DISPLAY_MODE_DEBUG;
+    return ESP_OK;
+}
+
+esp_err_t oled_display_update_debug(oled_display_t *display, const task_monitor_snapshot_t *snapshot)
+{
+    if (!display || !snapshot)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (display->mode != DISPLAY_MODE_DEBUG || snapshot->seq == 0 || snapshot->seq == display->debug_seq)
+    {
+        return ESP_OK;
+    }
+    display->debug_seq = snapshot->seq;
+
+    // 16 characters a row; every row is padded so it fully replaces the last one
+    char line[24];
+    snprintf(line, sizeof(line), "CPU %3u %3u     ", (snapshot->core_load_permille[0] + 5) / 10,
+             (snapshot->core_load_permille[1] + 5) / 10);
+    ESP_ERROR_CHECK(oled_draw_string(0, 0, line, false));
+    snprintf(line, sizeof(line), "RAM %4" PRIu32 "K %4" PRIu32 "K  ", snapshot->internal_free / 1024,
+             snapshot->internal_min / 1024);
+    ESP_ERROR_CHECK(oled_draw_string(1, 0, line, false));
+    if (snapshot->spiram_free > 0)
+    {
+        snprintf(line, sizeof(line), "PSR %4" PRIu32 "K %4" PRIu32 "K  ", snapshot->spiram_free / 1024,
+                 snapshot->spiram_min / 1024);
+    }
+    else
+    {
+        snprintf(line, sizeof(line), "PSR NONE        ");
+    }
+    ESP_ERROR_CHECK(oled_draw_string(2, 0, line, false));
+
+    // Busiest first: name, CPU percent of one core, least free stack in bytes
+    if (display->debug_first >= snapshot->task_count)
+    {
+        display->debug_first = snapshot->task_count > 0 ? snapshot->task_count - 1 : 0;
+    }
+    for (int row = 0; row < OLED_DEBUG_TASK_ROWS; row++)
+    {
+        uint32_t index = display->debug_first + row;
+        if (index < snapshot->task_count)
+        {
+            const task_monitor_task_t *task = &snapshot->tasks[index];
+            uint32_t stack = task->stack_free > 9999 ? 9999 : task->stack_free;
+            snprintf(line, sizeof(line), "%-7.7s %3u %4" PRIu32, task->name, (task->cpu_permille + 5) / 10, stack);
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "%16s", "");
+        }
+        ESP_ERROR_CHECK(oled_draw_string(OLED_DEBUG_TASK_PAGE_FIRST + row, 0, line, false));
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t oled_display_show_metrics(oled_display_t *display)
+{
+    if (!display)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ESP_ERROR_CHECK(oled_display_clear());
+    ESP_ERROR_CHECK(oled_draw_string(0, 0, "METRICS", false));
+
+    display->metrics_first = 0;
+    memset(display->metrics_lines, 0, sizeof(display->metrics_lines));
+    display->mode = DISPLAY_MODE_METRICS;
+    return ESP_OK;
+}
+
+esp_err_t oled_display_scroll_metrics(oled_display_t *display, int rows)
+{
+    if (!display)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // The last page keeps the list's tail on screen
+    int last = METRICS_ROW_COUNT > OLED_METRICS_ROWS ? METRICS_ROW_COUNT - OLED_METRICS_ROWS : 0;
+    int first = display->metrics_first + rows;
+    display->metrics_first = first < 0 ? 0 : (first > last ? last : first);
+    return ESP_OK;
+}
+
+esp_err_t oled_display_update_metrics(oled_display_t *display, const metrics_snapshot_t *snapshot)
+{
+    if (!display || !snapshot)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (display->mode != DISPLAY_MODE_METRICS)
+    {
+        return ESP_OK;
+    }
+
+    for (int row = 0; row < OLED_METRICS_ROWS; row++)
+    {
+        char line[OLED_LINE_CHARS + 8];
+        metrics_format_row(snapshot, display->metrics_first + row, line, sizeof(line));
+        if (strcmp(line, display->metrics_lines[row]) != 0)
+        {
+            ESP_ERROR_CHECK(oled_draw_string(row + 1, 0, line, false));
+            snprintf(display->metrics_lines[row], sizeof(display->metrics_lines[row]), "%s", line);
+        }
+    }
+
+    return ESP_OK;
+}
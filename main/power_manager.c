@@ -0,0 +1,384 @@
+#include "power_manager.h"
+#include "trace_buffer.h"
+#include "metrics.h"
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_pm.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_private/esp_clk.h"
+
+static const char *TAG = "POWER";
+
+static const uint32_t level_mhz[POWER_FREQ_LEVELS] = {80, 160, 240};
+
+// Supply current in mA from the ESP32 datasheet's modem-sleep ranges. Busy is
+// the middle of the range (one of two cores loaded), idle its low end at the
+// frequency the CPU waits at: the floor, except under a 240 MHz ceiling.
+static const float level_busy_ma[POWER_FREQ_LEVELS] = {26.0f, 36.0f, 49.0f};
+static const float level_idle_ma[POWER_FREQ_LEVELS] = {20.0f, 20.0f, 30.0f};
+
+typedef struct
+{
+    uint32_t sample_rate;
+    int level;            // Last ceiling chosen at this rate, -1 if none yet
+    uint32_t avg_q8;      // Cycles per sample
+    uint32_t peak_q8;
+    uint64_t time_us[POWER_FREQ_LEVELS];
+} power_rate_slot_t;
+
+// Audio PM lock; NULL when power management is off and the CPU stays at its boot frequency
+static esp_pm_lock_handle_t audio_lock = NULL;
+static bool pm_enabled = false;
+
+// Measurement window, written by the audio task once per block
+static portMUX_TYPE window_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t window_rate = 0;
+static uint32_t window_blocks = 0;
+static uint32_t window_peak_q8 = 0;
+static uint32_t window_avg_q8 = 0;
+
+// Control side
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static power_rate_slot_t slots[POWER_RATE_SLOTS];
+static int current_level = POWER_FREQ_LEVELS - 1;
+static uint32_t switches = 0;
+static int64_t downshift_since_us = 0;
+static int64_t last_update_us = 0;
+
+uint32_t power_manager_level_mhz(int level)
+{
+    if (level < 0 || level >= POWER_FREQ_LEVELS)
+    {
+        return 0;
+    }
+    return level_mhz[level];
+}
+
+// Share of a block period the given per-sample cost takes at a frequency level
+static float power_load_percent(uint32_t cycles_q8, uint32_t sample_rate, int level)
+{
+    return (float)cycles_q8 / 256.0f * (float)sample_rate * 100.0f / ((float)level_mhz[level] * 1e6f);
+}
+
+// Lowest level that keeps the load under the limit, the top level if none does
+static int power_pick_level(uint32_t cycles_q8, uint32_t sample_rate, float limit_percent)
+{
+    for (int level = 0; level < POWER_FREQ_LEVELS - 1; level++)
+    {
+        if (power_load_percent(cycles_q8, sample_rate, level) <= limit_percent)
+        {
+            return level;
+        }
+    }
+    return POWER_FREQ_LEVELS - 1;
+}
+
+static power_rate_slot_t *power_rate_slot(uint32_t sample_rate)
+{
+    power_rate_slot_t *empty = NULL;
+    for (int i = 0; i < POWER_RATE_SLOTS; i++)
+    {
+        if (slots[i].sample_rate == sample_rate)
+        {
+            return &slots[i];
+        }
+        if (!empty && slots[i].sample_rate == 0)
+        {
+            empty = &slots[i];
+        }
+    }
+
+    if (empty)
+    {
+        empty->sample_rate = sample_rate;
+        empty->level = -1;
+    }
+    return empty;
+}
+
+static esp_err_t power_apply_level(int level, const char *reason)
+{
+    // Without scaling the CPU stays where it booted
+    if (level == current_level || !pm_enabled)
+    {
+        return ESP_OK;
+    }
+
+    esp_pm_config_t config = {
+        .max_freq_mhz = level_mhz[level],
+        .min_freq_mhz = POWER_MIN_FREQ_MHZ,
+        .light_sleep_enable = POWER_LIGHT_SLEEP_ENABLE,
+    };
+    esp_err_t ret = esp_pm_configure(&config);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to set %" PRIu32 " MHz ceiling: %s", level_mhz[level], esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "CPU ceiling %" PRIu32 " -> %" PRIu32 " MHz (%s)", level_mhz[current_level], level_mhz[level],
+             reason);
+    current_level = level;
+    switches++;
+    TRACE_RECORD(TRACE_EV_CPU_CEILING, level_mhz[level], 0);
+    METRIC_SET(METRIC_CPU_CEILING_MHZ, level_mhz[level]);
+    downshift_since_us = 0;
+    return ESP_OK;
+}
+
+esp_err_t power_manager_init(void)
+{
+    memset(slots, 0, sizeof(slots));
+    current_level = POWER_FREQ_LEVELS - 1;
+    switches = 0;
+
+    // Start at the top, the ceiling comes down once the load has been measured
+    esp_pm_config_t config = {
+        .max_freq_mhz = POWER_MAX_FREQ_MHZ,
+        .min_freq_mhz = POWER_MIN_FREQ_MHZ,
+        .light_sleep_enable = POWER_LIGHT_SLEEP_ENABLE,
+    };
+    esp_err_t ret = esp_pm_configure(&config);
+    if (ret == ESP_OK)
+    {
+        ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "audio", &audio_lock);
+    }
+
+    if (ret != ESP_OK)
+    {
+        // Without CONFIG_PM_ENABLE the load is still measured and reported
+        audio_lock = NULL;
+        pm_enabled = false;
+        uint32_t boot_mhz = (uint32_t)(esp_clk_cpu_freq() / 1000000);
+        for (int level = 0; level < POWER_FREQ_LEVELS; level++)
+        {
+            if (level_mhz[level] <= boot_mhz)
+            {
+                current_level = level;
+            }
+        }
+        ESP_LOGW(TAG, "Frequency scaling unavailable (%s), CPU fixed at %" PRIu32 " MHz", esp_err_to_name(ret),
+                 boot_mhz);
+        METRIC_SET(METRIC_CPU_CEILING_MHZ, boot_mhz);
+        return ESP_OK;
+    }
+
+    pm_enabled = true;
+    METRIC_SET(METRIC_CPU_CEILING_MHZ, POWER_MAX_FREQ_MHZ);
+    last_update_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "Power manager initialized - ceiling %d..%d MHz, target load %d%%", POWER_MIN_FREQ_MHZ,
+             POWER_MAX_FREQ_MHZ, POWER_TARGET_LOAD_PERCENT);
+    return ESP_OK;
+}
+
+void power_manager_audio_begin(void)
+{
+    if (audio_lock)
+    {
+        esp_pm_lock_acquire(audio_lock);
+    }
+}
+
+void power_manager_audio_end(uint32_t cycles, size_t samples, uint32_t sample_rate, bool bypassed)
+{
+    if (audio_lock)
+    {
+        esp_pm_lock_release(audio_lock);
+    }
+
+    // Cycle counts barely depend on the clock, so blocks measured at any level compare
+    if (bypassed || samples == 0)
+    {
+        return;
+    }
+    uint32_t per_sample_q8 = (uint32_t)(((uint64_t)cycles << 8) / samples);
+
+    portENTER_CRITICAL(&window_lock);
+    if (sample_rate != window_rate)
+    {
+        // The previous rate's figures do not apply to this one
+        window_rate = sample_rate;
+        window_blocks = 0;
+        window_peak_q8 = 0;
+        window_avg_q8 = per_sample_q8;
+    }
+    window_blocks++;
+    if (per_sample_q8 > window_peak_q8)
+    {
+        window_peak_q8 = per_sample_q8;
+    }
+    window_avg_q8 += ((int32_t)(per_sample_q8 - window_avg_q8)) / 8;
+    portEXIT_CRITICAL(&window_lock);
+}
+
+void power_manager_set_sample_rate(uint32_t sample_rate)
+{
+    // Called before the stream restarts: a rate seen before gets its learned
+    // ceiling back, a new one starts at the top until it has been measured
+    portENTER_CRITICAL(&stats_lock);
+    power_rate_slot_t *slot = power_rate_slot(sample_rate);
+    int level = slot && slot->level >= 0 ? slot->level : POWER_FREQ_LEVELS - 1;
+    portEXIT_CRITICAL(&stats_lock);
+
+    power_apply_level(level, "sample rate change");
+}
+
+void power_manager_update(void)
+{
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&window_lock);
+    uint32_t rate = window_rate;
+    uint32_t blocks = window_blocks;
+    uint32_t peak_q8 = window_peak_q8;
+    uint32_t avg_q8 = window_avg_q8;
+    if (blocks >= POWER_EVAL_MIN_BLOCKS)
+    {
+        window_blocks = 0;
+        window_peak_q8 = 0;
+    }
+    portEXIT_CRITICAL(&window_lock);
+
+    if (rate == 0)
+    {
+        last_update_us = now_us;
+        return;
+    }
+
+    portENTER_CRITICAL(&stats_lock);
+    power_rate_slot_t *slot = power_rate_slot(rate);
+    if (slot)
+    {
+        if (last_update_us != 0)
+        {
+            slot->time_us[current_level] += now_us - last_update_us;
+        }
+        if (blocks >= POWER_EVAL_MIN_BLOCKS)
+        {
+            slot->avg_q8 = avg_q8;
+            if (peak_q8 > slot->peak_q8)
+            {
+                slot->peak_q8 = peak_q8;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&stats_lock);
+    last_update_us = now_us;
+
+    if (blocks < POWER_EVAL_MIN_BLOCKS)
+    {
+        return;
+    }
+
+    // Step up as soon as the worst block of the window is over target, step
+    // down one level at a time once the lower one has fit with margin for a while
+    int wanted = power_pick_level(peak_q8, rate, POWER_TARGET_LOAD_PERCENT);
+    int relaxed = power_pick_level(peak_q8, rate, POWER_TARGET_LOAD_PERCENT - POWER_DOWNSHIFT_MARGIN_PERCENT);
+    if (wanted > current_level)
+    {
+        power_apply_level(wanted, "load over target");
+    }
+    else if (relaxed < current_level)
+    {
+        if (downshift_since_us == 0)
+        {
+            downshift_since_us = now_us;
+        }
+        else if (now_us - downshift_since_us >= POWER_DOWNSHIFT_HOLD_MS * 1000LL)
+        {
+            power_apply_level(current_level - 1, "load under target");
+        }
+    }
+    else
+    {
+        downshift_since_us = 0;
+    }
+
+    portENTER_CRITICAL(&stats_lock);
+    if (slot)
+    {
+        slot->level = current_level;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+uint32_t power_manager_get_freq_mhz(void)
+{
+    return level_mhz[current_level];
+}
+
+esp_err_t power_manager_get_stats(power_stats_t *stats)
+{
+    if (!stats)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    power_rate_slot_t copy[POWER_RATE_SLOTS];
+    portENTER_CRITICAL(&stats_lock);
+    memcpy(copy, slots, sizeof(copy));
+    stats->freq_mhz = level_mhz[current_level];
+    stats->switches = switches;
+    portEXIT_CRITICAL(&stats_lock);
+    stats->pm_enabled = pm_enabled;
+
+    for (int i = 0; i < POWER_RATE_SLOTS; i++)
+    {
+        power_rate_stats_t *out = &stats->rate[i];
+        memset(out, 0, sizeof(*out));
+        out->sample_rate = copy[i].sample_rate;
+        if (copy[i].sample_rate == 0 || copy[i].avg_q8 == 0)
+        {
+            continue;
+        }
+
+        out->freq_mhz = copy[i].level >= 0 ? level_mhz[copy[i].level] : 0;
+        out->cycles_per_sample = copy[i].avg_q8 / 256.0f;
+        out->peak_cycles_per_sample = copy[i].peak_q8 / 256.0f;
+        for (int level = 0; level < POWER_FREQ_LEVELS; level++)
+        {
+            float load = power_load_percent(copy[i].avg_q8, copy[i].sample_rate, level);
+            out->load_percent[level] = load;
+            out->peak_percent[level] = power_load_percent(copy[i].peak_q8, copy[i].sample_rate, level);
+            out->time_us[level] = copy[i].time_us[level];
+
+            // Busy for the audio share of each period, waiting for the rest
+            float busy = load > 100.0f ? 1.0f : load / 100.0f;
+            float ma = busy * level_busy_ma[level] + (1.0f - busy) * level_idle_ma[level];
+            out->est_mw[level] = ma * POWER_SUPPLY_MV / 1000.0f;
+        }
+    }
+    return ESP_OK;
+}
+
+void power_manager_log_report(void)
+{
+    power_stats_t stats;
+    if (power_manager_get_stats(&stats) != ESP_OK)
+    {
+        return;
+    }
+
+    ESP_LOGI(TAG, "Ceiling %" PRIu32 " MHz, %" PRIu32 " switches, scaling %s", stats.freq_mhz, stats.switches,
+             stats.pm_enabled ? "on" : "off");
+
+    for (int i = 0; i < POWER_RATE_SLOTS; i++)
+    {
+        const power_rate_stats_t *rate = &stats.rate[i];
+        if (rate->cycles_per_sample == 0.0f)
+        {
+            continue;
+        }
+
+        ESP_LOGI(TAG, "%" PRIu32 " Hz: %.1f cycles/sample avg, %.1f peak, runs at %" PRIu32 " MHz",
+                 rate->sample_rate, rate->cycles_per_sample, rate->peak_cycles_per_sample, rate->freq_mhz);
+        for (int level = 0; level < POWER_FREQ_LEVELS; level++)
+        {
+            ESP_LOGI(TAG, "  %3" PRIu32 " MHz: load %5.1f%% peak %5.1f%% headroom %5.1f%%, ~%.0f mW est., %" PRIu64 " s",
+                     level_mhz[level], rate->load_percent[level], rate->peak_percent[level],
+                     100.0f - rate->peak_percent[level], rate->est_mw[level], rate->time_us[level] / 1000000);
+        }
+    }
+}
@@ -1,6 +1,12 @@
 #include "settings_manager.h"
+#include "audio_jitter.h"
+#include "trace_buffer.h"
+#include "metrics.h"
+#include "esp_timer.h"
 #include "esp_log.h"
 #include <string.h>
+#include <stdio.h>
+#include <inttypes.h>
 
 static const char *TAG = "SETTINGS";
 static nvs_handle_t nvs_handle_storage;
@@ -79,8 +85,22 @@ esp_err_t settings_load(user_settings_t *settings)
         settings->sample_rate = DEFAULT_SAMPLE_RATE;
     }
 
-    ESP_LOGI(TAG, "Settings loaded - Delay: %d ms, Sample Rate: %d Hz",
-             settings->delay_ms, settings->sample_rate);
+    // Load dry/wet mix setting
+    required_size = sizeof(settings->mix_percent);
+    ret = nvs_get_blob(nvs_handle_storage, NVS_KEY_MIX_PERCENT, &settings->mix_percent, &required_size);
+    if (ret == ESP_ERR_NVS_NOT_FOUND)
+    {
+        settings->mix_percent = DEFAULT_MIX_PERCENT;
+        ESP_LOGI(TAG, "Mix setting not found, using default: %d%%", DEFAULT_MIX_PERCENT);
+    }
+    else if (ret != ESP_OK || settings->mix_percent > 100)
+    {
+        ESP_LOGE(TAG, "Error reading mix setting: %s", esp_err_to_name(ret));
+        settings->mix_percent = DEFAULT_MIX_PERCENT;
+    }
+
+    ESP_LOGI(TAG, "Settings loaded - Delay: %d ms, Sample Rate: %d Hz, Mix: %d%%",
+             settings->delay_ms, settings->sample_rate, settings->mix_percent);
 
     return ESP_OK;
 }
@@ -98,11 +118,20 @@ esp_err_t settings_save(const user_settings_t *settings)
         return ESP_ERR_INVALID_STATE;
     }
 
+    // Flash writes stall the cache, tag them for the audio jitter tracker
+    audio_jitter_activity_begin(AUDIO_JITTER_ACT_NVS);
+    TRACE_RECORD(TRACE_EV_NVS_BEGIN, 0, 0);
+    METRIC_INC(METRIC_NVS_WRITES);
+    int64_t start_us = esp_timer_get_time();
+
     // Save delay setting
     esp_err_t ret = nvs_set_blob(nvs_handle_storage, NVS_KEY_DELAY_MS, &settings->delay_ms, sizeof(settings->delay_ms));
     if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "Error saving delay setting: %s", esp_err_to_name(ret));
+        TRACE_RECORD(TRACE_EV_NVS_END, ret, 0);
+        METRIC_INC(METRIC_NVS_ERRORS);
+        audio_jitter_activity_end(AUDIO_JITTER_ACT_NVS);
         return ret;
     }
 
@@ -111,19 +140,37 @@ esp_err_t settings_save(const user_settings_t *settings)
     if (ret != ESP_OK)
     {
         ESP_LOGE(TAG, "Error saving sample rate setting: %s", esp_err_to_name(ret));
+        TRACE_RECORD(TRACE_EV_NVS_END, ret, 0);
+        METRIC_INC(METRIC_NVS_ERRORS);
+        audio_jitter_activity_end(AUDIO_JITTER_ACT_NVS);
+        return ret;
+    }
+
+    // Save dry/wet mix setting
+    ret = nvs_set_blob(nvs_handle_storage, NVS_KEY_MIX_PERCENT, &settings->mix_percent, sizeof(settings->mix_percent));
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Error saving mix setting: %s", esp_err_to_name(ret));
+        TRACE_RECORD(TRACE_EV_NVS_END, ret, 0);
+        METRIC_INC(METRIC_NVS_ERRORS);
+        audio_jitter_activity_end(AUDIO_JITTER_ACT_NVS);
         return ret;
     }
 
     // Commit changes
     ret = nvs_commit(nvs_handle_storage);
+    METRIC_OBSERVE(METRIC_HIST_NVS_WRITE, esp_timer_get_time() - start_us);
+    TRACE_RECORD(TRACE_EV_NVS_END, ret, 0);
+    audio_jitter_activity_end(AUDIO_JITTER_ACT_NVS);
     if (ret != ESP_OK)
     {
+        METRIC_INC(METRIC_NVS_ERRORS);
         ESP_LOGE(TAG, "Error committing settings: %s", esp_err_to_name(ret));
         return ret;
     }
 
-    ESP_LOGI(TAG, "Settings saved - Delay: %d ms, Sample Rate: %d Hz",
-             settings->delay_ms, settings->sample_rate);
+    ESP_LOGI(TAG, "Settings saved - Delay: %d ms, Sample Rate: %d Hz, Mix: %d%%",
+             settings->delay_ms, settings->sample_rate, settings->mix_percent);
 
     return ESP_OK;
 }
@@ -137,7 +184,82 @@ esp_err_t settings_reset_to_default(user_settings_t *settings)
 
     settings->delay_ms = DEFAULT_DELAY_MS;
     settings->sample_rate = DEFAULT_SAMPLE_RATE;
+    settings->mix_percent = DEFAULT_MIX_PERCENT;
 
     ESP_LOGI(TAG, "Settings reset to default values");
     return ESP_OK;
 }
+
+esp_err_t settings_save_preset(uint32_t slot, const user_settings_t *settings)
+{
+    if (!settings || slot >= SETTINGS_PRESET_SLOTS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!nvs_initialized)
+    {
+        ESP_LOGE(TAG, "Settings manager not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    snprintf(key, sizeof(key), NVS_KEY_PRESET_FORMAT, (unsigned)slot);
+
+    audio_jitter_activity_begin(AUDIO_JITTER_ACT_NVS);
+    TRACE_RECORD(TRACE_EV_NVS_BEGIN, slot, 0);
+    METRIC_INC(METRIC_NVS_WRITES);
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = nvs_set_blob(nvs_handle_storage, key, settings, sizeof(*settings));
+    if (ret == ESP_OK)
+    {
+        ret = nvs_commit(nvs_handle_storage);
+    }
+    METRIC_OBSERVE(METRIC_HIST_NVS_WRITE, esp_timer_get_time() - start_us);
+    TRACE_RECORD(TRACE_EV_NVS_END, ret, 0);
+    audio_jitter_activity_end(AUDIO_JITTER_ACT_NVS);
+
+    if (ret != ESP_OK)
+    {
+        METRIC_INC(METRIC_NVS_ERRORS);
+        ESP_LOGE(TAG, "Error saving preset %" PRIu32 ": %s", slot, esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Preset %" PRIu32 " saved - Delay: %" PRIu32 " ms, Sample Rate: %" PRIu32 " Hz, Mix: %" PRIu32 "%%",
+             slot, settings->delay_ms, settings->sample_rate, settings->mix_percent);
+    return ESP_OK;
+}
+
+esp_err_t settings_load_preset(uint32_t slot, user_settings_t *settings)
+{
+    if (!settings || slot >= SETTINGS_PRESET_SLOTS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!nvs_initialized)
+    {
+        ESP_LOGE(TAG, "Settings manager not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    snprintf(key, sizeof(key), NVS_KEY_PRESET_FORMAT, (unsigned)slot);
+
+    // A blob of another size was written by a different layout, treat it as absent
+    user_settings_t loaded;
+    size_t size = sizeof(loaded);
+    esp_err_t ret = nvs_get_blob(nvs_handle_storage, key, &loaded, &size);
+    if (ret == ESP_OK && size != sizeof(loaded))
+    {
+        ret = ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+
+    *settings = loaded;
+    return ESP_OK;
+}
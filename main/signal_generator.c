@@ -0,0 +1,394 @@
+#include "signal_generator.h"
+#include "dsp_kernels.h"
+#include "esp_log.h"
+#include <math.h>
+#include <string.h>
+#include <inttypes.h>
+
+static const char *TAG = "SIGNAL_GEN";
+
+#define SINE_LUT_SIZE (1 << SIGNAL_GEN_SINE_LUT_BITS)
+#define NOISE_SEED 0x2545F491
+
+// One period plus a guard entry so interpolation never wraps the index
+static int16_t sine_lut[SINE_LUT_SIZE + 1];
+static bool sine_lut_ready = false;
+
+// Galois feedback masks of maximal-length polynomials, indexed by order - SIGNAL_GEN_MLS_ORDER_MIN
+static const uint32_t mls_taps[] = {
+    0x00240, // x^10 + x^7 + 1
+    0x00500, // x^11 + x^9 + 1
+    0x00E08, // x^12 + x^11 + x^10 + x^4 + 1
+    0x01C80, // x^13 + x^12 + x^11 + x^8 + 1
+    0x03802, // x^14 + x^13 + x^12 + x^2 + 1
+    0x06000, // x^15 + x^14 + 1
+    0x0D008, // x^16 + x^15 + x^13 + x^4 + 1
+    0x12000, // x^17 + x^14 + 1
+    0x20400, // x^18 + x^11 + 1
+    0x72000, // x^19 + x^18 + x^17 + x^14 + 1
+    0x90000, // x^20 + x^17 + 1
+};
+
+static const char *const type_names[] = {"off", "sine", "sweep", "impulse", "white", "pink", "mls"};
+
+static void signal_gen_build_lut(void)
+{
+    if (sine_lut_ready)
+    {
+        return;
+    }
+
+    for (int i = 0; i <= SINE_LUT_SIZE; i++)
+    {
+        sine_lut[i] = (int16_t)lroundf(32767.0f * sinf(2.0f * (float)M_PI * i / SINE_LUT_SIZE));
+    }
+    sine_lut_ready = true;
+}
+
+static inline uint32_t signal_gen_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Top bits index the table, the next 16 interpolate
+static inline int32_t signal_gen_sine(uint32_t phase)
+{
+    uint32_t index = phase >> (32 - SIGNAL_GEN_SINE_LUT_BITS);
+    int32_t frac = (int32_t)((phase >> (16 - SIGNAL_GEN_SINE_LUT_BITS)) & 0xFFFF);
+    int32_t a = sine_lut[index];
+    return a + (((sine_lut[index + 1] - a) * frac + (1 << 15)) >> 16);
+}
+
+static inline int16_t signal_gen_scale(int32_t value, int32_t amplitude)
+{
+    return (int16_t)((value * amplitude + (1 << 14)) >> 15);
+}
+
+// Derive the per-sample parameters of the current config at the current rate
+static esp_err_t signal_gen_derive(const signal_gen_config_t *config, uint32_t sample_rate, signal_gen_params_t *params)
+{
+    float nyquist = sample_rate / 2.0f;
+
+    memset(params, 0, sizeof(*params));
+    params->type = config->type;
+    params->amplitude = config->amplitude;
+
+    switch (config->type)
+    {
+    case SIGNAL_GEN_OFF:
+    case SIGNAL_GEN_WHITE:
+    case SIGNAL_GEN_PINK:
+        break;
+
+    case SIGNAL_GEN_SINE:
+        if (config->freq_hz <= 0.0f || config->freq_hz >= nyquist)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        params->phase_inc = (uint32_t)((double)config->freq_hz / sample_rate * 4294967296.0);
+        break;
+
+    case SIGNAL_GEN_SWEEP:
+    {
+        if (config->freq_hz <= 0.0f || config->freq_hz >= nyquist || config->freq_end_hz <= 0.0f ||
+            config->freq_end_hz >= nyquist || config->period_ms == 0)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        // Whole segments, so every sweep ends exactly on the end frequency
+        uint64_t period = (uint64_t)config->period_ms * sample_rate / 1000;
+        period = (period + SIGNAL_GEN_SWEEP_SEGMENT - 1) / SIGNAL_GEN_SWEEP_SEGMENT * SIGNAL_GEN_SWEEP_SEGMENT;
+        if (period > UINT32_MAX - SIGNAL_GEN_SWEEP_SEGMENT)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        params->period_samples = (uint32_t)period;
+        params->sweep_inc_start = (float)((double)config->freq_hz / sample_rate * 4294967296.0);
+        params->sweep_log_rate = logf(config->freq_end_hz / config->freq_hz) / (float)period;
+        break;
+    }
+
+    case SIGNAL_GEN_IMPULSE:
+    {
+        uint64_t period = (uint64_t)config->period_ms * sample_rate / 1000;
+        if (period == 0 || period > UINT32_MAX)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        params->period_samples = (uint32_t)period;
+        break;
+    }
+
+    case SIGNAL_GEN_MLS:
+        if (config->mls_order < SIGNAL_GEN_MLS_ORDER_MIN || config->mls_order > SIGNAL_GEN_MLS_ORDER_MAX)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        params->mls_taps = mls_taps[config->mls_order - SIGNAL_GEN_MLS_ORDER_MIN];
+        break;
+
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return ESP_OK;
+}
+
+// Single writer: the generator retries on the next block if it races a publish
+static void signal_gen_publish(signal_gen_t *gen, const signal_gen_params_t *params)
+{
+    uint32_t seq = gen->staged_seq;
+    __atomic_store_n(&gen->staged_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    gen->staged = *params;
+    __atomic_store_n(&gen->staged_seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+esp_err_t signal_gen_init(signal_gen_t *gen, uint32_t sample_rate)
+{
+    if (!gen || sample_rate == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    signal_gen_build_lut();
+
+    memset(gen, 0, sizeof(*gen));
+    gen->sample_rate = sample_rate;
+    gen->config.type = SIGNAL_GEN_OFF;
+    gen->config.amplitude = SIGNAL_GEN_DEFAULT_AMPLITUDE;
+    gen->config.freq_hz = 1000.0f;
+    gen->config.freq_end_hz = 20000.0f;
+    gen->config.period_ms = 1000;
+    gen->config.mls_order = 16;
+    gen->params.type = SIGNAL_GEN_OFF;
+    return ESP_OK;
+}
+
+esp_err_t signal_gen_configure(signal_gen_t *gen, const signal_gen_config_t *config)
+{
+    if (!gen || !config || config->amplitude < 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    signal_gen_params_t params;
+    esp_err_t ret = signal_gen_derive(config, gen->sample_rate, &params);
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+
+    gen->config = *config;
+    signal_gen_publish(gen, &params);
+
+    ESP_LOGI(TAG, "Generator %s - amplitude %d, %.1f-%.1f Hz, period %" PRIu32 " ms, MLS order %" PRIu32,
+             signal_gen_type_name(config->type), config->amplitude, config->freq_hz, config->freq_end_hz,
+             config->period_ms, config->mls_order);
+    return ESP_OK;
+}
+
+esp_err_t signal_gen_set_sample_rate(signal_gen_t *gen, uint32_t sample_rate)
+{
+    if (!gen || sample_rate == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    gen->sample_rate = sample_rate;
+
+    signal_gen_params_t params;
+    if (signal_gen_derive(&gen->config, sample_rate, &params) != ESP_OK)
+    {
+        // The frequencies no longer fit below Nyquist
+        ESP_LOGW(TAG, "Generator %s not valid at %" PRIu32 " Hz, switching off",
+                 signal_gen_type_name(gen->config.type), sample_rate);
+        gen->config.type = SIGNAL_GEN_OFF;
+        signal_gen_derive(&gen->config, sample_rate, &params);
+    }
+    signal_gen_publish(gen, &params);
+    return ESP_OK;
+}
+
+uint32_t signal_gen_mls_length(uint32_t order)
+{
+    if (order < SIGNAL_GEN_MLS_ORDER_MIN || order > SIGNAL_GEN_MLS_ORDER_MAX)
+    {
+        return 0;
+    }
+    return (1u << order) - 1;
+}
+
+const char *signal_gen_type_name(signal_gen_type_t type)
+{
+    return type < SIGNAL_GEN_TYPE_COUNT ? type_names[type] : "unknown";
+}
+
+static void signal_gen_restart(signal_gen_t *gen)
+{
+    gen->phase = 0;
+    gen->sweep_inc = 0;
+    gen->sweep_step = 0;
+    gen->position = 0;
+    gen->noise_state = NOISE_SEED;
+    gen->mls_state = 1;
+    memset(gen->pink_rows, 0, sizeof(gen->pink_rows));
+    gen->pink_sum = 0;
+    gen->pink_counter = 0;
+}
+
+static void signal_gen_fill_sine(signal_gen_t *gen, int16_t *out, size_t samples)
+{
+    uint32_t phase = gen->phase;
+    uint32_t inc = gen->params.phase_inc;
+    int32_t amplitude = gen->params.amplitude;
+
+    for (size_t i = 0; i < samples; i++)
+    {
+        out[i] = signal_gen_scale(signal_gen_sine(phase), amplitude);
+        phase += inc;
+    }
+    gen->phase = phase;
+}
+
+static void signal_gen_fill_sweep(signal_gen_t *gen, int16_t *out, size_t samples)
+{
+    const signal_gen_params_t *p = &gen->params;
+
+    for (size_t i = 0; i < samples; i++)
+    {
+        if ((gen->position % SIGNAL_GEN_SWEEP_SEGMENT) == 0)
+        {
+            if (gen->position >= p->period_samples)
+            {
+                gen->position = 0;
+            }
+            // Exact exponential at the segment edges, linear increment ramp in between
+            float start = p->sweep_inc_start * expf(p->sweep_log_rate * gen->position);
+            float end = p->sweep_inc_start * expf(p->sweep_log_rate * (gen->position + SIGNAL_GEN_SWEEP_SEGMENT));
+            gen->sweep_inc = (uint32_t)start;
+            gen->sweep_step = (int32_t)((end - start) / SIGNAL_GEN_SWEEP_SEGMENT);
+        }
+
+        out[i] = signal_gen_scale(signal_gen_sine(gen->phase), p->amplitude);
+        gen->phase += gen->sweep_inc;
+        gen->sweep_inc += gen->sweep_step;
+        gen->position++;
+    }
+}
+
+static void signal_gen_fill_impulse(signal_gen_t *gen, int16_t *out, size_t samples)
+{
+    uint32_t period = gen->params.period_samples;
+    size_t first = (period - gen->position) % period;
+
+    memset(out, 0, samples * sizeof(int16_t));
+    for (size_t i = first; i < samples; i += period)
+    {
+        out[i] = (int16_t)gen->params.amplitude;
+    }
+    gen->position = (uint32_t)((gen->position + samples) % period);
+}
+
+static void signal_gen_fill_white(signal_gen_t *gen, int16_t *out, size_t samples)
+{
+    uint32_t state = gen->noise_state;
+    int32_t amplitude = gen->params.amplitude;
+
+    for (size_t i = 0; i < samples; i++)
+    {
+        out[i] = signal_gen_scale((int16_t)(signal_gen_rand(&state) >> 16), amplitude);
+    }
+    gen->noise_state = state;
+}
+
+// Voss-McCartney: row n is redrawn every 2^(n+1) samples, plus a white row every sample.
+// Rows are +/-1024; the 17-row sum peaks at 17408, which maps just past amplitude,
+// and its RMS sits about 17 dB below that.
+static void signal_gen_fill_pink(signal_gen_t *gen, int16_t *out, size_t samples)
+{
+    const uint32_t counter_mask = (1u << SIGNAL_GEN_PINK_ROWS) - 1;
+    uint32_t state = gen->noise_state;
+    int32_t amplitude = gen->params.amplitude;
+
+    for (size_t i = 0; i < samples; i++)
+    {
+        uint32_t x = signal_gen_rand(&state);
+
+        gen->pink_counter = (gen->pink_counter + 1) & counter_mask;
+        if (gen->pink_counter != 0)
+        {
+            int row = __builtin_ctz(gen->pink_counter);
+            int32_t value = (int32_t)x >> 21;
+            gen->pink_sum += value - gen->pink_rows[row];
+            gen->pink_rows[row] = value;
+        }
+
+        int32_t white = (int32_t)(x << 21) >> 21;
+        out[i] = (int16_t)dsp_sat16(((gen->pink_sum + white) * amplitude) >> 14);
+    }
+    gen->noise_state = state;
+}
+
+static void signal_gen_fill_mls(signal_gen_t *gen, int16_t *out, size_t samples)
+{
+    uint32_t state = gen->mls_state;
+    uint32_t taps = gen->params.mls_taps;
+    int16_t high = (int16_t)gen->params.amplitude;
+    int16_t low = (int16_t)-gen->params.amplitude;
+
+    for (size_t i = 0; i < samples; i++)
+    {
+        uint32_t bit = state & 1;
+        state = (state >> 1) ^ (-bit & taps);
+        out[i] = bit ? high : low;
+    }
+    gen->mls_state = state;
+}
+
+bool signal_gen_fill(signal_gen_t *gen, int16_t *out, size_t samples)
+{
+    // Pick up a new config between blocks; a torn read waits for the next block
+    uint32_t seq = __atomic_load_n(&gen->staged_seq, __ATOMIC_ACQUIRE);
+    if (seq != gen->applied_seq && (seq & 1) == 0)
+    {
+        signal_gen_params_t params = gen->staged;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&gen->staged_seq, __ATOMIC_RELAXED) == seq)
+        {
+            gen->params = params;
+            gen->applied_seq = seq;
+            signal_gen_restart(gen);
+        }
+    }
+
+    switch (gen->params.type)
+    {
+    case SIGNAL_GEN_SINE:
+        signal_gen_fill_sine(gen, out, samples);
+        return true;
+    case SIGNAL_GEN_SWEEP:
+        signal_gen_fill_sweep(gen, out, samples);
+        return true;
+    case SIGNAL_GEN_IMPULSE:
+        signal_gen_fill_impulse(gen, out, samples);
+        return true;
+    case SIGNAL_GEN_WHITE:
+        signal_gen_fill_white(gen, out, samples);
+        return true;
+    case SIGNAL_GEN_PINK:
+        signal_gen_fill_pink(gen, out, samples);
+        return true;
+    case SIGNAL_GEN_MLS:
+        signal_gen_fill_mls(gen, out, samples);
+        return true;
+    case SIGNAL_GEN_OFF:
+    default:
+        return false;
+    }
+}
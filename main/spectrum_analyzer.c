@@ -0,0 +1,345 @@
+#include "spectrum_analyzer.h"
+#include "app_tasks.h"
+#include "dsp_fft.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_private/esp_clk.h"
+#include <math.h>
+#include <string.h>
+#include <inttypes.h>
+
+static const char *TAG = "SPECTRUM";
+
+// Handoff between the audio task and the analyzer. The analyzer owns the tap
+// buffer while IDLE or READY; the audio task owns it while ARMED and hands it
+// back with a release store once the frame is full.
+enum
+{
+    SPECTRUM_TAP_IDLE,
+    SPECTRUM_TAP_ARMED,
+    SPECTRUM_TAP_READY
+};
+
+static uint32_t tap_state = SPECTRUM_TAP_IDLE;
+static int16_t tap_buf[SPECTRUM_FFT_SIZE];
+static uint32_t tap_fill;
+static int32_t tap_acc;
+static uint32_t tap_acc_count;
+static uint32_t tap_rate;
+
+// Analyzer task state
+static volatile bool analyzer_active = false;
+static TaskHandle_t analyzer_task_handle = NULL;
+static dsp_fft_real_t analyzer_fft;
+static int16_t window_q15[SPECTRUM_FFT_SIZE];
+static int32_t work[SPECTRUM_FFT_SIZE];
+static uint16_t column_bin_lo[SPECTRUM_COLUMNS];
+static uint16_t column_bin_hi[SPECTRUM_COLUMNS]; // Exclusive
+static uint32_t column_rate = 0;
+static uint8_t heights[SPECTRUM_COLUMNS];
+static float power_ref; // Bin power of a full-scale sine through the Hann window
+static int64_t last_publish_us = 0;
+
+// Published frame behind a sequence lock, the analyzer task is the only writer
+static uint32_t frame_seq = 0;
+static spectrum_frame_t frame_snap;
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static spectrum_stats_t stats;
+
+void spectrum_analyzer_tap(const int16_t *block, size_t samples, uint32_t sample_rate)
+{
+    if (__atomic_load_n(&tap_state, __ATOMIC_ACQUIRE) != SPECTRUM_TAP_ARMED)
+    {
+        return;
+    }
+
+    // Box average down to the analyzer rate; good enough to keep the bars honest
+    uint32_t factor = (sample_rate + SPECTRUM_TAP_RATE_MAX - 1) / SPECTRUM_TAP_RATE_MAX;
+    if (factor == 0)
+    {
+        factor = 1;
+    }
+
+    for (size_t i = 0; i < samples; i++)
+    {
+        tap_acc += block[i];
+        if (++tap_acc_count < factor)
+        {
+            continue;
+        }
+
+        tap_buf[tap_fill++] = (int16_t)(tap_acc / (int32_t)factor);
+        tap_acc = 0;
+        tap_acc_count = 0;
+
+        if (tap_fill == SPECTRUM_FFT_SIZE)
+        {
+            tap_rate = sample_rate / factor;
+            __atomic_store_n(&tap_state, SPECTRUM_TAP_READY, __ATOMIC_RELEASE);
+            return;
+        }
+    }
+}
+
+static void spectrum_analyzer_arm(void)
+{
+    tap_fill = 0;
+    tap_acc = 0;
+    tap_acc_count = 0;
+    __atomic_store_n(&tap_state, SPECTRUM_TAP_ARMED, __ATOMIC_RELEASE);
+}
+
+// Log-spaced column edges from SPECTRUM_MIN_FREQ_HZ to Nyquist, in FFT bins
+static void spectrum_analyzer_build_columns(uint32_t rate)
+{
+    const uint32_t last_bin = SPECTRUM_FFT_SIZE / 2; // Nyquist is not shown
+    float ratio = (rate / 2.0f) / SPECTRUM_MIN_FREQ_HZ;
+    float bins_per_hz = (float)SPECTRUM_FFT_SIZE / rate;
+
+    for (int c = 0; c < SPECTRUM_COLUMNS; c++)
+    {
+        float f_lo = SPECTRUM_MIN_FREQ_HZ * powf(ratio, (float)c / SPECTRUM_COLUMNS);
+        float f_hi = SPECTRUM_MIN_FREQ_HZ * powf(ratio, (float)(c + 1) / SPECTRUM_COLUMNS);
+        uint32_t lo = (uint32_t)(f_lo * bins_per_hz + 0.5f);
+        uint32_t hi = (uint32_t)(f_hi * bins_per_hz + 0.5f);
+
+        // Low columns are narrower than a bin and repeat it
+        lo = lo < 1 ? 1 : lo;
+        lo = lo > last_bin - 1 ? last_bin - 1 : lo;
+        hi = hi <= lo ? lo + 1 : hi;
+        hi = hi > last_bin ? last_bin : hi;
+        column_bin_lo[c] = (uint16_t)lo;
+        column_bin_hi[c] = (uint16_t)hi;
+    }
+    column_rate = rate;
+}
+
+static void spectrum_analyzer_publish(uint32_t rate)
+{
+    uint32_t seq = frame_seq;
+    __atomic_store_n(&frame_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(frame_snap.height, heights, sizeof(frame_snap.height));
+    frame_snap.tap_rate = rate;
+    __atomic_store_n(&frame_seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+static void spectrum_analyzer_frame(void)
+{
+    uint32_t start = esp_cpu_get_cycle_count();
+    uint32_t rate = tap_rate;
+
+    for (int i = 0; i < SPECTRUM_FFT_SIZE; i++)
+    {
+        work[i] = (tap_buf[i] * window_q15[i] + (1 << 14)) >> 15;
+    }
+
+    // The samples are copied out, so the next capture can fill while this frame is computed
+    spectrum_analyzer_arm();
+
+    dsp_fft_real_s32(&analyzer_fft, work);
+    uint32_t fft_cycles = esp_cpu_get_cycle_count() - start;
+
+    if (rate != column_rate)
+    {
+        spectrum_analyzer_build_columns(rate);
+    }
+
+    for (int c = 0; c < SPECTRUM_COLUMNS; c++)
+    {
+        float peak = 0.0f;
+        for (uint32_t k = column_bin_lo[c]; k < column_bin_hi[c]; k++)
+        {
+            float re = (float)work[2 * k];
+            float im = (float)work[2 * k + 1];
+            float power = re * re + im * im;
+            if (power > peak)
+            {
+                peak = power;
+            }
+        }
+
+        int32_t h = 0;
+        if (peak > 0.0f)
+        {
+            float db = 10.0f * log10f(peak / power_ref);
+            h = (int32_t)((db + SPECTRUM_RANGE_DB) * SPECTRUM_HEIGHT / SPECTRUM_RANGE_DB);
+            h = h < 0 ? 0 : (h > SPECTRUM_HEIGHT ? SPECTRUM_HEIGHT : h);
+        }
+
+        int32_t fallen = (int32_t)heights[c] - SPECTRUM_FALL_PX;
+        heights[c] = (uint8_t)(h > fallen ? h : (fallen > 0 ? fallen : 0));
+    }
+
+    spectrum_analyzer_publish(rate);
+    uint32_t frame_cycles = esp_cpu_get_cycle_count() - start;
+
+    int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&stats_lock);
+    stats.frames++;
+    stats.fft_cycles = fft_cycles;
+    if (fft_cycles > stats.fft_cycles_max)
+    {
+        stats.fft_cycles_max = fft_cycles;
+    }
+    stats.frame_cycles = frame_cycles;
+    if (last_publish_us != 0 && now_us > last_publish_us)
+    {
+        float fps = 1e6f / (float)(now_us - last_publish_us);
+        stats.fps = stats.fps == 0.0f ? fps : stats.fps + (fps - stats.fps) / 8.0f;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+    last_publish_us = now_us;
+}
+
+static void spectrum_analyzer_task(void *arg)
+{
+    const TickType_t period = pdMS_TO_TICKS(1000 / SPECTRUM_TARGET_FPS);
+    TickType_t last_wake = xTaskGetTickCount();
+    bool was_active = false;
+
+    while (1)
+    {
+        if (!analyzer_active)
+        {
+            // Parked until the page opens, no periodic wakeups meanwhile. An armed
+            // tap still completes once, after that the audio task only sees READY
+            was_active = false;
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            last_wake = xTaskGetTickCount();
+            continue;
+        }
+
+        vTaskDelayUntil(&last_wake, period);
+
+        uint32_t state = __atomic_load_n(&tap_state, __ATOMIC_ACQUIRE);
+
+        if (!was_active)
+        {
+            // Bars start from the floor each time the page is opened
+            memset(heights, 0, sizeof(heights));
+            last_publish_us = 0;
+            was_active = true;
+        }
+
+        if (state == SPECTRUM_TAP_IDLE)
+        {
+            spectrum_analyzer_arm();
+        }
+        else if (state == SPECTRUM_TAP_READY)
+        {
+            spectrum_analyzer_frame();
+        }
+        // ARMED: the audio task is still filling, try again next period
+    }
+}
+
+esp_err_t spectrum_analyzer_init(void)
+{
+    esp_err_t ret = dsp_fft_real_init(&analyzer_fft, SPECTRUM_FFT_SIZE);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "FFT init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    for (int i = 0; i < SPECTRUM_FFT_SIZE; i++)
+    {
+        float w = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / SPECTRUM_FFT_SIZE);
+        int32_t q = (int32_t)lroundf(w * 32768.0f);
+        window_q15[i] = (int16_t)(q > INT16_MAX ? INT16_MAX : q);
+    }
+
+    // Hann coherent gain is 1/2 and the FFT output is 2X, so a full-scale sine peaks at 32768 * N / 2
+    float ref = 32768.0f * SPECTRUM_FFT_SIZE / 2.0f;
+    power_ref = ref * ref;
+
+    memset(heights, 0, sizeof(heights));
+    memset(&stats, 0, sizeof(stats));
+    column_rate = 0;
+
+    ESP_LOGI(TAG, "Spectrum analyzer initialized - %d-point FFT, %d columns, %d fps target",
+             SPECTRUM_FFT_SIZE, SPECTRUM_COLUMNS, SPECTRUM_TARGET_FPS);
+    return ESP_OK;
+}
+
+esp_err_t spectrum_analyzer_start(void)
+{
+    if (analyzer_task_handle)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Lowest priority on the control core, the FFT only runs in its idle time
+    return app_tasks_create(APP_TASK_SPECTRUM, spectrum_analyzer_task, NULL, &analyzer_task_handle);
+}
+
+void spectrum_analyzer_set_active(bool active)
+{
+    analyzer_active = active;
+    if (active && analyzer_task_handle)
+    {
+        xTaskNotifyGive(analyzer_task_handle);
+    }
+}
+
+esp_err_t spectrum_analyzer_get_frame(spectrum_frame_t *frame)
+{
+    if (!frame)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (int attempt = 0; attempt < SPECTRUM_READ_RETRIES; attempt++)
+    {
+        uint32_t before = __atomic_load_n(&frame_seq, __ATOMIC_ACQUIRE);
+        if (before & 1)
+        {
+            continue;
+        }
+
+        memcpy(frame->height, frame_snap.height, sizeof(frame->height));
+        frame->tap_rate = frame_snap.tap_rate;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&frame_seq, __ATOMIC_RELAXED) == before)
+        {
+            frame->seq = before / 2;
+            return ESP_OK;
+        }
+    }
+
+    return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t spectrum_analyzer_get_stats(spectrum_stats_t *out)
+{
+    if (!out)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_lock);
+
+    out->cpu_percent = (float)out->frame_cycles * out->fps * 100.0f / (float)esp_clk_cpu_freq();
+    return ESP_OK;
+}
+
+void spectrum_analyzer_log_report(void)
+{
+    spectrum_stats_t s;
+    if (spectrum_analyzer_get_stats(&s) != ESP_OK)
+    {
+        return;
+    }
+
+    ESP_LOGI(TAG, "Spectrum: %" PRIu32 " frames at %.1f fps, FFT %" PRIu32 " cycles (max %" PRIu32
+                  "), frame %" PRIu32 " cycles, %.2f%% CPU",
+             s.frames, s.fps, s.fft_cycles, s.fft_cycles_max, s.frame_cycles, s.cpu_percent);
+}
@@ -0,0 +1,340 @@
+#include "task_monitor.h"
+#include "app_tasks.h"
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "TASK_MON";
+
+// A task keeps its slot, and so its history column, for as long as it exists
+typedef struct
+{
+    bool used;
+    bool seen; // Present in the latest sample
+    UBaseType_t number;
+    char name[TASK_MONITOR_NAME_LEN];
+    uint32_t last_runtime;
+} task_monitor_slot_t;
+
+static TaskHandle_t monitor_task_handle = NULL;
+static SemaphoreHandle_t monitor_lock = NULL;
+
+// Collector state, monitor task only; kept off its stack
+static TaskStatus_t status[TASK_MONITOR_MAX_TASKS];
+static task_monitor_slot_t slots[TASK_MONITOR_MAX_TASKS];
+static uint32_t last_total_runtime = 0;
+
+// Published under monitor_lock
+static task_monitor_snapshot_t latest;
+static task_monitor_sample_t *history = NULL; // SPIRAM when there is some, it is only read on request
+static uint32_t history_head = 0;
+static uint32_t history_count = 0;
+
+static uint16_t task_monitor_kb(size_t bytes)
+{
+    size_t kb = bytes / 1024;
+    return kb > UINT16_MAX ? UINT16_MAX : (uint16_t)kb;
+}
+
+static int task_monitor_find_slot(UBaseType_t number, const char *name)
+{
+    int free_slot = -1;
+    for (int i = 0; i < TASK_MONITOR_MAX_TASKS; i++)
+    {
+        if (slots[i].used && slots[i].number == number)
+        {
+            return i;
+        }
+        if (free_slot < 0 && !slots[i].used)
+        {
+            free_slot = i;
+        }
+    }
+
+    if (free_slot >= 0)
+    {
+        // A reused slot must not inherit the previous task's history
+        for (uint32_t i = 0; history && i < TASK_MONITOR_HISTORY; i++)
+        {
+            history[i].task_cpu_half_pct[free_slot] = TASK_MONITOR_ABSENT;
+            history[i].task_stack_free[free_slot] = 0;
+        }
+        slots[free_slot].used = true;
+        slots[free_slot].number = number;
+        slots[free_slot].last_runtime = 0;
+        strncpy(slots[free_slot].name, name, TASK_MONITOR_NAME_LEN - 1);
+        slots[free_slot].name[TASK_MONITOR_NAME_LEN - 1] = '\0';
+    }
+    return free_slot;
+}
+
+static int task_monitor_compare_cpu(const void *a, const void *b)
+{
+    const task_monitor_task_t *ta = (const task_monitor_task_t *)a;
+    const task_monitor_task_t *tb = (const task_monitor_task_t *)b;
+    return (int)tb->cpu_permille - (int)ta->cpu_permille;
+}
+
+static void task_monitor_collect(void)
+{
+    // Takes the kernel lock only while it walks the task lists, a few microseconds
+    uint32_t total_runtime = 0;
+    UBaseType_t count = uxTaskGetSystemState(status, TASK_MONITOR_MAX_TASKS, &total_runtime);
+    if (count == 0)
+    {
+        ESP_LOGW(TAG, "More than %d tasks, raise TASK_MONITOR_MAX_TASKS", TASK_MONITOR_MAX_TASKS);
+        return;
+    }
+
+    // Run-time counters share one time base; a task's delta over the total's is its share of one core
+    uint32_t elapsed = total_runtime - last_total_runtime;
+    bool have_rates = last_total_runtime != 0 && elapsed != 0;
+    last_total_runtime = total_runtime;
+
+    TaskHandle_t idle[TASK_MONITOR_CORES];
+    for (int core = 0; core < TASK_MONITOR_CORES; core++)
+    {
+        idle[core] = xTaskGetIdleTaskHandleForCore(core);
+    }
+
+    static task_monitor_snapshot_t snap;
+    memset(&snap, 0, sizeof(snap));
+    snap.time_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    snap.internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    snap.internal_min = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    snap.spiram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    snap.spiram_min = heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
+
+    // Slots and history change together, readers see either the old or the new sample
+    xSemaphoreTake(monitor_lock, portMAX_DELAY);
+    for (int i = 0; i < TASK_MONITOR_MAX_TASKS; i++)
+    {
+        slots[i].seen = false;
+    }
+
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        const TaskStatus_t *st = &status[i];
+        int slot = task_monitor_find_slot(st->xTaskNumber, st->pcTaskName);
+        if (slot < 0)
+        {
+            continue;
+        }
+
+        uint32_t ran = st->ulRunTimeCounter - slots[slot].last_runtime;
+        uint32_t permille = 0;
+        if (have_rates && slots[slot].last_runtime != 0)
+        {
+            permille = (uint32_t)(((uint64_t)ran * 1000 + elapsed / 2) / elapsed);
+            permille = permille > 1000 ? 1000 : permille;
+        }
+        slots[slot].last_runtime = st->ulRunTimeCounter;
+        slots[slot].seen = true;
+
+        for (int core = 0; core < TASK_MONITOR_CORES; core++)
+        {
+            if (st->xHandle == idle[core])
+            {
+                snap.core_load_permille[core] = have_rates ? (uint16_t)(1000 - permille) : 0;
+            }
+        }
+
+        task_monitor_task_t *task = &snap.tasks[snap.task_count++];
+        memcpy(task->name, slots[slot].name, TASK_MONITOR_NAME_LEN);
+        task->slot = (uint8_t)slot;
+        task->core = st->xCoreID < TASK_MONITOR_CORES ? (uint8_t)st->xCoreID : TASK_MONITOR_CORE_ANY;
+        task->priority = (uint8_t)st->uxCurrentPriority;
+        task->cpu_permille = (uint16_t)permille;
+        task->stack_free = st->usStackHighWaterMark; // Bytes on ESP-IDF, same as uxTaskGetStackHighWaterMark()
+    }
+
+    // Tasks that are gone free their slot
+    for (int i = 0; i < TASK_MONITOR_MAX_TASKS; i++)
+    {
+        if (slots[i].used && !slots[i].seen)
+        {
+            slots[i].used = false;
+        }
+    }
+
+    qsort(snap.tasks, snap.task_count, sizeof(snap.tasks[0]), task_monitor_compare_cpu);
+    snap.seq = latest.seq + 1;
+    latest = snap;
+
+    if (history)
+    {
+        task_monitor_sample_t *sample = &history[history_head];
+        sample->time_s = snap.time_s;
+        memcpy(sample->core_load_permille, snap.core_load_permille, sizeof(sample->core_load_permille));
+        sample->internal_free_kb = task_monitor_kb(snap.internal_free);
+        sample->internal_min_kb = task_monitor_kb(snap.internal_min);
+        sample->spiram_free_kb = task_monitor_kb(snap.spiram_free);
+        sample->spiram_min_kb = task_monitor_kb(snap.spiram_min);
+        memset(sample->task_cpu_half_pct, TASK_MONITOR_ABSENT, sizeof(sample->task_cpu_half_pct));
+        memset(sample->task_stack_free, 0, sizeof(sample->task_stack_free));
+        for (uint32_t i = 0; i < snap.task_count; i++)
+        {
+            const task_monitor_task_t *task = &snap.tasks[i];
+            uint32_t half_pct = (task->cpu_permille + 2) / 5;
+            sample->task_cpu_half_pct[task->slot] = (uint8_t)(half_pct > 200 ? 200 : half_pct);
+            sample->task_stack_free[task->slot] =
+                (uint16_t)(task->stack_free > UINT16_MAX ? UINT16_MAX : task->stack_free);
+        }
+        history_head = (history_head + 1) % TASK_MONITOR_HISTORY;
+        if (history_count < TASK_MONITOR_HISTORY)
+        {
+            history_count++;
+        }
+    }
+    xSemaphoreGive(monitor_lock);
+}
+
+static void task_monitor_task(void *arg)
+{
+    const TickType_t period = pdMS_TO_TICKS(TASK_MONITOR_PERIOD_MS);
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (1)
+    {
+        task_monitor_collect();
+        vTaskDelayUntil(&last_wake, period);
+    }
+}
+
+esp_err_t task_monitor_start(void)
+{
+    if (monitor_task_handle)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    monitor_lock = xSemaphoreCreateMutex();
+    if (!monitor_lock)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // History is a debugging aid, internal RAM is kept for the audio path when SPIRAM exists
+    size_t history_bytes = TASK_MONITOR_HISTORY * sizeof(task_monitor_sample_t);
+    history = heap_caps_malloc(history_bytes, MALLOC_CAP_SPIRAM);
+    if (!history)
+    {
+        history = malloc(history_bytes);
+    }
+    if (!history)
+    {
+        ESP_LOGW(TAG, "No memory for history, keeping the latest sample only");
+    }
+    else
+    {
+        memset(history, 0, history_bytes);
+    }
+
+    memset(slots, 0, sizeof(slots));
+    memset(&latest, 0, sizeof(latest));
+    history_head = 0;
+    history_count = 0;
+    last_total_runtime = 0;
+
+    esp_err_t ret = app_tasks_create(APP_TASK_MONITOR, task_monitor_task, NULL, &monitor_task_handle);
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Task monitor started - every %d ms, %d samples of history (%u bytes)", TASK_MONITOR_PERIOD_MS,
+             TASK_MONITOR_HISTORY, (unsigned)history_bytes);
+    return ESP_OK;
+}
+
+esp_err_t task_monitor_get_snapshot(task_monitor_snapshot_t *snapshot)
+{
+    if (!snapshot)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!monitor_lock)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(monitor_lock, portMAX_DELAY);
+    *snapshot = latest;
+    xSemaphoreGive(monitor_lock);
+    return ESP_OK;
+}
+
+size_t task_monitor_get_history(task_monitor_sample_t *samples, size_t max_count)
+{
+    if (!samples || !monitor_lock)
+    {
+        return 0;
+    }
+
+    xSemaphoreTake(monitor_lock, portMAX_DELAY);
+    size_t count = history_count < max_count ? history_count : max_count;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t index = (history_head + TASK_MONITOR_HISTORY - 1 - i) % TASK_MONITOR_HISTORY;
+        samples[i] = history[index];
+    }
+    xSemaphoreGive(monitor_lock);
+    return count;
+}
+
+esp_err_t task_monitor_get_slot_name(uint8_t slot, char *name, size_t len)
+{
+    if (!name || len == 0 || slot >= TASK_MONITOR_MAX_TASKS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!monitor_lock)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(monitor_lock, portMAX_DELAY);
+    esp_err_t ret = slots[slot].used ? ESP_OK : ESP_ERR_NOT_FOUND;
+    if (ret == ESP_OK)
+    {
+        strncpy(name, slots[slot].name, len - 1);
+        name[len - 1] = '\0';
+    }
+    xSemaphoreGive(monitor_lock);
+    return ret;
+}
+
+void task_monitor_log_report(void)
+{
+    static task_monitor_snapshot_t snap;
+    if (task_monitor_get_snapshot(&snap) != ESP_OK || snap.seq == 0)
+    {
+        return;
+    }
+
+    ESP_LOGI(TAG, "CPU0 %.1f%%, CPU1 %.1f%%; internal heap %" PRIu32 " free, %" PRIu32 " min; SPIRAM %" PRIu32
+                  " free, %" PRIu32 " min",
+             snap.core_load_permille[0] / 10.0f, snap.core_load_permille[1] / 10.0f, snap.internal_free,
+             snap.internal_min, snap.spiram_free, snap.spiram_min);
+    for (uint32_t i = 0; i < snap.task_count; i++)
+    {
+        const task_monitor_task_t *task = &snap.tasks[i];
+        char core[4];
+        if (task->core == TASK_MONITOR_CORE_ANY)
+        {
+            strcpy(core, "-");
+        }
+        else
+        {
+            snprintf(core, sizeof(core), "%u", task->core);
+        }
+        ESP_LOGI(TAG, "  %-16s core %s prio %2u  cpu %5.1f%%  stack free %5" PRIu32, task->name, core,
+                 task->priority, task->cpu_permille / 10.0f, task->stack_free);
+    }
+}
@@ -0,0 +1,154 @@
+#include "trace_buffer.h"
+#include <stdio.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "TRACE";
+
+#define TRACE_RING_MASK (TRACE_RING_EVENTS - 1)
+
+// Recording that was already past the enabled check when a dump paused it gets this long to finish
+#define TRACE_DUMP_SETTLE_MS 2
+
+typedef struct
+{
+    uint32_t head; // Slots reserved since boot; only the owning core's tasks and ISRs add to it
+    trace_event_t events[TRACE_RING_EVENTS];
+} trace_ring_t;
+
+// Internal RAM, so recording works from IRAM ISRs with the cache disabled
+static DRAM_ATTR trace_ring_t trace_rings[TRACE_CORES];
+static DRAM_ATTR volatile bool trace_enabled = TRACE_ENABLED;
+
+#define TRACE_EVENT_INFO(id, name, phase, arg0, arg1) {name, phase, arg0, arg1},
+static const struct
+{
+    const char *name;
+    char phase;
+    const char *arg0;
+    const char *arg1;
+} trace_event_info[TRACE_EV_COUNT] = {TRACE_EVENT_TABLE(TRACE_EVENT_INFO)};
+#undef TRACE_EVENT_INFO
+
+void IRAM_ATTR trace_buffer_record(uint16_t id, uint32_t arg0, uint32_t arg1)
+{
+    if (!trace_enabled)
+    {
+        return;
+    }
+
+    // A task or ISR preempting us on this core simply takes the next slot
+    trace_ring_t *ring = &trace_rings[esp_cpu_get_core_id()];
+    uint32_t index = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+    trace_event_t *event = &ring->events[index & TRACE_RING_MASK];
+
+    // Mark the slot torn before overwriting it; no index that maps to this slot
+    // has index as its sequence, so a reader of the old event sees the change
+    __atomic_store_n(&event->seq, (uint16_t)index, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    event->timestamp_us = (uint32_t)esp_timer_get_time();
+    event->id = id;
+    event->arg0 = arg0;
+    event->arg1 = arg1;
+    __atomic_store_n(&event->seq, (uint16_t)(index + 1), __ATOMIC_RELEASE);
+}
+
+// Slots being written, or already reused by a newer event, fail the sequence check
+static bool trace_copy_slot(const trace_ring_t *ring, uint32_t index, trace_event_t *event)
+{
+    const trace_event_t *slot = &ring->events[index & TRACE_RING_MASK];
+    uint16_t expected = (uint16_t)(index + 1);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != expected)
+    {
+        return false;
+    }
+    *event = *slot;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == expected;
+}
+
+// First index still held by the ring
+static uint32_t trace_oldest(uint32_t head)
+{
+    return head < TRACE_RING_EVENTS ? 0 : head - TRACE_RING_EVENTS;
+}
+
+void trace_buffer_set_enabled(bool enabled)
+{
+    trace_enabled = enabled;
+}
+
+esp_err_t trace_buffer_get_stats(trace_stats_t *stats)
+{
+    if (!stats)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (int core = 0; core < TRACE_CORES; core++)
+    {
+        uint32_t head = __atomic_load_n(&trace_rings[core].head, __ATOMIC_RELAXED);
+        stats->recorded[core] = head;
+        stats->overwritten[core] = trace_oldest(head);
+    }
+    stats->enabled = trace_enabled;
+    return ESP_OK;
+}
+
+void trace_buffer_clear(void)
+{
+    // Invalidates every slot: no sequence number matches an index below the new head
+    for (int core = 0; core < TRACE_CORES; core++)
+    {
+        __atomic_fetch_add(&trace_rings[core].head, TRACE_RING_EVENTS, __ATOMIC_RELEASE);
+    }
+}
+
+void trace_buffer_dump(void)
+{
+    // Frozen while it is printed, which takes a few seconds at console speed
+    bool was_enabled = trace_enabled;
+    trace_enabled = false;
+    vTaskDelay(pdMS_TO_TICKS(TRACE_DUMP_SETTLE_MS));
+
+    trace_stats_t stats;
+    trace_buffer_get_stats(&stats);
+    int64_t now_us = esp_timer_get_time();
+
+    // Line format read by tools/trace_decode.py; bump the version when it changes
+    printf("TRACE-BEGIN 1 %d %d %" PRId64 "\n", TRACE_CORES, TRACE_RING_EVENTS, now_us);
+    for (int id = 0; id < TRACE_EV_COUNT; id++)
+    {
+        printf("TRACE-ID %d %c %s %s %s\n", id, trace_event_info[id].phase, trace_event_info[id].name,
+               trace_event_info[id].arg0, trace_event_info[id].arg1);
+    }
+
+    // Straight from the frozen rings, oldest first per core
+    uint32_t total = 0;
+    for (int core = 0; core < TRACE_CORES; core++)
+    {
+        const trace_ring_t *ring = &trace_rings[core];
+        uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        for (uint32_t index = trace_oldest(head); index != head; index++)
+        {
+            trace_event_t event;
+            if (trace_copy_slot(ring, index, &event))
+            {
+                printf("TRACE-EV %d %08" PRIx32 " %u %08" PRIx32 " %08" PRIx32 "\n", core, event.timestamp_us,
+                       event.id, event.arg0, event.arg1);
+                total++;
+            }
+        }
+    }
+    printf("TRACE-END %" PRIu32 "\n", total);
+
+    ESP_LOGI(TAG, "Dumped %" PRIu32 " events; recorded %" PRIu32 "/%" PRIu32 ", overwritten %" PRIu32 "/%" PRIu32,
+             total, stats.recorded[0], stats.recorded[1], stats.overwritten[0], stats.overwritten[1]);
+    trace_enabled = was_enabled;
+}
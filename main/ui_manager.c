@@ -1,5 +1,10 @@
 #include "ui_manager.h"
 #include "audio_delay.h"
+#include "audio_meter.h"
+#include "spectrum_analyzer.h"
+#include "task_monitor.h"
+#include "trace_buffer.h"
+#include "metrics.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include <string.h>
@@ -9,6 +14,38 @@ static const char *TAG = "UI_MANAGER";
 // Auto-save timeout (5 seconds of inactivity)
 #define AUTO_SAVE_TIMEOUT_MS 5000
 
+// Main loop wait between display updates: moving meters or bars refresh at the
+// meter rate, a still page only needs the auto-save check
+#define UI_REFRESH_MS 100
+#define UI_IDLE_REFRESH_MS 1000
+#define UI_METER_SETTLE_MS 2000 // Meters unchanged this long count as still
+
+// Dry/wet mix adjustment step in percent
+#define MIX_STEP_PERCENT 5
+
+// Requests from other tasks; a caller waits out a full sample rate switch in the UI task
+#define UI_REQUEST_QUEUE_LEN 16
+#define UI_REQUEST_TIMEOUT_MS (2 * RATE_SWITCH_TIMEOUT_MS + 1000)
+
+typedef enum
+{
+    UI_REQUEST_ENCODER,      // Knob event, nobody waits for it
+    UI_REQUEST_DELAY,
+    UI_REQUEST_SAMPLE_RATE,
+    UI_REQUEST_MIX,
+    UI_REQUEST_SETTINGS,     // All three at once
+    UI_REQUEST_GET_SETTINGS
+} ui_request_type_t;
+
+typedef struct
+{
+    ui_request_type_t type;
+    uint32_t seq; // Matches the reply to the waiting caller
+    ec11_event_t event;
+    uint32_t value;
+    user_settings_t settings;
+} ui_request_t;
+
 // Sample rate mapping
 static const uint32_t sample_rate_values[SAMPLE_RATE_COUNT] = {
     44100, // SAMPLE_RATE_44K
@@ -24,6 +61,19 @@ esp_err_t ui_manager_init(ui_manager_t *ui)
         return ESP_ERR_INVALID_ARG;
     }
 
+    ui->requests = xQueueCreate(UI_REQUEST_QUEUE_LEN, sizeof(ui_request_t));
+    ui->request_lock = xSemaphoreCreateMutex();
+    ui->request_done = xSemaphoreCreateBinary();
+    if (!ui->requests || !ui->request_lock || !ui->request_done)
+    {
+        ESP_LOGE(TAG, "Failed to create request queue");
+        return ESP_ERR_NO_MEM;
+    }
+    ui->request_seq = 0;
+    ui->request_done_seq = 0;
+    ui->request_result = ESP_OK;
+    ui->owner = NULL;
+
     // Initialize UI state
     ui->current_state = UI_STATE_MAIN;
     ui->selected_sample_rate = SAMPLE_RATE_48K;
@@ -39,6 +89,7 @@ esp_err_t ui_manager_init(ui_manager_t *ui)
     // Update display with loaded settings
     ESP_ERROR_CHECK(oled_display_update_delay(&ui->display, ui->settings.delay_ms));
     ESP_ERROR_CHECK(oled_display_update_sample_rate(&ui->display, ui->settings.sample_rate));
+    ESP_ERROR_CHECK(oled_display_update_mix(&ui->display, ui->settings.mix_percent));
 
     // Set initial sample rate selection based on loaded settings
     ui->selected_sample_rate = ui_manager_get_sample_rate_option(ui->settings.sample_rate);
@@ -66,11 +117,18 @@ esp_err_t ui_manager_deinit(ui_manager_t *ui)
     // Deinitialize display
     ESP_ERROR_CHECK(oled_display_deinit(&ui->display));
 
+    vQueueDelete(ui->requests);
+    vSemaphoreDelete(ui->request_lock);
+    vSemaphoreDelete(ui->request_done);
+    ui->requests = NULL;
+    ui->request_lock = NULL;
+    ui->request_done = NULL;
+
     ESP_LOGI(TAG, "UI manager deinitialized");
     return ESP_OK;
 }
 
-void ui_manager_handle_encoder_event(ui_manager_t *ui, ec11_event_t event)
+static void ui_manager_handle_encoder_event(ui_manager_t *ui, ec11_event_t event)
 {
     if (!ui)
     {
@@ -78,6 +136,7 @@ void ui_manager_handle_encoder_event(ui_manager_t *ui, ec11_event_t event)
     }
 
     ui->last_interaction_time = esp_timer_get_time() / 1000; // Update interaction time
+    METRIC_INC(METRIC_ENCODER_EVENTS);
 
     switch (ui->current_state)
     {
@@ -123,6 +182,153 @@ void ui_manager_handle_encoder_event(ui_manager_t *ui, ec11_event_t event)
             oled_display_show_menu(&ui->display);
             break;
 
+        case EC11_LONG_PRESSED:
+            // Enter dry/wet mix page
+            ui->current_state = UI_STATE_MIX;
+            oled_display_show_mix(&ui->display);
+            break;
+
+        default:
+            break;
+        }
+        break;
+
+    case UI_STATE_MIX:
+        switch (event)
+        {
+        case EC11_CW:
+            // More delayed signal
+            if (ui->settings.mix_percent < 100)
+            {
+                ui->settings.mix_percent += MIX_STEP_PERCENT;
+                if (ui->settings.mix_percent > 100)
+                {
+                    ui->settings.mix_percent = 100;
+                }
+                oled_display_update_mix(&ui->display, ui->settings.mix_percent);
+                ui->settings_changed = true;
+            }
+            break;
+
+        case EC11_CCW:
+            // More direct signal
+            if (ui->settings.mix_percent > 0)
+            {
+                if (ui->settings.mix_percent >= MIX_STEP_PERCENT)
+                {
+                    ui->settings.mix_percent -= MIX_STEP_PERCENT;
+                }
+                else
+                {
+                    ui->settings.mix_percent = 0;
+                }
+                oled_display_update_mix(&ui->display, ui->settings.mix_percent);
+                ui->settings_changed = true;
+            }
+            break;
+
+        case EC11_PRESSED:
+            // Back to main
+            ui->current_state = UI_STATE_MAIN;
+            oled_display_show_main(&ui->display);
+            break;
+
+        case EC11_LONG_PRESSED:
+            // On to the spectrum page; the analyzer only runs while it is shown
+            ui->current_state = UI_STATE_SPECTRUM;
+            oled_display_show_spectrum(&ui->display);
+            spectrum_analyzer_set_active(true);
+            break;
+
+        default:
+            break;
+        }
+        break;
+
+    case UI_STATE_SPECTRUM:
+        switch (event)
+        {
+        case EC11_PRESSED:
+            // Back to main
+            spectrum_analyzer_set_active(false);
+            oled_display_log_spectrum_rate(&ui->display);
+            spectrum_analyzer_log_report();
+            ui->current_state = UI_STATE_MAIN;
+            oled_display_show_main(&ui->display);
+            break;
+
+        case EC11_LONG_PRESSED:
+            // On to the debug page
+            spectrum_analyzer_set_active(false);
+            oled_display_log_spectrum_rate(&ui->display);
+            spectrum_analyzer_log_report();
+            ui->current_state = UI_STATE_DEBUG;
+            oled_display_show_debug(&ui->display);
+            break;
+
+        default:
+            break;
+        }
+        break;
+
+    case UI_STATE_DEBUG:
+        switch (event)
+        {
+        case EC11_CW:
+            // Scroll the task list, redrawn from the current sample
+            ui->display.debug_first++;
+            ui->display.debug_seq = 0;
+            break;
+
+        case EC11_CCW:
+            if (ui->display.debug_first > 0)
+            {
+                ui->display.debug_first--;
+                ui->display.debug_seq = 0;
+            }
+            break;
+
+        case EC11_PRESSED:
+            // Back to main
+            task_monitor_log_report();
+            ui->current_state = UI_STATE_MAIN;
+            oled_display_show_main(&ui->display);
+            break;
+
+        case EC11_LONG_PRESSED:
+            // On to the metrics page
+            ui->current_state = UI_STATE_METRICS;
+            oled_display_show_metrics(&ui->display);
+            break;
+
+        default:
+            break;
+        }
+        break;
+
+    case UI_STATE_METRICS:
+        switch (event)
+        {
+        case EC11_CW:
+            oled_display_scroll_metrics(&ui->display, 1);
+            break;
+
+        case EC11_CCW:
+            oled_display_scroll_metrics(&ui->display, -1);
+            break;
+
+        case EC11_PRESSED:
+            // Back to main
+            metrics_log_report();
+            ui->current_state = UI_STATE_MAIN;
+            oled_display_show_main(&ui->display);
+            break;
+
+        case EC11_LONG_PRESSED:
+            // Event trace to the console for tools/trace_decode.py; the page stays
+            trace_buffer_dump();
+            break;
+
         default:
             break;
         }
@@ -194,11 +400,19 @@ esp_err_t ui_manager_update_display(ui_manager_t *ui)
     }
 
     // Update display based on current state
+    int64_t update_start_us = esp_timer_get_time();
     switch (ui->current_state)
     {
     case UI_STATE_MAIN:
-        // Update main display if needed
+    {
+        // Level meters, redrawn only where they changed
+        audio_meter_snapshot_t levels;
+        if (audio_meter_get_snapshot(&levels) == ESP_OK)
+        {
+            oled_display_update_meters(&ui->display, &levels);
+        }
         break;
+    }
 
     case UI_STATE_MENU:
         // Update menu display
@@ -209,11 +423,75 @@ esp_err_t ui_manager_update_display(ui_manager_t *ui)
         // Update menu with confirmation
         oled_display_show_menu(&ui->display);
         break;
+
+    case UI_STATE_MIX:
+        // Update mix page
+        oled_display_show_mix(&ui->display);
+        break;
+
+    case UI_STATE_SPECTRUM:
+    {
+        // Newest analyzer frame; the page changes only where the bars moved
+        spectrum_frame_t frame;
+        if (spectrum_analyzer_get_frame(&frame) == ESP_OK)
+        {
+            oled_display_update_spectrum(&ui->display, &frame);
+        }
+        break;
+    }
+
+    case UI_STATE_DEBUG:
+    {
+        // Too large for the UI task's stack; only this task reads it
+        static task_monitor_snapshot_t snapshot;
+        if (task_monitor_get_snapshot(&snapshot) == ESP_OK)
+        {
+            oled_display_update_debug(&ui->display, &snapshot);
+        }
+        break;
+    }
+
+    case UI_STATE_METRICS:
+    {
+        // Rows are only resent where their text changed
+        metrics_snapshot_t snapshot;
+        if (metrics_get_snapshot(&snapshot) == ESP_OK)
+        {
+            oled_display_update_metrics(&ui->display, &snapshot);
+        }
+        break;
+    }
     }
+    METRIC_OBSERVE(METRIC_HIST_DISPLAY_UPDATE, esp_timer_get_time() - update_start_us);
 
     return ESP_OK;
 }
 
+uint32_t ui_manager_get_refresh_ms(ui_manager_t *ui)
+{
+    if (!ui)
+    {
+        return UI_IDLE_REFRESH_MS;
+    }
+
+    switch (ui->current_state)
+    {
+    case UI_STATE_SPECTRUM:
+        return UI_REFRESH_MS;
+
+    case UI_STATE_MAIN:
+    {
+        // Back off once the bars have settled, e.g. on a silent input
+        int64_t still_us = esp_timer_get_time() - ui->display.meter_changed_us;
+        return still_us < UI_METER_SETTLE_MS * 1000LL ? UI_REFRESH_MS : UI_IDLE_REFRESH_MS;
+    }
+
+    default:
+        // Menus only change on encoder events, which wake the main loop themselves; the debug pages once a second
+        return UI_IDLE_REFRESH_MS;
+    }
+}
+
 esp_err_t ui_manager_save_settings(ui_manager_t *ui)
 {
     if (!ui)
@@ -272,6 +550,233 @@ uint32_t ui_manager_get_current_sample_rate(ui_manager_t *ui)
     return ui->settings.sample_rate;
 }
 
+// Helper function to get current dry/wet mix in percent
+uint32_t ui_manager_get_current_mix(ui_manager_t *ui)
+{
+    if (!ui)
+    {
+        return DEFAULT_MIX_PERCENT;
+    }
+    return ui->settings.mix_percent;
+}
+
+static void ui_manager_apply_delay(ui_manager_t *ui, uint32_t delay_ms)
+{
+    ui->settings.delay_ms = delay_ms;
+    oled_display_update_delay(&ui->display, delay_ms);
+    ui->settings_changed = true;
+    ui->last_interaction_time = esp_timer_get_time() / 1000;
+}
+
+static void ui_manager_apply_sample_rate(ui_manager_t *ui, uint32_t sample_rate)
+{
+    ui->settings.sample_rate = sample_rate;
+    ui->selected_sample_rate = ui_manager_get_sample_rate_option(sample_rate);
+    oled_display_update_sample_rate(&ui->display, sample_rate);
+    ui->settings_changed = true;
+    ui->last_interaction_time = esp_timer_get_time() / 1000;
+}
+
+static void ui_manager_apply_mix(ui_manager_t *ui, uint32_t mix_percent)
+{
+    ui->settings.mix_percent = mix_percent;
+    oled_display_update_mix(&ui->display, mix_percent);
+    ui->settings_changed = true;
+    ui->last_interaction_time = esp_timer_get_time() / 1000;
+}
+
+// Runs in the UI task only
+static esp_err_t ui_manager_apply_request(ui_manager_t *ui, const ui_request_t *request)
+{
+    switch (request->type)
+    {
+    case UI_REQUEST_ENCODER:
+        ui_manager_handle_encoder_event(ui, request->event);
+        break;
+
+    case UI_REQUEST_DELAY:
+        ui_manager_apply_delay(ui, request->value);
+        break;
+
+    case UI_REQUEST_SAMPLE_RATE:
+        ui_manager_apply_sample_rate(ui, request->value);
+        break;
+
+    case UI_REQUEST_MIX:
+        ui_manager_apply_mix(ui, request->value);
+        break;
+
+    case UI_REQUEST_SETTINGS:
+        ui_manager_apply_delay(ui, request->settings.delay_ms);
+        ui_manager_apply_sample_rate(ui, request->settings.sample_rate);
+        ui_manager_apply_mix(ui, request->settings.mix_percent);
+        break;
+
+    case UI_REQUEST_GET_SETTINGS:
+        ui->request_settings = ui->settings;
+        break;
+    }
+    return ESP_OK;
+}
+
+static void ui_manager_wake(ui_manager_t *ui)
+{
+    if (ui->owner)
+    {
+        xTaskNotifyGive(ui->owner);
+    }
+}
+
+// Queue a request for the UI task and wait until it has been applied. The UI task
+// itself applies it in place, e.g. when it corrects the rate after a failed switch.
+static esp_err_t ui_manager_request(ui_manager_t *ui, ui_request_t *request, user_settings_t *reply)
+{
+    if (xTaskGetCurrentTaskHandle() == ui->owner)
+    {
+        esp_err_t ret = ui_manager_apply_request(ui, request);
+        if (reply)
+        {
+            *reply = ui->request_settings;
+        }
+        return ret;
+    }
+
+    xSemaphoreTake(ui->request_lock, portMAX_DELAY);
+    request->seq = ++ui->request_seq;
+
+    esp_err_t ret = ESP_ERR_TIMEOUT;
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(UI_REQUEST_TIMEOUT_MS);
+    if (xQueueSend(ui->requests, request, timeout) == pdTRUE)
+    {
+        ui_manager_wake(ui);
+
+        // A request that timed out earlier may still complete ahead of this one
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        while (elapsed < timeout && xSemaphoreTake(ui->request_done, timeout - elapsed) == pdTRUE)
+        {
+            if (ui->request_done_seq == request->seq)
+            {
+                ret = ui->request_result;
+                if (reply)
+                {
+                    *reply = ui->request_settings;
+                }
+                break;
+            }
+            elapsed = xTaskGetTickCount() - start;
+        }
+    }
+
+    if (ret == ESP_ERR_TIMEOUT)
+    {
+        ESP_LOGW(TAG, "UI task did not take request %d in time", (int)request->type);
+    }
+    xSemaphoreGive(ui->request_lock);
+    return ret;
+}
+
+// Knob events from the encoder task; it must not block, so a full queue drops the event
+esp_err_t ui_manager_post_encoder_event(ui_manager_t *ui, ec11_event_t event)
+{
+    if (!ui)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ui_request_t request = {.type = UI_REQUEST_ENCODER, .event = event};
+    if (xQueueSend(ui->requests, &request, 0) != pdTRUE)
+    {
+        ESP_LOGW(TAG, "Request queue full, encoder event dropped");
+        return ESP_ERR_NO_MEM;
+    }
+    ui_manager_wake(ui);
+    return ESP_OK;
+}
+
+// Called at the top of each UI task pass; the first call makes the caller the owner
+void ui_manager_process_requests(ui_manager_t *ui)
+{
+    if (!ui)
+    {
+        return;
+    }
+
+    ui->owner = xTaskGetCurrentTaskHandle();
+
+    ui_request_t request;
+    while (xQueueReceive(ui->requests, &request, 0) == pdTRUE)
+    {
+        esp_err_t ret = ui_manager_apply_request(ui, &request);
+        if (request.type != UI_REQUEST_ENCODER)
+        {
+            ui->request_result = ret;
+            ui->request_done_seq = request.seq;
+            xSemaphoreGive(ui->request_done);
+        }
+    }
+}
+
+esp_err_t ui_manager_set_delay(ui_manager_t *ui, uint32_t delay_ms)
+{
+    if (!ui || delay_ms > MAX_DELAY_MS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ui_request_t request = {.type = UI_REQUEST_DELAY, .value = delay_ms};
+    return ui_manager_request(ui, &request, NULL);
+}
+
+esp_err_t ui_manager_set_sample_rate(ui_manager_t *ui, uint32_t sample_rate)
+{
+    // Only the rates the menu offers
+    if (!ui || ui_manager_get_sample_rate_value(ui_manager_get_sample_rate_option(sample_rate)) != sample_rate)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ui_request_t request = {.type = UI_REQUEST_SAMPLE_RATE, .value = sample_rate};
+    return ui_manager_request(ui, &request, NULL);
+}
+
+esp_err_t ui_manager_set_mix(ui_manager_t *ui, uint32_t mix_percent)
+{
+    if (!ui || mix_percent > 100)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ui_request_t request = {.type = UI_REQUEST_MIX, .value = mix_percent};
+    return ui_manager_request(ui, &request, NULL);
+}
+
+// All three at once, e.g. from a preset; nothing changes if any value is out of range,
+// and the UI task never renders or saves a mix of old and new values
+esp_err_t ui_manager_apply_settings(ui_manager_t *ui, const user_settings_t *settings)
+{
+    if (!ui || !settings || settings->delay_ms > MAX_DELAY_MS || settings->mix_percent > 100 ||
+        ui_manager_get_sample_rate_value(ui_manager_get_sample_rate_option(settings->sample_rate)) !=
+            settings->sample_rate)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ui_request_t request = {.type = UI_REQUEST_SETTINGS, .settings = *settings};
+    return ui_manager_request(ui, &request, NULL);
+}
+
+esp_err_t ui_manager_get_settings(ui_manager_t *ui, user_settings_t *settings)
+{
+    if (!ui || !settings)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ui_request_t request = {.type = UI_REQUEST_GET_SETTINGS};
+    return ui_manager_request(ui, &request, settings);
+}
+
 // Helper function to check if settings have changed
 bool ui_manager_settings_changed(ui_manager_t *ui)
 {
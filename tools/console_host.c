@@ -0,0 +1,274 @@
+/*
+ * Runs the firmware's console commands on a host, one line from stdin at a
+ * time, against an in-memory model of the device. Lets the parser and the
+ * handlers be exercised without a board:
+ *
+ *     gcc -std=c99 -Wall -I main/include -o console_host tools/console_host.c main/console_commands.c
+ *     printf 'delay 8765\nrate 96000\npreset save 1\nstatus\n' | ./console_host
+ *
+ * Each command's result code is echoed after its output, so a script's
+ * output can be diffed against a known-good transcript. The exit status is
+ * the number of lines that did not return CONSOLE_OK.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "console_commands.h"
+
+#define HOST_MAX_DELAY_MS 10000
+#define HOST_PRESET_SLOTS 8
+#define HOST_EQ_BANDS 8
+
+typedef struct
+{
+    uint32_t delay_ms;
+    uint32_t sample_rate;
+    uint32_t mix_percent;
+} host_settings_t;
+
+static host_settings_t current = {30, 48000, 100};
+static host_settings_t presets[HOST_PRESET_SLOTS];
+static int preset_used[HOST_PRESET_SLOTS];
+static int trace_enabled = 1;
+static int eq_bands = 0;
+static int gen_type = 0;
+static int32_t feedback_q15 = 0;
+static int32_t damping_q15 = 0;
+
+static uint32_t host_get_delay(void)
+{
+    return current.delay_ms;
+}
+
+static int host_set_delay(uint32_t delay_ms)
+{
+    if (delay_ms > HOST_MAX_DELAY_MS)
+    {
+        return -1;
+    }
+    current.delay_ms = delay_ms;
+    return 0;
+}
+
+static uint32_t host_get_sample_rate(void)
+{
+    return current.sample_rate;
+}
+
+static int host_set_sample_rate(uint32_t sample_rate)
+{
+    if (sample_rate != 44100 && sample_rate != 48000 && sample_rate != 96000 && sample_rate != 192000)
+    {
+        return -1;
+    }
+    current.sample_rate = sample_rate;
+    return 0;
+}
+
+static uint32_t host_get_mix(void)
+{
+    return current.mix_percent;
+}
+
+static int host_set_mix(uint32_t mix_percent)
+{
+    if (mix_percent > 100)
+    {
+        return -1;
+    }
+    current.mix_percent = mix_percent;
+    return 0;
+}
+
+static void host_get_feedback(int32_t *feedback, int32_t *damping)
+{
+    *feedback = feedback_q15;
+    *damping = damping_q15;
+}
+
+static int host_set_feedback(int32_t feedback, int32_t damping)
+{
+    feedback_q15 = feedback;
+    damping_q15 = damping;
+    return 0;
+}
+
+static void host_metrics_report(void)
+{
+    printf("(metrics report)\n");
+}
+
+static void host_metrics_reset(void)
+{
+}
+
+static void host_trace_dump(void)
+{
+    printf("TRACE-BEGIN 1 2 512 0\nTRACE-END 0\n");
+}
+
+static void host_trace_clear(void)
+{
+}
+
+static void host_trace_enable(bool enabled)
+{
+    trace_enabled = enabled;
+}
+
+static void host_tasks_report(void)
+{
+    printf("(task report)\n");
+}
+
+static int host_preset_save(uint32_t slot)
+{
+    presets[slot] = current;
+    preset_used[slot] = 1;
+    return 0;
+}
+
+static int host_preset_load(uint32_t slot)
+{
+    if (!preset_used[slot])
+    {
+        return -1;
+    }
+    current = presets[slot];
+    return 0;
+}
+
+static int host_calibrate(uint32_t seconds)
+{
+    printf("(measured %u s)\n", (unsigned)seconds);
+    return 0;
+}
+
+static int host_cue(console_cue_param_t param, uint32_t value, uint32_t at_ms)
+{
+    static const uint32_t limits[] = {HOST_MAX_DELAY_MS, 100, 199, CONSOLE_FEEDBACK_Q15_MAX};
+    if (value > limits[param])
+    {
+        return -1;
+    }
+    printf("(scheduled %d = %u at %u ms)\n", (int)param, (unsigned)value, (unsigned)at_ms);
+    return 0;
+}
+
+static void host_cue_start(void)
+{
+}
+
+static void host_cue_clear(void)
+{
+}
+
+static void host_cue_report(void)
+{
+    printf("(cue report)\n");
+}
+
+static int host_bench(const char *suite, uint32_t block_samples)
+{
+    static const char *const suites[] = {"all", "kernels", "biquad", "fft", "gen", "convert", "backends", "delay"};
+    size_t i = 0;
+    while (i < sizeof(suites) / sizeof(suites[0]) && strcmp(suite, suites[i]) != 0)
+    {
+        i++;
+    }
+    if (i == sizeof(suites) / sizeof(suites[0]))
+    {
+        return -1;
+    }
+    printf("(bench %s, %u samples)\n", suite, (unsigned)block_samples);
+    return 0;
+}
+
+static int host_eq_add(console_eq_type_t type, uint32_t freq_hz, float q, float gain_db)
+{
+    // Below Nyquist at 48 kHz, positive Q, within +-12 dB
+    if (eq_bands >= HOST_EQ_BANDS || freq_hz == 0 || freq_hz >= 24000 || q <= 0.0f || gain_db > 12.0f ||
+        gain_db < -12.0f)
+    {
+        return -1;
+    }
+    printf("(band %d: type %d)\n", eq_bands, (int)type);
+    eq_bands++;
+    return 0;
+}
+
+static int host_eq_clear(void)
+{
+    eq_bands = 0;
+    return 0;
+}
+
+static void host_eq_report(void)
+{
+    printf("(eq, %d bands)\n", eq_bands);
+}
+
+static int host_gen_set(console_gen_type_t type, uint32_t freq_hz, uint32_t level_percent)
+{
+    if (freq_hz >= 24000 || (type == CONSOLE_GEN_IMPULSE && freq_hz > 1000))
+    {
+        return -1;
+    }
+    gen_type = (int)type;
+    printf("(generator %d, %u Hz, %u%%)\n", gen_type, (unsigned)freq_hz, (unsigned)level_percent);
+    return 0;
+}
+
+static void host_gen_report(void)
+{
+    printf("(generator %d)\n", gen_type);
+}
+
+static const console_ops_t host_ops = {
+    .get_delay_ms = host_get_delay,
+    .set_delay_ms = host_set_delay,
+    .get_sample_rate = host_get_sample_rate,
+    .set_sample_rate = host_set_sample_rate,
+    .get_mix_percent = host_get_mix,
+    .set_mix_percent = host_set_mix,
+    .get_feedback = host_get_feedback,
+    .set_feedback = host_set_feedback,
+    .metrics_report = host_metrics_report,
+    .metrics_reset = host_metrics_reset,
+    .trace_dump = host_trace_dump,
+    .trace_clear = host_trace_clear,
+    .trace_enable = host_trace_enable,
+    .tasks_report = host_tasks_report,
+    .preset_save = host_preset_save,
+    .preset_load = host_preset_load,
+    .preset_slots = HOST_PRESET_SLOTS,
+    .calibrate = host_calibrate,
+    .cue = host_cue,
+    .cue_start = host_cue_start,
+    .cue_clear = host_cue_clear,
+    .cue_report = host_cue_report,
+    .bench = host_bench,
+    .eq_add = host_eq_add,
+    .eq_clear = host_eq_clear,
+    .eq_report = host_eq_report,
+    .gen_set = host_gen_set,
+    .gen_report = host_gen_report,
+};
+
+int main(void)
+{
+    char line[CONSOLE_LINE_MAX * 2];
+    int failures = 0;
+
+    console_commands_init(&host_ops, stdout);
+    while (fgets(line, sizeof(line), stdin))
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        int result = console_commands_run_line(line);
+        if (line[0] != '\0' && line[0] != '#')
+        {
+            printf("> %s -> %d\n", line, result);
+        }
+        failures += result != CONSOLE_OK;
+    }
+    return failures;
+}
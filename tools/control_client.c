@@ -0,0 +1,270 @@
+/*
+ * Reference host client for the binary control protocol. Build it together
+ * with the firmware's framing code:
+ *
+ *     gcc -std=c99 -Wall -I main/include -I tools -c tools/control_client.c main/control_protocol.c
+ *
+ * Requests are synchronous: one frame out, then bytes are read until the
+ * reply with the same sequence number arrives. Telemetry frames seen on the
+ * way are handed to the callback, so streaming and parameter writes can
+ * share the port.
+ */
+#define _DEFAULT_SOURCE
+#include "control_client.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+static speed_t control_client_speed(int baud)
+{
+    switch (baud)
+    {
+    case 9600:
+        return B9600;
+    case 115200:
+        return B115200;
+    case 230400:
+        return B230400;
+#ifdef B460800
+    case 460800:
+        return B460800;
+#endif
+#ifdef B921600
+    case 921600:
+        return B921600;
+#endif
+    default:
+        return 0;
+    }
+}
+
+static int64_t control_client_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void control_client_attach(control_client_t *client, int fd)
+{
+    memset(client, 0, sizeof(*client));
+    client->fd = fd;
+    control_parser_init(&client->parser);
+}
+
+int control_client_open(control_client_t *client, const char *path, int baud)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    // Raw 8N1, no flow control; a pty ignores the speed
+    struct termios tio;
+    speed_t speed = control_client_speed(baud);
+    if (tcgetattr(fd, &tio) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~CRTSCTS;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    if (speed)
+    {
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+    }
+    if (tcsetattr(fd, TCSANOW, &tio) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+
+    control_client_attach(client, fd);
+    return 0;
+}
+
+void control_client_close(control_client_t *client)
+{
+    if (client->fd >= 0)
+    {
+        close(client->fd);
+        client->fd = -1;
+    }
+}
+
+void control_client_on_telemetry(control_client_t *client, control_telemetry_cb_t cb, void *arg)
+{
+    client->on_telemetry = cb;
+    client->arg = arg;
+}
+
+static void control_client_telemetry(control_client_t *client, const control_frame_t *frame)
+{
+    client->telemetry_frames++;
+    if (!client->on_telemetry || frame->length < 5)
+    {
+        return;
+    }
+
+    uint32_t values[CONTROL_TELEMETRY_MAX_VALUES];
+    size_t count = frame->payload[4];
+    if (count > CONTROL_TELEMETRY_MAX_VALUES || 5 + 4 * count > frame->length)
+    {
+        return;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        values[i] = control_get_u32(&frame->payload[5 + 4 * i]);
+    }
+    client->on_telemetry(control_get_u32(frame->payload), values, count, client->arg);
+}
+
+// Reads until a reply with the given sequence arrives (seq < 0: until the timeout)
+static int control_client_wait(control_client_t *client, int seq, control_frame_t *reply, int timeout_ms)
+{
+    int64_t deadline = control_client_now_ms() + timeout_ms;
+
+    for (;;)
+    {
+        while (client->rx_pos < client->rx_length)
+        {
+            const control_frame_t *frame = control_parser_feed(&client->parser, client->rx[client->rx_pos++]);
+            if (!frame)
+            {
+                continue;
+            }
+            if (frame->type == CONTROL_MSG_TELEMETRY)
+            {
+                control_client_telemetry(client, frame);
+            }
+            else if (seq >= 0 && frame->seq == (uint8_t)seq)
+            {
+                if (reply)
+                {
+                    *reply = *frame;
+                }
+                return 0;
+            }
+            else
+            {
+                client->stray_frames++;
+            }
+        }
+
+        int64_t left = deadline - control_client_now_ms();
+        if (left < 0)
+        {
+            return seq < 0 ? 0 : -1;
+        }
+
+        struct pollfd pfd = {.fd = client->fd, .events = POLLIN};
+        int ready = poll(&pfd, 1, (int)left);
+        if (ready < 0 && errno != EINTR)
+        {
+            return -1;
+        }
+        if (ready <= 0)
+        {
+            continue;
+        }
+
+        ssize_t got = read(client->fd, client->rx, sizeof(client->rx));
+        if (got < 0 && errno != EINTR && errno != EAGAIN)
+        {
+            return -1;
+        }
+        client->rx_length = got > 0 ? (size_t)got : 0;
+        client->rx_pos = 0;
+    }
+}
+
+int control_client_request(control_client_t *client, uint8_t type, const uint8_t *payload, size_t length,
+                           control_frame_t *reply, int timeout_ms)
+{
+    uint8_t out[CONTROL_FRAME_MAX];
+    uint8_t seq = client->seq++;
+    size_t size = control_frame_encode(type, seq, payload, length, out, sizeof(out));
+    if (size == 0)
+    {
+        return -1;
+    }
+
+    for (size_t sent = 0; sent < size;)
+    {
+        ssize_t n = write(client->fd, out + sent, size - sent);
+        if (n < 0 && errno != EINTR)
+        {
+            return -1;
+        }
+        sent += n > 0 ? (size_t)n : 0;
+    }
+    return control_client_wait(client, seq, reply, timeout_ms);
+}
+
+// ACK payload: request type, status, param, value
+static int control_client_ack(const control_frame_t *reply, uint8_t request, uint32_t *value)
+{
+    if (reply->type != CONTROL_MSG_ACK || reply->length != 7 || reply->payload[0] != request)
+    {
+        return -1;
+    }
+    if (value)
+    {
+        *value = control_get_u32(&reply->payload[3]);
+    }
+    return reply->payload[1];
+}
+
+int control_client_set_param(control_client_t *client, control_param_t param, uint32_t value, uint32_t *applied)
+{
+    uint8_t payload[5] = {(uint8_t)param};
+    control_frame_t reply;
+    control_put_u32(&payload[1], value);
+    if (control_client_request(client, CONTROL_MSG_SET_PARAM, payload, sizeof(payload), &reply,
+                               CONTROL_CLIENT_TIMEOUT_MS) != 0)
+    {
+        return -1;
+    }
+    return control_client_ack(&reply, CONTROL_MSG_SET_PARAM, applied);
+}
+
+int control_client_get_param(control_client_t *client, control_param_t param, uint32_t *value)
+{
+    uint8_t payload[1] = {(uint8_t)param};
+    control_frame_t reply;
+    if (control_client_request(client, CONTROL_MSG_GET_PARAM, payload, sizeof(payload), &reply,
+                               CONTROL_CLIENT_TIMEOUT_MS) != 0)
+    {
+        return -1;
+    }
+    return control_client_ack(&reply, CONTROL_MSG_GET_PARAM, value);
+}
+
+int control_client_stream(control_client_t *client, uint16_t interval_ms)
+{
+    uint8_t payload[2];
+    control_frame_t reply;
+    control_put_u16(payload, interval_ms);
+    if (control_client_request(client, CONTROL_MSG_STREAM, payload, sizeof(payload), &reply,
+                               CONTROL_CLIENT_TIMEOUT_MS) != 0)
+    {
+        return -1;
+    }
+    return control_client_ack(&reply, CONTROL_MSG_STREAM, NULL);
+}
+
+// Handles telemetry for the given time without sending anything
+int control_client_pump(control_client_t *client, int timeout_ms)
+{
+    return control_client_wait(client, -1, NULL, timeout_ms);
+}
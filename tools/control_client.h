@@ -0,0 +1,40 @@
+#ifndef CONTROL_CLIENT_H
+#define CONTROL_CLIENT_H
+
+#include <stdint.h>
+#include "control_protocol.h"
+
+// Host side of the binary control protocol, for rig scripts written in C.
+// POSIX only: the port is a tty opened raw, or any file descriptor that
+// behaves like one (a pty, a socket).
+#define CONTROL_CLIENT_TIMEOUT_MS 500
+
+typedef void (*control_telemetry_cb_t)(uint32_t time_ms, const uint32_t *values, size_t count, void *arg);
+
+typedef struct
+{
+    int fd;
+    uint8_t seq;
+    control_parser_t parser;
+    uint8_t rx[256]; // Read but not yet parsed, left over after a reply
+    size_t rx_length;
+    size_t rx_pos;
+    control_telemetry_cb_t on_telemetry; // Called for every snapshot that arrives while waiting
+    void *arg;
+    uint32_t telemetry_frames;
+    uint32_t stray_frames; // Replies to requests that already timed out
+} control_client_t;
+
+// Functions return 0 or a control_status_t from the device, -1 on I/O errors and timeouts
+int control_client_open(control_client_t *client, const char *path, int baud);
+void control_client_attach(control_client_t *client, int fd);
+void control_client_close(control_client_t *client);
+void control_client_on_telemetry(control_client_t *client, control_telemetry_cb_t cb, void *arg);
+int control_client_request(control_client_t *client, uint8_t type, const uint8_t *payload, size_t length,
+                           control_frame_t *reply, int timeout_ms);
+int control_client_set_param(control_client_t *client, control_param_t param, uint32_t value, uint32_t *applied);
+int control_client_get_param(control_client_t *client, control_param_t param, uint32_t *value);
+int control_client_stream(control_client_t *client, uint16_t interval_ms);
+int control_client_pump(control_client_t *client, int timeout_ms);
+
+#endif // CONTROL_CLIENT_H
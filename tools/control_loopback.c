@@ -0,0 +1,338 @@
+/*
+ * Loopback test for the binary control protocol. The firmware's dispatcher
+ * (main/control_protocol.c) runs in a thread on the master side of a pty
+ * with an in-memory device model; the reference client talks to the slave
+ * side exactly as it would to /dev/ttyUSB0:
+ *
+ *     gcc -std=c99 -O2 -Wall -pthread -I main/include -I tools -o control_loopback \
+ *         tools/control_loopback.c tools/control_client.c main/control_protocol.c
+ *     ./control_loopback [round trips]
+ *
+ * It checks replies, rejections, CRC error recovery and the telemetry rate,
+ * and prints the parameter write round-trip time. The exit status is the
+ * number of failed checks. The pty has no baud rate, so the times are the
+ * protocol and scheduling cost alone; on a real port add about 11 byte
+ * times per frame each way (0.12 ms at 921600 baud).
+ */
+#define _XOPEN_SOURCE 700
+#define _DEFAULT_SOURCE
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "control_client.h"
+
+#define LOOPBACK_ROUND_TRIPS 2000
+#define LOOPBACK_MAX_DELAY_MS 10000
+#define LOOPBACK_HIGHPASS_MIN_HZ 20
+#define LOOPBACK_HIGHPASS_MAX_HZ 1000
+#define LOOPBACK_GEN_TYPES 7
+#define LOOPBACK_GEN_MAX_HZ 20000
+#define LOOPBACK_FEEDBACK_Q15_MAX 32767
+#define LOOPBACK_STREAM_MS 20
+#define LOOPBACK_STREAM_WINDOW_MS 1000
+#define LOOPBACK_TELEMETRY_VALUES 18 // Same count as the firmware's metric rows
+
+static int device_fd = -1;
+static volatile int device_running = 1;
+static uint32_t device_params[CONTROL_PARAM_COUNT] = {30, 48000, 100, 0, 0, 1000, 50, 0, 0};
+static uint32_t device_snapshots = 0;
+static int failures = 0;
+
+#define CHECK(cond, ...)                  \
+    do                                    \
+    {                                     \
+        if (!(cond))                      \
+        {                                 \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n");                 \
+            failures++;                   \
+        }                                 \
+    } while (0)
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// Device model, with the firmware's limits
+static int device_get_param(control_param_t param, uint32_t *value)
+{
+    *value = device_params[param];
+    return 0;
+}
+
+static int device_set_param(control_param_t param, uint32_t value)
+{
+    if ((param == CONTROL_PARAM_DELAY_MS && value > LOOPBACK_MAX_DELAY_MS) ||
+        (param == CONTROL_PARAM_SAMPLE_RATE && value != 44100 && value != 48000 && value != 96000 &&
+         value != 192000) ||
+        (param == CONTROL_PARAM_MIX_PERCENT && value > 100) ||
+        (param == CONTROL_PARAM_HIGHPASS_HZ && value != 0 &&
+         (value < LOOPBACK_HIGHPASS_MIN_HZ || value > LOOPBACK_HIGHPASS_MAX_HZ)) ||
+        (param == CONTROL_PARAM_GEN_TYPE && value >= LOOPBACK_GEN_TYPES) ||
+        (param == CONTROL_PARAM_GEN_FREQ_HZ && (value == 0 || value > LOOPBACK_GEN_MAX_HZ)) ||
+        (param == CONTROL_PARAM_GEN_LEVEL_PERCENT && (value == 0 || value > 100)) ||
+        (param == CONTROL_PARAM_FEEDBACK_Q15 &&
+         ((int32_t)value < -LOOPBACK_FEEDBACK_Q15_MAX || (int32_t)value > LOOPBACK_FEEDBACK_Q15_MAX)) ||
+        (param == CONTROL_PARAM_DAMPING_Q15 && value > LOOPBACK_FEEDBACK_Q15_MAX))
+    {
+        return -1;
+    }
+    device_params[param] = value;
+    return 0;
+}
+
+static size_t device_telemetry(uint32_t *values, size_t max)
+{
+    size_t count = max < LOOPBACK_TELEMETRY_VALUES ? max : LOOPBACK_TELEMETRY_VALUES;
+    device_snapshots++;
+    for (size_t i = 0; i < count; i++)
+    {
+        values[i] = device_snapshots * 100 + (uint32_t)i;
+    }
+    return count;
+}
+
+static void device_write(const uint8_t *data, size_t length)
+{
+    while (length)
+    {
+        ssize_t n = write(device_fd, data, length);
+        if (n <= 0)
+        {
+            return;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+}
+
+static const control_ops_t device_ops = {
+    .get_param = device_get_param,
+    .set_param = device_set_param,
+    .telemetry = device_telemetry,
+    .write = device_write,
+};
+
+// Mirrors the firmware's control task: read what is there, then poll for telemetry
+static void *device_thread(void *arg)
+{
+    (void)arg;
+    uint32_t wait_ms = 10;
+
+    while (device_running)
+    {
+        struct pollfd pfd = {.fd = device_fd, .events = POLLIN};
+        if (poll(&pfd, 1, (int)(wait_ms > 10 ? 10 : wait_ms)) > 0)
+        {
+            uint8_t buffer[256];
+            ssize_t got = read(device_fd, buffer, sizeof(buffer));
+            if (got > 0)
+            {
+                control_protocol_receive(buffer, (size_t)got);
+            }
+        }
+        wait_ms = control_protocol_poll((uint32_t)(now_us() / 1000));
+    }
+    return NULL;
+}
+
+static int compare_i64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void on_telemetry(uint32_t time_ms, const uint32_t *values, size_t count, void *arg)
+{
+    uint32_t *last_count = arg;
+    (void)time_ms;
+    (void)values;
+    *last_count = (uint32_t)count;
+}
+
+static void test_round_trips(control_client_t *client, int round_trips)
+{
+    int64_t *rtt = malloc(sizeof(int64_t) * (size_t)round_trips);
+    int64_t total = 0;
+    if (!rtt)
+    {
+        return;
+    }
+
+    for (int i = 0; i < round_trips; i++)
+    {
+        uint32_t value = (uint32_t)(i * 37) % LOOPBACK_MAX_DELAY_MS, applied = 0;
+        int64_t start = now_us();
+        int status = control_client_set_param(client, CONTROL_PARAM_DELAY_MS, value, &applied);
+        rtt[i] = now_us() - start;
+        total += rtt[i];
+        CHECK(status == CONTROL_STATUS_OK && applied == value, "set delay %" PRIu32 ": status %d, applied %" PRIu32,
+              value, status, applied);
+    }
+
+    qsort(rtt, (size_t)round_trips, sizeof(int64_t), compare_i64);
+    printf("set_param round trip over %d writes: min %" PRId64 " us, mean %" PRId64 " us, p50 %" PRId64
+           " us, p99 %" PRId64 " us, max %" PRId64 " us\n",
+           round_trips, rtt[0], total / round_trips, rtt[round_trips / 2], rtt[(round_trips * 99) / 100],
+           rtt[round_trips - 1]);
+    free(rtt);
+}
+
+static void test_rejections(control_client_t *client)
+{
+    uint32_t before = 0, applied = 0;
+    control_client_get_param(client, CONTROL_PARAM_DELAY_MS, &before);
+
+    int status = control_client_set_param(client, CONTROL_PARAM_DELAY_MS, LOOPBACK_MAX_DELAY_MS + 1, &applied);
+    CHECK(status == CONTROL_STATUS_REJECTED && applied == before, "out of range delay: status %d", status);
+
+    status = control_client_set_param(client, CONTROL_PARAM_SAMPLE_RATE, 22050, &applied);
+    CHECK(status == CONTROL_STATUS_REJECTED && applied == 48000, "unsupported rate: status %d", status);
+
+    status = control_client_set_param(client, CONTROL_PARAM_SAMPLE_RATE, 96000, &applied);
+    CHECK(status == CONTROL_STATUS_OK && applied == 96000, "rate 96000: status %d", status);
+
+    status = control_client_set_param(client, CONTROL_PARAM_HIGHPASS_HZ, LOOPBACK_HIGHPASS_MAX_HZ + 1, &applied);
+    CHECK(status == CONTROL_STATUS_REJECTED && applied == 0, "out of range high-pass: status %d", status);
+
+    status = control_client_set_param(client, CONTROL_PARAM_HIGHPASS_HZ, 80, &applied);
+    CHECK(status == CONTROL_STATUS_OK && applied == 80, "high-pass 80: status %d", status);
+
+    status = control_client_set_param(client, CONTROL_PARAM_GEN_TYPE, LOOPBACK_GEN_TYPES, &applied);
+    CHECK(status == CONTROL_STATUS_REJECTED && applied == 0, "unknown generator: status %d", status);
+
+    status = control_client_set_param(client, CONTROL_PARAM_GEN_LEVEL_PERCENT, 101, &applied);
+    CHECK(status == CONTROL_STATUS_REJECTED && applied == 50, "generator level 101: status %d", status);
+
+    // Feedback is signed and travels as two's complement
+    status = control_client_set_param(client, CONTROL_PARAM_FEEDBACK_Q15, (uint32_t)-16000, &applied);
+    CHECK(status == CONTROL_STATUS_OK && (int32_t)applied == -16000, "feedback -16000: status %d", status);
+
+    status = control_client_set_param(client, CONTROL_PARAM_FEEDBACK_Q15, (uint32_t)-32768, &applied);
+    CHECK(status == CONTROL_STATUS_REJECTED && (int32_t)applied == -16000, "feedback -32768: status %d", status);
+
+    status = control_client_set_param(client, CONTROL_PARAM_DAMPING_Q15, 32768, &applied);
+    CHECK(status == CONTROL_STATUS_REJECTED && applied == 0, "damping 32768: status %d", status);
+
+    status = control_client_set_param(client, (control_param_t)CONTROL_PARAM_COUNT, 1, &applied);
+    CHECK(status == CONTROL_STATUS_BAD_PARAM, "unknown param: status %d", status);
+
+    control_frame_t reply;
+    status = control_client_request(client, 0x55, NULL, 0, &reply, CONTROL_CLIENT_TIMEOUT_MS);
+    CHECK(status == 0 && reply.type == CONTROL_MSG_ACK && reply.payload[1] == CONTROL_STATUS_BAD_FRAME,
+          "unknown type: status %d", status);
+}
+
+static void test_corruption(control_client_t *client)
+{
+    control_stats_t before, after;
+    control_protocol_get_stats(&before);
+
+    // Noise, an oversized length and a frame with a broken CRC; a good request must still get through
+    uint8_t payload[1] = {CONTROL_PARAM_MIX_PERCENT};
+    uint8_t frame[CONTROL_FRAME_MAX];
+    size_t size = control_frame_encode(CONTROL_MSG_GET_PARAM, 200, payload, sizeof(payload), frame, sizeof(frame));
+    frame[size - 1] ^= 0x40;
+    static const uint8_t noise[] = {0x00, 0xFF, 0x13, CONTROL_SOF, 0xFE};
+    CHECK(write(client->fd, noise, sizeof(noise)) == (ssize_t)sizeof(noise), "write noise");
+    CHECK(write(client->fd, frame, size) == (ssize_t)size, "write corrupt frame");
+
+    uint32_t mix = 0;
+    int status = control_client_get_param(client, CONTROL_PARAM_MIX_PERCENT, &mix);
+    CHECK(status == CONTROL_STATUS_OK && mix == 100, "request after corruption: status %d", status);
+
+    control_protocol_get_stats(&after);
+    CHECK(after.crc_errors == before.crc_errors + 1, "crc errors %" PRIu32 " -> %" PRIu32, before.crc_errors,
+          after.crc_errors);
+    CHECK(after.skipped > before.skipped, "noise not counted as skipped");
+}
+
+static void test_stream(control_client_t *client)
+{
+    uint32_t last_count = 0;
+    control_client_on_telemetry(client, on_telemetry, &last_count);
+
+    CHECK(control_client_stream(client, CONTROL_STREAM_MIN_MS - 1) == CONTROL_STATUS_REJECTED,
+          "too fast a stream accepted");
+    CHECK(control_client_stream(client, LOOPBACK_STREAM_MS) == CONTROL_STATUS_OK, "stream start");
+
+    // Writes keep working while snapshots arrive
+    uint32_t start_frames = client->telemetry_frames;
+    int64_t start = now_us();
+    for (int i = 0; i < 10; i++)
+    {
+        uint32_t applied = 0;
+        CHECK(control_client_set_param(client, CONTROL_PARAM_MIX_PERCENT, (uint32_t)i * 10, &applied) ==
+                  CONTROL_STATUS_OK,
+              "set mix while streaming");
+        control_client_pump(client, LOOPBACK_STREAM_WINDOW_MS / 10);
+    }
+    int64_t elapsed_ms = (now_us() - start) / 1000;
+    CHECK(control_client_stream(client, 0) == CONTROL_STATUS_OK, "stream stop");
+
+    uint32_t frames = client->telemetry_frames - start_frames;
+    uint32_t expected = (uint32_t)(elapsed_ms / LOOPBACK_STREAM_MS);
+    printf("telemetry: %" PRIu32 " snapshots of %" PRIu32 " values in %" PRId64 " ms at %d ms (expected about %" PRIu32
+           ")\n",
+           frames, last_count, elapsed_ms, LOOPBACK_STREAM_MS, expected);
+    CHECK(frames + 2 >= expected && frames <= expected + 2, "telemetry rate");
+    CHECK(last_count == LOOPBACK_TELEMETRY_VALUES, "telemetry value count %" PRIu32, last_count);
+
+    // Nothing more once stopped
+    frames = client->telemetry_frames;
+    control_client_pump(client, 5 * LOOPBACK_STREAM_MS);
+    CHECK(client->telemetry_frames == frames, "telemetry after stop");
+}
+
+int main(int argc, char **argv)
+{
+    int round_trips = argc > 1 ? atoi(argv[1]) : LOOPBACK_ROUND_TRIPS;
+    round_trips = round_trips > 0 ? round_trips : LOOPBACK_ROUND_TRIPS;
+
+    device_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (device_fd < 0 || grantpt(device_fd) != 0 || unlockpt(device_fd) != 0)
+    {
+        perror("pty");
+        return 1;
+    }
+
+    control_client_t client;
+    if (control_client_open(&client, ptsname(device_fd), 921600) != 0)
+    {
+        perror("open slave");
+        return 1;
+    }
+
+    control_protocol_init(&device_ops);
+    pthread_t thread;
+    pthread_create(&thread, NULL, device_thread, NULL);
+
+    control_frame_t reply;
+    uint8_t ping[3] = {1, 2, 3};
+    int status = control_client_request(&client, CONTROL_MSG_PING, ping, sizeof(ping), &reply, 1000);
+    CHECK(status == 0 && reply.type == CONTROL_MSG_PONG && reply.length == 3 && memcmp(reply.payload, ping, 3) == 0,
+          "ping");
+
+    test_round_trips(&client, round_trips);
+    test_rejections(&client);
+    test_corruption(&client);
+    test_stream(&client);
+
+    device_running = 0;
+    pthread_join(thread, NULL);
+    control_client_close(&client);
+    close(device_fd);
+
+    printf("%s: %d failed checks, %" PRIu32 " stray replies\n", failures ? "FAIL" : "PASS", failures,
+           client.stray_frames);
+    return failures;
+}
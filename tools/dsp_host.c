@@ -0,0 +1,61 @@
+/*
+ * Runs the DSP verification and timing suites of main/dsp_bench.c on a host.
+ * The firmware sources build unchanged against the stand-in IDF headers in
+ * tools/host:
+ *
+ *     gcc -std=gnu17 -O2 -Wall -DTRACE_ENABLED=0 -DMETRICS_ENABLED=0 -I main/include -I tools/host \
+ *         -o dsp_host tools/dsp_host.c main/dsp_bench.c main/dsp_kernels.c main/dsp_biquad.c main/dsp_fft.c \
+ *         main/dsp_convert.c main/dsp_backend.c main/signal_generator.c main/audio_delay_line.c \
+ *         main/audio_events.c main/audio_gate.c -lm
+ *     ./dsp_host [suite|all] [block samples]
+ *
+ * The delay suite runs the engine's block processing without the I2S task;
+ * trace and metrics are compiled out since the host has neither.
+ *
+ * Add -DDSP_BACKEND=1 to build the audio path's stages on the float backend;
+ * the backends suite reports which one it was built with.
+ *
+ * Every bit-exactness and accuracy check runs as on the board. Timings are
+ * host nanoseconds reported as cycles at 1 GHz, so only ratios (optimised
+ * against reference, fixed against float) carry over; board figures come
+ * from the console bench command. The exit status is the number of suites
+ * that failed.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dsp_bench.h"
+
+int main(int argc, char **argv)
+{
+    const char *only = argc > 1 ? argv[1] : "all";
+    size_t block = argc > 2 ? (size_t)strtoul(argv[2], NULL, 10) : 0;
+    int failures = 0;
+    int matched = 0;
+
+    for (size_t i = 0; i < dsp_bench_suite_count(); i++)
+    {
+        const char *name = dsp_bench_suite_name(i);
+        if (strcmp(only, "all") != 0 && strcmp(only, name) != 0)
+        {
+            continue;
+        }
+
+        matched++;
+        esp_err_t ret = dsp_bench_run_suite(name, block);
+        printf("%-10s %s\n", name, ret == ESP_OK ? "PASS" : esp_err_to_name(ret));
+        failures += ret != ESP_OK;
+    }
+
+    if (!matched)
+    {
+        fprintf(stderr, "usage: %s [suite|all] [block samples]\nsuites:", argv[0]);
+        for (size_t i = 0; i < dsp_bench_suite_count(); i++)
+        {
+            fprintf(stderr, " %s", dsp_bench_suite_name(i));
+        }
+        fprintf(stderr, "\n");
+        return 1;
+    }
+    return failures;
+}
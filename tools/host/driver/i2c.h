@@ -0,0 +1,9 @@
+#ifndef HOST_DRIVER_I2C_H
+#define HOST_DRIVER_I2C_H
+
+// Host stand-in so oled_display.h's geometry can be included; no bus access
+typedef int i2c_port_t;
+
+#define I2C_NUM_0 0
+
+#endif // HOST_DRIVER_I2C_H
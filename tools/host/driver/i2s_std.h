@@ -0,0 +1,6 @@
+#ifndef HOST_DRIVER_I2S_STD_H
+#define HOST_DRIVER_I2S_STD_H
+
+// Host stand-in so audio_delay.h can be included; no I2S access on the host
+
+#endif // HOST_DRIVER_I2S_STD_H
@@ -0,0 +1,20 @@
+#ifndef HOST_ESP_CPU_H
+#define HOST_ESP_CPU_H
+
+// Host stand-in: the "cycle" counter is the monotonic clock in nanoseconds,
+// with esp_clk_cpu_freq() reporting 1 GHz to match. Host numbers compare
+// kernels with each other; absolute figures for the board come from the
+// console bench command.
+#include <stdint.h>
+#include <time.h>
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+static inline esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (esp_cpu_cycle_count_t)((uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec);
+}
+
+#endif // HOST_ESP_CPU_H
@@ -0,0 +1,22 @@
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+// Host stand-in: log lines go to stdout in the IDF's "L (tag): message" shape.
+// Debug is compiled out as at the firmware's default INFO level.
+#include <stdio.h>
+
+#define HOST_LOG(level, tag, format, ...) printf(level " (%s): " format "\n", tag, ##__VA_ARGS__)
+
+#define ESP_LOGE(tag, format, ...) HOST_LOG("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) HOST_LOG("W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) HOST_LOG("I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...)                     \
+    do                                                 \
+    {                                                  \
+        if (0)                                         \
+        {                                              \
+            HOST_LOG("D", tag, format, ##__VA_ARGS__); \
+        }                                              \
+    } while (0)
+
+#endif // HOST_ESP_LOG_H
@@ -0,0 +1,10 @@
+#ifndef HOST_ESP_CLK_H
+#define HOST_ESP_CLK_H
+
+// Host stand-in, see esp_cpu.h: one nanosecond per "cycle"
+static inline int esp_clk_cpu_freq(void)
+{
+    return 1000000000;
+}
+
+#endif // HOST_ESP_CLK_H
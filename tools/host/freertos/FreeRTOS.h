@@ -0,0 +1,23 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+// Host stand-in: a 1 kHz tick on the monotonic clock, enough for the
+// bounded waits in the DSP sources. The host runs single-threaded, so
+// critical sections compile to nothing.
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+
+typedef struct
+{
+    int unused;
+} portMUX_TYPE;
+
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#define portMUX_INITIALIZE(mux) ((void)(mux))
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,7 @@
+#ifndef HOST_FREERTOS_SEMPHR_H
+#define HOST_FREERTOS_SEMPHR_H
+
+// Host stand-in so audio_delay.h can be included; nothing on the host takes a semaphore
+typedef void *SemaphoreHandle_t;
+
+#endif // HOST_FREERTOS_SEMPHR_H
@@ -0,0 +1,20 @@
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+
+static inline TickType_t xTaskGetTickCount(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (TickType_t)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+static inline void vTaskDelay(TickType_t ticks)
+{
+    struct timespec delay = {ticks / 1000, (long)(ticks % 1000) * 1000000};
+    nanosleep(&delay, NULL);
+}
+
+#endif // HOST_FREERTOS_TASK_H
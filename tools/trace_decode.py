@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""Decode a trace dump from the serial console into Chrome trace JSON.
+
+The firmware prints the dump (trace_buffer_dump) between TRACE-BEGIN and
+TRACE-END lines; everything else in the log is ignored, so a whole monitor
+capture can be fed in. Open the result in chrome://tracing or ui.perfetto.dev.
+
+    idf.py monitor | tee monitor.log
+    python3 tools/trace_decode.py monitor.log -o trace.json
+"""
+
+import argparse
+import json
+import re
+import sys
+
+FORMAT_VERSION = 1
+
+# ESP-IDF monitor may prefix or colour lines, so match anywhere in the line
+LINE_RE = re.compile(r"(TRACE-(?:BEGIN|ID|EV|END))\s+(.*)$")
+ANSI_RE = re.compile(r"\x1b\[[0-9;]*m")
+
+
+def parse_dumps(lines):
+    """Yield one dict per complete dump found in the log."""
+    dump = None
+    for raw in lines:
+        match = LINE_RE.search(ANSI_RE.sub("", raw.rstrip("\r\n")))
+        if not match:
+            continue
+        kind, fields = match.group(1), match.group(2).split()
+
+        if kind == "TRACE-BEGIN":
+            version = int(fields[0])
+            if version != FORMAT_VERSION:
+                raise ValueError("dump format %d, this decoder reads %d" % (version, FORMAT_VERSION))
+            dump = {"cores": int(fields[1]), "ring": int(fields[2]), "now_us": int(fields[3]),
+                    "ids": {}, "events": []}
+        elif dump is None:
+            continue
+        elif kind == "TRACE-ID":
+            dump["ids"][int(fields[0])] = {"phase": fields[1], "name": fields[2], "args": fields[3:5]}
+        elif kind == "TRACE-EV":
+            core, ts, event_id, arg0, arg1 = fields
+            dump["events"].append((int(core), int(ts, 16), int(event_id), int(arg0, 16), int(arg1, 16)))
+        elif kind == "TRACE-END":
+            if int(fields[0]) != len(dump["events"]):
+                print("warning: dump lists %s events, %d decoded" % (fields[0], len(dump["events"])),
+                      file=sys.stderr)
+            yield dump
+            dump = None
+
+    if dump is not None:
+        print("warning: last dump is truncated, ignored", file=sys.stderr)
+
+
+def unwrap_us(ts32, now_us):
+    """Extend a 32-bit microsecond stamp to the 64-bit clock; events are at most ~71 minutes old."""
+    return now_us - ((now_us - ts32) & 0xFFFFFFFF)
+
+
+def signed32(value):
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def to_chrome(dump):
+    """Chrome trace events: one process, one thread per core."""
+    out = [{"name": "thread_name", "ph": "M", "pid": 0, "tid": core, "args": {"name": "core %d" % core}}
+           for core in range(dump["cores"])]
+
+    events = sorted(dump["events"], key=lambda e: (unwrap_us(e[1], dump["now_us"]), e[0]))
+    open_spans = {}
+    for core, ts32, event_id, arg0, arg1 in events:
+        info = dump["ids"].get(event_id, {"phase": "i", "name": "event_%d" % event_id, "args": ["arg0", "arg1"]})
+        ts = unwrap_us(ts32, dump["now_us"])
+        args = {}
+        for name, value in zip(info["args"], (arg0, arg1)):
+            if name != "unused":
+                args[name] = signed32(value)
+
+        # Spans cut by the ring wrapping or the dump would confuse the viewer
+        key = (core, info["name"])
+        if info["phase"] == "B":
+            open_spans[key] = open_spans.get(key, 0) + 1
+        elif info["phase"] == "E":
+            if open_spans.get(key, 0) == 0:
+                continue
+            open_spans[key] -= 1
+
+        event = {"name": info["name"], "ph": info["phase"], "ts": ts, "pid": 0, "tid": core, "args": args}
+        if info["phase"] == "i":
+            event["s"] = "t"
+        elif info["phase"] == "C":
+            event["tid"] = 0
+        out.append(event)
+
+    return out
+
+
+def print_summary(dump):
+    counts = {}
+    for _, _, event_id, _, _ in dump["events"]:
+        name = dump["ids"].get(event_id, {"name": "event_%d" % event_id})["name"]
+        counts[name] = counts.get(name, 0) + 1
+    stamps = [unwrap_us(e[1], dump["now_us"]) for e in dump["events"]]
+    span_ms = (max(stamps) - min(stamps)) / 1000.0 if stamps else 0.0
+    print("%d events over %.1f ms" % (len(dump["events"]), span_ms), file=sys.stderr)
+    for name in sorted(counts, key=counts.get, reverse=True):
+        print("  %-20s %6d" % (name, counts[name]), file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", nargs="?", help="serial log holding the dump, stdin if omitted")
+    parser.add_argument("-o", "--output", help="Chrome trace JSON file, stdout if omitted")
+    parser.add_argument("-n", "--dump", type=int, default=-1,
+                        help="which dump to decode when the log holds several (default: last)")
+    args = parser.parse_args()
+
+    source = open(args.log, errors="replace") if args.log else sys.stdin
+    with source:
+        dumps = list(parse_dumps(source))
+    if not dumps:
+        print("no trace dump found", file=sys.stderr)
+        return 1
+
+    dump = dumps[args.dump]
+    print_summary(dump)
+    trace = {"traceEvents": to_chrome(dump), "displayTimeUnit": "ms"}
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+        sys.stdout.write("\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())